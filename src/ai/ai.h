@@ -22,8 +22,10 @@
 #ifndef __AI_H__
 #define __AI_H__
 
+#include "ai_aas.h"
 #include "ai_goal.h"
 #include "ai_main.h"
+#include "ai_path.h"
 #include "ai_types.h"
 
 #endif /* __AI_H__ */
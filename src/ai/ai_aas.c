@@ -0,0 +1,257 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ai_local.h"
+
+/*
+ * The AAS file is produced by quemap -aas alongside the BSP. It is loaded and
+ * byte-swapped in place, and the navigation graph points into the loaded buffer.
+ */
+
+ai_aas_t ai_aas;
+
+static void *ai_aas_buffer;
+
+/**
+ * @brief Resolves the specified lump of the AAS buffer, validating its bounds.
+ * @return The lump data, or NULL if the lump is invalid.
+ */
+static void *Ai_AasLump(void *buffer, int64_t len, const d_bsp_lump_t *lump, size_t size, int32_t *count) {
+
+	const int32_t ofs = LittleLong(lump->file_ofs);
+	const int32_t lump_len = LittleLong(lump->file_len);
+
+	if (ofs < (int32_t) sizeof(d_aas_header_t) || lump_len < 0 || ofs + (int64_t) lump_len > len ||
+			lump_len % size) {
+		return NULL;
+	}
+
+	*count = lump_len / size;
+	return ((byte *) buffer) + ofs;
+}
+
+/**
+ * @brief Initializes the navigation graph from the specified AAS buffer, which
+ * is byte-swapped in place and must persist until Ai_FreeAas.
+ * @return True if the buffer is a valid AAS file, false otherwise.
+ */
+_Bool Ai_InitAas(void *buffer, int64_t len) {
+	int32_t num_routes;
+
+	memset(&ai_aas, 0, sizeof(ai_aas));
+
+	if (len < (int64_t) sizeof(d_aas_header_t)) {
+		return false;
+	}
+
+	const d_aas_header_t *header = (d_aas_header_t *) buffer;
+
+	if (LittleLong(header->ident) != AAS_IDENT || LittleLong(header->version) != AAS_VERSION) {
+		return false;
+	}
+
+	ai_aas_t aas;
+	memset(&aas, 0, sizeof(aas));
+
+	aas.areas = Ai_AasLump(buffer, len, &header->lumps[AAS_LUMP_AREAS],
+			sizeof(d_aas_area_t), &aas.num_areas);
+	aas.reachability = Ai_AasLump(buffer, len, &header->lumps[AAS_LUMP_REACHABILITY],
+			sizeof(d_aas_reachability_t), &aas.num_reachability);
+	aas.leaf_areas = Ai_AasLump(buffer, len, &header->lumps[AAS_LUMP_LEAF_AREAS],
+			sizeof(int32_t), &aas.num_leaf_areas);
+	aas.clusters = Ai_AasLump(buffer, len, &header->lumps[AAS_LUMP_CLUSTERS],
+			sizeof(d_aas_cluster_t), &aas.num_clusters);
+	aas.routes = Ai_AasLump(buffer, len, &header->lumps[AAS_LUMP_ROUTES],
+			sizeof(uint16_t), &num_routes);
+
+	if (!aas.areas || !aas.reachability || !aas.leaf_areas || !aas.clusters || !aas.routes) {
+		return false;
+	}
+
+	if (num_routes != aas.num_clusters * aas.num_clusters) {
+		return false;
+	}
+
+	d_aas_area_t *area = aas.areas;
+	for (int32_t i = 0; i < aas.num_areas; i++, area++) {
+
+		area->flags = LittleLong(area->flags);
+		area->cluster = LittleLong(area->cluster);
+
+		for (int32_t j = 0; j < 3; j++) {
+			area->mins[j] = LittleFloat(area->mins[j]);
+			area->maxs[j] = LittleFloat(area->maxs[j]);
+			area->origin[j] = LittleFloat(area->origin[j]);
+		}
+
+		area->first_reachability = LittleLong(area->first_reachability);
+		area->num_reachability = LittleLong(area->num_reachability);
+
+		if (area->cluster < 0 || area->cluster >= aas.num_clusters ||
+				area->first_reachability < 0 || area->num_reachability < 0 ||
+				area->first_reachability + area->num_reachability > aas.num_reachability) {
+			return false;
+		}
+	}
+
+	d_aas_reachability_t *reach = aas.reachability;
+	for (int32_t i = 0; i < aas.num_reachability; i++, reach++) {
+
+		reach->travel = LittleLong(reach->travel);
+		reach->area = LittleLong(reach->area);
+
+		for (int32_t j = 0; j < 3; j++) {
+			reach->start[j] = LittleFloat(reach->start[j]);
+			reach->end[j] = LittleFloat(reach->end[j]);
+		}
+
+		reach->cost = LittleLong(reach->cost);
+
+		if (reach->area < 0 || reach->area >= aas.num_areas || reach->cost < 0) {
+			return false;
+		}
+	}
+
+	// the path heuristic is the distance between area origins, so no reachability
+	// may cost less than that, or paths would be suboptimal
+	area = aas.areas;
+	for (int32_t i = 0; i < aas.num_areas; i++, area++) {
+
+		reach = aas.reachability + area->first_reachability;
+		for (int32_t j = 0; j < area->num_reachability; j++, reach++) {
+			vec3_t delta;
+
+			VectorSubtract(aas.areas[reach->area].origin, area->origin, delta);
+			reach->cost = MAX(reach->cost, (int32_t) ceilf(VectorLength(delta)));
+		}
+	}
+
+	for (int32_t i = 0; i < aas.num_leaf_areas; i++) {
+		aas.leaf_areas[i] = LittleLong(aas.leaf_areas[i]);
+
+		if (aas.leaf_areas[i] < AAS_INVALID_AREA || aas.leaf_areas[i] >= aas.num_areas) {
+			return false;
+		}
+	}
+
+	d_aas_cluster_t *cluster = aas.clusters;
+	for (int32_t i = 0; i < aas.num_clusters; i++, cluster++) {
+
+		for (int32_t j = 0; j < 3; j++) {
+			cluster->origin[j] = LittleFloat(cluster->origin[j]);
+		}
+
+		cluster->num_areas = LittleLong(cluster->num_areas);
+	}
+
+	for (int32_t i = 0; i < num_routes; i++) {
+		aas.routes[i] = LittleShort(aas.routes[i]);
+
+		if (aas.routes[i] != AAS_INVALID_ROUTE && aas.routes[i] >= aas.num_clusters) {
+			return false;
+		}
+	}
+
+	ai_aas = aas;
+	return true;
+}
+
+/**
+ * @brief Loads the navigation graph for the specified map, if it has one. Bots
+ * on maps without an AAS file simply have no paths.
+ */
+void Ai_LoadAas(const char *name) {
+
+	Ai_FreeAas();
+
+	const int64_t len = Fs_Load(name, &ai_aas_buffer);
+	if (len == -1) {
+		Com_Debug("No AAS file %s\n", name);
+		return;
+	}
+
+	if (!Ai_InitAas(ai_aas_buffer, len)) {
+		Com_Warn("Invalid AAS file %s\n", name);
+		Ai_FreeAas();
+		return;
+	}
+
+	Com_Debug("Loaded %s: %d areas, %d reachabilities, %d clusters\n", name, ai_aas.num_areas,
+			ai_aas.num_reachability, ai_aas.num_clusters);
+}
+
+/**
+ * @brief Frees the navigation graph, and all cached paths through it.
+ */
+void Ai_FreeAas(void) {
+
+	Ai_FreePaths();
+
+	if (ai_aas_buffer) {
+		Fs_Free(ai_aas_buffer);
+		ai_aas_buffer = NULL;
+	}
+
+	memset(&ai_aas, 0, sizeof(ai_aas));
+}
+
+/**
+ * @return The area number of the specified leaf, or AAS_INVALID_AREA.
+ */
+static int32_t Ai_LeafArea(int32_t leaf_num) {
+
+	if (leaf_num < 0 || leaf_num >= ai_aas.num_leaf_areas) {
+		return AAS_INVALID_AREA;
+	}
+
+	return ai_aas.leaf_areas[leaf_num];
+}
+
+/**
+ * @brief Resolves the area the specified position stands in. Areas are keyed by
+ * the leaf just above their floor, so the position is first dropped to the
+ * ground. Positions in water or on ladders resolve to the leaf they are in.
+ * @return The area number, or AAS_INVALID_AREA.
+ */
+int32_t Ai_PointArea(const vec3_t pos) {
+	vec3_t end;
+
+	if (!ai_aas.num_areas) {
+		return AAS_INVALID_AREA;
+	}
+
+	const int32_t area = Ai_LeafArea(Cm_PointLeafnum(pos, 0));
+	if (area != AAS_INVALID_AREA && !(ai_aas.areas[area].flags & AAS_AREA_GROUNDED)) {
+		return area;
+	}
+
+	VectorMA(pos, -MAX_WORLD_DIST, vec3_up, end);
+
+	const cm_trace_t tr = Cm_BoxTrace(pos, end, vec3_origin, vec3_origin, 0, MASK_CLIP_PLAYER);
+	if (tr.start_solid || tr.fraction == 1.0) {
+		return area;
+	}
+
+	VectorMA(tr.end, 1.0, vec3_up, end);
+
+	const int32_t ground = Ai_LeafArea(Cm_PointLeafnum(end, 0));
+	return ground != AAS_INVALID_AREA ? ground : area;
+}
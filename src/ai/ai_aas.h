@@ -0,0 +1,37 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __AI_AAS_H__
+#define __AI_AAS_H__
+
+#include "ai_types.h"
+
+void Ai_LoadAas(const char *name);
+void Ai_FreeAas(void);
+int32_t Ai_PointArea(const vec3_t pos);
+
+#ifdef __AI_LOCAL_H__
+_Bool Ai_InitAas(void *buffer, int64_t len);
+
+extern ai_aas_t ai_aas;
+#endif /* __AI_LOCAL_H__ */
+
+#endif /* __AI_AAS_H__ */
@@ -22,6 +22,8 @@
 #ifndef __AI_LOCAL_H__
 #define __AI_LOCAL_H__
 
+#include "collision/cmodel.h"
+
 #include "ai.h"
 
 #endif /* __AI_LOCAL_H__ */
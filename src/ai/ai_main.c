@@ -32,5 +32,8 @@ void Ai_Init(void) {
  * @brief Shuts down the AI subsystem.
  */
 void Ai_Shutdown(void) {
+
+	Ai_FreeAas();
+
 	Mem_FreeTag(MEM_TAG_AI);
 }
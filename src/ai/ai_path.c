@@ -0,0 +1,535 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include <SDL2/SDL_atomic.h>
+
+#include "ai_local.h"
+
+/*
+ * Paths are resolved with A* over the areas of the navigation graph. The search
+ * is first confined to the clusters along the precomputed cluster route, and
+ * only widened to the whole graph if that fails. Resolved paths, including the
+ * absence of one, are kept in a least recently used cache keyed by their start
+ * and goal areas, so that bots pursuing common goals rarely search at all.
+ *
+ * Searches run on whichever threads are thinking for bots. Each takes a set of
+ * scratch buffers, sized to the navigation graph, from a free list, and returns
+ * it when done, so searching does not touch the allocator. Paths leaving the
+ * cache are only freed once the cache is unlocked.
+ */
+
+#define AI_PATH_CACHE_SIZE 1024
+
+typedef struct {
+	int32_t cost; // the estimated total cost through this area
+	int32_t area;
+} ai_path_node_t;
+
+typedef struct {
+	ai_path_node_t *nodes;
+	int32_t size, capacity;
+} ai_path_heap_t;
+
+typedef struct ai_path_scratch_s {
+	int32_t *cost;
+	int32_t *via;
+	int32_t *from;
+	byte *clusters;
+	ai_path_heap_t heap;
+
+	struct ai_path_scratch_s *next; // in the free list
+} ai_path_scratch_t;
+
+typedef struct {
+	SDL_SpinLock lock;
+
+	GHashTable *paths; // ai_path_t, by key
+	GQueue lru; // ai_path_t, most recently used first
+	GQueue evicted; // ai_path_t, to be freed once the cache is unlocked
+
+	ai_path_scratch_t *scratch; // the free list
+
+	ai_path_stats_t stats;
+} ai_path_state_t;
+
+static ai_path_state_t ai_path_state;
+
+/**
+ * @brief Pushes a node onto the binary min-heap, growing it if necessary.
+ */
+static void Ai_HeapPush(ai_path_heap_t *heap, ai_path_node_t node) {
+
+	if (heap->size == heap->capacity) {
+		heap->capacity *= 2;
+
+		ai_path_node_t *nodes = Mem_TagMalloc(heap->capacity * sizeof(ai_path_node_t), MEM_TAG_AI);
+		memcpy(nodes, heap->nodes, heap->size * sizeof(ai_path_node_t));
+
+		Mem_Free(heap->nodes);
+		heap->nodes = nodes;
+	}
+
+	int32_t i = heap->size++;
+
+	while (i > 0) {
+		const int32_t parent = (i - 1) / 2;
+		if (heap->nodes[parent].cost <= node.cost) {
+			break;
+		}
+		heap->nodes[i] = heap->nodes[parent];
+		i = parent;
+	}
+
+	heap->nodes[i] = node;
+}
+
+/**
+ * @brief Pops the least costly node from the binary min-heap.
+ */
+static ai_path_node_t Ai_HeapPop(ai_path_heap_t *heap) {
+
+	const ai_path_node_t top = heap->nodes[0];
+	const ai_path_node_t last = heap->nodes[--heap->size];
+
+	int32_t i = 0;
+	while (true) {
+		int32_t child = i * 2 + 1;
+		if (child >= heap->size) {
+			break;
+		}
+		if (child + 1 < heap->size && heap->nodes[child + 1].cost < heap->nodes[child].cost) {
+			child++;
+		}
+		if (heap->nodes[child].cost >= last.cost) {
+			break;
+		}
+		heap->nodes[i] = heap->nodes[child];
+		i = child;
+	}
+
+	heap->nodes[i] = last;
+	return top;
+}
+
+/**
+ * @return The A* heuristic for the specified area: the distance to the goal. This
+ * is consistent because no reachability costs less than the distance between the
+ * origins of its areas, which Ai_InitAas enforces.
+ */
+static int32_t Ai_PathHeuristic(int32_t area, int32_t goal) {
+	vec3_t delta;
+
+	VectorSubtract(ai_aas.areas[goal].origin, ai_aas.areas[area].origin, delta);
+	return (int32_t) VectorLength(delta);
+}
+
+/**
+ * @brief Takes a set of scratch buffers from the free list, allocating one sized
+ * to the navigation graph if none is free.
+ */
+static ai_path_scratch_t *Ai_AcquireScratch(void) {
+
+	SDL_AtomicLock(&ai_path_state.lock);
+
+	ai_path_scratch_t *scratch = ai_path_state.scratch;
+	if (scratch) {
+		ai_path_state.scratch = scratch->next;
+	}
+
+	SDL_AtomicUnlock(&ai_path_state.lock);
+
+	if (scratch == NULL) {
+		scratch = Mem_TagMalloc(sizeof(ai_path_scratch_t), MEM_TAG_AI);
+
+		scratch->cost = Mem_LinkMalloc(ai_aas.num_areas * sizeof(int32_t), scratch);
+		scratch->via = Mem_LinkMalloc(ai_aas.num_areas * sizeof(int32_t), scratch);
+		scratch->from = Mem_LinkMalloc(ai_aas.num_areas * sizeof(int32_t), scratch);
+		scratch->clusters = Mem_LinkMalloc(MAX(ai_aas.num_clusters, 1), scratch);
+
+		// with a consistent heuristic, each reachability is pushed at most once
+		scratch->heap.capacity = MAX(ai_aas.num_reachability + 1, 16);
+		scratch->heap.nodes = Mem_TagMalloc(scratch->heap.capacity * sizeof(ai_path_node_t), MEM_TAG_AI);
+	}
+
+	return scratch;
+}
+
+/**
+ * @brief Returns the scratch buffers to the free list.
+ */
+static void Ai_ReleaseScratch(ai_path_scratch_t *scratch) {
+
+	SDL_AtomicLock(&ai_path_state.lock);
+
+	scratch->next = ai_path_state.scratch;
+	ai_path_state.scratch = scratch;
+
+	SDL_AtomicUnlock(&ai_path_state.lock);
+}
+
+/**
+ * @brief Frees the specified scratch buffers.
+ */
+static void Ai_FreeScratch(ai_path_scratch_t *scratch) {
+
+	Mem_Free(scratch->heap.nodes);
+	Mem_Free(scratch);
+}
+
+/**
+ * @brief Searches for a path from `start` to `goal`, expanding only areas in
+ * clusters for which `clusters` is set, or all areas if `clusters` is NULL.
+ * @return True if a path was found, with `path` populated.
+ */
+static _Bool Ai_AStar(ai_path_scratch_t *scratch, int32_t start, int32_t goal, const byte *clusters,
+		ai_path_t *path) {
+
+	int32_t *cost = scratch->cost;
+	int32_t *via = scratch->via;
+	int32_t *from = scratch->from;
+
+	ai_path_heap_t *heap = &scratch->heap;
+	heap->size = 0;
+
+	for (int32_t i = 0; i < ai_aas.num_areas; i++) {
+		cost[i] = INT32_MAX;
+	}
+
+	cost[start] = 0;
+	via[start] = from[start] = -1;
+
+	Ai_HeapPush(heap, (ai_path_node_t) {
+		.cost = Ai_PathHeuristic(start, goal), .area = start
+	});
+
+	_Bool found = false;
+
+	while (heap->size) {
+		const ai_path_node_t node = Ai_HeapPop(heap);
+
+		if (node.area == goal) {
+			found = true;
+			break;
+		}
+
+		if (node.cost - Ai_PathHeuristic(node.area, goal) > cost[node.area]) {
+			continue; // stale
+		}
+
+		const d_aas_area_t *area = &ai_aas.areas[node.area];
+
+		for (int32_t i = 0; i < area->num_reachability; i++) {
+			const int32_t r = area->first_reachability + i;
+			const d_aas_reachability_t *reach = &ai_aas.reachability[r];
+
+			if (clusters && !clusters[ai_aas.areas[reach->area].cluster]) {
+				continue;
+			}
+
+			const int32_t c = cost[node.area] + MAX(reach->cost, 1);
+			if (c < cost[reach->area]) {
+				cost[reach->area] = c;
+				via[reach->area] = r;
+				from[reach->area] = node.area;
+
+				Ai_HeapPush(heap, (ai_path_node_t) {
+					.cost = c + Ai_PathHeuristic(reach->area, goal), .area = reach->area
+				});
+			}
+		}
+	}
+
+	if (found) {
+		int32_t count = 0;
+		for (int32_t a = goal; a != start; a = from[a]) {
+			count++;
+		}
+
+		path->num_reachability = count;
+		path->reachability = Mem_TagMalloc(MAX(count, 1) * sizeof(int32_t), MEM_TAG_AI);
+
+		for (int32_t a = goal; a != start; a = from[a]) {
+			path->reachability[--count] = via[a];
+		}
+	}
+
+	return found;
+}
+
+/**
+ * @brief Resolves a new path from `start` to `goal`. The search is confined to
+ * the cluster route first, and the whole graph second.
+ */
+static ai_path_t *Ai_ResolvePath(int32_t start, int32_t goal) {
+
+	ai_path_t *path = Mem_TagMalloc(sizeof(ai_path_t), MEM_TAG_AI);
+
+	path->key = ((uint64_t) start << 32) | (uint32_t) goal;
+	path->start = start;
+	path->goal = goal;
+	path->num_reachability = -1;
+
+	path->link = g_list_alloc();
+	path->link->data = path;
+
+	ai_path_scratch_t *scratch = Ai_AcquireScratch();
+
+	const int32_t n = ai_aas.num_clusters;
+	const int32_t goal_cluster = ai_aas.areas[goal].cluster;
+
+	byte *clusters = scratch->clusters;
+	memset(clusters, 0, n);
+
+	int32_t c = ai_aas.areas[start].cluster;
+	clusters[c] = true;
+
+	while (c != goal_cluster) {
+		c = ai_aas.routes[c * n + goal_cluster];
+
+		if (c == AAS_INVALID_ROUTE) {
+			break;
+		}
+
+		if (clusters[c]) {
+			break; // malformed routes, let the full search sort it out
+		}
+
+		clusters[c] = true;
+	}
+
+	if (c != AAS_INVALID_ROUTE) {
+		if (!Ai_AStar(scratch, start, goal, clusters, path)) {
+			Ai_AStar(scratch, start, goal, NULL, path);
+		}
+	}
+
+	Ai_ReleaseScratch(scratch);
+
+	return path;
+}
+
+/**
+ * @brief Frees the specified path, and its link.
+ */
+static void Ai_FreePath(gpointer data) {
+	ai_path_t *path = (ai_path_t *) data;
+
+	g_list_free_1(path->link);
+
+	if (path->reachability) {
+		Mem_Free(path->reachability);
+	}
+
+	Mem_Free(path);
+}
+
+/**
+ * @brief Unlocks the path cache, and then frees any paths evicted while it was
+ * locked, so that other threads do not spin on the allocator.
+ */
+static void Ai_UnlockPaths(void) {
+
+	GQueue evicted = ai_path_state.evicted;
+	g_queue_init(&ai_path_state.evicted);
+
+	SDL_AtomicUnlock(&ai_path_state.lock);
+
+	GList *link = evicted.head;
+	while (link) {
+		GList *next = link->next;
+		Ai_FreePath(link->data);
+		link = next;
+	}
+}
+
+/**
+ * @brief Resolves the path from `start` to `goal`, from the cache if possible.
+ * @remarks This returns with the path cache locked, so that the path may be
+ * read safely. The caller must unlock it with Ai_UnlockPaths.
+ */
+static const ai_path_t *Ai_Path(int32_t start, int32_t goal) {
+
+	const uint64_t key = ((uint64_t) start << 32) | (uint32_t) goal;
+
+	SDL_AtomicLock(&ai_path_state.lock);
+
+	if (ai_path_state.paths == NULL) {
+		ai_path_state.paths = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, Ai_FreePath);
+	}
+
+	ai_path_t *path = g_hash_table_lookup(ai_path_state.paths, &key);
+	if (path) {
+		g_queue_unlink(&ai_path_state.lru, path->link);
+		g_queue_push_head_link(&ai_path_state.lru, path->link);
+
+		ai_path_state.stats.hits++;
+		return path;
+	}
+
+	ai_path_state.stats.misses++;
+
+	SDL_AtomicUnlock(&ai_path_state.lock);
+
+	path = Ai_ResolvePath(start, goal);
+
+	SDL_AtomicLock(&ai_path_state.lock);
+
+	// another thread may have resolved the same path while we were searching
+	ai_path_t *existing = g_hash_table_lookup(ai_path_state.paths, &key);
+	if (existing) {
+		g_queue_push_tail_link(&ai_path_state.evicted, path->link);
+		return existing;
+	}
+
+	while (g_queue_get_length(&ai_path_state.lru) >= AI_PATH_CACHE_SIZE) {
+		GList *link = ai_path_state.lru.tail;
+		g_queue_unlink(&ai_path_state.lru, link);
+
+		ai_path_t *evict = link->data;
+		g_hash_table_steal(ai_path_state.paths, &evict->key);
+
+		g_queue_push_tail_link(&ai_path_state.evicted, link);
+
+		ai_path_state.stats.evictions++;
+	}
+
+	g_queue_push_head_link(&ai_path_state.lru, path->link);
+
+	g_hash_table_insert(ai_path_state.paths, &path->key, path);
+
+	return path;
+}
+
+/**
+ * @brief Resolves the reachabilities to traverse from area `start` to `goal`.
+ * @return The number of reachabilities in the path, which may exceed
+ * `max_reachability`, or -1 if the goal is unreachable.
+ */
+int32_t Ai_AreaPath(int32_t start, int32_t goal, int32_t *reachability, int32_t max_reachability) {
+
+	if (start < 0 || start >= ai_aas.num_areas || goal < 0 || goal >= ai_aas.num_areas) {
+		return -1;
+	}
+
+	const ai_path_t *path = Ai_Path(start, goal);
+
+	const int32_t count = path->num_reachability;
+	if (count > 0) {
+		memcpy(reachability, path->reachability, MIN(count, max_reachability) * sizeof(int32_t));
+	}
+
+	Ai_UnlockPaths();
+
+	return count;
+}
+
+/**
+ * @brief Resolves a path of waypoints from `start` to `goal`. Each reachability
+ * contributes its end point, preceded by its start point if it is not walked.
+ * The goal itself is the final point.
+ * @return The number of points written to `points`, or 0 if no path exists.
+ */
+size_t Ai_FindPath(const vec3_t start, const vec3_t goal, vec3_t *points, size_t max_points) {
+	size_t count = 0;
+
+	const int32_t start_area = Ai_PointArea(start);
+	const int32_t goal_area = Ai_PointArea(goal);
+
+	if (start_area == AAS_INVALID_AREA || goal_area == AAS_INVALID_AREA || max_points == 0) {
+		return 0;
+	}
+
+	const ai_path_t *path = Ai_Path(start_area, goal_area);
+
+	for (int32_t i = 0; i < path->num_reachability && count < max_points; i++) {
+		const d_aas_reachability_t *reach = &ai_aas.reachability[path->reachability[i]];
+
+		if (reach->travel != AAS_TRAVEL_WALK) {
+			VectorCopy(reach->start, points[count]);
+			if (++count == max_points) {
+				break;
+			}
+		}
+
+		VectorCopy(reach->end, points[count]);
+		count++;
+	}
+
+	const _Bool found = path->num_reachability != -1;
+
+	Ai_UnlockPaths();
+
+	if (!found) {
+		return 0;
+	}
+
+	if (count < max_points) {
+		VectorCopy(goal, points[count]);
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * @brief Copies the path cache statistics to `stats`.
+ */
+void Ai_PathStats(ai_path_stats_t *stats) {
+
+	SDL_AtomicLock(&ai_path_state.lock);
+
+	*stats = ai_path_state.stats;
+	stats->paths = g_queue_get_length(&ai_path_state.lru);
+
+	SDL_AtomicUnlock(&ai_path_state.lock);
+}
+
+/**
+ * @brief Frees all cached paths, which must be done whenever the navigation
+ * graph changes.
+ */
+void Ai_FreePaths(void) {
+
+	SDL_AtomicLock(&ai_path_state.lock);
+
+	if (ai_path_state.paths) {
+		Com_Debug("Path cache: %u hits, %u misses, %u evictions\n", ai_path_state.stats.hits,
+				ai_path_state.stats.misses, ai_path_state.stats.evictions);
+
+		g_hash_table_destroy(ai_path_state.paths); // frees the links, too
+		ai_path_state.paths = NULL;
+	}
+
+	g_queue_init(&ai_path_state.lru);
+	memset(&ai_path_state.stats, 0, sizeof(ai_path_state.stats));
+
+	// the scratch buffers are sized to the navigation graph, so they go too
+	ai_path_scratch_t *scratch = ai_path_state.scratch;
+	ai_path_state.scratch = NULL;
+
+	Ai_UnlockPaths();
+
+	while (scratch) {
+		ai_path_scratch_t *next = scratch->next;
+		Ai_FreeScratch(scratch);
+		scratch = next;
+	}
+}
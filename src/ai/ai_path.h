@@ -0,0 +1,35 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __AI_PATH_H__
+#define __AI_PATH_H__
+
+#include "ai_types.h"
+
+size_t Ai_FindPath(const vec3_t start, const vec3_t goal, vec3_t *points, size_t max_points);
+void Ai_PathStats(ai_path_stats_t *stats);
+void Ai_FreePaths(void);
+
+#ifdef __AI_LOCAL_H__
+int32_t Ai_AreaPath(int32_t start, int32_t goal, int32_t *reachability, int32_t max_reachability);
+#endif /* __AI_LOCAL_H__ */
+
+#endif /* __AI_PATH_H__ */
@@ -22,19 +22,51 @@
 #ifndef __AI_TYPES_H__
 #define __AI_TYPES_H__
 
+#include "files.h"
 #include "mem.h"
 #include "game/game.h"
 
+/**
+ * @brief The loaded navigation graph. See d_aas_header_t.
+ */
 typedef struct {
-	GList *portals;
+	d_aas_area_t *areas;
+	int32_t num_areas;
+
+	d_aas_reachability_t *reachability;
+	int32_t num_reachability;
+
+	int32_t *leaf_areas;
+	int32_t num_leaf_areas;
+
+	d_aas_cluster_t *clusters;
+	int32_t num_clusters;
+
+	uint16_t *routes;
+} ai_aas_t;
+
+/**
+ * @brief A path between two areas, as the reachabilities to traverse. Paths are
+ * owned by the path cache.
+ */
+typedef struct {
+	uint64_t key; // the start and goal areas
+	int32_t start;
+	int32_t goal;
+	int32_t num_reachability; // -1 if the goal is unreachable
+	int32_t *reachability;
+	GList *link; // in the least recently used queue, or awaiting Ai_FreePath
 } ai_path_t;
 
+/**
+ * @brief Path cache statistics.
+ */
 typedef struct {
-	cm_bsp_plane_t *plane;
-	vec3_t mins;
-	vec3_t maxs;
-	GHashTable *paths;
-} ai_node_t;
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t evictions;
+	uint32_t paths;
+} ai_path_stats_t;
 
 typedef enum {
 	AI_GOAL_NAV,
@@ -47,7 +79,7 @@ typedef struct {
 	ai_goal_type_t type;
 	g_entity_t *ent;
 	vec_t priority;
-	ai_node_t *node;
+	int32_t area;
 } ai_goal_t;
 
 #endif /* __AI_TYPES_H__ */
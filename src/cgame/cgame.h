@@ -24,7 +24,7 @@
 
 #include "client/cl_types.h"
 
-#define CGAME_API_VERSION 1
+#define CGAME_API_VERSION 2
 
 // exposed to the client game by the engine
 typedef struct cg_import_s {
@@ -112,6 +112,7 @@ typedef struct cg_import_s {
 	*(*AddLinkedEntity)(const r_entity_t *parent, const r_model_t *model, const char *tag_name);
 	void (*AddLight)(const r_light_t *l);
 	void (*AddParticle)(const r_particle_t *p);
+	void (*AddParticles)(const r_particle_t *p, const size_t count);
 	void (*AddSustainedLight)(const r_sustained_light_t *s);
 
 	// 2D drawing facilities
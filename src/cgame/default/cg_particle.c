@@ -21,100 +21,119 @@
 
 #include "cg_local.h"
 
-static cg_particle_t *cg_free_particles; // list of free particles
-static cg_particles_t *cg_active_particles; // list of active particles, by image
-
-static cg_particle_t cg_particles[MAX_PARTICLES];
+/*
+ * Particles are pooled by image, and each pool stores its particles as a
+ * structure of arrays: one array of each simulated quantity, followed by the
+ * r_particle_t which is added to the view. Particles are updated one quantity
+ * at a time over the whole pool, and dead particles are compacted away, so no
+ * lists are walked. Cg_AllocParticle returns a staging particle for the caller
+ * to populate, which is appended to its pool after the pools are next updated.
+ */
 
 /**
- * @brief Pushes the particle onto the head of specified list.
+ * @brief The simulated quantities of each particle, stored as arrays.
  */
-static void Cg_PushParticle(cg_particle_t *p, cg_particle_t **list) {
+typedef enum {
+	CG_PARTICLE_ORG,
+	CG_PARTICLE_END = CG_PARTICLE_ORG + 3,
+	CG_PARTICLE_VEL = CG_PARTICLE_END + 3,
+	CG_PARTICLE_ACCEL = CG_PARTICLE_VEL + 3,
+	CG_PARTICLE_COLOR = CG_PARTICLE_ACCEL + 3,
+	CG_PARTICLE_COLOR_VEL = CG_PARTICLE_COLOR + 4,
+	CG_PARTICLE_SCALE = CG_PARTICLE_COLOR_VEL + 4,
+	CG_PARTICLE_SCALE_VEL,
+	CG_PARTICLE_END_Z,
+	CG_PARTICLE_FIELDS
+} cg_particle_field_t;
 
-	p->prev = NULL;
+#define CG_PARTICLE_MIN_CAPACITY 64
 
-	if (*list) {
-		(*list)->prev = p;
-	}
+static cg_particles_t *cg_active_particles; // list of particle pools, by image
+
+static cg_particle_t cg_spawned_particles[MAX_PARTICLES]; // allocated since the last update
+static cg_particles_t *cg_spawned_pools[MAX_PARTICLES]; // and the pool of each
+static uint32_t cg_num_spawned_particles;
 
-	p->next = *list;
-	*list = p;
+static uint32_t cg_num_particles; // in all pools
+
+static uint32_t cg_live_particles[MAX_PARTICLES]; // scratch for compacting a pool
+
+/**
+ * @return The array of the specified field of the pool.
+ */
+static inline vec_t *Cg_ParticleField(const cg_particles_t *ps, const cg_particle_field_t field) {
+	return ps->fields + field * ps->capacity;
 }
 
 /**
- * @brief Pops the particle from the specified list, repairing the list if it
- * becomes broken.
+ * @brief Ensures the pool has room for the specified number of particles.
  */
-static void Cg_PopParticle(cg_particle_t *p, cg_particle_t **list) {
+static void Cg_ReserveParticles(cg_particles_t *ps, const uint32_t count) {
+
+	if (count <= ps->capacity) {
+		return;
+	}
 
-	if (p->prev) {
-		p->prev->next = p->next;
+	uint32_t capacity = MAX(ps->capacity * 2, CG_PARTICLE_MIN_CAPACITY);
+	while (capacity < count) {
+		capacity *= 2;
 	}
 
-	if (p->next) {
-		p->next->prev = p->prev;
+	r_particle_t *parts = cgi.LinkMalloc(capacity * sizeof(r_particle_t), ps);
+	vec_t *fields = cgi.LinkMalloc(capacity * CG_PARTICLE_FIELDS * sizeof(vec_t), ps);
+
+	if (ps->count) {
+		memcpy(parts, ps->parts, ps->count * sizeof(r_particle_t));
+
+		for (int32_t f = 0; f < CG_PARTICLE_FIELDS; f++) {
+			memcpy(fields + f * capacity, Cg_ParticleField(ps, f), ps->count * sizeof(vec_t));
+		}
 	}
 
-	if (*list == p) {
-		*list = p->next;
+	if (ps->parts) {
+		cgi.Free(ps->parts);
+		cgi.Free(ps->fields);
 	}
 
-	p->prev = p->next = NULL;
+	ps->parts = parts;
+	ps->fields = fields;
+	ps->capacity = capacity;
 }
 
 /**
- * @brief Allocates a free particle with the specified type and image.
+ * @brief Allocates a particle with the specified type and image. The particle
+ * is staged until the next call to Cg_AddParticles, so the caller may populate
+ * it freely.
  */
 cg_particle_t *Cg_AllocParticle(const uint16_t type, cg_particles_t *particles) {
 
 	if (!cg_add_particles->integer)
 		return NULL;
 
-	if (!cg_free_particles) {
+	if (cg_num_particles + cg_num_spawned_particles == MAX_PARTICLES) {
 		cgi.Debug("No free particles\n");
 		return NULL;
 	}
 
-	cg_particle_t *p = cg_free_particles;
+	particles = particles ? particles : cg_particles_normal;
 
-	Cg_PopParticle(p, &cg_free_particles);
+	cg_spawned_pools[cg_num_spawned_particles] = particles;
+	cg_particle_t *p = &cg_spawned_particles[cg_num_spawned_particles++];
 
-	particles = particles ? particles : cg_particles_normal;
+	memset(p, 0, sizeof(*p));
 
 	p->part.type = type;
 	p->part.image = particles->image;
 
-	Cg_PushParticle(p, &particles->particles);
-
-	p->time = cgi.client->systime;
-
-	return p;
-}
-
-/**
- * @brief Frees the specified particle, returning the particle it was pointing
- * to as a convenience for continued iteration.
- */
-static cg_particle_t *Cg_FreeParticle(cg_particle_t *p, cg_particle_t **list) {
-	cg_particle_t *next = p->next;
-
-	if (list) {
-		Cg_PopParticle(p, list);
-	}
-
-	memset(p, 0, sizeof(cg_particle_t));
-
 	p->part.blend = GL_ONE;
 	Vector4Set(p->part.color, 1.0, 1.0, 1.0, 1.0);
 	p->part.scale = 1.0;
 
-	Cg_PushParticle(p, &cg_free_particles);
-
-	return next;
+	return p;
 }
 
 /**
- * @brief Allocates a particles chain for the specified image.
+ * @brief Allocates a particle pool for the specified image.
  */
 cg_particles_t *Cg_AllocParticles(const r_image_t *image) {
 	cg_particles_t *particles;
@@ -129,24 +148,117 @@ cg_particles_t *Cg_AllocParticles(const r_image_t *image) {
 }
 
 /**
- * @brief Frees all particles, returning them to the eligible list.
+ * @brief Frees all particles. The pools themselves are freed with the media.
  */
 void Cg_FreeParticles(void) {
-	uint32_t i;
 
-	cg_free_particles = NULL;
 	cg_active_particles = NULL;
 
-	memset(cg_particles, 0, sizeof(cg_particles));
+	cg_num_spawned_particles = 0;
+	cg_num_particles = 0;
+}
+
+/**
+ * @brief Advances the particles of the specified pool by delta seconds, and
+ * compacts away those which have disappeared.
+ */
+static void Cg_UpdateParticles(cg_particles_t *ps, const vec_t delta) {
+
+	const uint32_t count = ps->count;
 
-	for (i = 0; i < lengthof(cg_particles); i++) {
-		Cg_FreeParticle(&cg_particles[i], NULL);
+	if (count == 0) {
+		return;
 	}
+
+	const vec_t delta_squared = delta * delta;
+
+	// apply color and scale velocity
+
+	for (int32_t i = 0; i < 4; i++) {
+		Cg_ParticleMA(Cg_ParticleField(ps, CG_PARTICLE_COLOR + i),
+				Cg_ParticleField(ps, CG_PARTICLE_COLOR_VEL + i), delta, count);
+	}
+
+	Cg_ParticleMA(Cg_ParticleField(ps, CG_PARTICLE_SCALE),
+			Cg_ParticleField(ps, CG_PARTICLE_SCALE_VEL), delta, count);
+
+	// update origin, end, and velocity
+
+	for (int32_t i = 0; i < 3; i++) {
+		Cg_ParticleMove(Cg_ParticleField(ps, CG_PARTICLE_ORG + i),
+				Cg_ParticleField(ps, CG_PARTICLE_END + i),
+				Cg_ParticleField(ps, CG_PARTICLE_VEL + i),
+				Cg_ParticleField(ps, CG_PARTICLE_ACCEL + i), delta, delta_squared, count);
+	}
+
+	// resolve the particles which survive, freeing those which have disappeared,
+	// and weather particles which have hit the ground
+
+	const uint32_t num_live = Cg_ParticleLive(Cg_ParticleField(ps, CG_PARTICLE_COLOR + 3),
+			Cg_ParticleField(ps, CG_PARTICLE_SCALE),
+			Cg_ParticleField(ps, CG_PARTICLE_ORG + 2),
+			Cg_ParticleField(ps, CG_PARTICLE_END_Z), count, cg_live_particles);
+
+	// compact each field, and the view particles
+
+	if (num_live < count) {
+		for (int32_t f = 0; f < CG_PARTICLE_FIELDS; f++) {
+			Cg_ParticleCompact(Cg_ParticleField(ps, f), cg_live_particles, num_live);
+		}
+
+		for (uint32_t i = 0; i < num_live; i++) {
+			ps->parts[i] = ps->parts[cg_live_particles[i]];
+		}
+
+		cg_num_particles -= count - num_live;
+		ps->count = num_live;
+	}
+}
+
+/**
+ * @brief Appends the staged particles to their pools.
+ */
+static void Cg_SpawnParticles(void) {
+
+	for (uint32_t i = 0; i < cg_num_spawned_particles; i++) {
+		const cg_particle_t *p = &cg_spawned_particles[i];
+		cg_particles_t *ps = cg_spawned_pools[i];
+
+		Cg_ReserveParticles(ps, ps->count + 1);
+
+		const uint32_t j = ps->count++;
+
+		ps->parts[j] = p->part;
+
+		for (int32_t k = 0; k < 3; k++) {
+			Cg_ParticleField(ps, CG_PARTICLE_ORG + k)[j] = p->part.org[k];
+			Cg_ParticleField(ps, CG_PARTICLE_END + k)[j] = p->part.end[k];
+			Cg_ParticleField(ps, CG_PARTICLE_VEL + k)[j] = p->vel[k];
+			Cg_ParticleField(ps, CG_PARTICLE_ACCEL + k)[j] = p->accel[k];
+		}
+
+		for (int32_t k = 0; k < 4; k++) {
+			Cg_ParticleField(ps, CG_PARTICLE_COLOR + k)[j] = p->part.color[k];
+			Cg_ParticleField(ps, CG_PARTICLE_COLOR_VEL + k)[j] = p->color_vel[k];
+		}
+
+		Cg_ParticleField(ps, CG_PARTICLE_SCALE)[j] = p->part.scale;
+		Cg_ParticleField(ps, CG_PARTICLE_SCALE_VEL)[j] = p->scale_vel;
+		if (p->part.type == PARTICLE_WEATHER) {
+			Cg_ParticleField(ps, CG_PARTICLE_END_Z)[j] = p->end_z;
+		} else {
+			Cg_ParticleField(ps, CG_PARTICLE_END_Z)[j] = -INFINITY;
+		}
+	}
+
+	cg_num_particles += cg_num_spawned_particles;
+	cg_num_spawned_particles = 0;
 }
 
 /**
- * @brief Adds all particles that are active for this frame to the view.
- * Particles that fade or shrink beyond visibility are freed.
+ * @brief Adds all particles that are active for this frame to the view, one
+ * pool at a time. Particles that fade or shrink beyond visibility are freed.
+ * Particles allocated since the last frame are added as they were populated.
  */
 void Cg_AddParticles(void) {
 	static uint32_t last_particle_time;
@@ -158,50 +270,45 @@ void Cg_AddParticles(void) {
 		last_particle_time = 0;
 
 	const vec_t delta = (cgi.client->systime - last_particle_time) * 0.001;
-	const vec_t delta_squared = delta * delta;
 
 	last_particle_time = cgi.client->systime;
 
-	cg_particles_t *ps = cg_active_particles;
-	while (ps) {
+	for (cg_particles_t *ps = cg_active_particles; ps; ps = ps->next) {
+		Cg_UpdateParticles(ps, delta);
+	}
 
-		cg_particle_t *p = ps->particles;
-		while (p) {
-			// update any particles allocated in previous frames
-			if (p->time != cgi.client->systime) {
+	Cg_SpawnParticles();
 
-				// apply color velocity
-				for (int32_t i = 0; i < 4; i++) {
-					p->part.color[i] += delta * p->color_vel[i];
-				}
+	// refresh the view attributes of each particle, and add each pool
 
-				// and scale velocity
-				p->part.scale += delta * p->scale_vel;
+	for (const cg_particles_t *ps = cg_active_particles; ps; ps = ps->next) {
 
-				// free up particles that have disappeared
-				if (p->part.color[3] <= 0.0 || p->part.scale <= 0.0) {
-					p = Cg_FreeParticle(p, &ps->particles);
-					continue;
-				}
+		if (ps->count == 0) {
+			continue;
+		}
 
-				for (int32_t i = 0; i < 3; i++) { // update origin, end, and acceleration
-					p->part.org[i] += p->vel[i] * delta + p->accel[i] * delta_squared;
-					p->part.end[i] += p->vel[i] * delta + p->accel[i] * delta_squared;
+		const vec_t *org[3], *end[3], *color[4];
+
+		for (int32_t j = 0; j < 3; j++) {
+			org[j] = Cg_ParticleField(ps, CG_PARTICLE_ORG + j);
+			end[j] = Cg_ParticleField(ps, CG_PARTICLE_END + j);
+		}
+
+		for (int32_t j = 0; j < 4; j++) {
+			color[j] = Cg_ParticleField(ps, CG_PARTICLE_COLOR + j);
+		}
 
-					p->vel[i] += p->accel[i] * delta;
-				}
+		const vec_t *scale = Cg_ParticleField(ps, CG_PARTICLE_SCALE);
 
-				// free up weather particles that have hit the ground
-				if (p->part.type == PARTICLE_WEATHER && (p->part.org[2] <= p->end_z)) {
-					p = Cg_FreeParticle(p, &ps->particles);
-					continue;
-				}
-			}
+		r_particle_t *part = ps->parts;
+		for (uint32_t i = 0; i < ps->count; i++, part++) {
 
-			cgi.AddParticle(&p->part);
-			p = p->next;
+			VectorSet(part->org, org[0][i], org[1][i], org[2][i]);
+			VectorSet(part->end, end[0][i], end[1][i], end[2][i]);
+			Vector4Set(part->color, color[0][i], color[1][i], color[2][i], color[3][i]);
+			part->scale = scale[i];
 		}
 
-		ps = ps->next;
+		cgi.AddParticles(ps->parts, ps->count);
 	}
 }
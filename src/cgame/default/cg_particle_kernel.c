@@ -0,0 +1,188 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "cg_local.h"
+
+/*
+ * The particle update kernels operate on one field of a particle pool at a time,
+ * 4 particles at a time where SSE is available. The arithmetic is never fused,
+ * so that the SSE kernels and their scalar tails produce identical particles.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+ #define CG_PARTICLE_SSE __attribute__((target("sse")))
+#endif
+
+#if defined(__clang__)
+ #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+ #pragma GCC optimize ("fp-contract=off")
+#endif
+
+#if defined(CG_PARTICLE_SSE)
+
+/**
+ * @brief out += in * scale, 4 particles at a time.
+ */
+CG_PARTICLE_SSE static uint32_t Cg_ParticleMA_SSE(vec_t *out, const vec_t *in, const vec_t scale,
+		const uint32_t count) {
+	uint32_t i;
+
+	const __m128 s = _mm_set1_ps(scale);
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		const __m128 a = _mm_loadu_ps(out + i);
+		const __m128 b = _mm_loadu_ps(in + i);
+		_mm_storeu_ps(out + i, _mm_add_ps(a, _mm_mul_ps(b, s)));
+	}
+
+	return i;
+}
+
+/**
+ * @brief Advances origin, end and velocity along one axis, 4 particles at a time.
+ */
+CG_PARTICLE_SSE static uint32_t Cg_ParticleMove_SSE(vec_t *org, vec_t *end, vec_t *vel,
+		const vec_t *accel, const vec_t delta, const vec_t delta_squared, const uint32_t count) {
+	uint32_t i;
+
+	const __m128 d = _mm_set1_ps(delta);
+	const __m128 d2 = _mm_set1_ps(delta_squared);
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		const __m128 v = _mm_loadu_ps(vel + i);
+		const __m128 a = _mm_loadu_ps(accel + i);
+
+		const __m128 move = _mm_add_ps(_mm_mul_ps(v, d), _mm_mul_ps(a, d2));
+
+		_mm_storeu_ps(org + i, _mm_add_ps(_mm_loadu_ps(org + i), move));
+		_mm_storeu_ps(end + i, _mm_add_ps(_mm_loadu_ps(end + i), move));
+		_mm_storeu_ps(vel + i, _mm_add_ps(v, _mm_mul_ps(a, d)));
+	}
+
+	return i;
+}
+
+/**
+ * @brief Appends the indexes of live particles to the specified list, 4
+ * particles at a time.
+ */
+CG_PARTICLE_SSE static uint32_t Cg_ParticleLive_SSE(const vec_t *alpha, const vec_t *scale,
+		const vec_t *z, const vec_t *end_z, const uint32_t count, uint32_t *live, uint32_t *num_live) {
+	uint32_t i;
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		__m128 mask = _mm_cmpgt_ps(_mm_loadu_ps(alpha + i), zero);
+		mask = _mm_and_ps(mask, _mm_cmpgt_ps(_mm_loadu_ps(scale + i), zero));
+		mask = _mm_and_ps(mask, _mm_cmpgt_ps(_mm_loadu_ps(z + i), _mm_loadu_ps(end_z + i)));
+
+		const int32_t bits = _mm_movemask_ps(mask);
+
+		if (bits == 0xf) {
+			live[(*num_live)++] = i + 0;
+			live[(*num_live)++] = i + 1;
+			live[(*num_live)++] = i + 2;
+			live[(*num_live)++] = i + 3;
+		} else {
+			for (uint32_t j = 0; j < 4; j++) {
+				if (bits & (1 << j)) {
+					live[(*num_live)++] = i + j;
+				}
+			}
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+/**
+ * @brief Advances origin, end and velocity along one axis, for count particles.
+ */
+void Cg_ParticleMove(vec_t *org, vec_t *end, vec_t *vel, const vec_t *accel,
+		const vec_t delta, const vec_t delta_squared, const uint32_t count) {
+	uint32_t i = 0;
+
+#if defined(CG_PARTICLE_SSE)
+	i = Cg_ParticleMove_SSE(org, end, vel, accel, delta, delta_squared, count);
+#endif
+
+	for (; i < count; i++) {
+		const vec_t move = vel[i] * delta + accel[i] * delta_squared;
+
+		org[i] += move;
+		end[i] += move;
+
+		vel[i] += accel[i] * delta;
+	}
+}
+
+/**
+ * @brief Resolves the indexes of the particles which are still visible, and
+ * which have not fallen below their end Z, for count particles.
+ * @return The number of live particles.
+ */
+uint32_t Cg_ParticleLive(const vec_t *alpha, const vec_t *scale, const vec_t *z,
+		const vec_t *end_z, const uint32_t count, uint32_t *live) {
+	uint32_t i = 0, num_live = 0;
+
+#if defined(CG_PARTICLE_SSE)
+	i = Cg_ParticleLive_SSE(alpha, scale, z, end_z, count, live, &num_live);
+#endif
+
+	for (; i < count; i++) {
+		if (alpha[i] > 0.0 && scale[i] > 0.0 && z[i] > end_z[i]) {
+			live[num_live++] = i;
+		}
+	}
+
+	return num_live;
+}
+
+/**
+ * @brief out += in * scale, for count particles.
+ */
+void Cg_ParticleMA(vec_t *out, const vec_t *in, const vec_t scale, const uint32_t count) {
+	uint32_t i = 0;
+
+#if defined(CG_PARTICLE_SSE)
+	i = Cg_ParticleMA_SSE(out, in, scale, count);
+#endif
+
+	for (; i < count; i++) {
+		out[i] += in[i] * scale;
+	}
+}
+
+/**
+ * @brief Compacts the specified field in place, keeping only the live particles.
+ * This is safe because live indexes never trail their destinations.
+ */
+void Cg_ParticleCompact(vec_t *field, const uint32_t *live, const uint32_t num_live) {
+
+	for (uint32_t i = 0; i < num_live; i++) {
+		field[i] = field[live[i]];
+	}
+}
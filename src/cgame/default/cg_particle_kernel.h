@@ -0,0 +1,34 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __CG_PARTICLE_KERNEL_H__
+#define __CG_PARTICLE_KERNEL_H__
+
+#ifdef __CG_LOCAL_H__
+void Cg_ParticleMove(vec_t *org, vec_t *end, vec_t *vel, const vec_t *accel,
+		const vec_t delta, const vec_t delta_squared, const uint32_t count);
+uint32_t Cg_ParticleLive(const vec_t *alpha, const vec_t *scale, const vec_t *z,
+		const vec_t *end_z, const uint32_t count, uint32_t *live);
+void Cg_ParticleMA(vec_t *out, const vec_t *in, const vec_t scale, const uint32_t count);
+void Cg_ParticleCompact(vec_t *field, const uint32_t *live, const uint32_t num_live);
+#endif /* __CG_LOCAL_H__ */
+
+#endif /* __CG_PARTICLE_KERNEL_H__ */
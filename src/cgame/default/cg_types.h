@@ -27,6 +27,10 @@
 
 #ifdef __CG_LOCAL_H__
 
+/**
+ * @brief A newly allocated particle, populated by the caller of Cg_AllocParticle
+ * and appended to its pool by Cg_AddParticles.
+ */
 typedef struct cg_particle_s {
 	r_particle_t part; // the r_particle_t to add to the view
 	vec3_t vel;
@@ -34,15 +38,15 @@ typedef struct cg_particle_s {
 	vec4_t color_vel;
 	vec_t scale_vel;
 	vec_t end_z; // weather particles are freed at this Z
-	uint32_t time; // client time when allocated
-	struct cg_particle_s *prev; // previous particle in the chain
-	struct cg_particle_s *next; // next particle in chain
 } cg_particle_t;
 
-// particles are chained by image
+// particles are pooled by image, as structures of arrays
 typedef struct cg_particles_s {
 	const r_image_t *image;
-	cg_particle_t *particles;
+	r_particle_t *parts; // the r_particle_t of each particle, to add to the view
+	vec_t *fields; // the simulated quantities, an array of capacity for each field
+	uint32_t count;
+	uint32_t capacity;
 	struct cg_particles_s *next;
 } cg_particles_t;
 
@@ -185,6 +185,7 @@ void Cl_InitCgame(void) {
 	import.AddLinkedEntity = R_AddLinkedEntity;
 	import.AddLight = R_AddLight;
 	import.AddParticle = R_AddParticle;
+	import.AddParticles = R_AddParticles;
 	import.AddSustainedLight = R_AddSustainedLight;
 
 	import.DrawImage = R_DrawImage;
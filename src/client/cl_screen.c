@@ -158,6 +158,9 @@ static void Cl_DrawRendererStats(void) {
 	R_DrawString(0, y, va("%d surfaces", r_view.num_bsp_surfaces), CON_COLOR_YELLOW);
 	y += ch;
 
+	R_DrawString(0, y, va("%d batches", r_view.num_bsp_batches), CON_COLOR_YELLOW);
+	y += ch;
+
 	y += ch;
 	R_DrawString(0, y, "Mesh:", CON_COLOR_CYAN);
 	y += ch;
@@ -168,6 +171,12 @@ static void Cl_DrawRendererStats(void) {
 	R_DrawString(0, y, va("%d tris", r_view.num_mesh_tris), CON_COLOR_CYAN);
 	y += ch;
 
+	R_DrawString(0, y, va("%d batches", r_view.num_mesh_batches), CON_COLOR_CYAN);
+	y += ch;
+
+	R_DrawString(0, y, va("%d draws", r_view.num_mesh_draws), CON_COLOR_CYAN);
+	y += ch;
+
 	y += ch;
 	R_DrawString(0, y, "Other:", CON_COLOR_WHITE);
 	y += ch;
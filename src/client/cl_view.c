@@ -34,9 +34,10 @@ static void Cl_ClearView(void) {
 	r_view.num_bind_texture = r_view.num_bind_lightmap = r_view.num_bind_deluxemap = 0;
 	r_view.num_bind_normalmap = r_view.num_bind_specularmap = 0;
 
-	r_view.num_bsp_surfaces = 0;
+	r_view.num_bsp_surfaces = r_view.num_bsp_batches = 0;
 
 	r_view.num_mesh_models = r_view.num_mesh_tris = 0;
+	r_view.num_mesh_batches = r_view.num_mesh_draws = 0;
 }
 
 /**
@@ -189,8 +190,8 @@ void Cl_UpdateView(void) {
 	// set area bits to mark visible leafs
 	r_view.area_bits = cl.frame.area_bits;
 
-	// create the thread which populates the view
-	r_view.thread = Thread_Create((ThreadRunFunc) cls.cgame->PopulateView, &cl.frame);
+	// submit the task which populates the view
+	r_view.task = Task_Submit_("PopulateView", (ThreadRunFunc) cls.cgame->PopulateView, &cl.frame, NULL, 0);
 }
 
 /**
@@ -411,7 +411,76 @@ static void R_MarkBspSurfaces_(r_bsp_node_t *node) {
 }
 
 /**
- * @brief Entry point for BSP recursion and surface-level visibility test.
+ * @return True if the view origin is behind the specified plane, with respect
+ * to the R_SURF_PLANE_BACK flag of the surfaces upon it.
+ */
+_Bool R_CullBspPlane(const cm_bsp_plane_t *plane, uint16_t flags) {
+	vec_t dot;
+
+	if (AXIAL(plane))
+		dot = r_view.origin[plane->type] - plane->dist;
+	else
+		dot = DotProduct(r_view.origin, plane->normal) - plane->dist;
+
+	if (dot > SIDE_EPSILON)
+		return (flags & R_SURF_PLANE_BACK) != 0;
+
+	return (flags & R_SURF_PLANE_BACK) == 0;
+}
+
+/**
+ * @return True if the world's opaque surfaces are drawn by cluster. Otherwise,
+ * surfaces are marked by BSP recursion, and drawn one by one.
+ */
+_Bool R_BspClustersEnabled(void) {
+	return r_model_state.world->num_elements && !r_draw_wireframe->value;
+}
+
+/**
+ * @brief Marks the clusters within the PVS, a connected area and the view
+ * frustum, and flags their surfaces as with R_MarkBspSurfaces_. Surfaces shared
+ * by several clusters are flagged by the first of them.
+ */
+static void R_MarkBspClusters(void) {
+
+	r_bsp_cluster_t *cluster = r_model_state.world->bsp->clusters;
+	for (uint16_t i = 0; i < r_model_state.world->bsp->num_clusters; i++, cluster++) {
+
+		if (cluster->vis_frame != r_locals.vis_frame)
+			continue; // not in the PVS
+
+		if (r_view.area_bits && cluster->area >= 0) { // check for door connected areas
+			if (!(r_view.area_bits[cluster->area >> 3] & (1 << (cluster->area & 7))))
+				continue;
+		}
+
+		if (R_CullBox(cluster->mins, cluster->maxs))
+			continue;
+
+		cluster->frame = r_locals.frame;
+
+		r_bsp_surface_t **s = cluster->surfaces;
+		for (uint32_t j = 0; j < cluster->num_surfaces; j++, s++) {
+
+			if ((*s)->frame == r_locals.frame || (*s)->back_frame == r_locals.frame)
+				continue; // already flagged
+
+			(*s)->vis_frame = r_locals.vis_frame;
+
+			if (R_CullBspPlane((*s)->plane, (*s)->flags)) {
+				(*s)->frame = -1;
+				(*s)->back_frame = r_locals.frame;
+			} else {
+				(*s)->frame = r_locals.frame;
+				(*s)->back_frame = -1;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Entry point for BSP recursion and surface-level visibility test. When
+ * drawing by cluster, the clusters themselves are walked instead.
  */
 void R_MarkBspSurfaces(void) {
 
@@ -422,7 +491,10 @@ void R_MarkBspSurfaces(void) {
 	R_ClearSkyBox();
 
 	// flag all visible world surfaces
-	R_MarkBspSurfaces_(r_model_state.world->bsp->nodes);
+	if (R_BspClustersEnabled())
+		R_MarkBspClusters();
+	else
+		R_MarkBspSurfaces_(r_model_state.world->bsp->nodes);
 }
 
 /**
@@ -534,6 +606,9 @@ void R_UpdateVis(void) {
 		for (uint16_t i = 0; i < r_model_state.world->bsp->num_nodes; i++)
 			r_model_state.world->bsp->nodes[i].vis_frame = r_locals.vis_frame;
 
+		for (uint16_t i = 0; i < r_model_state.world->bsp->num_clusters; i++)
+			r_model_state.world->bsp->clusters[i].vis_frame = r_locals.vis_frame;
+
 		r_view.num_bsp_clusters = r_model_state.world->bsp->num_clusters;
 		r_view.num_bsp_leafs = r_model_state.world->bsp->num_leafs;
 
@@ -28,6 +28,8 @@ _Bool R_LeafHearable(const r_bsp_leaf_t *leaf);
 
 #ifdef __R_LOCAL_H__
 _Bool R_CullBox(const vec3_t mins, const vec3_t maxs);
+_Bool R_CullBspPlane(const cm_bsp_plane_t *plane, uint16_t flags);
+_Bool R_BspClustersEnabled(void);
 _Bool R_CullBspInlineModel(const r_entity_t *e);
 void R_DrawBspInlineModels(const r_entities_t *ents);
 void R_DrawBspLeafs(void);
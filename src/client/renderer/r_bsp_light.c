@@ -288,6 +288,114 @@ void R_LoadBspLights(r_bsp_model_t *bsp) {
 	Com_Debug("Loaded %d bsp lights\n", bsp->num_bsp_lights);
 }
 
+/**
+ * @return The light grid cell at the specified grid coordinates, or NULL if the
+ * coordinates are out of bounds or the cell is in solid.
+ */
+static const d_bsp_light_grid_cell_t *R_LightGridCell(const r_bsp_light_grid_t *grid, const int32_t *c) {
+	int32_t b[3];
+
+	for (int32_t i = 0; i < 3; i++) {
+		if (c[i] < 0) {
+			return NULL;
+		}
+
+		b[i] = c[i] / BSP_LIGHT_GRID_BRICK;
+
+		if (b[i] >= grid->bricks[i]) {
+			return NULL;
+		}
+	}
+
+	const int32_t brick = grid->table[b[0] + grid->bricks[0] * (b[1] + grid->bricks[1] * b[2])];
+	if (brick == -1) {
+		return NULL;
+	}
+
+	const int32_t x = c[0] % BSP_LIGHT_GRID_BRICK;
+	const int32_t y = c[1] % BSP_LIGHT_GRID_BRICK;
+	const int32_t z = c[2] % BSP_LIGHT_GRID_BRICK;
+
+	const d_bsp_light_grid_cell_t *cell = &grid->cells[brick * BSP_LIGHT_GRID_BRICK_CELLS +
+			x + BSP_LIGHT_GRID_BRICK * (y + BSP_LIGHT_GRID_BRICK * z)];
+
+	if (!cell->direction[0] && !cell->direction[1] && !cell->direction[2]) {
+		return NULL; // in solid
+	}
+
+	return cell;
+}
+
+/**
+ * @brief Trilinearly samples the world's light grid at the specified position.
+ * Cells in solid are skipped, and the remaining weights renormalized.
+ * @return True if any cell contributed, false if the world has no light grid or
+ * the position is entirely surrounded by solid.
+ */
+_Bool R_SampleLightGrid(const vec3_t pos, vec3_t ambient, vec3_t diffuse, vec3_t direction) {
+	int32_t c[3];
+	vec_t f[3];
+
+	if (!r_model_state.world || !r_model_state.world->bsp->light_grid) {
+		return false;
+	}
+
+	const r_bsp_light_grid_t *grid = r_model_state.world->bsp->light_grid;
+
+	for (int32_t i = 0; i < 3; i++) {
+		const vec_t p = (pos[i] - grid->mins[i]) / grid->size[i];
+		c[i] = (int32_t) floor(p);
+		f[i] = p - c[i];
+	}
+
+	VectorClear(ambient);
+	VectorClear(diffuse);
+	VectorClear(direction);
+
+	vec_t total = 0.0;
+
+	for (int32_t i = 0; i < 8; i++) {
+		int32_t corner[3];
+		vec_t weight = 1.0;
+
+		for (int32_t j = 0; j < 3; j++) {
+			if (i & (1 << j)) {
+				corner[j] = c[j] + 1;
+				weight *= f[j];
+			} else {
+				corner[j] = c[j];
+				weight *= 1.0 - f[j];
+			}
+		}
+
+		const d_bsp_light_grid_cell_t *cell = R_LightGridCell(grid, corner);
+		if (!cell || weight == 0.0) {
+			continue;
+		}
+
+		for (int32_t j = 0; j < 3; j++) {
+			ambient[j] += weight * cell->ambient[j] / 255.0;
+			diffuse[j] += weight * cell->diffuse[j] / 255.0;
+			direction[j] += weight * (cell->direction[j] / 127.0 - 1.0);
+		}
+
+		total += weight;
+	}
+
+	if (total == 0.0) {
+		return false;
+	}
+
+	VectorScale(ambient, 1.0 / total, ambient);
+	VectorScale(diffuse, 1.0 / total, diffuse);
+
+	if (VectorNormalize(direction) == 0.0) {
+		VectorCopy(vec3_up, direction);
+	}
+
+	return true;
+}
+
 /**
  * @brief Developer tool for viewing static BSP light sources.
  */
@@ -45,6 +45,7 @@ typedef struct {
 extern r_bsp_light_state_t r_bsp_light_state;
 
 void R_LoadBspLights(r_bsp_model_t *mod);
+_Bool R_SampleLightGrid(const vec3_t pos, vec3_t ambient, vec3_t diffuse, vec3_t direction);
 void R_DrawBspLights(void);
 #endif /* __R_LOCAL_H__ */
 
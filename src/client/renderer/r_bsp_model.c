@@ -56,6 +56,64 @@ static void R_LoadBspLightmaps(r_bsp_model_t *bsp, const d_bsp_lump_t *l) {
 	}
 }
 
+/**
+ * @brief Loads the light grid, if the map has one.
+ */
+static void R_LoadBspLightGrid(r_bsp_model_t *bsp, const d_bsp_lump_t *l) {
+
+	if (l->file_len == 0) { // not lit, or lit with -legacy
+		return;
+	}
+
+	const d_bsp_light_grid_t *in = (const void *) (r_bsp_base + l->file_ofs);
+
+	if (l->file_len < (int32_t) sizeof(*in) || LittleLong(in->ident) != BSP_LIGHT_GRID_IDENT) {
+		Com_Error(ERR_DROP, "Invalid light grid\n");
+	}
+
+	r_bsp_light_grid_t *grid = Mem_LinkMalloc(sizeof(r_bsp_light_grid_t), bsp);
+
+	int64_t num_bricks = 1;
+	for (int32_t i = 0; i < 3; i++) {
+		grid->mins[i] = LittleFloat(in->mins[i]);
+		grid->size[i] = LittleFloat(in->size[i]);
+		grid->bricks[i] = LittleLong(in->bricks[i]);
+
+		if (grid->size[i] <= 0.0 || grid->bricks[i] <= 0) {
+			Com_Error(ERR_DROP, "Invalid light grid\n");
+		}
+
+		num_bricks *= grid->bricks[i];
+	}
+
+	const int32_t num_populated = LittleLong(in->num_bricks);
+	const size_t brick_size = BSP_LIGHT_GRID_BRICK_CELLS * sizeof(d_bsp_light_grid_cell_t);
+
+	if (num_populated < 0 || sizeof(*in) + num_bricks * sizeof(int32_t) + num_populated * brick_size
+			> (size_t) l->file_len) {
+		Com_Error(ERR_DROP, "Funny lump size\n");
+	}
+
+	grid->table = Mem_LinkMalloc(num_bricks * sizeof(int32_t), bsp);
+
+	const int32_t *table = (const int32_t *) (in + 1);
+	for (int64_t i = 0; i < num_bricks; i++) {
+		grid->table[i] = LittleLong(table[i]);
+
+		if (grid->table[i] < -1 || grid->table[i] >= num_populated) {
+			Com_Error(ERR_DROP, "Invalid light grid brick\n");
+		}
+	}
+
+	grid->cells = Mem_LinkMalloc(MAX(num_populated, 1) * brick_size, bsp);
+	memcpy(grid->cells, table + num_bricks, num_populated * brick_size);
+
+	bsp->light_grid = grid;
+
+	Com_Debug("Loaded %d x %d x %d light grid bricks, %d populated\n", grid->bricks[0],
+			grid->bricks[1], grid->bricks[2], num_populated);
+}
+
 /**
  * @brief Loads all r_bsp_cluster_t for the specified BSP model. Note that
  * no information is actually loaded at this point. Rather, space for the
@@ -780,7 +838,369 @@ static void R_SortBspSurfacesArrays(r_bsp_model_t *bsp) {
 }
 
 /**
- * @brief Allocate, populate and sort the surfaces arrays for the world model.
+ * @brief A surface referenced by a cluster, for building the cluster materials.
+ */
+typedef struct {
+	int16_t cluster;
+	r_bsp_surface_t *surf;
+} r_bsp_cluster_surface_t;
+
+/**
+ * @brief A material reference referenced by a cluster, for building the cluster
+ * materials.
+ */
+typedef struct {
+	int16_t cluster;
+	r_material_ref_t *ref;
+} r_bsp_cluster_material_t;
+
+/**
+ * @return The shadow stencil reference for the specified surface.
+ */
+static GLint R_BspSurfaceStencil(const r_bsp_surface_t *surf) {
+	return (surf->plane->num % 0xff) + 1;
+}
+
+/**
+ * @brief Compares two pointers for qsort, where only identity matters.
+ */
+#define R_COMPARE_POINTERS(a, b) if ((a) != (b)) return (a) < (b) ? -1 : 1
+
+/**
+ * @brief Qsort comparator for the surfaces of each cluster, by cluster and then
+ * by surface.
+ */
+static int R_LoadBspClusterSurfaces_Compare(const void *a, const void *b) {
+
+	const r_bsp_cluster_surface_t *c1 = (const r_bsp_cluster_surface_t *) a;
+	const r_bsp_cluster_surface_t *c2 = (const r_bsp_cluster_surface_t *) b;
+
+	if (c1->cluster != c2->cluster)
+		return c1->cluster - c2->cluster;
+
+	R_COMPARE_POINTERS(c1->surf, c2->surf);
+
+	return 0;
+}
+
+/**
+ * @brief Qsort comparator for R_LoadBspClusterMaterials. Opaque surfaces are
+ * grouped by owning cluster, and then by all of the state needed to draw and
+ * cull them.
+ */
+static int R_LoadBspClusterMaterials_Compare(const void *a, const void *b) {
+
+	const r_bsp_cluster_surface_t *c1 = (const r_bsp_cluster_surface_t *) a;
+	const r_bsp_cluster_surface_t *c2 = (const r_bsp_cluster_surface_t *) b;
+
+	if (c1->cluster != c2->cluster)
+		return c1->cluster - c2->cluster;
+
+	const int32_t order = g_strcmp0(c1->surf->texinfo->name, c2->surf->texinfo->name);
+	if (order)
+		return order;
+
+	R_COMPARE_POINTERS(c1->surf->texinfo->material, c2->surf->texinfo->material);
+	R_COMPARE_POINTERS(c1->surf->lightmap, c2->surf->lightmap);
+	R_COMPARE_POINTERS(c1->surf->deluxemap, c2->surf->deluxemap);
+
+	if (c1->surf->plane->num != c2->surf->plane->num)
+		return c1->surf->plane->num - c2->surf->plane->num;
+
+	const int32_t s1 = c1->surf->flags & R_SURF_PLANE_BACK, s2 = c2->surf->flags & R_SURF_PLANE_BACK;
+	if (s1 != s2)
+		return s1 - s2;
+
+	R_COMPARE_POINTERS(c1->surf, c2->surf);
+
+	return 0;
+}
+
+/**
+ * @brief Qsort comparator for the material references of each cluster, by
+ * cluster and then in element order.
+ */
+static int R_LoadBspClusterMaterialRefs_Compare(const void *a, const void *b) {
+
+	const r_bsp_cluster_material_t *c1 = (const r_bsp_cluster_material_t *) a;
+	const r_bsp_cluster_material_t *c2 = (const r_bsp_cluster_material_t *) b;
+
+	if (c1->cluster != c2->cluster)
+		return c1->cluster - c2->cluster;
+
+	R_COMPARE_POINTERS(c1->ref, c2->ref);
+
+	return 0;
+}
+
+/**
+ * @return True if the specified cluster surfaces may not be drawn together.
+ */
+static _Bool R_BspClusterSurfacesDiffer(const r_bsp_cluster_surface_t *a, const r_bsp_cluster_surface_t *b) {
+
+	if (a == NULL || a->cluster != b->cluster)
+		return true;
+
+	if (a->surf->texinfo->material != b->surf->texinfo->material)
+		return true;
+
+	if (a->surf->lightmap != b->surf->lightmap || a->surf->deluxemap != b->surf->deluxemap)
+		return true;
+
+	if (a->surf->plane != b->surf->plane)
+		return true;
+
+	return (a->surf->flags & R_SURF_PLANE_BACK) != (b->surf->flags & R_SURF_PLANE_BACK);
+}
+
+/**
+ * @brief Builds the surface lists and material references of each cluster, and
+ * the triangle elements that the material references draw. Only opaque
+ * surfaces are drawn by cluster. Each is owned by the first cluster containing
+ * it, so that it belongs to exactly one material reference.
+ */
+static void R_LoadBspClusterMaterials(r_model_t *mod) {
+	r_bsp_model_t *bsp = mod->bsp;
+
+	if (!bsp->num_clusters)
+		return;
+
+	_Bool *opaque = Mem_Malloc(bsp->num_surfaces * sizeof(_Bool));
+
+	const r_bsp_surfaces_t *surfs = &bsp->sorted_surfaces->opaque;
+	for (size_t i = 0; i < surfs->count; i++) {
+		if (!(surfs->surfaces[i]->texinfo->flags & SURF_MATERIAL)) {
+			opaque[surfs->surfaces[i] - bsp->surfaces] = true;
+		}
+	}
+
+	r_bsp_cluster_t *cluster = bsp->clusters;
+	for (uint16_t i = 0; i < bsp->num_clusters; i++, cluster++) {
+		ClearBounds(cluster->mins, cluster->maxs);
+		cluster->area = INT16_MIN;
+		cluster->frame = cluster->light_frame = -1;
+	}
+
+	// gather the surfaces of every cluster, and resolve their bounds
+
+	size_t count = 0;
+
+	const r_bsp_leaf_t *leaf = bsp->leafs;
+	for (uint16_t i = 0; i < bsp->num_leafs; i++, leaf++) {
+
+		if (leaf->cluster == -1)
+			continue;
+
+		cluster = &bsp->clusters[leaf->cluster];
+
+		AddPointToBounds(leaf->mins, cluster->mins, cluster->maxs);
+		AddPointToBounds(leaf->maxs, cluster->mins, cluster->maxs);
+
+		if (cluster->area == INT16_MIN)
+			cluster->area = leaf->area;
+		else if (cluster->area != leaf->area)
+			cluster->area = -1;
+
+		count += leaf->num_leaf_surfaces;
+	}
+
+	r_bsp_cluster_surface_t *cluster_surfs = Mem_Malloc(MAX(count, 1) * sizeof(r_bsp_cluster_surface_t));
+	count = 0;
+
+	leaf = bsp->leafs;
+	for (uint16_t i = 0; i < bsp->num_leafs; i++, leaf++) {
+
+		if (leaf->cluster == -1)
+			continue;
+
+		r_bsp_surface_t **s = leaf->first_leaf_surface;
+		for (uint16_t j = 0; j < leaf->num_leaf_surfaces; j++, s++) {
+			cluster_surfs[count].cluster = leaf->cluster;
+			cluster_surfs[count].surf = *s;
+			count++;
+		}
+	}
+
+	qsort(cluster_surfs, count, sizeof(r_bsp_cluster_surface_t), R_LoadBspClusterSurfaces_Compare);
+
+	// discard surfaces referenced by more than one leaf of a cluster, and
+	// resolve the owning cluster of each surface
+
+	int16_t *owners = Mem_Malloc(MAX(bsp->num_surfaces, 1) * sizeof(int16_t));
+	for (uint16_t i = 0; i < bsp->num_surfaces; i++) {
+		owners[i] = -1;
+	}
+
+	size_t num_unique = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		const r_bsp_cluster_surface_t *cs = &cluster_surfs[i];
+
+		if (num_unique && cluster_surfs[num_unique - 1].cluster == cs->cluster &&
+				cluster_surfs[num_unique - 1].surf == cs->surf)
+			continue;
+
+		const ptrdiff_t s = cs->surf - bsp->surfaces;
+		if (owners[s] == -1)
+			owners[s] = cs->cluster;
+
+		bsp->clusters[cs->cluster].num_surfaces++;
+
+		cluster_surfs[num_unique++] = *cs;
+	}
+
+	r_bsp_surface_t **surfaces = Mem_LinkMalloc(MAX(num_unique, 1) * sizeof(r_bsp_surface_t *), bsp);
+
+	cluster = bsp->clusters;
+	for (uint16_t i = 0; i < bsp->num_clusters; i++, cluster++) {
+		cluster->surfaces = surfaces;
+		surfaces += cluster->num_surfaces;
+		cluster->num_surfaces = 0;
+	}
+
+	for (size_t i = 0; i < num_unique; i++) {
+		cluster = &bsp->clusters[cluster_surfs[i].cluster];
+		cluster->surfaces[cluster->num_surfaces++] = cluster_surfs[i].surf;
+	}
+
+	// group the opaque surfaces by owning cluster and drawing state, counting
+	// their elements and the material references
+
+	r_bsp_cluster_surface_t *owned = Mem_Malloc(MAX(bsp->num_surfaces, 1) * sizeof(r_bsp_cluster_surface_t));
+	size_t num_owned = 0;
+
+	for (uint16_t i = 0; i < bsp->num_surfaces; i++) {
+		if (opaque[i] && owners[i] != -1) {
+			owned[num_owned].cluster = owners[i];
+			owned[num_owned].surf = &bsp->surfaces[i];
+			num_owned++;
+		}
+	}
+
+	qsort(owned, num_owned, sizeof(r_bsp_cluster_surface_t), R_LoadBspClusterMaterials_Compare);
+
+	size_t num_materials = 0;
+	mod->num_elements = 0;
+
+	const r_bsp_cluster_surface_t *prev = NULL;
+	for (size_t i = 0; i < num_owned; i++) {
+		const r_bsp_cluster_surface_t *cs = &owned[i];
+
+		if (R_BspClusterSurfacesDiffer(prev, cs)) {
+			num_materials++;
+		}
+
+		mod->num_elements += (cs->surf->num_edges - 2) * 3;
+		prev = cs;
+	}
+
+	r_material_ref_t **surface_refs = Mem_Malloc(MAX(bsp->num_surfaces, 1) * sizeof(r_material_ref_t *));
+
+	if (num_materials) {
+		mod->elements = Mem_LinkMalloc(mod->num_elements * sizeof(GLuint), mod);
+
+		r_material_ref_t *refs = Mem_LinkMalloc(num_materials * sizeof(r_material_ref_t), bsp);
+		r_material_ref_t *ref = NULL;
+
+		// write the elements of each surface as a triangle fan, starting new
+		// material references wherever the drawing state changes
+
+		GLuint *e = mod->elements;
+
+		prev = NULL;
+		for (size_t i = 0; i < num_owned; i++) {
+			const r_bsp_cluster_surface_t *cs = &owned[i];
+			r_bsp_surface_t *surf = cs->surf;
+
+			if (R_BspClusterSurfacesDiffer(prev, cs)) {
+
+				ref = ref ? ref + 1 : refs;
+
+				ref->material = surf->texinfo->material;
+				ref->lightmap = surf->lightmap;
+				ref->deluxemap = surf->deluxemap;
+				ref->stencil = R_BspSurfaceStencil(surf);
+				ref->plane = surf->plane;
+				ref->flags = surf->flags & R_SURF_PLANE_BACK;
+				ref->frame = -1;
+				ref->cluster = cs->cluster;
+				ref->index = (GLuint) (e - mod->elements);
+			}
+
+			for (uint16_t j = 2; j < surf->num_edges; j++) {
+				*e++ = surf->index;
+				*e++ = surf->index + j - 1;
+				*e++ = surf->index + j;
+			}
+
+			ref->count += (surf->num_edges - 2) * 3;
+			ref->num_surfaces++;
+
+			surface_refs[surf - bsp->surfaces] = ref;
+
+			prev = cs;
+		}
+	}
+
+	// and reference them from every cluster containing their surfaces
+
+	r_bsp_cluster_material_t *cluster_refs = Mem_Malloc(MAX(num_unique, 1) * sizeof(r_bsp_cluster_material_t));
+	size_t num_refs = 0;
+
+	for (size_t i = 0; i < num_unique; i++) {
+		r_material_ref_t *ref = surface_refs[cluster_surfs[i].surf - bsp->surfaces];
+
+		if (ref) {
+			cluster_refs[num_refs].cluster = cluster_surfs[i].cluster;
+			cluster_refs[num_refs].ref = ref;
+			num_refs++;
+		}
+	}
+
+	qsort(cluster_refs, num_refs, sizeof(r_bsp_cluster_material_t), R_LoadBspClusterMaterialRefs_Compare);
+
+	size_t num_unique_refs = 0;
+
+	for (size_t i = 0; i < num_refs; i++) {
+		const r_bsp_cluster_material_t *cr = &cluster_refs[i];
+
+		if (num_unique_refs && cluster_refs[num_unique_refs - 1].cluster == cr->cluster &&
+				cluster_refs[num_unique_refs - 1].ref == cr->ref)
+			continue;
+
+		bsp->clusters[cr->cluster].num_materials++;
+
+		cluster_refs[num_unique_refs++] = *cr;
+	}
+
+	r_material_ref_t **materials = Mem_LinkMalloc(MAX(num_unique_refs, 1) * sizeof(r_material_ref_t *), bsp);
+
+	cluster = bsp->clusters;
+	for (uint16_t i = 0; i < bsp->num_clusters; i++, cluster++) {
+		cluster->materials = materials;
+		materials += cluster->num_materials;
+		cluster->num_materials = 0;
+	}
+
+	for (size_t i = 0; i < num_unique_refs; i++) {
+		cluster = &bsp->clusters[cluster_refs[i].cluster];
+		cluster->materials[cluster->num_materials++] = cluster_refs[i].ref;
+	}
+
+	Com_Debug("!  Cluster materials: %u, %u elements\n", (uint32_t) num_materials,
+			(uint32_t) mod->num_elements);
+
+	Mem_Free(cluster_refs);
+	Mem_Free(surface_refs);
+	Mem_Free(owned);
+	Mem_Free(owners);
+	Mem_Free(cluster_surfs);
+	Mem_Free(opaque);
+}
+
+/**
+ * @brief Allocate, populate and sort the surfaces arrays for the world model,
+ * and build the material references of each cluster from them.
  */
 static void R_LoadBspSurfacesArrays(r_model_t *mod) {
 
@@ -869,6 +1289,9 @@ static void R_LoadBspSurfacesArrays(r_model_t *mod) {
 
 	// now sort them by texture
 	R_SortBspSurfacesArrays(mod->bsp);
+
+	// and build the material references of each cluster
+	R_LoadBspClusterMaterials(mod);
 }
 
 /**
@@ -884,10 +1307,14 @@ void R_LoadBspModel(r_model_t *mod, void *buffer) {
 		((int32_t *) &header)[i] = LittleLong(((int32_t *) &header)[i]);
 	}
 
-	if (header.version != BSP_VERSION && header.version != BSP_VERSION_QUETOO) {
+	if (!BSP_VERSION_SUPPORTED(header.version)) {
 		Com_Error(ERR_DROP, "%s has unsupported version: %d\n", mod->media.name, header.version);
 	}
 
+	if (header.version != BSP_VERSION_QUETOO) { // shorter header, see BSP_VERSION_QUETOO_NO_LIGHT_GRID
+		memset(&header.lumps[BSP_LUMP_LIGHT_GRID], 0, sizeof(d_bsp_lump_t));
+	}
+
 	mod->bsp = Mem_LinkMalloc(sizeof(r_bsp_model_t), mod);
 	mod->bsp->version = header.version;
 
@@ -897,7 +1324,7 @@ void R_LoadBspModel(r_model_t *mod, void *buffer) {
 	R_LoadBspVertexes(mod->bsp, &header.lumps[BSP_LUMP_VERTEXES]);
 	Cl_LoadingProgress(4, "vertices");
 
-	if (header.version == BSP_VERSION_QUETOO) // enhanced format
+	if (header.version != BSP_VERSION) // enhanced format
 		R_LoadBspNormals(mod->bsp, &header.lumps[BSP_LUMP_NORMALS]);
 
 	R_LoadBspEdges(mod->bsp, &header.lumps[BSP_LUMP_EDGES]);
@@ -909,6 +1336,8 @@ void R_LoadBspModel(r_model_t *mod, void *buffer) {
 	R_LoadBspLightmaps(mod->bsp, &header.lumps[BSP_LUMP_LIGHTMAPS]);
 	Cl_LoadingProgress(16, "lightmaps");
 
+	R_LoadBspLightGrid(mod->bsp, &header.lumps[BSP_LUMP_LIGHT_GRID]);
+
 	R_LoadBspPlanes(mod->bsp, &header.lumps[BSP_LUMP_PLANES]);
 	Cl_LoadingProgress(20, "planes");
 
@@ -185,6 +185,187 @@ void R_DrawOpaqueBspSurfaces_default(const r_bsp_surfaces_t *surfs) {
 #endif
 }
 
+/**
+ * @return The bit mask of the dynamic light sources reaching the specified
+ * cluster's bounds, resolved once per frame.
+ */
+static uint64_t R_BspClusterLights(r_bsp_cluster_t *cluster) {
+
+	if (cluster->light_frame == r_locals.frame)
+		return cluster->light_mask;
+
+	cluster->light_frame = r_locals.frame;
+	cluster->light_mask = 0;
+
+	const r_light_t *l = r_view.lights;
+	for (uint16_t i = 0; i < r_view.num_lights; i++, l++) {
+		vec_t dist = 0.0;
+
+		for (int32_t j = 0; j < 3; j++) {
+			if (l->origin[j] < cluster->mins[j]) {
+				dist += (cluster->mins[j] - l->origin[j]) * (cluster->mins[j] - l->origin[j]);
+			} else if (l->origin[j] > cluster->maxs[j]) {
+				dist += (l->origin[j] - cluster->maxs[j]) * (l->origin[j] - cluster->maxs[j]);
+			}
+		}
+
+		if (dist < l->radius * l->radius) {
+			cluster->light_mask |= ((uint64_t) 1 << i);
+		}
+	}
+
+	return cluster->light_mask;
+}
+
+/**
+ * @return True if the specified material reference should not be drawn, either
+ * because another cluster has drawn it this frame, or because it faces away.
+ */
+static _Bool R_CullBspMaterialRef(const r_material_ref_t *ref) {
+
+	if (ref->frame == r_locals.frame)
+		return true;
+
+	return R_CullBspPlane(ref->plane, ref->flags);
+}
+
+/**
+ * @return True if the specified material references may be drawn together:
+ * they are contiguous, share their owning cluster and their drawing state.
+ */
+static _Bool R_BspMaterialRefsMerge(const r_material_ref_t *first, GLuint count, const r_material_ref_t *ref) {
+
+	if (ref->index != first->index + count || ref->cluster != first->cluster)
+		return false;
+
+	if (r_state.stencil_test_enabled && ref->stencil != first->stencil)
+		return false;
+
+	return ref->material == first->material && ref->lightmap == first->lightmap
+			&& ref->deluxemap == first->deluxemap;
+}
+
+/**
+ * @brief Draws the material references of the specified cluster which have not
+ * been drawn yet this frame, and which face the view. Contiguous references
+ * sharing their drawing state are drawn together.
+ *
+ * @param elements The element buffer offset, or the element array.
+ */
+static void R_DrawBspCluster(const r_bsp_cluster_t *cluster, const GLubyte *elements) {
+	r_bsp_model_t *bsp = r_model_state.world->bsp;
+
+	r_material_ref_t **refs = cluster->materials;
+	r_material_ref_t **end = refs + cluster->num_materials;
+
+	while (refs < end) {
+		r_material_ref_t *first = *refs++;
+
+		if (R_CullBspMaterialRef(first))
+			continue;
+
+		first->frame = r_locals.frame;
+
+		GLuint count = first->count;
+		r_view.num_bsp_surfaces += first->num_surfaces;
+
+		while (refs < end && R_BspMaterialRefsMerge(first, count, *refs) && !R_CullBspMaterialRef(*refs)) {
+			r_material_ref_t *ref = *refs++;
+
+			ref->frame = r_locals.frame;
+
+			count += ref->count;
+			r_view.num_bsp_surfaces += ref->num_surfaces;
+		}
+
+		if (texunit_diffuse.enabled)
+			R_BindTexture(first->material->diffuse->texnum);
+
+		if (texunit_lightmap.enabled)
+			R_BindLightmapTexture(first->lightmap->texnum);
+
+		if (r_state.lighting_enabled) {
+			R_BindDeluxemapTexture(first->deluxemap->texnum);
+
+			R_UseMaterial(first->material);
+
+			R_EnableLights(R_BspClusterLights(&bsp->clusters[first->cluster]));
+		}
+
+		if (r_state.stencil_test_enabled)
+			glStencilFunc(GL_ALWAYS, first->stencil, ~0);
+
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, elements + first->index * sizeof(GLuint));
+
+		r_view.num_bsp_batches++;
+	}
+}
+
+/**
+ * @brief Draws the opaque surfaces of the world by cluster. Each cluster marked
+ * by R_MarkBspSurfaces draws its material references, by material, rather than
+ * surface by surface. Each material reference is drawn at most once per frame,
+ * and only if it faces the view. If the world has no cluster materials, the
+ * opaque surfaces are drawn as usual.
+ */
+void R_DrawOpaqueBspClusters(void) {
+	const r_model_t *mod = r_model_state.world;
+
+	if (!R_BspClustersEnabled()) {
+		R_DrawOpaqueBspSurfaces(&mod->bsp->sorted_surfaces->opaque);
+		return;
+	}
+
+	if (r_draw_bsp_lightmaps->value)
+		R_EnableTexture(&texunit_diffuse, false);
+
+	R_EnableTexture(&texunit_lightmap, true);
+
+	R_EnableLighting(r_state.default_program, true);
+
+	if (r_shadows->value)
+		R_EnableStencilTest(GL_REPLACE, true);
+
+	R_SetArrayState(mod);
+
+	const GLubyte *elements = (const GLubyte *) mod->elements;
+
+	if (r_vertex_buffers->value && mod->element_buffer) {
+		qglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mod->element_buffer);
+		elements = NULL;
+	}
+
+	const r_bsp_cluster_t *cluster = mod->bsp->clusters;
+	for (uint16_t i = 0; i < mod->bsp->num_clusters; i++, cluster++) {
+
+		if (cluster->frame != r_locals.frame)
+			continue; // not in the PVS, a connected area or the view frustum
+
+		R_DrawBspCluster(cluster, elements);
+	}
+
+	if (mod->element_buffer)
+		qglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	// reset state
+	if (r_state.lighting_enabled) {
+
+		R_UseMaterial(NULL);
+
+		R_EnableLights(0);
+	}
+
+	if (r_shadows->value)
+		R_EnableStencilTest(GL_KEEP, false);
+
+	R_EnableLighting(NULL, false);
+
+	R_EnableTexture(&texunit_lightmap, false);
+
+	if (r_draw_bsp_lightmaps->value)
+		R_EnableTexture(&texunit_diffuse, true);
+}
+
 /**
  * @brief
  */
@@ -26,6 +26,7 @@
 
 #ifdef __R_LOCAL_H__
 void R_DrawOpaqueBspSurfaces_default(const r_bsp_surfaces_t *surfs);
+void R_DrawOpaqueBspClusters(void);
 void R_DrawOpaqueWarpBspSurfaces_default(const r_bsp_surfaces_t *surfs);
 void R_DrawAlphaTestBspSurfaces_default(const r_bsp_surfaces_t *surfs);
 void R_DrawBlendBspSurfaces_default(const r_bsp_surfaces_t *surfs);
@@ -28,6 +28,8 @@ typedef struct {
 	size_t count; // the number of elements in the current frame
 	size_t size; // the total size (max) allocated for this level
 
+	void *scratch; // for sorting the elements pool
+
 	r_bsp_surfaces_t surfs; // a bucket for depth-sorted BSP surfaces
 } r_element_state_t;
 
@@ -55,58 +57,35 @@ void R_AddElement(const r_element_t *e) {
 }
 
 /**
- * @brief Adds elements for the specified blended surfaces lists.
+ * @brief Adds elements for the visible surfaces of the specified blended
+ * surfaces list.
  */
-static void R_AddBspSurfaceElements(void) {
-	static r_element_t e;
-
-	r_bsp_surface_t *s = r_model_state.world->bsp->surfaces;
-
-	uint16_t i;
-	for (i = 0; i < r_model_state.world->bsp->num_surfaces; i++, s++) {
+static void R_AddBspSurfaceElements_(const r_bsp_surfaces_t *surfs, r_element_type_t type) {
+	r_element_t e = { .type = type };
 
-		if (s->texinfo->flags & (SURF_BLEND_33 | SURF_BLEND_66)) {
-			if (s->frame == r_locals.frame) {
+	r_bsp_surface_t **s = surfs->surfaces;
+	for (size_t i = 0; i < surfs->count; i++, s++) {
 
-				if (s->texinfo->flags & SURF_WARP) {
-					e.type = ELEMENT_BSP_SURFACE_BLEND_WARP;
-				} else {
-					e.type = ELEMENT_BSP_SURFACE_BLEND;
-				}
+		if ((*s)->frame == r_locals.frame) {
 
-				e.element = (const void *) s;
-				e.origin = (const vec_t *) s->center;
+			e.element = (const void *) *s;
+			e.origin = (const vec_t *) (*s)->center;
 
-				R_AddElement(&e);
-			}
+			R_AddElement(&e);
 		}
 	}
 }
 
 /**
- * @brief Qsort comparator for render elements. Qsort sorts elements into
- * ascending order, so we return negative values when a is behind b (b - a).
- *
- * Example:
- *
- * (a) is a particle with depth 255.0.
- * (b) is a surface with depth 64.0
- *
- * 64.0 - 255.0 = -191.0
- *
- * Thus (a) is sorted before (b) so that we may render back-to-front by
- * iterating the sorted array from 0 to length.
+ * @brief Adds elements for the blended surfaces lists, which are prebuilt at
+ * load time.
  */
-static int R_SortElements_Compare(const void *a, const void *b) {
-	return ((r_element_t *) b)->depth - ((r_element_t *) a)->depth;
-}
+static void R_AddBspSurfaceElements(void) {
 
-/**
- * @brief Sorts the specified elements array by their distance from the view.
- * Elements are sorted farthest-first so that they are rendered back-to-front.
- */
-static void R_SortElements_(r_element_t *e, const size_t count) {
-	qsort(e, count, sizeof(r_element_t), R_SortElements_Compare);
+	const r_sorted_bsp_surfaces_t *sorted = r_model_state.world->bsp->sorted_surfaces;
+
+	R_AddBspSurfaceElements_(&sorted->blend, ELEMENT_BSP_SURFACE_BLEND);
+	R_AddBspSurfaceElements_(&sorted->blend_warp, ELEMENT_BSP_SURFACE_BLEND_WARP);
 }
 
 /**
@@ -120,7 +99,7 @@ void R_SortElements(void *data __attribute__((unused))) {
 	if (!r_element_state.count)
 		return;
 
-	R_SortElements_(r_element_state.elements, r_element_state.count);
+	R_RadixSortElements(r_element_state.elements, r_element_state.count, r_element_state.scratch);
 
 	R_UpdateParticles(r_element_state.elements, r_element_state.count);
 }
@@ -226,4 +205,6 @@ void R_InitElements(r_bsp_model_t *bsp) {
 
 	r_element_state.size = MIN_ELEMENTS + r_element_state.surfs.count;
 	r_element_state.elements = Mem_LinkMalloc(r_element_state.size * sizeof(r_element_t), bsp);
+
+	r_element_state.scratch = Mem_LinkMalloc(R_ElementSortScratchSize(r_element_state.size), bsp);
 }
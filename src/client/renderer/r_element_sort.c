@@ -0,0 +1,124 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "r_local.h"
+
+/*
+ * Elements are sorted by a least significant digit radix sort over 32 bit depth
+ * keys, packed above the 32 bit index of each element. The keys alone are
+ * shuffled through each pass, and the elements are then permuted once. Passes
+ * whose digit is shared by every key are skipped.
+ */
+
+#define R_RADIX_BITS 8
+#define R_RADIX_SIZE (1 << R_RADIX_BITS)
+#define R_RADIX_PASSES (32 / R_RADIX_BITS)
+
+/**
+ * @return The size of the scratch space needed to sort `count` elements.
+ */
+size_t R_ElementSortScratchSize(size_t count) {
+	return count * (sizeof(uint64_t) * 2 + sizeof(r_element_t));
+}
+
+/**
+ * @return A key for the specified depth which sorts farthest-first in ascending
+ * unsigned order. The sign bit is flipped for positive depths, and all bits for
+ * negative depths, so that the keys order as the floats do. The key is then
+ * inverted.
+ */
+static inline uint32_t R_ElementDepthKey(vec_t depth) {
+	union {
+		float f;
+		uint32_t u;
+	} bits = { .f = depth };
+
+	if (bits.u & 0x80000000) {
+		bits.u = ~bits.u;
+	} else {
+		bits.u |= 0x80000000;
+	}
+
+	return ~bits.u;
+}
+
+/**
+ * @brief Sorts the specified elements by their distance from the view, farthest
+ * first, so that they are rendered back-to-front. Elements of equal depth retain
+ * their order.
+ *
+ * @param scratch At least R_ElementSortScratchSize(count) bytes.
+ */
+void R_RadixSortElements(r_element_t *e, size_t count, void *scratch) {
+	uint32_t histograms[R_RADIX_PASSES][R_RADIX_SIZE];
+
+	if (count < 2)
+		return;
+
+	uint64_t *keys = (uint64_t *) scratch;
+	uint64_t *temp = keys + count;
+	r_element_t *sorted = (r_element_t *) (temp + count);
+
+	memset(histograms, 0, sizeof(histograms));
+
+	// pack the keys and count every digit in a single pass
+	for (size_t i = 0; i < count; i++) {
+		const uint32_t key = R_ElementDepthKey(e[i].depth);
+
+		keys[i] = ((uint64_t) key << 32) | (uint32_t) i;
+
+		for (int32_t p = 0; p < R_RADIX_PASSES; p++) {
+			histograms[p][(key >> (p * R_RADIX_BITS)) & (R_RADIX_SIZE - 1)]++;
+		}
+	}
+
+	for (int32_t p = 0; p < R_RADIX_PASSES; p++) {
+		uint32_t *histogram = histograms[p];
+
+		const uint32_t shift = 32 + p * R_RADIX_BITS;
+
+		if (histogram[(keys[0] >> shift) & (R_RADIX_SIZE - 1)] == count)
+			continue; // every key shares this digit
+
+		// convert the counts to offsets
+		uint32_t offset = 0;
+		for (int32_t i = 0; i < R_RADIX_SIZE; i++) {
+			const uint32_t c = histogram[i];
+			histogram[i] = offset;
+			offset += c;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			temp[histogram[(keys[i] >> shift) & (R_RADIX_SIZE - 1)]++] = keys[i];
+		}
+
+		uint64_t *swap = keys;
+		keys = temp;
+		temp = swap;
+	}
+
+	// permute the elements
+	for (size_t i = 0; i < count; i++) {
+		sorted[i] = e[(uint32_t) keys[i]];
+	}
+
+	memcpy(e, sorted, count * sizeof(r_element_t));
+}
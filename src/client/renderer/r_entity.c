@@ -131,20 +131,45 @@ void R_SetMatrixForEntity(r_entity_t *e) {
 }
 
 /**
- * @brief Qsort comparator for R_CullEntities.
+ * @brief Qsort comparator for R_CullEntities. Entities are ordered by model, and
+ * then by skins, frames and effects, so that those which may be drawn together
+ * are adjacent.
  */
 static int32_t R_CullEntities_compare(const void *a, const void *b) {
 
 	const r_entity_t *e1 = *((const r_entity_t **) a);
 	const r_entity_t *e2 = *((const r_entity_t **) b);
 
-	return strcmp(e1->model->media.name, e2->model->media.name);
+	int32_t order = strcmp(e1->model->media.name, e2->model->media.name);
+	if (order) {
+		return order;
+	}
+
+	order = memcmp(e1->skins, e2->skins, sizeof(e1->skins));
+	if (order) {
+		return order;
+	}
+
+	if (e1->frame != e2->frame) {
+		return e1->frame - e2->frame;
+	}
+
+	if (e1->old_frame != e2->old_frame) {
+		return e1->old_frame - e2->old_frame;
+	}
+
+	if (e1->effects != e2->effects) {
+		return e1->effects < e2->effects ? -1 : 1;
+	}
+
+	return e1->lerp < e2->lerp ? -1 : e1->lerp > e2->lerp;
 }
 
 /**
  * @brief Performs a frustum-cull of all entities. This is performed in a separate
  * thread while the renderer draws the world. Mesh entities which pass a frustum
- * cull will also have their lighting information updated.
+ * cull will also have their lighting information updated, and their animations
+ * interpolated.
  */
 void R_CullEntities(void *data __attribute__((unused))) {
 
@@ -175,10 +200,14 @@ void R_CullEntities(void *data __attribute__((unused))) {
 		R_SetMatrixForEntity(e); // set the transform matrix
 	}
 
-	// sort the mesh entities list by model to allow object instancing
+	// sort the mesh entities list by model, skins and frames to allow batching
 
 	r_entities_t *mesh = &r_sorted_entities.mesh_entities;
 	qsort(mesh, mesh->count, sizeof(r_entity_t *), R_CullEntities_compare);
+
+	// and interpolate the animated ones while the world is drawn
+
+	R_InterpolateMeshModels(mesh);
 }
 
 /**
@@ -28,12 +28,17 @@ void (APIENTRY *qglGenBuffers)(GLuint count, GLuint *ids);
 void (APIENTRY *qglDeleteBuffers)(GLuint count, GLuint *ids);
 void (APIENTRY *qglBindBuffer)(GLenum target, GLuint id);
 void (APIENTRY *qglBufferData)(GLenum target, GLsizei size, const GLvoid *data, GLenum usage);
+void (APIENTRY *qglBufferSubData)(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data);
 
 void (APIENTRY *qglEnableVertexAttribArray)(GLuint index);
 void (APIENTRY *qglDisableVertexAttribArray)(GLuint index);
 void (APIENTRY *qglVertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized,
 										GLsizei stride, const GLvoid *pointer);
 
+void (APIENTRY *qglDrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+void (APIENTRY *qglDrawElementsInstanced)(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices,
+										  GLsizei primcount);
+
 GLuint (APIENTRY *qglCreateShader)(GLenum type);
 void (APIENTRY *qglDeleteShader)(GLuint id);
 void (APIENTRY *qglShaderSource)(GLuint id, GLuint count, GLchar **sources, GLuint *len);
@@ -93,9 +98,17 @@ void R_InitGlExtensions(void) {
 		qglDeleteBuffers = SDL_GL_GetProcAddress("glDeleteBuffers");
 		qglBindBuffer = SDL_GL_GetProcAddress("glBindBuffer");
 		qglBufferData = SDL_GL_GetProcAddress("glBufferData");
+		qglBufferSubData = SDL_GL_GetProcAddress("glBufferSubData");
 	} else
 		Com_Warn("GL_ARB_vertex_buffer_object not found\n");
 
+	// instanced drawing
+	if (strstr(r_config.extensions_string, "GL_ARB_draw_instanced")) {
+		qglDrawArraysInstanced = SDL_GL_GetProcAddress("glDrawArraysInstancedARB");
+		qglDrawElementsInstanced = SDL_GL_GetProcAddress("glDrawElementsInstancedARB");
+	} else
+		Com_Warn("GL_ARB_draw_instanced not found\n");
+
 	// glsl vertex and fragment shaders and programs
 	if (strstr(r_config.extensions_string, "GL_ARB_fragment_shader")) {
 		qglCreateShader = SDL_GL_GetProcAddress("glCreateShader");
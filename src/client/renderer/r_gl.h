@@ -53,6 +53,14 @@
 #define GL_STATIC_DRAW 0x88E4
 #endif
 
+#ifndef GL_ELEMENT_ARRAY_BUFFER
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#endif
+
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+
 #ifndef GL_TEXTURE0_ARB
 #define GL_TEXTURE0_ARB 0x84C0
 #define GL_TEXTURE1_ARB 0x84C1
@@ -74,6 +82,7 @@ extern void (APIENTRY *qglGenBuffers)(GLuint count, GLuint *ids);
 extern void (APIENTRY *qglDeleteBuffers)(GLuint count, GLuint *ids);
 extern void (APIENTRY *qglBindBuffer)(GLenum target, GLuint id);
 extern void (APIENTRY *qglBufferData)(GLenum target, GLsizei size, const GLvoid *data, GLenum usage);
+extern void (APIENTRY *qglBufferSubData)(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data);
 
 // vertex attribute arrays
 extern void (APIENTRY *qglEnableVertexAttribArray)(GLuint index);
@@ -81,6 +90,11 @@ extern void (APIENTRY *qglDisableVertexAttribArray)(GLuint index);
 extern void (APIENTRY *qglVertexAttribPointer)(GLuint index, GLint size, GLenum type,
 											   GLboolean normalized, GLsizei stride, const GLvoid *pointer);
 
+// instanced drawing
+extern void (APIENTRY *qglDrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+extern void (APIENTRY *qglDrawElementsInstanced)(GLenum mode, GLsizei count, GLenum type,
+												 const GLvoid *indices, GLsizei primcount);
+
 // glsl vertex and fragment shaders and programs
 extern GLuint (APIENTRY *qglCreateShader)(GLenum type);
 extern void (APIENTRY *qglDeleteShader)(GLuint id);
@@ -166,6 +166,44 @@ static void R_SunIllumination(const r_lighting_t *l) {
 	R_AddIllumination(&il);
 }
 
+#define LIGHTING_GRID_RADIUS 360.0
+#define LIGHTING_GRID_DIST 260.0
+
+/**
+ * @brief Adds ambient and directional illuminations sampled from the light grid,
+ * in lieu of tracing to the sun and static light sources.
+ * @return True if the light grid was sampled, false if the world has none.
+ */
+static _Bool R_LightGridIlluminations(const r_lighting_t *l) {
+	r_illumination_t il;
+	vec3_t ambient, diffuse, dir;
+
+	if (!R_SampleLightGrid(l->origin, ambient, diffuse, dir))
+		return false;
+
+	VectorMA(l->origin, LIGHTING_AMBIENT_DIST, vec3_up, il.light.origin);
+	VectorCopy(ambient, il.light.color);
+
+	il.type = ILLUM_AMBIENT;
+	il.light.radius = LIGHTING_AMBIENT_RADIUS * r_lighting->value;
+	il.diffuse = il.light.radius - LIGHTING_AMBIENT_DIST;
+
+	R_AddIllumination(&il);
+
+	if (VectorCompare(diffuse, vec3_origin))
+		return true;
+
+	VectorMA(l->origin, LIGHTING_GRID_DIST, dir, il.light.origin);
+	VectorCopy(diffuse, il.light.color);
+
+	il.type = ILLUM_GRID;
+	il.light.radius = LIGHTING_GRID_RADIUS * r_lighting->value;
+	il.diffuse = il.light.radius - LIGHTING_GRID_DIST;
+
+	R_AddIllumination(&il);
+	return true;
+}
+
 /**
  * @brief Adds an illumination for the positional light source, if the given
  * point is within range and not occluded.
@@ -282,12 +320,16 @@ static void R_UpdateIlluminations(r_lighting_t *l) {
 
 	memset(l->illuminations, 0, sizeof(l->illuminations));
 
-	// otherwise, resolve ambient, sun and static illuminations as well
-	R_AmbientIllumination(l);
+	// otherwise, resolve ambient, sun and static illuminations as well, from
+	// the light grid if the map has one, or by tracing to them if not
+	if (!R_LightGridIlluminations(l)) {
+
+		R_AmbientIllumination(l);
 
-	R_SunIllumination(l);
+		R_SunIllumination(l);
 
-	R_StaticIlluminations(l);
+		R_StaticIlluminations(l);
+	}
 
 	r_illumination_t *il = r_illuminations.illuminations;
 
@@ -404,6 +446,7 @@ static void R_UpdateShadows(r_lighting_t *l) {
 			case ILLUM_AMBIENT:
 				break;
 			case ILLUM_SUN:
+			case ILLUM_GRID:
 				if (r_shadows->integer < 2)
 					continue;
 				break;
@@ -193,7 +193,7 @@ static void R_BuildLightmap(const r_bsp_model_t *bsp, const r_bsp_surface_t *sur
 		*lm++ = *in++;
 
 		// read in directional samples for per-pixel lighting as well
-		if (bsp->version == BSP_VERSION_QUETOO) {
+		if (bsp->version != BSP_VERSION) {
 			*dm++ = *in++;
 			*dm++ = *in++;
 			*dm++ = *in++;
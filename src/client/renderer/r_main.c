@@ -154,18 +154,19 @@ void R_DrawView(void) {
 
 	R_DrawSkyBox();
 
-	// wait for the client to fully populate the scene
-	Thread_Wait(r_view.thread);
+	// cull entities and sort elements while we draw the world, once populated
+	task_t *cull_entities = Task_SubmitAfter(R_CullEntities, NULL, &r_view.task, 1);
+	task_t *sort_elements = Task_SubmitAfter(R_SortElements, NULL, &r_view.task, 1);
 
-	// dispatch threads to cull entities and sort elements while we draw the world
-	thread_t *cull_entities = Thread_Create(R_CullEntities, NULL);
-	thread_t *sort_elements = Thread_Create(R_SortElements, NULL);
+	// wait for the client to fully populate the scene
+	Task_Wait(r_view.task);
+	r_view.task = NULL;
 
 	R_MarkLights();
 
 	const r_sorted_bsp_surfaces_t *surfs = r_model_state.world->bsp->sorted_surfaces;
 
-	R_DrawOpaqueBspSurfaces(&surfs->opaque);
+	R_DrawOpaqueBspClusters();
 
 	R_DrawOpaqueWarpBspSurfaces(&surfs->opaque_warp);
 
@@ -182,14 +183,14 @@ void R_DrawView(void) {
 	R_EnableBlend(false);
 
 	// wait for entity culling to complete
-	Thread_Wait(cull_entities);
+	Task_Wait(cull_entities);
 
 	R_DrawEntities();
 
 	R_EnableBlend(true);
 
 	// wait for element sorting to complete
-	Thread_Wait(sort_elements);
+	Task_Wait(sort_elements);
 
 	R_DrawElements();
 
@@ -555,6 +556,8 @@ void R_Init(void) {
 
 	R_InitDraw();
 
+	R_InitParticles();
+
 	R_InitModels();
 
 	R_InitView();
@@ -573,6 +576,8 @@ void R_Shutdown(void) {
 
 	R_ShutdownMedia();
 
+	R_ShutdownParticles();
+
 	R_ShutdownPrograms();
 
 	R_ShutdownContext();
@@ -416,10 +416,10 @@ void R_DrawMaterialBspSurfaces(const r_bsp_surfaces_t *surfs) {
 }
 
 /**
- * @brief Re-draws the currently bound arrays from the given offset to count after
- * setting GL state for the stage.
+ * @brief Re-draws the currently bound arrays of the specified entity from the
+ * given offset to count after setting GL state for the stage.
  */
-void R_DrawMeshMaterial(r_material_t *m, const GLuint offset, const GLuint count) {
+void R_DrawMeshMaterial(const r_entity_t *e, r_material_t *m, const GLuint offset, const GLuint count) {
 	const _Bool blend = r_state.blend_enabled;
 
 	if (!r_materials->value || r_draw_wireframe->value)
@@ -447,7 +447,7 @@ void R_DrawMeshMaterial(r_material_t *m, const GLuint offset, const GLuint count
 
 		R_SetStageState(NULL, s);
 
-		glDrawArrays(GL_TRIANGLES, offset, count);
+		R_DrawMeshModelArrays(e, offset, count);
 	}
 
 	R_EnablePolygonOffset(GL_POLYGON_OFFSET_FILL, false);
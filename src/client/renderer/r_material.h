@@ -59,7 +59,7 @@ r_material_t *R_LoadMaterial(const char *diffuse);
 )
 
 void R_DrawMaterialBspSurfaces(const r_bsp_surfaces_t *surfs);
-void R_DrawMeshMaterial(r_material_t *m, const GLuint offset, const GLuint count);
+void R_DrawMeshMaterial(const r_entity_t *e, r_material_t *m, const GLuint offset, const GLuint count);
 void R_LoadMaterials(const r_model_t *mod);
 void R_SaveMaterials_f(void);
 #endif /* __R_LOCAL_H__ */
@@ -157,80 +157,199 @@ void R_UpdateMeshModelLighting(const r_entity_t *e) {
 }
 
 /**
- * @brief Interpolate the animation for the give entity, writing primitives to
- * the default vertex arrays. This must be called at each frame for animated
- * entities.
+ * @brief Resolves the specified frame of the animated mesh entity, falling back
+ * on the first frame if it is not valid.
  */
-void R_InterpolateMeshModel(const r_entity_t *e) {
+static uint16_t R_InterpolateMeshModel_frame(const r_entity_t *e, int32_t frame) {
 
-	const r_md3_t *md3 = (r_md3_t *) e->model->mesh->data;
-	const d_md3_frame_t *frame, *old_frame;
+	if (frame < 0 || frame >= e->model->mesh->num_frames) {
+		Com_Warn("%s: no such frame %d\n", e->model->media.name, frame);
+		return 0;
+	}
 
-	if (e->frame >= e->model->mesh->num_frames) {
-		Com_Warn("%s: no such frame %d\n", e->model->media.name, e->frame);
-		frame = &md3->frames[0];
-	} else {
-		frame = &md3->frames[e->frame];
+	return (uint16_t) frame;
+}
+
+typedef struct {
+	const r_entity_t *entities[MAX_ENTITIES];
+	uint16_t frames[MAX_ENTITIES];
+	uint16_t old_frames[MAX_ENTITIES];
+
+	const r_entity_t *instances[MAX_ENTITIES]; // entities sharing the interpolation
+	const r_entity_t *sources[MAX_ENTITIES]; // of the entity they share it with
+	size_t num_instances;
+} r_mesh_interpolate_t;
+
+static r_mesh_interpolate_t r_mesh_interpolate;
+
+/**
+ * @brief Interpolates the vertexes and normals of a range of animated entities.
+ */
+static void R_InterpolateMeshModels_(void *data, int32_t begin, int32_t end) {
+	const r_mesh_interpolate_t *in = (const r_mesh_interpolate_t *) data;
+
+	for (int32_t i = begin; i < end; i++) {
+		const r_entity_t *e = in->entities[i];
+
+		const r_md3_t *md3 = (r_md3_t *) e->model->mesh->data;
+		const r_mesh_interpolation_t *out = &r_mesh_state.interpolations[e - r_view.entities];
+
+		const size_t count = md3->num_verts * 3;
+
+		const size_t frame = in->frames[i] * count;
+		const size_t old_frame = in->old_frames[i] * count;
+
+		R_LerpMeshVertexes(out->verts, md3->verts + old_frame, md3->verts + frame,
+				e->back_lerp, e->lerp, count);
+
+		R_LerpMeshVertexes(out->normals, md3->normals + old_frame, md3->normals + frame,
+				e->back_lerp, 1.0 - e->back_lerp, count);
 	}
+}
 
-	if (e->old_frame >= e->model->mesh->num_frames) {
-		Com_Warn("%s: no such old_frame %d\n", e->model->media.name, e->old_frame);
-		old_frame = &md3->frames[0];
-	} else {
-		old_frame = &md3->frames[e->old_frame];
+/**
+ * @return True if the specified entities would interpolate to the same vertexes.
+ */
+static _Bool R_InterpolateMeshModels_shared(const r_entity_t *a, const r_entity_t *b) {
+
+	if (a->model != b->model) {
+		return false;
 	}
 
-	vec3_t trans;
-	for (int32_t i = 0; i < 3; i++) // calculate the translation
-		trans[i] = e->back_lerp * old_frame->translate[i] + e->lerp * frame->translate[i];
+	if (a->frame != b->frame || a->old_frame != b->old_frame) {
+		return false;
+	}
+
+	return a->lerp == b->lerp && a->back_lerp == b->back_lerp;
+}
 
-	GLuint vert_index = 0;
+/**
+ * @brief Interpolates the animations of all animated entities in the specified
+ * list, in parallel. Space for each entity is reserved serially, and the frames
+ * are resolved, so that the interpolation itself writes only its own entity.
+ * Entities which are adjacent in the sorted list and would interpolate to the
+ * same vertexes share a single interpolation. This must be called at each frame,
+ * before any animated entities are drawn.
+ */
+void R_InterpolateMeshModels(const r_entities_t *ents) {
+	size_t size = 0, count = 0;
 
-	const r_md3_mesh_t *mesh = md3->meshes;
-	for (uint16_t i = 0; i < md3->num_meshes; i++, mesh++) { // iterate the meshes
+	r_mesh_interpolate.num_instances = 0;
 
-		const r_md3_vertex_t *v = mesh->verts + e->frame * mesh->num_verts;
-		const r_md3_vertex_t *ov = mesh->verts + e->old_frame * mesh->num_verts;
+	for (size_t i = 0; i < ents->count; i++) {
+		const r_entity_t *e = ents->entities[i];
 
-		const uint32_t *tri = mesh->tris;
+		if (e->model->type != MOD_MD3 || e->model->mesh->num_frames == 1) {
+			continue;
+		}
 
-		for (uint16_t j = 0; j < mesh->num_verts; j++, v++, ov++) { // interpolate the vertexes
-			VectorSet(r_mesh_state.vertexes[j],
-					trans[0] + ov->point[0] * e->back_lerp + v->point[0] * e->lerp,
-					trans[1] + ov->point[1] * e->back_lerp + v->point[1] * e->lerp,
-					trans[2] + ov->point[2] * e->back_lerp + v->point[2] * e->lerp);
+		if (count && R_InterpolateMeshModels_shared(r_mesh_interpolate.entities[count - 1], e)) {
+			const size_t j = r_mesh_interpolate.num_instances++;
 
-			if (r_state.lighting_enabled) { // and the normals
-				VectorSet(r_mesh_state.normals[j],
-						v->normal[0] + (ov->normal[0] - v->normal[0]) * e->back_lerp,
-						v->normal[1] + (ov->normal[1] - v->normal[1]) * e->back_lerp,
-						v->normal[2] + (ov->normal[2] - v->normal[2]) * e->back_lerp);
-			}
+			r_mesh_interpolate.instances[j] = e;
+			r_mesh_interpolate.sources[j] = r_mesh_interpolate.entities[count - 1];
+			continue;
 		}
 
-		for (uint16_t j = 0; j < mesh->num_tris; j++, tri += 3) { // populate the triangles
+		r_mesh_interpolate.entities[count] = e;
+		r_mesh_interpolate.frames[count] = R_InterpolateMeshModel_frame(e, e->frame);
+		r_mesh_interpolate.old_frames[count] = R_InterpolateMeshModel_frame(e, e->old_frame);
+		count++;
 
-			VectorCopy(r_mesh_state.vertexes[tri[0]], (&r_state.vertex_array_3d[vert_index + 0]));
-			VectorCopy(r_mesh_state.vertexes[tri[1]], (&r_state.vertex_array_3d[vert_index + 3]));
-			VectorCopy(r_mesh_state.vertexes[tri[2]], (&r_state.vertex_array_3d[vert_index + 6]));
+		size += ((const r_md3_t *) e->model->mesh->data)->num_verts * 6;
+	}
 
-			if (r_state.lighting_enabled) { // normal vectors for lighting
-				VectorCopy(r_mesh_state.normals[tri[0]], (&r_state.normal_array[vert_index + 0]));
-				VectorCopy(r_mesh_state.normals[tri[1]], (&r_state.normal_array[vert_index + 3]));
-				VectorCopy(r_mesh_state.normals[tri[2]], (&r_state.normal_array[vert_index + 6]));
-			}
+	if (count == 0) {
+		return;
+	}
+
+	if (size > r_mesh_state.interpolated_size) {
 
-			vert_index += 9;
+		if (r_mesh_state.interpolated) {
+			Mem_Free(r_mesh_state.interpolated);
 		}
+
+		r_mesh_state.interpolated = Mem_TagMalloc(size * sizeof(GLfloat), MEM_TAG_RENDERER);
+		r_mesh_state.interpolated_size = size;
+	}
+
+	GLfloat *out = r_mesh_state.interpolated;
+
+	for (size_t i = 0; i < count; i++) {
+		const r_entity_t *e = r_mesh_interpolate.entities[i];
+
+		const size_t verts = ((const r_md3_t *) e->model->mesh->data)->num_verts * 3;
+
+		r_mesh_interpolation_t *in = &r_mesh_state.interpolations[e - r_view.entities];
+
+		in->verts = out;
+		out += verts;
+
+		in->normals = out;
+		out += verts;
+	}
+
+	for (size_t i = 0; i < r_mesh_interpolate.num_instances; i++) {
+		const r_entity_t *e = r_mesh_interpolate.instances[i];
+		const r_entity_t *source = r_mesh_interpolate.sources[i];
+
+		r_mesh_state.interpolations[e - r_view.entities] =
+				r_mesh_state.interpolations[source - r_view.entities];
+	}
+
+	Task_ParallelFor(R_InterpolateMeshModels_, &r_mesh_interpolate, (int32_t) count, 1);
+}
+
+/**
+ * @brief Binds the interpolated vertex and normal arrays of the specified animated
+ * entity. R_InterpolateMeshModels must have been called for the current frame.
+ */
+void R_BindInterpolatedMeshModel(const r_entity_t *e) {
+
+	const r_mesh_interpolation_t *in = &r_mesh_state.interpolations[e - r_view.entities];
+
+	R_BindArray(GL_VERTEX_ARRAY, GL_FLOAT, in->verts);
+
+	if (r_state.lighting_enabled) {
+		R_BindArray(GL_NORMAL_ARRAY, GL_FLOAT, in->normals);
+	}
+}
+
+/**
+ * @brief Restores the default vertex and normal arrays after drawing an animated
+ * entity.
+ */
+void R_ResetInterpolatedMeshModel(void) {
+
+	R_BindDefaultArray(GL_VERTEX_ARRAY);
+
+	if (r_state.lighting_enabled) {
+		R_BindDefaultArray(GL_NORMAL_ARRAY);
+	}
+}
+
+/**
+ * @brief Draws `count` vertexes of the bound arrays of the specified entity,
+ * from `offset`. Animated MD3 models are drawn by their elements, whose offsets
+ * coincide with those of the expanded arrays of static models.
+ */
+void R_DrawMeshModelArrays(const r_entity_t *e, GLuint offset, GLuint count) {
+
+	if (e->model->type == MOD_MD3 && e->model->mesh->num_frames > 1) {
+		const r_md3_t *md3 = (r_md3_t *) e->model->mesh->data;
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, md3->elements + offset);
+	} else {
+		glDrawArrays(GL_TRIANGLES, offset, count);
 	}
+
+	r_view.num_mesh_draws++;
 }
 
 /**
- * @brief Sets the shade color for the mesh by modulating any preset color
+ * @brief Resolves the shade color for the mesh by modulating any preset color
  * with static lighting.
  */
-static void R_SetMeshColor_default(const r_entity_t *e) {
-	vec4_t color;
+static void R_MeshColor_default(const r_entity_t *e, vec4_t color) {
 
 	VectorCopy(r_bsp_light_state.ambient, color);
 
@@ -256,17 +375,24 @@ static void R_SetMeshColor_default(const r_entity_t *e) {
 		color[3] = Clamp(e->color[3], 0.0, 1.0);
 	else
 		color[3] = 1.0;
+}
+
+/**
+ * @brief Sets the shade color for the mesh.
+ */
+static void R_SetMeshColor_default(const r_entity_t *e) {
+	vec4_t color;
+
+	R_MeshColor_default(e, color);
 
 	R_Color(color);
 }
 
 /**
- * @brief Populates hardware light sources with illumination information.
+ * @brief Resolves the light sources illuminating the specified mesh entity.
+ * @return The number of light sources.
  */
-static void R_ApplyMeshModelLighting_default(const r_entity_t *e) {
-
-	vec4_t position = { 0.0, 0.0, 0.0, 1.0 };
-	vec4_t diffuse = { 0.0, 0.0, 0.0, 1.0 };
+static uint16_t R_MeshModelLights_default(const r_entity_t *e, r_light_t *lights) {
 
 	uint16_t i;
 	for (i = 0; i < MAX_ACTIVE_LIGHTS; i++) {
@@ -276,21 +402,99 @@ static void R_ApplyMeshModelLighting_default(const r_entity_t *e) {
 		if (il->diffuse == 0.0)
 			break;
 
-		VectorCopy(il->light.origin, position);
+		lights[i] = il->light;
+	}
+
+	return i;
+}
+
+/**
+ * @brief Populates hardware light sources with the specified lights.
+ */
+static void R_ApplyMeshLights_default(const r_light_t *lights, uint16_t count) {
+
+	vec4_t position = { 0.0, 0.0, 0.0, 1.0 };
+	vec4_t diffuse = { 0.0, 0.0, 0.0, 1.0 };
+
+	for (uint16_t i = 0; i < count; i++) {
+
+		VectorCopy(lights[i].origin, position);
 		glLightfv(GL_LIGHT0 + i, GL_POSITION, position);
 
-		VectorCopy(il->light.color, diffuse);
+		VectorCopy(lights[i].color, diffuse);
 		glLightfv(GL_LIGHT0 + i, GL_DIFFUSE, diffuse);
 
-		glLightf(GL_LIGHT0 + i, GL_CONSTANT_ATTENUATION, il->light.radius);
+		glLightf(GL_LIGHT0 + i, GL_CONSTANT_ATTENUATION, lights[i].radius);
+	}
+
+	if (count < MAX_ACTIVE_LIGHTS) // disable the next light as a stop
+		glLightf(GL_LIGHT0 + count, GL_CONSTANT_ATTENUATION, 0.0);
+}
+
+/**
+ * @brief Populates hardware light sources with illumination information.
+ */
+static void R_ApplyMeshModelLighting_default(const r_entity_t *e) {
+	r_light_t lights[MAX_ACTIVE_LIGHTS];
+
+	R_ApplyMeshLights_default(lights, R_MeshModelLights_default(e, lights));
+}
+
+/**
+ * @brief Effects which alter the renderer state of a batch of mesh entities.
+ */
+#define R_MESH_BATCH_EFFECTS (EF_ALPHATEST | EF_BLEND | EF_WEAPON | EF_NO_LIGHTING)
+
+/**
+ * @return True if the specified entities may be drawn in the same batch, sharing
+ * their model, skins, frames and renderer state.
+ */
+static _Bool R_MeshModelBatchable(const r_entity_t *a, const r_entity_t *b) {
+
+	if (a->model != b->model) {
+		return false;
 	}
 
-	if (i < MAX_ACTIVE_LIGHTS) // disable the next light as a stop
-		glLightf(GL_LIGHT0 + i, GL_CONSTANT_ATTENUATION, 0.0);
+	if (memcmp(a->skins, b->skins, sizeof(a->skins))) {
+		return false;
+	}
+
+	if (a->frame != b->frame || a->old_frame != b->old_frame) {
+		return false;
+	}
+
+	return (a->effects & R_MESH_BATCH_EFFECTS) == (b->effects & R_MESH_BATCH_EFFECTS);
+}
+
+/**
+ * @return True if lighting should be applied to the specified entity.
+ */
+static _Bool R_MeshModelLit_default(const r_entity_t *e) {
+	return !r_draw_wireframe->value && (e->effects & EF_NO_LIGHTING) == 0 && r_state.lighting_enabled;
 }
 
 /**
- * @brief Sets renderer state for the specified entity.
+ * @brief Sets the material of the specified mesh of the entity, binding its
+ * diffuse texture. Material stages bind their own textures, so this must be
+ * called before each mesh is drawn.
+ */
+static void R_SetMeshMaterial_default(const r_entity_t *e, uint16_t mesh) {
+
+	if (r_draw_wireframe->value)
+		return;
+
+	r_mesh_state.material = e->skins[mesh] ?: e->model->mesh->material;
+
+	R_BindTexture(r_mesh_state.material->diffuse->texnum);
+
+	if (R_MeshModelLit_default(e)) {
+		R_UseMaterial(r_mesh_state.material);
+	}
+}
+
+/**
+ * @brief Sets the renderer state shared by a batch of entities, the first of
+ * which is specified.
  */
 static void R_SetMeshState_default(const r_entity_t *e) {
 
@@ -300,29 +504,17 @@ static void R_SetMeshState_default(const r_entity_t *e) {
 		R_ResetArrayState();
 
 		R_BindArray(GL_TEXTURE_COORD_ARRAY, GL_FLOAT, e->model->texcoords);
-
-		R_InterpolateMeshModel(e);
 	}
 
 	if (!r_draw_wireframe->value) {
 
-		r_mesh_state.material = e->skins[0] ?: e->model->mesh->material;
-
-		R_BindTexture(r_mesh_state.material->diffuse->texnum);
-
-		R_SetMeshColor_default(e);
+		R_SetMeshMaterial_default(e, 0);
 
 		if (e->effects & EF_ALPHATEST)
 			R_EnableAlphaTest(true);
 
 		if (e->effects & EF_BLEND)
 			R_EnableBlend(true);
-
-		if ((e->effects & EF_NO_LIGHTING) == 0 && r_state.lighting_enabled) {
-			R_UseMaterial(r_mesh_state.material);
-
-			R_ApplyMeshModelLighting_default(e);
-		}
 	} else {
 		R_Color(NULL);
 
@@ -331,17 +523,14 @@ static void R_SetMeshState_default(const r_entity_t *e) {
 
 	if (e->effects & EF_WEAPON)
 		glDepthRange(0.0, 0.3);
-
-	R_RotateForEntity(e);
 }
 
 /**
- * @brief Restores renderer state for the given entity.
+ * @brief Restores the renderer state shared by a batch of entities, the first
+ * of which is specified.
  */
 static void R_ResetMeshState_default(const r_entity_t *e) {
 
-	R_RotateForEntity(NULL);
-
 	if (e->effects & EF_WEAPON)
 		glDepthRange(0.0, 1.0);
 
@@ -355,55 +544,283 @@ static void R_ResetMeshState_default(const r_entity_t *e) {
 		if (texunit_diffuse.enabled) {
 			R_BindDefaultArray(GL_TEXTURE_COORD_ARRAY);
 		}
+
+		R_ResetInterpolatedMeshModel();
+	}
+}
+
+/**
+ * @brief Draws `count` vertexes of the bound arrays from `offset` for each of
+ * `instances` instances of the specified entity's model.
+ */
+static void R_DrawMeshModelArraysInstanced(const r_entity_t *e, GLuint offset, GLuint count,
+		GLsizei instances) {
+
+	if (e->model->type == MOD_MD3 && e->model->mesh->num_frames > 1) {
+		const r_md3_t *md3 = (r_md3_t *) e->model->mesh->data;
+		qglDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, md3->elements + offset, instances);
+	} else {
+		qglDrawArraysInstanced(GL_TRIANGLES, offset, count, instances);
+	}
+
+	r_view.num_mesh_draws++;
+}
+
+/**
+ * @brief Draws the specified range of the bound arrays with the material of the
+ * given mesh. If `instances` is not 0, the range is drawn once per instance.
+ * Otherwise, it is drawn for the current entity only, along with any material
+ * stages.
+ */
+static void R_DrawMeshModelMesh_default(const r_entity_t *e, uint16_t mesh, GLuint offset, GLuint count,
+		GLsizei instances) {
+
+	R_SetMeshMaterial_default(e, mesh);
+
+	if (instances) {
+		R_DrawMeshModelArraysInstanced(e, offset, count, instances);
+	} else {
+		R_DrawMeshModelArrays(e, offset, count);
+
+		R_DrawMeshMaterial(e, r_mesh_state.material, offset, count);
+	}
+}
+
+/**
+ * @brief Draws each mesh of the specified entity's model with its own material.
+ */
+static void R_DrawMeshModelMeshes_default(const r_entity_t *e, GLsizei instances) {
+
+	if (e->model->type == MOD_MD3) {
+		const r_md3_t *md3 = (const r_md3_t *) e->model->mesh->data;
+
+		GLuint offset = 0;
+
+		const r_md3_mesh_t *mesh = md3->meshes;
+		for (uint16_t i = 0; i < md3->num_meshes; i++, mesh++) {
+
+			R_DrawMeshModelMesh_default(e, i, offset, mesh->num_tris * 3, instances);
+
+			offset += mesh->num_tris * 3;
+		}
+	} else {
+		R_DrawMeshModelMesh_default(e, 0, 0, e->model->num_verts, instances);
 	}
 }
 
 /**
- * @brief Draw the diffuse pass of each mesh segment for the specified model.
+ * @brief Draws each entity of the batch in turn, setting its color, lighting and
+ * transform once for all of its meshes. Animated entities which share an
+ * interpolation also share their array bindings.
  */
-static void R_DrawMeshParts_default(const r_entity_t *e, const r_md3_t *md3) {
-	uint32_t offset = 0;
+static void R_DrawMeshEntities_default(const r_entity_t **ents, size_t count) {
+
+	const GLfloat *verts = NULL;
+
+	for (size_t i = 0; i < count; i++) {
+		const r_entity_t *e = ents[i];
+
+		r_view.current_entity = e;
+
+		if (e->model->mesh->num_frames > 1) {
+			const r_mesh_interpolation_t *in = &r_mesh_state.interpolations[e - r_view.entities];
 
-	const r_md3_mesh_t *mesh = md3->meshes;
-	for (uint16_t i = 0; i < md3->num_meshes; i++, mesh++) {
+			if (in->verts != verts) {
+				R_BindInterpolatedMeshModel(e);
+				verts = in->verts;
+			}
+		}
 
 		if (!r_draw_wireframe->value) {
-			if (i > 0) { // update the diffuse state for the current mesh
-				r_mesh_state.material = e->skins[i] ?: e->model->mesh->material;
+			R_SetMeshColor_default(e);
+
+			if (R_MeshModelLit_default(e)) {
+				R_ApplyMeshModelLighting_default(e);
+			}
+		}
+
+		R_RotateForEntity(e);
+
+		R_DrawMeshModelMeshes_default(e, 0);
+
+		R_RotateForEntity(NULL);
+	}
+}
+
+/**
+ * @return True if the specified batch of entities may be drawn with instanced
+ * draw calls. Material stages are drawn per entity, so batches with stages may
+ * not be.
+ */
+static _Bool R_MeshModelInstanced_default(const r_entity_t **ents, size_t count) {
+
+	if (count < 2 || !qglDrawArraysInstanced || !qglDrawElementsInstanced)
+		return false;
+
+	const r_entity_t *e = ents[0];
+
+	if (r_state.active_program != r_state.default_program || !R_MeshModelLit_default(e))
+		return false;
 
-				R_BindTexture(r_mesh_state.material->diffuse->texnum);
+	if (r_materials->value) {
+		uint16_t num_meshes = 1;
 
-				R_UseMaterial(r_mesh_state.material);
+		if (e->model->type == MOD_MD3) {
+			num_meshes = ((const r_md3_t *) e->model->mesh->data)->num_meshes;
+		}
+
+		for (uint16_t i = 0; i < num_meshes; i++) {
+			const r_material_t *material = e->skins[i] ?: e->model->mesh->material;
+
+			if (material->flags & STAGE_DIFFUSE)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @return The index of the specified light within `lights`, or -1.
+ */
+static int32_t R_MeshInstanceLight_default(const r_light_t *lights, uint16_t count, const r_light_t *light) {
+
+	for (uint16_t i = 0; i < count; i++) {
+		if (!memcmp(&lights[i], light, sizeof(*light))) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Applies the specified light sources and instances, and draws each mesh
+ * of the model once for all of the instances.
+ */
+static void R_DrawMeshInstances_flush(const r_entity_t *e, const r_mesh_instances_t *instances,
+		const r_light_t *lights, uint16_t num_lights) {
+
+	R_ApplyMeshLights_default(lights, num_lights);
+
+	R_UseMeshInstances_default(instances);
+
+	R_DrawMeshModelMeshes_default(e, instances->count);
+}
+
+/**
+ * @brief Draws the batch of entities with instanced draw calls, up to
+ * MAX_MESH_INSTANCES at a time. The transform, color and interpolation of each
+ * instance are resolved by the vertex shader. Instances share the applied light
+ * sources, each reaching only those instances it illuminates, so a draw call is
+ * also issued before their union would exceed MAX_ACTIVE_LIGHTS.
+ */
+static void R_DrawMeshInstances_default(const r_entity_t **ents, size_t count) {
+
+	const r_entity_t *e = ents[0];
+
+	const _Bool animated = e->model->type == MOD_MD3 && e->model->mesh->num_frames > 1;
+
+	if (animated) { // bind the frames shared by the batch for interpolation
+		const r_md3_t *md3 = (const r_md3_t *) e->model->mesh->data;
+		const size_t num_components = md3->num_verts * 3;
+
+		const size_t frame = R_InterpolateMeshModel_frame(e, e->frame) * num_components;
+		const size_t old_frame = R_InterpolateMeshModel_frame(e, e->old_frame) * num_components;
+
+		R_BindArray(GL_VERTEX_ARRAY, GL_FLOAT, md3->verts + frame);
+		R_BindArray(GL_NORMAL_ARRAY, GL_FLOAT, md3->normals + frame);
+
+		R_UseMeshLerp_default(md3->verts + old_frame, md3->normals + old_frame);
+	}
+
+	r_mesh_instances_t instances;
+	instances.count = 0;
+
+	r_light_t lights[MAX_ACTIVE_LIGHTS];
+	uint16_t num_lights = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		e = ents[i];
+
+		r_view.current_entity = e;
+
+		r_light_t entity_lights[MAX_ACTIVE_LIGHTS];
+		const uint16_t num_entity_lights = R_MeshModelLights_default(e, entity_lights);
+
+		uint16_t num_new_lights = 0;
+		for (uint16_t j = 0; j < num_entity_lights; j++) {
+			if (R_MeshInstanceLight_default(lights, num_lights, &entity_lights[j]) == -1) {
+				num_new_lights++;
+			}
+		}
+
+		if (instances.count == MAX_MESH_INSTANCES || num_lights + num_new_lights > MAX_ACTIVE_LIGHTS) {
+			R_DrawMeshInstances_flush(e, &instances, lights, num_lights);
+
+			instances.count = 0;
+			num_lights = 0;
+		}
+
+		const uint16_t n = instances.count++;
+
+		uint32_t mask = 0;
+
+		for (uint16_t j = 0; j < num_entity_lights; j++) {
+			int32_t k = R_MeshInstanceLight_default(lights, num_lights, &entity_lights[j]);
+
+			if (k == -1) {
+				k = num_lights++;
+				lights[k] = entity_lights[j];
 			}
+
+			mask |= 1 << k;
 		}
 
-		glDrawArrays(GL_TRIANGLES, offset, mesh->num_tris * 3);
+		instances.matrices[n] = e->matrix;
 
-		R_DrawMeshMaterial(r_mesh_state.material, offset, mesh->num_tris * 3);
+		R_MeshColor_default(e, instances.colors[n]);
 
-		offset += mesh->num_tris * 3;
+		if (animated) {
+			Vector4Set(instances.params[n], e->lerp, e->back_lerp, mask, 0.0);
+		} else {
+			Vector4Set(instances.params[n], 1.0, 0.0, mask, 0.0);
+		}
+	}
+
+	if (instances.count) {
+		R_DrawMeshInstances_flush(e, &instances, lights, num_lights);
+	}
+
+	R_UseMeshInstances_default(NULL);
+
+	if (animated) {
+		R_UseMeshLerp_default(NULL, NULL);
 	}
 }
 
 /**
- * @brief Draws the mesh model for the given entity.
+ * @brief Draws a batch of entities sharing model, skins and frames, with
+ * instanced draw calls where possible. Otherwise, each entity is drawn in turn.
  */
-void R_DrawMeshModel_default(const r_entity_t *e) {
+static void R_DrawMeshModelBatch_default(const r_entity_t **ents, size_t count) {
+
+	const r_entity_t *e = ents[0];
 
 	R_SetMeshState_default(e);
 
-	if (e->model->type == MOD_MD3) {
-		R_DrawMeshParts_default(e, (const r_md3_t *) e->model->mesh->data);
+	if (R_MeshModelInstanced_default(ents, count)) {
+		R_DrawMeshInstances_default(ents, count);
 	} else {
-		glDrawArrays(GL_TRIANGLES, 0, e->model->num_verts);
-
-		R_DrawMeshMaterial(r_mesh_state.material, 0, e->model->num_verts);
+		R_DrawMeshEntities_default(ents, count);
 	}
 
-	R_ResetMeshState_default(e); // reset state
+	R_ResetMeshState_default(e);
+
+	r_view.num_mesh_batches++;
 
-	r_view.num_mesh_models++;
-	r_view.num_mesh_tris += e->model->num_verts / 3;
+	r_view.num_mesh_models += count;
+	r_view.num_mesh_tris += count * e->model->num_verts / 3;
 }
 
 /**
@@ -418,15 +835,27 @@ void R_DrawMeshModels_default(const r_entities_t *ents) {
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	}
 
+	// entities are sorted by model, skins and frames, so batches are contiguous
+
+	const r_entity_t *batch[MAX_ENTITIES];
+	size_t count = 0;
+
 	for (size_t i = 0; i < ents->count; i++) {
 		const r_entity_t *e = ents->entities[i];
 
 		if (e->effects & EF_NO_DRAW)
 			continue;
 
-		r_view.current_entity = e;
+		if (count && !R_MeshModelBatchable(batch[0], e)) {
+			R_DrawMeshModelBatch_default(batch, count);
+			count = 0;
+		}
+
+		batch[count++] = e;
+	}
 
-		R_DrawMeshModel_default(e);
+	if (count) {
+		R_DrawMeshModelBatch_default(batch, count);
 	}
 
 	r_view.current_entity = NULL;
@@ -26,12 +26,42 @@
 
 #ifdef __R_LOCAL_H__
 
+/**
+ * @brief The interpolated vertexes and normals of an animated mesh entity.
+ */
+typedef struct {
+	GLfloat *verts;
+	GLfloat *normals;
+} r_mesh_interpolation_t;
+
+/**
+ * @brief The maximum number of entities drawn by a single instanced draw call.
+ * This must match MAX_INSTANCES in the default vertex shader.
+ */
+#define MAX_MESH_INSTANCES 8
+
+/**
+ * @brief The per-instance state of an instanced mesh draw call, laid out as the
+ * uniform arrays of the default program.
+ */
+typedef struct {
+	matrix4x4_t matrices[MAX_MESH_INSTANCES];
+	vec4_t colors[MAX_MESH_INSTANCES];
+	vec4_t params[MAX_MESH_INSTANCES]; // frame and old frame fractions, and mask of applied lights
+	uint16_t count;
+} r_mesh_instances_t;
+
 typedef struct {
 	r_material_t *material;
 
 	vec3_t vertexes[MD3_MAX_TRIANGLES * 3];
 	vec3_t normals[MD3_MAX_TRIANGLES * 3];
 	vec4_t tangents[MD3_MAX_TRIANGLES * 3];
+
+	GLfloat *interpolated; // the vertexes and normals of all animated entities
+	size_t interpolated_size; // in components
+
+	r_mesh_interpolation_t interpolations[MAX_ENTITIES]; // by view entity index
 } r_mesh_state_t;
 
 extern r_mesh_state_t r_mesh_state;
@@ -39,7 +69,10 @@ extern r_mesh_state_t r_mesh_state;
 void R_ApplyMeshModelTag(r_entity_t *e);
 void R_ApplyMeshModelConfig(r_entity_t *e);
 _Bool R_CullMeshModel(const r_entity_t *e);
-void R_InterpolateMeshModel(const r_entity_t *e);
+void R_InterpolateMeshModels(const r_entities_t *ents);
+void R_BindInterpolatedMeshModel(const r_entity_t *e);
+void R_ResetInterpolatedMeshModel(void);
+void R_DrawMeshModelArrays(const r_entity_t *e, GLuint offset, GLuint count);
 void R_UpdateMeshModelLighting(const r_entity_t *e);
 void R_DrawMeshModels_default(const r_entities_t *ents);
 #endif /* __R_LOCAL_H__ */
@@ -0,0 +1,119 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include <SDL2/SDL_cpuinfo.h>
+
+#include "r_local.h"
+
+/*
+ * Animated mesh models store each frame as a flat array of components, so that
+ * interpolating between two frames is a single weighted sum over two arrays.
+ * As much of the array as possible is processed with the widest kernel the
+ * host supports, and the remainder is finished in scalar code.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+ #define R_MESH_LERP_SSE __attribute__((target("sse")))
+ #define R_MESH_LERP_AVX __attribute__((target("avx")))
+#endif
+
+#if defined(R_MESH_LERP_AVX)
+
+/**
+ * @return True if the host supports AVX, resolved on first use.
+ */
+static _Bool R_MeshLerpHasAVX(void) {
+	static int32_t has_avx = -1;
+
+	if (has_avx == -1) {
+		has_avx = SDL_HasAVX() ? 1 : 0;
+	}
+
+	return has_avx == 1;
+}
+
+/**
+ * @brief Interpolates 8 components at a time.
+ */
+R_MESH_LERP_AVX static size_t R_LerpMeshVertexes_AVX(GLfloat *out, const GLfloat *from, const GLfloat *to,
+		vec_t from_frac, vec_t to_frac, size_t count) {
+	size_t i;
+
+	const __m256 f = _mm256_set1_ps(from_frac);
+	const __m256 t = _mm256_set1_ps(to_frac);
+
+	for (i = 0; i + 8 <= count; i += 8) {
+		const __m256 a = _mm256_mul_ps(_mm256_loadu_ps(from + i), f);
+		const __m256 b = _mm256_mul_ps(_mm256_loadu_ps(to + i), t);
+		_mm256_storeu_ps(out + i, _mm256_add_ps(a, b));
+	}
+
+	return i;
+}
+
+#endif
+
+#if defined(R_MESH_LERP_SSE)
+
+/**
+ * @brief Interpolates 4 components at a time.
+ */
+R_MESH_LERP_SSE static size_t R_LerpMeshVertexes_SSE(GLfloat *out, const GLfloat *from, const GLfloat *to,
+		vec_t from_frac, vec_t to_frac, size_t count) {
+	size_t i;
+
+	const __m128 f = _mm_set1_ps(from_frac);
+	const __m128 t = _mm_set1_ps(to_frac);
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		const __m128 a = _mm_mul_ps(_mm_loadu_ps(from + i), f);
+		const __m128 b = _mm_mul_ps(_mm_loadu_ps(to + i), t);
+		_mm_storeu_ps(out + i, _mm_add_ps(a, b));
+	}
+
+	return i;
+}
+
+#endif
+
+/**
+ * @brief Writes `from * from_frac + to * to_frac` for `count` components. For
+ * vertex positions, the fractions are the entity's back_lerp and lerp.
+ */
+void R_LerpMeshVertexes(GLfloat *out, const GLfloat *from, const GLfloat *to, vec_t from_frac,
+		vec_t to_frac, size_t count) {
+	size_t i = 0;
+
+#if defined(R_MESH_LERP_AVX)
+	if (R_MeshLerpHasAVX()) {
+		i = R_LerpMeshVertexes_AVX(out, from, to, from_frac, to_frac, count);
+	}
+#endif
+
+#if defined(R_MESH_LERP_SSE)
+	i += R_LerpMeshVertexes_SSE(out + i, from + i, to + i, from_frac, to_frac, count - i);
+#endif
+
+	for (; i < count; i++) {
+		out[i] = from[i] * from_frac + to[i] * to_frac;
+	}
+}
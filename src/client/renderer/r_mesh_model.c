@@ -278,12 +278,76 @@ static void R_LoadMd3Tangents(r_md3_mesh_t *mesh) {
 	Mem_Free(tan2);
 }
 
+/**
+ * @brief Loads the interleaved frames and element array for animated models. Each
+ * frame is laid out as a flat array of components, with the frame translation
+ * applied, so that frames may be interpolated as a whole. The elements are drawn
+ * in place of the expanded triangles of static models, so that the vertexes of
+ * each frame need only be interpolated once.
+ */
+static void R_LoadMd3AnimatedVertexArrays(r_model_t *mod) {
+
+	r_md3_t *md3 = (r_md3_t *) mod->mesh->data;
+	const r_md3_mesh_t *mesh = md3->meshes;
+
+	md3->num_verts = 0;
+	md3->num_elements = 0;
+
+	for (uint16_t i = 0; i < md3->num_meshes; i++, mesh++) {
+		md3->num_verts += mesh->num_verts;
+		md3->num_elements += mesh->num_tris * 3;
+	}
+
+	const size_t size = md3->num_frames * md3->num_verts * sizeof(vec3_t);
+
+	md3->verts = Mem_LinkMalloc(size, mod);
+	md3->normals = Mem_LinkMalloc(size, mod);
+	md3->elements = Mem_LinkMalloc(md3->num_elements * sizeof(GLuint), mod);
+
+	mod->texcoords = Mem_LinkMalloc(md3->num_verts * sizeof(vec2_t), mod);
+
+	GLuint *eout = md3->elements;
+	vec_t *sout = mod->texcoords;
+
+	uint32_t first_vert = 0;
+
+	mesh = md3->meshes;
+	for (uint16_t i = 0; i < md3->num_meshes; i++, mesh++) {
+
+		const d_md3_frame_t *frame = md3->frames;
+		for (uint16_t j = 0; j < md3->num_frames; j++, frame++) {
+
+			const r_md3_vertex_t *v = mesh->verts + j * mesh->num_verts;
+
+			vec_t *vout = md3->verts + (j * md3->num_verts + first_vert) * 3;
+			vec_t *nout = md3->normals + (j * md3->num_verts + first_vert) * 3;
+
+			for (uint16_t k = 0; k < mesh->num_verts; k++, v++, vout += 3, nout += 3) {
+				VectorAdd(frame->translate, v->point, vout);
+				VectorCopy(v->normal, nout);
+			}
+		}
+
+		const d_md3_texcoord_t *texcoords = mesh->coords;
+		for (uint16_t j = 0; j < mesh->num_verts; j++, sout += 2) {
+			Vector2Copy(texcoords[j].st, sout);
+		}
+
+		const uint32_t *tri = mesh->tris;
+		for (uint32_t j = 0; j < mesh->num_tris * 3u; j++) {
+			*eout++ = first_vert + tri[j];
+		}
+
+		first_vert += mesh->num_verts;
+	}
+}
+
 /**
  * @brief Loads and populates vertex array data for the specified MD3 model.
  *
  * @remarks Static MD3 meshes receive vertex, normal and tangent arrays in
- * addition to texture coordinate arrays. Animated models receive only texture
- * coordinates, because they must be interpolated at each frame.
+ * addition to texture coordinate arrays. Animated models receive indexed frame
+ * arrays instead, because they must be interpolated at each frame.
  */
 static void R_LoadMd3VertexArrays(r_model_t *mod) {
 
@@ -296,12 +360,15 @@ static void R_LoadMd3VertexArrays(r_model_t *mod) {
 		mod->num_verts += mesh->num_tris * 3;
 	}
 
-	if (mod->mesh->num_frames == 1) {
-		mod->verts = Mem_LinkMalloc(mod->num_verts * sizeof(vec3_t), mod);
-		mod->normals = Mem_LinkMalloc(mod->num_verts * sizeof(vec3_t), mod);
-		mod->tangents = Mem_LinkMalloc(mod->num_verts * sizeof(vec4_t), mod);
+	if (mod->mesh->num_frames > 1) {
+		R_LoadMd3AnimatedVertexArrays(mod);
+		return;
 	}
 
+	mod->verts = Mem_LinkMalloc(mod->num_verts * sizeof(vec3_t), mod);
+	mod->normals = Mem_LinkMalloc(mod->num_verts * sizeof(vec3_t), mod);
+	mod->tangents = Mem_LinkMalloc(mod->num_verts * sizeof(vec4_t), mod);
+
 	mod->texcoords = Mem_LinkMalloc(mod->num_verts * sizeof(vec2_t), mod);
 
 	vec_t *vout = mod->verts;
@@ -316,12 +383,10 @@ static void R_LoadMd3VertexArrays(r_model_t *mod) {
 
 		const r_md3_vertex_t *v = mesh->verts;
 
-		if (mod->mesh->num_frames == 1) { // for static models, build the verts and normals
-			for (uint16_t j = 0; j < mesh->num_verts; j++, v++) {
-				VectorAdd(frame->translate, v->point, r_mesh_state.vertexes[j]);
-				VectorCopy(v->normal, r_mesh_state.normals[j]);
-				Vector4Copy(v->tangent, r_mesh_state.tangents[j]);
-			}
+		for (uint16_t j = 0; j < mesh->num_verts; j++, v++) { // build the verts and normals
+			VectorAdd(frame->translate, v->point, r_mesh_state.vertexes[j]);
+			VectorCopy(v->normal, r_mesh_state.normals[j]);
+			Vector4Copy(v->tangent, r_mesh_state.tangents[j]);
 		}
 
 		uint32_t *tri = mesh->tris;
@@ -329,22 +394,20 @@ static void R_LoadMd3VertexArrays(r_model_t *mod) {
 
 		for (uint16_t j = 0; j < mesh->num_tris; j++, tri += 3) { // populate the arrays
 
-			if (mod->mesh->num_frames == 1) {
-				VectorCopy(r_mesh_state.vertexes[tri[0]], vout + 0);
-				VectorCopy(r_mesh_state.vertexes[tri[1]], vout + 3);
-				VectorCopy(r_mesh_state.vertexes[tri[2]], vout + 6);
-				vout += 9;
-
-				VectorCopy(r_mesh_state.normals[tri[0]], nout + 0);
-				VectorCopy(r_mesh_state.normals[tri[1]], nout + 3);
-				VectorCopy(r_mesh_state.normals[tri[2]], nout + 6);
-				nout += 9;
-
-				Vector4Copy(r_mesh_state.tangents[tri[0]], tout + 0);
-				Vector4Copy(r_mesh_state.tangents[tri[1]], tout + 4);
-				Vector4Copy(r_mesh_state.tangents[tri[2]], tout + 8);
-				tout += 12;
-			}
+			VectorCopy(r_mesh_state.vertexes[tri[0]], vout + 0);
+			VectorCopy(r_mesh_state.vertexes[tri[1]], vout + 3);
+			VectorCopy(r_mesh_state.vertexes[tri[2]], vout + 6);
+			vout += 9;
+
+			VectorCopy(r_mesh_state.normals[tri[0]], nout + 0);
+			VectorCopy(r_mesh_state.normals[tri[1]], nout + 3);
+			VectorCopy(r_mesh_state.normals[tri[2]], nout + 6);
+			nout += 9;
+
+			Vector4Copy(r_mesh_state.tangents[tri[0]], tout + 0);
+			Vector4Copy(r_mesh_state.tangents[tri[1]], tout + 4);
+			Vector4Copy(r_mesh_state.tangents[tri[2]], tout + 8);
+			tout += 12;
 
 			Vector2Copy(texcoords[tri[0]].st, sout + 0);
 			Vector2Copy(texcoords[tri[1]].st, sout + 2);
@@ -110,7 +110,7 @@ static void R_DrawMeshShadow_default_(const r_entity_t *e, const r_shadow_t *s)
 
 	R_SetMeshShadowState_default(e, s);
 
-	glDrawArrays(GL_TRIANGLES, 0, e->model->num_verts);
+	R_DrawMeshModelArrays(e, 0, e->model->num_verts);
 
 	R_ResetMeshShadowState_default(e, s);
 }
@@ -125,7 +125,7 @@ void R_DrawMeshShadow_default(const r_entity_t *e) {
 	} else {
 		R_ResetArrayState();
 
-		R_InterpolateMeshModel(e);
+		R_BindInterpolatedMeshModel(e);
 	}
 
 	r_shadow_t *s = e->lighting->shadows;
@@ -152,6 +152,10 @@ void R_DrawMeshShadow_default(const r_entity_t *e) {
 	}
 
 	r_view.current_shadow = NULL;
+
+	if (e->model->mesh->num_frames > 1) {
+		R_ResetInterpolatedMeshModel();
+	}
 }
 
 /**
@@ -44,7 +44,7 @@ static void R_SetMeshShellState_default(const r_entity_t *e) {
 
 		R_BindArray(GL_TEXTURE_COORD_ARRAY, GL_FLOAT, e->model->texcoords);
 
-		R_InterpolateMeshModel(e);
+		R_BindInterpolatedMeshModel(e);
 	}
 
 	R_SetMeshShellColor_default(e);
@@ -68,6 +68,10 @@ static void R_ResetMeshShellState_default(const r_entity_t *e) {
 		glDepthRange(0.0, 1.0);
 
 	R_RotateForEntity(NULL);
+
+	if (e->model->mesh->num_frames > 1) {
+		R_ResetInterpolatedMeshModel();
+	}
 }
 
 /**
@@ -77,7 +81,7 @@ void R_DrawMeshShell_default(const r_entity_t *e) {
 
 	R_SetMeshShellState_default(e);
 
-	glDrawArrays(GL_TRIANGLES, 0, e->model->num_verts);
+	R_DrawMeshModelArrays(e, 0, e->model->num_verts);
 
 	R_ResetMeshShellState_default(e);
 }
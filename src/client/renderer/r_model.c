@@ -75,6 +75,15 @@ static void R_LoadVertexBuffers(r_model_t *mod) {
 
 	qglBindBuffer(GL_ARRAY_BUFFER, 0);
 
+	if (mod->elements) {
+		qglGenBuffers(1, &mod->element_buffer);
+		qglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mod->element_buffer);
+		qglBufferData(GL_ELEMENT_ARRAY_BUFFER, mod->num_elements * sizeof(GLuint), mod->elements,
+				GL_STATIC_DRAW);
+
+		qglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
 	R_GetError(mod->media.name);
 }
 
@@ -129,6 +138,9 @@ static void R_FreeModel(r_media_t *self) {
 	if (mod->tangent_buffer)
 		qglDeleteBuffers(1, &mod->tangent_buffer);
 
+	if (mod->element_buffer)
+		qglDeleteBuffers(1, &mod->element_buffer);
+
 	R_GetError(mod->media.name);
 }
 
@@ -217,4 +229,8 @@ r_model_t *R_WorldModel(void) {
  */
 void R_InitModels(void) {
 	memset(&r_model_state, 0, sizeof(r_model_state));
+
+	// the mesh interpolation pool is freed with the renderer, and grows on demand
+	r_mesh_state.interpolated = NULL;
+	r_mesh_state.interpolated_size = 0;
 }
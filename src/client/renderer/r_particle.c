@@ -22,25 +22,54 @@
 #include "r_local.h"
 
 /**
- * @brief Copies the specified particle into the view structure, provided it
- * passes a basic visibility test.
+ * @brief Copies the specified particles into the view structure, and adds an
+ * element for each. The elements reference the copies, so the caller's
+ * particles need not outlive this call.
  */
-void R_AddParticle(const r_particle_t *p) {
-	static r_element_t e;
+void R_AddParticles(const r_particle_t *p, const size_t count) {
 
-	if (r_view.num_particles == lengthof(r_view.particles))
+	const size_t n = MIN(count, lengthof(r_view.particles) - r_view.num_particles);
+	if (n == 0) {
 		return;
+	}
+
+	r_particle_t *part = &r_view.particles[r_view.num_particles];
+	memcpy(part, p, n * sizeof(r_particle_t));
+
+	r_view.num_particles += n;
 
-	r_view.particles[r_view.num_particles++] = *p;
+	r_element_t e = { .type = ELEMENT_PARTICLE };
 
-	e.type = ELEMENT_PARTICLE;
+	for (size_t i = 0; i < n; i++, part++) {
 
-	e.element = (const void *) p;
-	e.origin = (const vec_t *) p->org;
+		e.element = (const void *) part;
+		e.origin = (const vec_t *) part->org;
 
-	R_AddElement(&e);
+		R_AddElement(&e);
+	}
+}
+
+/**
+ * @brief Copies the specified particle into the view structure. The element
+ * references the copy, so the caller's particle need not outlive this call.
+ */
+void R_AddParticle(const r_particle_t *p) {
+	R_AddParticles(p, 1);
 }
 
+#define R_PARTICLE_VERTS_SIZE (sizeof(GLfloat) * 3 * 4)
+#define R_PARTICLE_TEXCOORDS_SIZE (sizeof(GLfloat) * 2 * 4)
+#define R_PARTICLE_COLORS_SIZE (sizeof(GLubyte) * 4 * 4)
+
+#define R_PARTICLE_SIZE (R_PARTICLE_VERTS_SIZE + R_PARTICLE_TEXCOORDS_SIZE + R_PARTICLE_COLORS_SIZE)
+
+/**
+ * @brief The particle vertex buffer holds this many frames of particles, so
+ * that the frames in flight are not overwritten.
+ */
+#define R_PARTICLE_BUFFER_FRAMES 3
+#define R_PARTICLE_BUFFER_SIZE (R_PARTICLE_BUFFER_FRAMES * MAX_PARTICLES * R_PARTICLE_SIZE)
+
 /**
  * @brief Pools commonly used angular vectors for particle calculations and
  * accumulates particle primitives each frame.
@@ -54,6 +83,17 @@ typedef struct {
 	GLfloat verts[MAX_PARTICLES * 3 * 4];
 	GLfloat texcoords[MAX_PARTICLES * 2 * 4];
 	GLubyte colors[MAX_PARTICLES * 4 * 4];
+
+	uint32_t num_particles; // generated this frame
+
+	GLuint buffer; // the ring buffer the primitives are streamed to
+	GLintptr buffer_head; // the next free byte of the ring
+
+	_Bool uploaded; // true once this frame's primitives are streamed
+
+	GLintptr verts_offset; // the offsets of this frame's primitives in the ring
+	GLintptr texcoords_offset;
+	GLintptr colors_offset;
 } r_particle_state_t;
 
 static r_particle_state_t r_particle_state;
@@ -219,6 +259,75 @@ void R_UpdateParticles(r_element_t *e, const size_t count) {
 			e->data = (void *) (uintptr_t) j++;
 		}
 	}
+
+	r_particle_state.num_particles = (uint32_t) j;
+	r_particle_state.uploaded = false;
+}
+
+/**
+ * @return True if particles should be streamed through the vertex buffer.
+ */
+static _Bool R_UseParticleBuffer(void) {
+	return r_particle_state.buffer && r_vertex_buffers->value;
+}
+
+/**
+ * @brief Streams this frame's particle primitives to the next segment of the
+ * ring buffer. When the ring is exhausted, its storage is orphaned, so that the
+ * driver may continue to source the frames in flight from the previous storage
+ * while the ring starts over.
+ */
+static void R_UploadParticles(void) {
+
+	const GLsizeiptr num_particles = r_particle_state.num_particles;
+	const GLsizeiptr size = num_particles * R_PARTICLE_SIZE;
+
+	qglBindBuffer(GL_ARRAY_BUFFER, r_particle_state.buffer);
+
+	if (r_particle_state.buffer_head + size > R_PARTICLE_BUFFER_SIZE) {
+		qglBufferData(GL_ARRAY_BUFFER, R_PARTICLE_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+		r_particle_state.buffer_head = 0;
+	}
+
+	r_particle_state.verts_offset = r_particle_state.buffer_head;
+	r_particle_state.texcoords_offset = r_particle_state.verts_offset + num_particles * R_PARTICLE_VERTS_SIZE;
+	r_particle_state.colors_offset = r_particle_state.texcoords_offset + num_particles * R_PARTICLE_TEXCOORDS_SIZE;
+
+	qglBufferSubData(GL_ARRAY_BUFFER, r_particle_state.verts_offset,
+			num_particles * R_PARTICLE_VERTS_SIZE, r_particle_state.verts);
+	qglBufferSubData(GL_ARRAY_BUFFER, r_particle_state.texcoords_offset,
+			num_particles * R_PARTICLE_TEXCOORDS_SIZE, r_particle_state.texcoords);
+	qglBufferSubData(GL_ARRAY_BUFFER, r_particle_state.colors_offset,
+			num_particles * R_PARTICLE_COLORS_SIZE, r_particle_state.colors);
+
+	r_particle_state.buffer_head += size;
+	r_particle_state.uploaded = true;
+
+	R_GetError(NULL);
+}
+
+/**
+ * @brief Binds the particle arrays, streaming them to the ring buffer on the
+ * first draw of each frame if vertex buffers are enabled.
+ */
+static void R_BindParticleArrays(void) {
+
+	if (R_UseParticleBuffer()) {
+
+		if (!r_particle_state.uploaded) {
+			R_UploadParticles();
+		} else {
+			qglBindBuffer(GL_ARRAY_BUFFER, r_particle_state.buffer);
+		}
+
+		R_BindArray(GL_VERTEX_ARRAY, GL_FLOAT, (GLvoid *) r_particle_state.verts_offset);
+		R_BindArray(GL_TEXTURE_COORD_ARRAY, GL_FLOAT, (GLvoid *) r_particle_state.texcoords_offset);
+		R_BindArray(GL_COLOR_ARRAY, GL_UNSIGNED_BYTE, (GLvoid *) r_particle_state.colors_offset);
+	} else {
+		R_BindArray(GL_VERTEX_ARRAY, GL_FLOAT, r_particle_state.verts);
+		R_BindArray(GL_TEXTURE_COORD_ARRAY, GL_FLOAT, r_particle_state.texcoords);
+		R_BindArray(GL_COLOR_ARRAY, GL_UNSIGNED_BYTE, r_particle_state.colors);
+	}
 }
 
 /**
@@ -232,9 +341,7 @@ void R_DrawParticles(const r_element_t *e, const size_t count) {
 	R_ResetArrayState();
 
 	// alter the array pointers
-	R_BindArray(GL_VERTEX_ARRAY, GL_FLOAT, r_particle_state.verts);
-	R_BindArray(GL_TEXTURE_COORD_ARRAY, GL_FLOAT, r_particle_state.texcoords);
-	R_BindArray(GL_COLOR_ARRAY, GL_UNSIGNED_BYTE, r_particle_state.colors);
+	R_BindParticleArrays();
 
 	const GLuint base = (uintptr_t) e->data;
 
@@ -268,6 +375,10 @@ void R_DrawParticles(const r_element_t *e, const size_t count) {
 	glDepthRange(0.0, 1.0);
 
 	// restore array pointers
+	if (R_UseParticleBuffer()) {
+		qglBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
 	R_BindDefaultArray(GL_VERTEX_ARRAY);
 	R_BindDefaultArray(GL_TEXTURE_COORD_ARRAY);
 	R_BindDefaultArray(GL_COLOR_ARRAY);
@@ -279,3 +390,34 @@ void R_DrawParticles(const r_element_t *e, const size_t count) {
 	R_Color(NULL);
 }
 
+/**
+ * @brief Allocates the ring buffer particles are streamed through.
+ */
+void R_InitParticles(void) {
+
+	memset(&r_particle_state, 0, sizeof(r_particle_state));
+
+	if (!qglGenBuffers || !qglBufferSubData) {
+		return;
+	}
+
+	qglGenBuffers(1, &r_particle_state.buffer);
+
+	qglBindBuffer(GL_ARRAY_BUFFER, r_particle_state.buffer);
+	qglBufferData(GL_ARRAY_BUFFER, R_PARTICLE_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+	qglBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	R_GetError("Particle buffer");
+}
+
+/**
+ * @brief Frees the particle ring buffer.
+ */
+void R_ShutdownParticles(void) {
+
+	if (r_particle_state.buffer) {
+		qglDeleteBuffers(1, &r_particle_state.buffer);
+	}
+
+	r_particle_state.buffer = 0;
+}
@@ -25,10 +25,13 @@
 #include "r_types.h"
 
 void R_AddParticle(const r_particle_t *p);
+void R_AddParticles(const r_particle_t *p, const size_t count);
 
 #ifdef __R_LOCAL_H__
 void R_UpdateParticles(r_element_t *e, const size_t count);
 void R_DrawParticles(const r_element_t *e, const size_t count);
+void R_InitParticles(void);
+void R_ShutdownParticles(void);
 #endif /* __R_LOCAL_H__ */
 
 #endif /* __R_PARTICLE_H__ */
@@ -171,6 +171,35 @@ void R_ProgramParameterMatrix4fv(r_uniform_matrix4fv_t *variable, const GLfloat
 	R_GetError(variable->name);
 }
 
+/**
+ * @brief Uploads `count` elements of a uniform vec4 array. Arrays are not cached.
+ */
+void R_ProgramParameter4fvArray(r_uniform4fv_t *variable, GLsizei count, const GLfloat *value) {
+
+	if (!variable || variable->location == -1) {
+		Com_Warn("NULL or invalid variable\n");
+		return;
+	}
+
+	qglUniform4fv(variable->location, count, (GLfloat *) value);
+
+	R_GetError(variable->name);
+}
+
+/**
+ * @brief Uploads `count` elements of a uniform mat4 array. Arrays are not cached.
+ */
+void R_ProgramParameterMatrix4fvArray(r_uniform_matrix4fv_t *variable, GLsizei count, const GLfloat *value) {
+
+	if (!variable || variable->location == -1) {
+		Com_Warn("NULL or invalid variable\n");
+		return;
+	}
+
+	qglUniformMatrix4fv(variable->location, count, false, value);
+
+	R_GetError(variable->name);
+}
 
 /**
  * @brief
@@ -92,6 +92,8 @@ void R_ProgramParameter1f(r_uniform1f_t *variable, const GLfloat value);
 void R_ProgramParameter3fv(r_uniform3fv_t *variable, const GLfloat *value);
 void R_ProgramParameter4fv(r_uniform4fv_t *variable, const GLfloat *value);
 void R_ProgramParameterMatrix4fv(r_uniform_matrix4fv_t *variable, const GLfloat *value);
+void R_ProgramParameter4fvArray(r_uniform4fv_t *variable, GLsizei count, const GLfloat *value);
+void R_ProgramParameterMatrix4fvArray(r_uniform_matrix4fv_t *variable, GLsizei count, const GLfloat *value);
 void R_AttributePointer(const char *name, GLuint size, const GLvoid *array);
 void R_EnableAttribute(r_attribute_t *attribute);
 void R_DisableAttribute(r_attribute_t *attribute);
@@ -24,6 +24,8 @@
 // these are the variables defined in the GLSL shader
 typedef struct {
 	r_attribute_t tangent;
+	r_attribute_t old_vertex;
+	r_attribute_t old_normal;
 
 	r_uniform1i_t diffuse;
 	r_uniform1i_t lightmap;
@@ -35,6 +37,12 @@ typedef struct {
 	r_uniform1f_t hardness;
 	r_uniform1f_t specular;
 
+	r_uniform1i_t instanced;
+
+	r_uniform_matrix4fv_t instance_matrix;
+	r_uniform4fv_t instance_color;
+	r_uniform4fv_t instance_params;
+
 	r_sampler2d_t sampler0;
 	r_sampler2d_t sampler1;
 	r_sampler2d_t sampler2;
@@ -52,6 +60,8 @@ void R_InitProgram_default(void) {
 	r_default_program_t *p = &r_default_program;
 
 	R_ProgramVariable(&p->tangent, R_ATTRIBUTE, "TANGENT");
+	R_ProgramVariable(&p->old_vertex, R_ATTRIBUTE, "OLD_VERTEX");
+	R_ProgramVariable(&p->old_normal, R_ATTRIBUTE, "OLD_NORMAL");
 
 	R_ProgramVariable(&p->diffuse, R_UNIFORM_INT, "DIFFUSE");
 	R_ProgramVariable(&p->lightmap, R_UNIFORM_INT, "LIGHTMAP");
@@ -63,6 +73,12 @@ void R_InitProgram_default(void) {
 	R_ProgramVariable(&p->hardness, R_UNIFORM_FLOAT, "HARDNESS");
 	R_ProgramVariable(&p->specular, R_UNIFORM_FLOAT, "SPECULAR");
 
+	R_ProgramVariable(&p->instanced, R_UNIFORM_INT, "INSTANCED");
+
+	R_ProgramVariable(&p->instance_matrix, R_UNIFORM_MAT4, "INSTANCE_MATRIX");
+	R_ProgramVariable(&p->instance_color, R_UNIFORM_VEC4, "INSTANCE_COLOR");
+	R_ProgramVariable(&p->instance_params, R_UNIFORM_VEC4, "INSTANCE_PARAMS");
+
 	R_ProgramVariable(&p->sampler0, R_SAMPLER_2D, "SAMPLER0");
 	R_ProgramVariable(&p->sampler1, R_SAMPLER_2D, "SAMPLER1");
 	R_ProgramVariable(&p->sampler2, R_SAMPLER_2D, "SAMPLER2");
@@ -70,6 +86,8 @@ void R_InitProgram_default(void) {
 	R_ProgramVariable(&p->sampler4, R_SAMPLER_2D, "SAMPLER4");
 
 	R_DisableAttribute(&p->tangent);
+	R_DisableAttribute(&p->old_vertex);
+	R_DisableAttribute(&p->old_normal);
 
 	R_ProgramParameter1i(&p->lightmap, 0);
 	R_ProgramParameter1i(&p->normalmap, 0);
@@ -80,6 +98,8 @@ void R_InitProgram_default(void) {
 	R_ProgramParameter1f(&p->hardness, 1.0);
 	R_ProgramParameter1f(&p->specular, 1.0);
 
+	R_ProgramParameter1i(&p->instanced, 0);
+
 	R_ProgramParameter1i(&p->sampler0, 0);
 	R_ProgramParameter1i(&p->sampler1, 1);
 	R_ProgramParameter1i(&p->sampler2, 2);
@@ -129,3 +149,48 @@ void R_UseMaterial_default(const r_material_t *material) {
 	R_ProgramParameter1f(&p->hardness, material->hardness * r_hardness->value);
 	R_ProgramParameter1f(&p->specular, material->specular * r_specular->value);
 }
+
+/**
+ * @brief Uploads the state of the specified mesh instances, so that subsequent
+ * instanced draw calls transform, interpolate and light each instance in turn.
+ * Pass NULL to resume drawing with the fixed-function transform and color.
+ */
+void R_UseMeshInstances_default(const r_mesh_instances_t *instances) {
+
+	r_default_program_t *p = &r_default_program;
+
+	if (!instances) {
+		R_ProgramParameter1i(&p->instanced, 0);
+		return;
+	}
+
+	const GLsizei count = instances->count;
+
+	R_ProgramParameterMatrix4fvArray(&p->instance_matrix, count, (const GLfloat *) instances->matrices);
+	R_ProgramParameter4fvArray(&p->instance_color, count, (const GLfloat *) instances->colors);
+	R_ProgramParameter4fvArray(&p->instance_params, count, (const GLfloat *) instances->params);
+
+	R_ProgramParameter1i(&p->instanced, 1);
+}
+
+/**
+ * @brief Binds the old frame vertexes and normals of the instanced animated mesh,
+ * which the vertex shader interpolates towards the bound vertex and normal arrays.
+ * Pass NULL to unbind them.
+ */
+void R_UseMeshLerp_default(const GLfloat *verts, const GLfloat *normals) {
+
+	r_default_program_t *p = &r_default_program;
+
+	if (!verts) {
+		R_DisableAttribute(&p->old_vertex);
+		R_DisableAttribute(&p->old_normal);
+		return;
+	}
+
+	R_AttributePointer("OLD_VERTEX", 3, verts);
+	R_EnableAttribute(&p->old_vertex);
+
+	R_AttributePointer("OLD_NORMAL", 3, normals);
+	R_EnableAttribute(&p->old_normal);
+}
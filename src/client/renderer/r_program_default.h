@@ -28,6 +28,8 @@
 void R_InitProgram_default(void);
 void R_UseProgram_default(void);
 void R_UseMaterial_default(const r_material_t *material);
+void R_UseMeshInstances_default(const r_mesh_instances_t *instances);
+void R_UseMeshLerp_default(const GLfloat *verts, const GLfloat *normals);
 #endif /* __R_LOCAL_H__ */
 
 #endif /* __R_PROGRAM_DEFAULT_H__ */
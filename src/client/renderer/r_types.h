@@ -335,10 +335,49 @@ typedef struct {
 } r_bsp_leaf_t;
 
 /**
- * @brief
+ * @brief A range of the world element buffer, sharing all of the state needed
+ * to draw it, including a plane and side for back-face culling. Each opaque
+ * surface belongs to exactly one of these, which is owned by the first cluster
+ * containing the surface, and is referenced by every cluster containing it.
+ */
+typedef struct {
+	r_material_t *material;
+	r_image_t *lightmap;
+	r_image_t *deluxemap;
+	GLint stencil; // the shadow stencil reference of the surfaces' plane
+
+	cm_bsp_plane_t *plane;
+	uint16_t flags; // R_SURF_PLANE_BACK
+
+	int16_t frame; // renderer frame, so that references shared by clusters are drawn once
+	int16_t cluster; // the owning cluster
+
+	GLuint index; // first element
+	GLuint count; // element count
+
+	uint16_t num_surfaces;
+} r_material_ref_t;
+
+/**
+ * @brief PVS clusters mark their surfaces, and draw their opaque surfaces by
+ * material, in place of the BSP node recursion.
  */
 typedef struct {
 	int16_t vis_frame; // PVS eligibility
+	int16_t frame; // renderer frame, if in a connected area and the view frustum
+
+	vec3_t mins; // the bounds of the cluster's leafs
+	vec3_t maxs;
+	int16_t area; // or -1 if the cluster spans areas
+
+	int16_t light_frame; // renderer frame of light_mask
+	uint64_t light_mask; // bit mask of dynamic light sources reaching the bounds
+
+	r_bsp_surface_t **surfaces; // every surface of the cluster's leafs
+	uint32_t num_surfaces;
+
+	r_material_ref_t **materials; // in element order
+	uint32_t num_materials;
 } r_bsp_cluster_t;
 
 /**
@@ -350,6 +389,18 @@ typedef struct {
 	byte *data;
 } r_bsp_lightmaps_t;
 
+/**
+ * @brief The BSP light grid, for lighting mesh entities without tracing. See
+ * d_bsp_light_grid_t.
+ */
+typedef struct {
+	vec3_t mins;
+	vec3_t size;
+	int32_t bricks[3];
+	int32_t *table; // populated brick indexes, or -1 for bricks in solid
+	d_bsp_light_grid_cell_t *cells; // the populated bricks
+} r_bsp_light_grid_t;
+
 /**
  * @brief BSP light sources.
  */
@@ -426,6 +477,14 @@ typedef struct {
 
 	uint16_t num_animations;
 	r_md3_animation_t *animations;
+
+	// animated models only, indexed by the elements and interpolated by frame
+	uint32_t num_verts; // of all meshes, per frame
+	GLfloat *verts; // num_frames * num_verts, translated
+	GLfloat *normals; // num_frames * num_verts
+
+	uint32_t num_elements;
+	GLuint *elements; // per mesh, offset by the mesh's first vertex
 } r_md3_t;
 
 typedef struct {
@@ -501,6 +560,8 @@ typedef struct {
 
 	r_bsp_lightmaps_t *lightmaps;
 
+	r_bsp_light_grid_t *light_grid; // NULL if the map has none
+
 	uint16_t num_bsp_lights;
 	r_bsp_light_t *bsp_lights;
 
@@ -552,11 +613,15 @@ typedef struct r_model_s {
 	GLfloat *normals;
 	GLfloat *tangents;
 
+	GLsizei num_elements; // triangle elements, for the world model's clusters
+	GLuint *elements;
+
 	GLuint vertex_buffer; // vertex buffer objects
 	GLuint texcoord_buffer;
 	GLuint lightmap_texcoord_buffer;
 	GLuint normal_buffer;
 	GLuint tangent_buffer;
+	GLuint element_buffer;
 } r_model_t;
 
 #define IS_MESH_MODEL(m) (m && m->mesh)
@@ -589,7 +654,8 @@ typedef enum {
 	ILLUM_AMBIENT = 0x1,
 	ILLUM_SUN     = 0x2,
 	ILLUM_STATIC  = 0x4,
-	ILLUM_DYNAMIC = 0x8
+	ILLUM_DYNAMIC = 0x8,
+	ILLUM_GRID    = 0x10
 } r_illumination_type_t;
 
 /**
@@ -837,7 +903,7 @@ typedef struct {
 
 	r_sustained_light_t sustained_lights[MAX_LIGHTS];
 
-	thread_t *thread; // client thread which populates view
+	task_t *task; // client task which populates view
 
 	const r_entity_t *current_entity; // entity being rendered
 	const r_shadow_t *current_shadow; // shadow being rendered
@@ -853,9 +919,12 @@ typedef struct {
 	uint32_t num_bsp_clusters;
 	uint32_t num_bsp_leafs;
 	uint32_t num_bsp_surfaces;
+	uint32_t num_bsp_batches;
 
 	uint32_t num_mesh_models;
 	uint32_t num_mesh_tris;
+	uint32_t num_mesh_batches;
+	uint32_t num_mesh_draws;
 
 	_Bool update; // inform the client of state changes
 } r_view_t;
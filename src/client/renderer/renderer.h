@@ -34,6 +34,7 @@
 #include "r_corona.h"
 #include "r_draw.h"
 #include "r_element.h"
+#include "r_element_sort.h"
 #include "r_entity.h"
 #include "r_flare.h"
 #include "r_gl.h"
@@ -44,6 +45,7 @@
 #include "r_main.h"
 #include "r_material.h"
 #include "r_media.h"
+#include "r_mesh_lerp.h"
 #include "r_mesh_model.h"
 #include "r_mesh_shadow.h"
 #include "r_mesh_shell.h"
@@ -15,6 +15,7 @@ uniform bool DIFFUSE;
 uniform bool LIGHTMAP;
 uniform bool NORMALMAP;
 uniform bool GLOSSMAP;
+uniform bool INSTANCED;
 
 uniform float BUMP;
 uniform float PARALLAX;
@@ -32,6 +33,8 @@ varying vec3 normal;
 varying vec3 tangent;
 varying vec3 bitangent;
 
+varying float lights;
+
 varying float fog;
 
 const vec3 two = vec3(2.0);
@@ -66,6 +69,19 @@ vec3 BumpFragment(in vec3 deluxemap, in vec3 normalmap, in vec3 glossmap) {
 	return diffuse + specular * glossmap;
 }
 
+/**
+ * @brief Yield 1.0 if the specified light source reaches this fragment, and 0.0
+ * otherwise. Instanced meshes share their light sources, and pass the mask of
+ * those which reach them.
+ */
+float LightReach(in int i) {
+
+	if (INSTANCED)
+		return mod(floor((lights + 0.5) / exp2(float(i))), 2.0);
+
+	return 1.0;
+}
+
 /**
  * @brief Yield the final sample color after factoring in dynamic light sources. 
  */
@@ -91,7 +107,7 @@ void LightFragment(in vec4 diffuse, in vec3 lightmap, in vec3 normalmap) {
 			if (d > 0.0) {
 			
 				dist = 1.0 - dist / gl_LightSource[i].constantAttenuation;
-				light += gl_LightSource[i].diffuse.rgb * d * LIGHT_ATTENUATION;
+				light += gl_LightSource[i].diffuse.rgb * d * LIGHT_ATTENUATION * LightReach(i);
 			}
 		}
 	}
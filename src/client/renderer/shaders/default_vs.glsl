@@ -3,30 +3,68 @@
  */
 
 #version 120
+#extension GL_ARB_draw_instanced : enable
+
+#ifdef GL_ARB_draw_instanced
+#define INSTANCE gl_InstanceIDARB
+#else
+#define INSTANCE 0
+#endif
+
+// must match MAX_MESH_INSTANCES
+#define MAX_INSTANCES 8
 
 uniform bool DIFFUSE;
 uniform bool NORMALMAP;
+uniform bool INSTANCED;
+
+uniform mat4 INSTANCE_MATRIX[MAX_INSTANCES];
+uniform vec4 INSTANCE_COLOR[MAX_INSTANCES];
+uniform vec4 INSTANCE_PARAMS[MAX_INSTANCES];
 
 varying vec3 point;
 varying vec3 normal;
 varying vec3 tangent;
 varying vec3 bitangent;
 
+varying float lights;
+
 varying float fog;
 
 attribute vec4 TANGENT;
+attribute vec3 OLD_VERTEX;
+attribute vec3 OLD_NORMAL;
+
+/**
+ * @brief Interpolate the vertex and normal of the current instance from its old
+ * frame, and transform them and the tangent by its model matrix. The color and
+ * the light sources reaching the instance are resolved as well.
+ */
+void InstanceVertex(inout vec4 vertex, inout vec3 norm, inout vec3 tang) {
+
+	mat4 matrix = INSTANCE_MATRIX[INSTANCE];
+	vec4 params = INSTANCE_PARAMS[INSTANCE];
+
+	vertex = matrix * vec4(OLD_VERTEX * params.y + vertex.xyz * params.x, 1.0);
+	norm = mat3(matrix) * (OLD_NORMAL * params.y + norm * (1.0 - params.y));
+	tang = mat3(matrix) * tang;
+
+	gl_FrontColor = INSTANCE_COLOR[INSTANCE];
+
+	lights = params.z;
+}
 
 /**
  * @brief Transform the point, normal and tangent vectors, passing them through
  * to the fragment shader for per-pixel lighting.
  */
-void LightVertex(void) {
+void LightVertex(in vec4 vertex, in vec3 norm, in vec3 tang) {
 
-	point = vec3(gl_ModelViewMatrix * gl_Vertex);
-	normal = normalize(gl_NormalMatrix * gl_Normal);
+	point = vec3(gl_ModelViewMatrix * vertex);
+	normal = normalize(gl_NormalMatrix * norm);
 
 	if (NORMALMAP) {
-		tangent = normalize(gl_NormalMatrix * TANGENT.xyz);
+		tangent = normalize(gl_NormalMatrix * tang);
 		bitangent = cross(normal, tangent) * TANGENT.w;
 	}
 }
@@ -44,18 +82,29 @@ void FogVertex(void) {
  */
 void main(void) {
 
-	// mvp transform into clip space
-	gl_Position = ftransform();
+	vec4 vertex = gl_Vertex;
+	vec3 norm = gl_Normal;
+	vec3 tang = TANGENT.xyz;
+
+	if (INSTANCED) { // resolve the instance, and mvp transform it into clip space
+		InstanceVertex(vertex, norm, tang);
+
+		gl_Position = gl_ModelViewProjectionMatrix * vertex;
+	} else { // mvp transform into clip space
+		gl_Position = ftransform();
+
+		// pass the color through as well
+		gl_FrontColor = gl_Color;
+
+		lights = 0.0;
+	}
 
 	if (DIFFUSE) { // pass texcoords through
 		gl_TexCoord[0] = gl_MultiTexCoord0;
 		gl_TexCoord[1] = gl_MultiTexCoord1;
 	}
 
-	// pass the color through as well
-	gl_FrontColor = gl_Color;
-
-	LightVertex();
+	LightVertex(vertex, norm, tang);
 
 	FogVertex();
 }
@@ -0,0 +1,513 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include <SDL2/SDL_cpuinfo.h>
+
+#include "cm_local.h"
+
+/*
+ * Bit vectors (PVS and PHS rows, portal vis, etc) are combined and tested in
+ * bulk here. Each operation processes as much of its input as possible with
+ * the widest kernel available on the host, and finishes the remainder with
+ * 64 bit words and finally bytes. The inputs need not be aligned.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+ #define CM_BITSET_SSE2 __attribute__((target("sse2")))
+ #define CM_BITSET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(CM_BITSET_AVX2)
+
+/**
+ * @return True if the host supports AVX2, resolved on first use.
+ */
+static _Bool Cm_BitsetHasAVX2(void) {
+	static int32_t has_avx2 = -1;
+
+	if (has_avx2 == -1) {
+		has_avx2 = SDL_HasAVX2() ? 1 : 0;
+	}
+
+	return has_avx2 == 1;
+}
+
+/**
+ * @brief out = a | b, 32 bytes at a time.
+ */
+CM_BITSET_AVX2 static size_t Cm_BitsetOr_AVX2(byte *out, const byte *a, const byte *b, const size_t len) {
+	size_t i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		const __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+		const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+		_mm256_storeu_si256((__m256i *) (out + i), _mm256_or_si256(va, vb));
+	}
+
+	return i;
+}
+
+/**
+ * @brief out = a & b, 32 bytes at a time.
+ */
+CM_BITSET_AVX2 static size_t Cm_BitsetAnd_AVX2(byte *out, const byte *a, const byte *b, const size_t len) {
+	size_t i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		const __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+		const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+		_mm256_storeu_si256((__m256i *) (out + i), _mm256_and_si256(va, vb));
+	}
+
+	return i;
+}
+
+/**
+ * @brief Counts the set bits of a, 32 bytes at a time, using a nibble lookup.
+ */
+CM_BITSET_AVX2 static size_t Cm_BitsetCount_AVX2(const byte *a, const size_t len, size_t *count) {
+	size_t i;
+
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+	                                        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+	const __m256i zero = _mm256_setzero_si256();
+
+	__m256i sum = zero;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		const __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+
+		const __m256i lo = _mm256_and_si256(va, nibble);
+		const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(va, 4), nibble);
+
+		const __m256i bits = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		sum = _mm256_add_epi64(sum, _mm256_sad_epu8(bits, zero));
+	}
+
+	// _mm256_extract_epi64 is not available on 32 bit targets, so store the lanes
+	uint64_t lanes[4];
+	_mm256_storeu_si256((__m256i *) lanes, sum);
+
+	*count += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+	return i;
+}
+
+/**
+ * @brief Resolves whether any bit of a is set, 32 bytes at a time.
+ */
+CM_BITSET_AVX2 static size_t Cm_BitsetAny_AVX2(const byte *a, const size_t len, _Bool *any) {
+	size_t i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		const __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+		if (!_mm256_testz_si256(va, va)) {
+			*any = true;
+			break;
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief Resolves whether any bit of a is set that is not set in b, 32 bytes
+ * at a time.
+ */
+CM_BITSET_AVX2 static size_t Cm_BitsetAnyAndNot_AVX2(const byte *a, const byte *b, const size_t len, _Bool *any) {
+	size_t i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		const __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+		const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+		if (!_mm256_testc_si256(vb, va)) {
+			*any = true;
+			break;
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief out = a & b, resolving whether any bit of out is set that is not set
+ * in c, 32 bytes at a time.
+ */
+CM_BITSET_AVX2 static size_t Cm_BitsetAndAnyAndNot_AVX2(byte *out, const byte *a, const byte *b, const byte *c,
+		const size_t len, _Bool *any) {
+	size_t i;
+
+	int32_t contained = 1;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		const __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+		const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+		const __m256i vc = _mm256_loadu_si256((const __m256i *) (c + i));
+		const __m256i v = _mm256_and_si256(va, vb);
+		_mm256_storeu_si256((__m256i *) (out + i), v);
+		contained &= _mm256_testc_si256(vc, v);
+	}
+
+	if (!contained) {
+		*any = true;
+	}
+
+	return i;
+}
+
+#endif /* CM_BITSET_AVX2 */
+
+#if defined(CM_BITSET_SSE2)
+
+/**
+ * @brief out = a | b, 16 bytes at a time.
+ */
+CM_BITSET_SSE2 static size_t Cm_BitsetOr_SSE2(byte *out, const byte *a, const byte *b, const size_t len) {
+	size_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+		const __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+		_mm_storeu_si128((__m128i *) (out + i), _mm_or_si128(va, vb));
+	}
+
+	return i;
+}
+
+/**
+ * @brief out = a & b, 16 bytes at a time.
+ */
+CM_BITSET_SSE2 static size_t Cm_BitsetAnd_SSE2(byte *out, const byte *a, const byte *b, const size_t len) {
+	size_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+		const __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+		_mm_storeu_si128((__m128i *) (out + i), _mm_and_si128(va, vb));
+	}
+
+	return i;
+}
+
+/**
+ * @brief Counts the set bits of a, 16 bytes at a time, using SWAR arithmetic.
+ */
+CM_BITSET_SSE2 static size_t Cm_BitsetCount_SSE2(const byte *a, const size_t len, size_t *count) {
+	size_t i;
+
+	const __m128i m1 = _mm_set1_epi8(0x55);
+	const __m128i m2 = _mm_set1_epi8(0x33);
+	const __m128i m4 = _mm_set1_epi8(0x0f);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i sum = zero;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (a + i));
+
+		v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+		v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+		v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+	}
+
+	*count += _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+
+	return i;
+}
+
+/**
+ * @brief Resolves whether any bit of a is set, 16 bytes at a time.
+ */
+CM_BITSET_SSE2 static size_t Cm_BitsetAny_SSE2(const byte *a, const size_t len, _Bool *any) {
+	size_t i;
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, zero)) != 0xffff) {
+			*any = true;
+			break;
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief Resolves whether any bit of a is set that is not set in b, 16 bytes
+ * at a time.
+ */
+CM_BITSET_SSE2 static size_t Cm_BitsetAnyAndNot_SSE2(const byte *a, const byte *b, const size_t len, _Bool *any) {
+	size_t i;
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+		const __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+		const __m128i v = _mm_andnot_si128(vb, va);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xffff) {
+			*any = true;
+			break;
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief out = a & b, resolving whether any bit of out is set that is not set
+ * in c, 16 bytes at a time.
+ */
+CM_BITSET_SSE2 static size_t Cm_BitsetAndAnyAndNot_SSE2(byte *out, const byte *a, const byte *b, const byte *c,
+		const size_t len, _Bool *any) {
+	size_t i;
+
+	__m128i rest = _mm_setzero_si128();
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+		const __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+		const __m128i vc = _mm_loadu_si128((const __m128i *) (c + i));
+		const __m128i v = _mm_and_si128(va, vb);
+		_mm_storeu_si128((__m128i *) (out + i), v);
+		rest = _mm_or_si128(rest, _mm_andnot_si128(vc, v));
+	}
+
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(rest, _mm_setzero_si128())) != 0xffff) {
+		*any = true;
+	}
+
+	return i;
+}
+
+#endif /* CM_BITSET_SSE2 */
+
+/**
+ * @brief Loads a 64 bit word from a potentially unaligned address.
+ */
+static inline uint64_t Cm_BitsetLoad(const byte *in) {
+	uint64_t word;
+	memcpy(&word, in, sizeof(word));
+	return word;
+}
+
+/**
+ * @brief Stores a 64 bit word to a potentially unaligned address.
+ */
+static inline void Cm_BitsetStore(byte *out, const uint64_t word) {
+	memcpy(out, &word, sizeof(word));
+}
+
+/**
+ * @brief Sets `out` to the union of `a` and `b`. `out` may alias either input.
+ */
+void Cm_BitsetOr(byte *out, const byte *a, const byte *b, const size_t len) {
+	size_t i = 0;
+
+#if defined(CM_BITSET_AVX2)
+	if (Cm_BitsetHasAVX2()) {
+		i = Cm_BitsetOr_AVX2(out, a, b, len);
+	}
+#endif
+
+#if defined(CM_BITSET_SSE2)
+	i += Cm_BitsetOr_SSE2(out + i, a + i, b + i, len - i);
+#endif
+
+	for (; i + 8 <= len; i += 8) {
+		Cm_BitsetStore(out + i, Cm_BitsetLoad(a + i) | Cm_BitsetLoad(b + i));
+	}
+
+	for (; i < len; i++) {
+		out[i] = a[i] | b[i];
+	}
+}
+
+/**
+ * @brief Sets `out` to the intersection of `a` and `b`. `out` may alias either
+ * input.
+ */
+void Cm_BitsetAnd(byte *out, const byte *a, const byte *b, const size_t len) {
+	size_t i = 0;
+
+#if defined(CM_BITSET_AVX2)
+	if (Cm_BitsetHasAVX2()) {
+		i = Cm_BitsetAnd_AVX2(out, a, b, len);
+	}
+#endif
+
+#if defined(CM_BITSET_SSE2)
+	i += Cm_BitsetAnd_SSE2(out + i, a + i, b + i, len - i);
+#endif
+
+	for (; i + 8 <= len; i += 8) {
+		Cm_BitsetStore(out + i, Cm_BitsetLoad(a + i) & Cm_BitsetLoad(b + i));
+	}
+
+	for (; i < len; i++) {
+		out[i] = a[i] & b[i];
+	}
+}
+
+/**
+ * @return The number of bits set in `a`.
+ */
+size_t Cm_BitsetCount(const byte *a, const size_t len) {
+	size_t i = 0, count = 0;
+
+#if defined(CM_BITSET_AVX2)
+	if (Cm_BitsetHasAVX2()) {
+		i = Cm_BitsetCount_AVX2(a, len, &count);
+	}
+#endif
+
+#if defined(CM_BITSET_SSE2)
+	i += Cm_BitsetCount_SSE2(a + i, len - i, &count);
+#endif
+
+	for (; i + 8 <= len; i += 8) {
+		count += __builtin_popcountll(Cm_BitsetLoad(a + i));
+	}
+
+	for (; i < len; i++) {
+		count += __builtin_popcount(a[i]);
+	}
+
+	return count;
+}
+
+/**
+ * @return True if any bit of `a` is set.
+ */
+_Bool Cm_BitsetAny(const byte *a, const size_t len) {
+	_Bool any = false;
+	size_t i = 0;
+
+#if defined(CM_BITSET_AVX2)
+	if (Cm_BitsetHasAVX2()) {
+		i = Cm_BitsetAny_AVX2(a, len, &any);
+	}
+#endif
+
+#if defined(CM_BITSET_SSE2)
+	if (!any) {
+		i += Cm_BitsetAny_SSE2(a + i, len - i, &any);
+	}
+#endif
+
+	if (any) {
+		return true;
+	}
+
+	for (; i + 8 <= len; i += 8) {
+		if (Cm_BitsetLoad(a + i)) {
+			return true;
+		}
+	}
+
+	for (; i < len; i++) {
+		if (a[i]) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @return True if any bit of `a` is set which is not set in `b`.
+ */
+_Bool Cm_BitsetAnyAndNot(const byte *a, const byte *b, const size_t len) {
+	_Bool any = false;
+	size_t i = 0;
+
+#if defined(CM_BITSET_AVX2)
+	if (Cm_BitsetHasAVX2()) {
+		i = Cm_BitsetAnyAndNot_AVX2(a, b, len, &any);
+	}
+#endif
+
+#if defined(CM_BITSET_SSE2)
+	if (!any) {
+		i += Cm_BitsetAnyAndNot_SSE2(a + i, b + i, len - i, &any);
+	}
+#endif
+
+	if (any) {
+		return true;
+	}
+
+	for (; i + 8 <= len; i += 8) {
+		if (Cm_BitsetLoad(a + i) & ~Cm_BitsetLoad(b + i)) {
+			return true;
+		}
+	}
+
+	for (; i < len; i++) {
+		if (a[i] & ~b[i]) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Sets `out` to the intersection of `a` and `b`, as Cm_BitsetAnd does.
+ * @return True if any bit of `out` is set which is not set in `c`.
+ * @remarks This fuses the two passes of portal flow into one. `out` may alias
+ * `a` or `b`, but not `c`.
+ */
+_Bool Cm_BitsetAndAnyAndNot(byte *out, const byte *a, const byte *b, const byte *c, const size_t len) {
+	_Bool any = false;
+	size_t i = 0;
+
+#if defined(CM_BITSET_AVX2)
+	if (Cm_BitsetHasAVX2()) {
+		i = Cm_BitsetAndAnyAndNot_AVX2(out, a, b, c, len, &any);
+	}
+#endif
+
+#if defined(CM_BITSET_SSE2)
+	i += Cm_BitsetAndAnyAndNot_SSE2(out + i, a + i, b + i, c + i, len - i, &any);
+#endif
+
+	uint64_t rest = 0;
+
+	for (; i + 8 <= len; i += 8) {
+		const uint64_t word = Cm_BitsetLoad(a + i) & Cm_BitsetLoad(b + i);
+		Cm_BitsetStore(out + i, word);
+		rest |= word & ~Cm_BitsetLoad(c + i);
+	}
+
+	for (; i < len; i++) {
+		out[i] = a[i] & b[i];
+		rest |= out[i] & ~c[i];
+	}
+
+	return any || rest;
+}
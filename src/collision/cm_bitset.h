@@ -0,0 +1,44 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __CM_BITSET_H__
+#define __CM_BITSET_H__
+
+#include "cm_types.h"
+
+/**
+ * @brief Tests the specified bit of a bit vector, such as a PVS or PHS row.
+ */
+#define Cm_BitsetTest(bits, bit) ((bits)[(bit) >> 3] & (1 << ((bit) & 7)))
+
+/**
+ * @brief Sets the specified bit of a bit vector.
+ */
+#define Cm_BitsetSet(bits, bit) ((bits)[(bit) >> 3] |= (1 << ((bit) & 7)))
+
+void Cm_BitsetOr(byte *out, const byte *a, const byte *b, const size_t len);
+void Cm_BitsetAnd(byte *out, const byte *a, const byte *b, const size_t len);
+size_t Cm_BitsetCount(const byte *a, const size_t len);
+_Bool Cm_BitsetAny(const byte *a, const size_t len);
+_Bool Cm_BitsetAnyAndNot(const byte *a, const byte *b, const size_t len);
+_Bool Cm_BitsetAndAnyAndNot(byte *out, const byte *a, const byte *b, const byte *c, const size_t len);
+
+#endif /* __CM_BITSET_H__ */
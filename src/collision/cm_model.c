@@ -430,6 +430,7 @@ cm_bsp_model_t *Cm_LoadBspModel(const char *name, int64_t *size) {
 		if (size) {
 			*size = 0;
 		}
+		Cm_InitVisCache();
 		return &cm_bsp.models[0];
 	}
 
@@ -449,7 +450,7 @@ cm_bsp_model_t *Cm_LoadBspModel(const char *name, int64_t *size) {
 		((int32_t *) &header)[i] = LittleLong(((int32_t *) &header)[i]);
 	}
 
-	if (header.version != BSP_VERSION && header.version != BSP_VERSION_QUETOO) {
+	if (!BSP_VERSION_SUPPORTED(header.version)) {
 		Com_Error(ERR_DROP, "%s has unsupported version: %d\n", name, header.version);
 	}
 
@@ -477,8 +478,12 @@ cm_bsp_model_t *Cm_LoadBspModel(const char *name, int64_t *size) {
 
 	Cm_InitBoxHull();
 
+	Cm_ResetTraceStats();
+
 	Cm_FloodAreas();
 
+	Cm_InitVisCache();
+
 	return &cm_bsp.models[0];
 }
 
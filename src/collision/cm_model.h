@@ -40,6 +40,13 @@ int32_t Cm_LeafArea(const int32_t leaf_num);
 #ifdef __CM_LOCAL_H__
 
 #include "files.h"
+#include "thread.h"
+
+/**
+ * @brief Box hulls are appended beyond the parsed size of the map: one for
+ * general use, and one for each thread that may trace concurrently.
+ */
+#define MAX_BOX_HULLS (MAX_THREADS + 2)
 
 typedef struct {
 	char name[MAX_QPATH];
@@ -49,28 +56,28 @@ typedef struct {
 	char entity_string[MAX_BSP_ENT_STRING];
 
 	int32_t num_planes;
-	cm_bsp_plane_t planes[MAX_BSP_PLANES + 12]; // extra for box hull
+	cm_bsp_plane_t planes[MAX_BSP_PLANES + 12 * MAX_BOX_HULLS]; // extra for box hulls
 
 	int32_t num_nodes;
-	cm_bsp_node_t nodes[MAX_BSP_NODES + 6]; // extra for box hull
+	cm_bsp_node_t nodes[MAX_BSP_NODES + 6 * MAX_BOX_HULLS]; // extra for box hulls
 
 	int32_t num_surfaces;
 	cm_bsp_surface_t surfaces[MAX_BSP_TEXINFO];
 
 	int32_t num_leafs;
-	cm_bsp_leaf_t leafs[MAX_BSP_LEAFS + 1]; // extra for box hull
+	cm_bsp_leaf_t leafs[MAX_BSP_LEAFS + MAX_BOX_HULLS]; // extra for box hulls
 
 	int32_t num_leaf_brushes;
-	uint16_t leaf_brushes[MAX_BSP_LEAF_BRUSHES + 1]; // extra for box hull
+	uint16_t leaf_brushes[MAX_BSP_LEAF_BRUSHES + MAX_BOX_HULLS]; // extra for box hulls
 
 	int32_t num_models;
 	cm_bsp_model_t models[MAX_BSP_MODELS];
 
 	int32_t num_brushes;
-	cm_bsp_brush_t brushes[MAX_BSP_BRUSHES + 1]; // extra for box hull
+	cm_bsp_brush_t brushes[MAX_BSP_BRUSHES + MAX_BOX_HULLS]; // extra for box hulls
 
 	int32_t num_brush_sides;
-	cm_bsp_brush_side_t brush_sides[MAX_BSP_BRUSH_SIDES + 6]; // extra for box hull
+	cm_bsp_brush_side_t brush_sides[MAX_BSP_BRUSH_SIDES + 6 * MAX_BOX_HULLS]; // extra for box hulls
 
 	int32_t num_visibility;
 	byte visibility[MAX_BSP_VISIBILITY];
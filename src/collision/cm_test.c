@@ -19,6 +19,8 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#include <SDL2/SDL_atomic.h>
+
 #include "cm_local.h"
 
 /**
@@ -111,116 +113,174 @@ typedef struct {
 	cm_bsp_leaf_t *leaf;
 } cm_box_t;
 
-static cm_box_t cm_box;
+static cm_box_t cm_box[MAX_BOX_HULLS];
+
+/**
+ * @brief Box hull 0 is shared by all callers that have not bound a private box
+ * hull with Cm_BindBoxHull.
+ */
+static __thread int32_t cm_box_hull;
+
+static _Bool cm_box_hull_bound[MAX_BOX_HULLS];
+static SDL_SpinLock cm_box_hull_lock;
 
 /**
  * @brief Appends a brush (6 nodes, 12 planes) opaquely to the primary BSP
- * structure to represent the bounding box used for Cm_BoxLeafnums. This brush
- * is never tested by the rest of the collision detection code, as it resides
- * just beyond the parsed size of the map.
+ * structure for each box hull, to represent the bounding box used for
+ * Cm_BoxLeafnums. These brushes are never tested by the rest of the collision
+ * detection code, as they reside just beyond the parsed size of the map.
  */
 void Cm_InitBoxHull(void) {
 	static cm_bsp_surface_t null_surface;
 
-	if (cm_bsp.num_planes + 12 > MAX_BSP_PLANES)
-		Com_Error(ERR_DROP, "MAX_BSP_PLANES\n");
+	// leaf brushes are referenced by 16 bit index
+	if (cm_bsp.num_leaf_brushes + MAX_BOX_HULLS > UINT16_MAX)
+		Com_Error(ERR_DROP, "MAX_BSP_LEAF_BRUSHES\n");
 
-	if (cm_bsp.num_nodes + 6 > MAX_BSP_NODES)
-		Com_Error(ERR_DROP, "MAX_BSP_NODES\n");
+	for (int32_t i = 0; i < MAX_BOX_HULLS; i++) {
+		cm_box_t *box = &cm_box[i];
+
+		const int32_t plane_num = cm_bsp.num_planes + i * 12;
+		const int32_t node_num = cm_bsp.num_nodes + i * 6;
+		const int32_t leaf_num = cm_bsp.num_leafs + i;
+		const int32_t leaf_brush_num = cm_bsp.num_leaf_brushes + i;
+		const int32_t brush_num = cm_bsp.num_brushes + i;
+		const int32_t brush_side_num = cm_bsp.num_brush_sides + i * 6;
+
+		// head node
+		box->head_node = node_num;
+
+		// planes
+		box->planes = &cm_bsp.planes[plane_num];
+
+		// leaf
+		box->leaf = &cm_bsp.leafs[leaf_num];
+		box->leaf->contents = CONTENTS_MONSTER;
+		box->leaf->first_leaf_brush = leaf_brush_num;
+		box->leaf->num_leaf_brushes = 1;
+
+		// leaf brush
+		cm_bsp.leaf_brushes[leaf_brush_num] = brush_num;
+
+		// brush
+		box->brush = &cm_bsp.brushes[brush_num];
+		box->brush->num_sides = 6;
+		box->brush->first_brush_side = brush_side_num;
+		box->brush->contents = CONTENTS_MONSTER;
+
+		for (int32_t j = 0; j < 6; j++) {
+
+			// fill in planes, two per side
+			cm_bsp_plane_t *plane = &box->planes[j * 2];
+			plane->type = j >> 1;
+			VectorClear(plane->normal);
+			plane->normal[j >> 1] = 1.0;
+			plane->sign_bits = Cm_SignBitsForPlane(plane);
+			plane->num = (plane_num >> 1) + (j >> 1) + 1;
+
+			plane = &box->planes[j * 2 + 1];
+			plane->type = PLANE_ANY_X + (j >> 1);
+			VectorClear(plane->normal);
+			plane->normal[j >> 1] = -1.0;
+			plane->sign_bits = Cm_SignBitsForPlane(plane);
+			plane->num = (plane_num >> 1) + (j >> 1) + 1;
+
+			const int32_t side = j & 1;
+
+			// fill in nodes, one per side
+			cm_bsp_node_t *node = &cm_bsp.nodes[node_num + j];
+			node->plane = cm_bsp.planes + (plane_num + j * 2);
+			node->children[side] = -1 - leaf_num;
+			if (j != 5)
+				node->children[side ^ 1] = node_num + j + 1;
+			else
+				node->children[side ^ 1] = -1 - leaf_num;
+
+			// fill in brush sides, one per side
+			cm_bsp_brush_side_t *bside = &cm_bsp.brush_sides[brush_side_num + j];
+			bside->plane = cm_bsp.planes + (plane_num + j * 2 + side);
+			bside->surface = &null_surface;
+		}
+	}
+}
 
-	if (cm_bsp.num_leafs + 1 > MAX_BSP_LEAFS)
-		Com_Error(ERR_DROP, "MAX_BSP_LEAFS\n");
+/**
+ * @brief Binds a private box hull to the calling thread, so that it may call
+ * Cm_SetBoxHull and trace against the result concurrently with other threads.
+ * Threads which already have a private box hull retain it.
+ *
+ * @return The box hull previously bound to the calling thread, which should be
+ * passed to Cm_UnbindBoxHull when the thread has finished tracing.
+ */
+int32_t Cm_BindBoxHull(void) {
 
-	if (cm_bsp.num_leaf_brushes + 1 > MAX_BSP_LEAF_BRUSHES)
-		Com_Error(ERR_DROP, "MAX_BSP_LEAF_BRUSHES\n");
+	const int32_t prev = cm_box_hull;
 
-	if (cm_bsp.num_brushes + 1 > MAX_BSP_BRUSHES)
-		Com_Error(ERR_DROP, "MAX_BSP_BRUSHES\n");
-
-	if (cm_bsp.num_brush_sides + 6 > MAX_BSP_BRUSH_SIDES)
-		Com_Error(ERR_DROP, "MAX_BSP_BRUSH_SIDES\n");
-
-	// head node
-	cm_box.head_node = cm_bsp.num_nodes;
-
-	// planes
-	cm_box.planes = &cm_bsp.planes[cm_bsp.num_planes];
-
-	// leaf
-	cm_box.leaf = &cm_bsp.leafs[cm_bsp.num_leafs];
-	cm_box.leaf->contents = CONTENTS_MONSTER;
-	cm_box.leaf->first_leaf_brush = cm_bsp.num_leaf_brushes;
-	cm_box.leaf->num_leaf_brushes = 1;
-
-	// leaf brush
-	cm_bsp.leaf_brushes[cm_bsp.num_leaf_brushes] = cm_bsp.num_brushes;
-
-	// brush
-	cm_box.brush = &cm_bsp.brushes[cm_bsp.num_brushes];
-	cm_box.brush->num_sides = 6;
-	cm_box.brush->first_brush_side = cm_bsp.num_brush_sides;
-	cm_box.brush->contents = CONTENTS_MONSTER;
-
-	for (int32_t i = 0; i < 6; i++) {
-
-		// fill in planes, two per side
-		cm_bsp_plane_t *plane = &cm_box.planes[i * 2];
-		plane->type = i >> 1;
-		VectorClear(plane->normal);
-		plane->normal[i >> 1] = 1.0;
-		plane->sign_bits = Cm_SignBitsForPlane(plane);
-		plane->num = (cm_bsp.num_planes >> 1) + (i >> 1) + 1;
-
-		plane = &cm_box.planes[i * 2 + 1];
-		plane->type = PLANE_ANY_X + (i >> 1);
-		VectorClear(plane->normal);
-		plane->normal[i >> 1] = -1.0;
-		plane->sign_bits = Cm_SignBitsForPlane(plane);
-		plane->num = (cm_bsp.num_planes >> 1) + (i >> 1) + 1;
-
-		const int32_t side = i & 1;
-
-		// fill in nodes, one per side
-		cm_bsp_node_t *node = &cm_bsp.nodes[cm_box.head_node + i];
-		node->plane = cm_bsp.planes + (cm_bsp.num_planes + i * 2);
-		node->children[side] = -1 - cm_bsp.num_leafs;
-		if (i != 5)
-			node->children[side ^ 1] = cm_box.head_node + i + 1;
-		else
-			node->children[side ^ 1] = -1 - cm_bsp.num_leafs;
+	if (prev == 0) {
+		SDL_AtomicLock(&cm_box_hull_lock);
+
+		for (int32_t i = 1; i < MAX_BOX_HULLS; i++) {
+			if (!cm_box_hull_bound[i]) {
+				cm_box_hull_bound[i] = true;
+				cm_box_hull = i;
+				break;
+			}
+		}
 
-		// fill in brush sides, one per side
-		cm_bsp_brush_side_t *bside = &cm_bsp.brush_sides[cm_bsp.num_brush_sides + i];
-		bside->plane = cm_bsp.planes + (cm_bsp.num_planes + i * 2 + side);
-		bside->surface = &null_surface;
+		SDL_AtomicUnlock(&cm_box_hull_lock);
+
+		if (cm_box_hull == 0) {
+			Com_Error(ERR_DROP, "MAX_BOX_HULLS\n");
+		}
+	}
+
+	return prev;
+}
+
+/**
+ * @brief Releases the box hull bound by Cm_BindBoxHull, restoring the calling
+ * thread's previous box hull.
+ */
+void Cm_UnbindBoxHull(const int32_t prev) {
+
+	if (cm_box_hull != prev) {
+		SDL_AtomicLock(&cm_box_hull_lock);
+
+		cm_box_hull_bound[cm_box_hull] = false;
+
+		SDL_AtomicUnlock(&cm_box_hull_lock);
+
+		cm_box_hull = prev;
 	}
 }
 
 /**
- * @brief Initializes the box hull for the specified bounds, returning the
- * head node for the resulting box hull tree.
+ * @brief Initializes the calling thread's box hull for the specified bounds,
+ * returning the head node for the resulting box hull tree.
  */
 int32_t Cm_SetBoxHull(const vec3_t mins, const vec3_t maxs, const int32_t contents) {
 
-	VectorCopy(mins, cm_box.brush->mins);
-	VectorCopy(maxs, cm_box.brush->maxs);
-	
-	cm_box.planes[0].dist = maxs[0];
-	cm_box.planes[1].dist = -maxs[0];
-	cm_box.planes[2].dist = mins[0];
-	cm_box.planes[3].dist = -mins[0];
-	cm_box.planes[4].dist = maxs[1];
-	cm_box.planes[5].dist = -maxs[1];
-	cm_box.planes[6].dist = mins[1];
-	cm_box.planes[7].dist = -mins[1];
-	cm_box.planes[8].dist = maxs[2];
-	cm_box.planes[9].dist = -maxs[2];
-	cm_box.planes[10].dist = mins[2];
-	cm_box.planes[11].dist = -mins[2];
-
-	cm_box.leaf->contents = cm_box.brush->contents = contents;
-
-	return cm_box.head_node;
+	cm_box_t *box = &cm_box[cm_box_hull];
+
+	VectorCopy(mins, box->brush->mins);
+	VectorCopy(maxs, box->brush->maxs);
+
+	box->planes[0].dist = maxs[0];
+	box->planes[1].dist = -maxs[0];
+	box->planes[2].dist = mins[0];
+	box->planes[3].dist = -mins[0];
+	box->planes[4].dist = maxs[1];
+	box->planes[5].dist = -maxs[1];
+	box->planes[6].dist = mins[1];
+	box->planes[7].dist = -mins[1];
+	box->planes[8].dist = maxs[2];
+	box->planes[9].dist = -maxs[2];
+	box->planes[10].dist = mins[2];
+	box->planes[11].dist = -mins[2];
+
+	box->leaf->contents = box->brush->contents = contents;
+
+	return box->head_node;
 }
 
 /**
@@ -26,6 +26,8 @@
 
 int32_t Cm_SignBitsForPlane(const cm_bsp_plane_t *plane);
 int32_t Cm_BoxOnPlaneSide(const vec3_t mins, const vec3_t maxs, const cm_bsp_plane_t *plane);
+int32_t Cm_BindBoxHull(void);
+void Cm_UnbindBoxHull(const int32_t prev);
 int32_t Cm_SetBoxHull(const vec3_t mins, const vec3_t maxs, const int32_t contents);
 int32_t Cm_PointLeafnum(const vec3_t p, int32_t head_node);
 int32_t Cm_PointContents(const vec3_t p, int32_t head_node);
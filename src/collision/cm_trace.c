@@ -19,6 +19,8 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#include <SDL2/SDL_atomic.h>
+
 #include "cm_local.h"
 
 /**
@@ -41,20 +43,138 @@ typedef struct {
 
 	cm_trace_t trace;
 
-	int32_t brushes[32]; // used to avoid multiple intersection tests with brushes
+	uint32_t stamp; // the generation of this trace in cm_brush_stamps
+	int32_t brushes_tested, brushes_skipped;
 } cm_trace_data_t;
 
 /**
- * @brief
+ * @brief The generation of the trace which last tested each brush, by brush
+ * number, for the calling thread. This makes brush de-duplication exact across
+ * all leafs a trace crosses, and requires no clearing between traces. The
+ * stamps are allocated by the first trace a thread performs on a map, so that
+ * threads which never trace carry no buffer.
+ */
+static __thread uint32_t *cm_brush_stamps;
+static __thread size_t cm_num_brush_stamps;
+static __thread uint32_t cm_brush_stamp;
+
+/**
+ * @brief Set to collect brush de-duplication statistics. This is off by
+ * default, so that the trace path is not burdened with bookkeeping.
+ */
+_Bool cm_trace_stats_enabled = false;
+
+/**
+ * @brief The number of traces a thread accumulates before folding its
+ * counters into the totals.
+ */
+#define CM_TRACE_STATS_BATCH 256
+
+/**
+ * @brief Brush de-duplication counters for the calling thread, not yet folded
+ * into the totals.
+ */
+static __thread cm_trace_stats_t cm_thread_trace_stats;
+
+/**
+ * @brief Brush de-duplication counters, accumulated across all threads.
+ */
+static struct {
+	SDL_SpinLock lock;
+	cm_trace_stats_t totals;
+} cm_trace_stats;
+
+/**
+ * @brief Advances the brush generation for a new trace.
+ */
+static void Cm_BeginTrace(cm_trace_data_t *data) {
+
+	const size_t num_brush_stamps = cm_bsp.num_brushes + MAX_BOX_HULLS;
+
+	if (cm_num_brush_stamps != num_brush_stamps) { // size them to the loaded map
+		Mem_Free(cm_brush_stamps);
+
+		cm_brush_stamps = Mem_Malloc(num_brush_stamps * sizeof(uint32_t));
+		cm_num_brush_stamps = num_brush_stamps;
+		cm_brush_stamp = 0;
+	}
+
+	data->stamp = ++cm_brush_stamp;
+
+	if (data->stamp == 0) { // wrapped, so stale generations must be cleared
+		memset(cm_brush_stamps, 0, cm_num_brush_stamps * sizeof(uint32_t));
+		data->stamp = cm_brush_stamp = 1;
+	}
+}
+
+/**
+ * @brief Accumulates the brush de-duplication counters of a finished trace for
+ * the calling thread, folding them into the totals periodically.
+ */
+static void Cm_EndTrace(const cm_trace_data_t *data) {
+
+	if (!cm_trace_stats_enabled) {
+		return;
+	}
+
+	cm_trace_stats_t *stats = &cm_thread_trace_stats;
+
+	stats->traces++;
+	stats->brushes_tested += data->brushes_tested;
+	stats->brushes_skipped += data->brushes_skipped;
+
+	if (stats->traces == CM_TRACE_STATS_BATCH) {
+		SDL_AtomicLock(&cm_trace_stats.lock);
+
+		cm_trace_stats.totals.traces += stats->traces;
+		cm_trace_stats.totals.brushes_tested += stats->brushes_tested;
+		cm_trace_stats.totals.brushes_skipped += stats->brushes_skipped;
+
+		SDL_AtomicUnlock(&cm_trace_stats.lock);
+
+		memset(stats, 0, sizeof(*stats));
+	}
+}
+
+/**
+ * @return True if the brush has already been tested by this trace, marking it
+ * as tested otherwise.
  */
 static _Bool Cm_BrushAlreadyTested(cm_trace_data_t *data, const int32_t brush_num) {
 
-	const int32_t hash = brush_num & 31;
-	const _Bool skip = (data->brushes[hash] == brush_num);
+	if (cm_brush_stamps[brush_num] == data->stamp) {
+		data->brushes_skipped++;
+		return true;
+	}
+
+	cm_brush_stamps[brush_num] = data->stamp;
+	return false;
+}
+
+/**
+ * @brief Populates the specified structure with the brush de-duplication
+ * counters accumulated since the last reset. Each thread folds its counters
+ * in batches, so up to CM_TRACE_STATS_BATCH traces per thread may be pending.
+ */
+void Cm_TraceStats(cm_trace_stats_t *stats) {
+
+	SDL_AtomicLock(&cm_trace_stats.lock);
+
+	*stats = cm_trace_stats.totals;
+
+	SDL_AtomicUnlock(&cm_trace_stats.lock);
+}
+
+/**
+ * @brief Resets the brush de-duplication counters.
+ */
+void Cm_ResetTraceStats(void) {
+
+	SDL_AtomicLock(&cm_trace_stats.lock);
 
-	data->brushes[hash] = brush_num;
+	memset(&cm_trace_stats.totals, 0, sizeof(cm_trace_stats.totals));
 
-	return skip;
+	SDL_AtomicUnlock(&cm_trace_stats.lock);
 }
 
 /**
@@ -176,9 +296,6 @@ static void Cm_TraceToLeaf(cm_trace_data_t *data, int32_t leaf_num) {
 	if (!(leaf->contents & data->contents))
 		return;
 
-	// reset the brushes cache for this leaf
-	memset(data->brushes, 0xff, sizeof(data->brushes));
-
 	// trace line against all brushes in the leaf
 	for (int32_t i = 0; i < leaf->num_leaf_brushes; i++) {
 		const int32_t brush_num = cm_bsp.leaf_brushes[leaf->first_leaf_brush + i];
@@ -192,6 +309,7 @@ static void Cm_TraceToLeaf(cm_trace_data_t *data, int32_t leaf_num) {
 			continue;
 
 		Cm_TraceToBrush(data, b);
+		data->brushes_tested++;
 
 		if (data->trace.all_solid)
 			return;
@@ -221,6 +339,7 @@ static void Cm_TestInLeaf(cm_trace_data_t *data, int32_t leaf_num) {
 			continue;
 
 		Cm_TestBoxInBrush(data, b);
+		data->brushes_tested++;
 
 		if (data->trace.all_solid)
 			return;
@@ -340,6 +459,8 @@ cm_trace_t Cm_BoxTrace(const vec3_t start, const vec3_t end, const vec3_t mins,
 		return data.trace;
 	}
 
+	Cm_BeginTrace(&data);
+
 	VectorCopy(start, data.start);
 	VectorCopy(end, data.end);
 
@@ -418,6 +539,8 @@ cm_trace_t Cm_BoxTrace(const vec3_t start, const vec3_t end, const vec3_t mins,
 		}
 
 		VectorCopy(start, data.trace.end);
+
+		Cm_EndTrace(&data);
 		return data.trace;
 	}
 
@@ -431,6 +554,7 @@ cm_trace_t Cm_BoxTrace(const vec3_t start, const vec3_t end, const vec3_t mins,
 		VectorLerp(start, end, data.trace.fraction, data.trace.end);
 	}
 
+	Cm_EndTrace(&data);
 	return data.trace;
 }
 
@@ -481,3 +605,31 @@ cm_trace_t Cm_TransformedBoxTrace(const vec3_t start, const vec3_t end, const ve
 
 	return trace;
 }
+
+/**
+ * @brief The number of requests claimed at a time by Cm_TraceBatch workers.
+ */
+#define TRACE_BATCH_CHUNK 8
+
+/**
+ * @brief Resolves the trace requests in [begin, end).
+ */
+static void Cm_TraceBatch_(void *data, int32_t begin, int32_t end) {
+	cm_trace_request_t *requests = (cm_trace_request_t *) data;
+
+	for (int32_t i = begin; i < end; i++) {
+		cm_trace_request_t *r = &requests[i];
+		r->trace = Cm_BoxTrace(r->start, r->end, r->mins, r->maxs, r->head_node, r->contents);
+	}
+}
+
+/**
+ * @brief Resolves the specified trace requests, fanning them out across the
+ * thread pool. Each request is traced exactly as if by Cm_BoxTrace. The head
+ * node of each request must belong to the world or an inline BSP model, as
+ * box hulls are private to the thread which set them.
+ */
+void Cm_TraceBatch(cm_trace_request_t *requests, const size_t count) {
+
+	Task_ParallelFor(Cm_TraceBatch_, requests, (int32_t) count, TRACE_BATCH_CHUNK);
+}
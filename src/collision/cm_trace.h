@@ -31,4 +31,9 @@ cm_trace_t Cm_TransformedBoxTrace(const vec3_t start, const vec3_t end, const ve
 		const vec3_t maxs, const int32_t head_node, const int32_t contents,
 		const matrix4x4_t *matrix, const matrix4x4_t *inverse_matrix);
 
+void Cm_TraceBatch(cm_trace_request_t *requests, const size_t count);
+
+void Cm_TraceStats(cm_trace_stats_t *stats);
+void Cm_ResetTraceStats(void);
+
 #endif /* __CM_TRACE_H__ */
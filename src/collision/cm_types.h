@@ -135,6 +135,60 @@ typedef struct {
 	struct g_entity_s *ent; // not set by Cm_*() functions
 } cm_trace_t;
 
+/**
+ * @brief A trace request for Cm_TraceBatch. The result is written to `trace`.
+ */
+typedef struct {
+	vec3_t start, end;
+	vec3_t mins, maxs;
+	int32_t head_node;
+	int32_t contents;
+
+	cm_trace_t trace;
+} cm_trace_request_t;
+
+/**
+ * @brief Brush de-duplication statistics for box traces.
+ */
+typedef struct {
+	/**
+	 * @brief The number of traces issued.
+	 */
+	uint64_t traces;
+
+	/**
+	 * @brief The number of brushes tested, and the number skipped because the
+	 * same trace had already tested them in another leaf.
+	 */
+	uint64_t brushes_tested, brushes_skipped;
+} cm_trace_stats_t;
+
+/**
+ * @brief Statistics for the decompressed vis cache.
+ */
+typedef struct {
+	/**
+	 * @brief The cache budget, and the memory actually used, in bytes.
+	 */
+	size_t size, used;
+
+	/**
+	 * @brief The number of PVS and PHS rows in the map, and the number that
+	 * may be cached at once.
+	 */
+	int32_t rows, cached_rows;
+
+	/**
+	 * @brief True if every row was expanded at map load.
+	 */
+	_Bool full;
+
+	/**
+	 * @brief Lookups satisfied by the cache, and those requiring expansion.
+	 */
+	uint64_t hits, misses;
+} cm_vis_cache_stats_t;
+
 #ifdef __CM_LOCAL_H__
 
 typedef struct {
@@ -19,6 +19,8 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#include <SDL2/SDL_atomic.h>
+
 #include "cm_local.h"
 
 /**
@@ -59,6 +61,279 @@ static void Cm_DecompressVis(const byte *in, byte *out) {
 	}
 }
 
+/**
+ * @brief An entry in the decompressed vis cache, linked into the LRU list.
+ */
+typedef struct {
+	int32_t key; // (cluster << 1) | DVIS_PVS or DVIS_PHS, or -1 if unused
+	int32_t prev, next; // toward most and least recently used, or -1
+} cm_vis_cache_entry_t;
+
+/**
+ * @brief The decompressed vis cache holds expanded PVS and PHS rows, keyed by
+ * cluster and vis type. If the budget allows every row to be expanded, they
+ * are all expanded at map load and the cache is read-only thereafter.
+ * Otherwise, rows are expanded on demand and the least recently used row is
+ * evicted to make room.
+ */
+typedef struct {
+	size_t size; // the budget, in bytes
+	size_t row; // the length of an expanded row, in bytes
+
+	byte *rows; // num_entries * row
+	cm_vis_cache_entry_t *entries;
+	int32_t num_entries;
+
+	int32_t *keys; // the entry for each key, or -1 if not cached
+	int32_t num_keys;
+
+	int32_t head, tail; // most and least recently used entries
+	_Bool full; // true if all rows were expanded at load
+
+	SDL_SpinLock lock;
+
+	SDL_SpinLock stats_lock;
+	uint64_t hits, misses; // accumulated across all threads
+} cm_vis_cache_t;
+
+static cm_vis_cache_t cm_vis_cache;
+
+/**
+ * @brief The number of lookups a thread accumulates before folding its
+ * counters into the totals.
+ */
+#define CM_VIS_CACHE_STATS_BATCH 256
+
+/**
+ * @brief Vis cache counters for the calling thread, not yet folded into the
+ * totals. Keeping them per thread spares each lookup a contended atomic.
+ */
+static __thread struct {
+	uint32_t hits, misses;
+} cm_thread_vis_cache_stats;
+
+/**
+ * @brief Counts a lookup for the calling thread, folding the counters into the
+ * totals periodically.
+ */
+static void Cm_CountVisCacheLookup(const _Bool hit) {
+
+	if (hit) {
+		cm_thread_vis_cache_stats.hits++;
+	} else {
+		cm_thread_vis_cache_stats.misses++;
+	}
+
+	if (cm_thread_vis_cache_stats.hits + cm_thread_vis_cache_stats.misses == CM_VIS_CACHE_STATS_BATCH) {
+		SDL_AtomicLock(&cm_vis_cache.stats_lock);
+
+		cm_vis_cache.hits += cm_thread_vis_cache_stats.hits;
+		cm_vis_cache.misses += cm_thread_vis_cache_stats.misses;
+
+		SDL_AtomicUnlock(&cm_vis_cache.stats_lock);
+
+		memset(&cm_thread_vis_cache_stats, 0, sizeof(cm_thread_vis_cache_stats));
+	}
+}
+
+/**
+ * @brief Frees all memory held by the decompressed vis cache.
+ */
+static void Cm_FreeVisCache(void) {
+
+	Mem_Free(cm_vis_cache.rows);
+	Mem_Free(cm_vis_cache.entries);
+	Mem_Free(cm_vis_cache.keys);
+
+	const size_t size = cm_vis_cache.size;
+
+	memset(&cm_vis_cache, 0, sizeof(cm_vis_cache));
+
+	cm_vis_cache.size = size;
+}
+
+/**
+ * @brief Initializes the decompressed vis cache for the current map, within
+ * the current budget. If the budget affords it, all rows are expanded now.
+ */
+void Cm_InitVisCache(void) {
+
+	Cm_FreeVisCache();
+
+	if (!cm_bsp.num_visibility || !cm_vis->num_clusters) {
+		return;
+	}
+
+	cm_vis_cache.row = (cm_vis->num_clusters + 7) >> 3;
+	cm_vis_cache.num_keys = cm_vis->num_clusters << 1;
+
+	const size_t max_entries = cm_vis_cache.size / cm_vis_cache.row;
+	if (max_entries == 0) {
+		return;
+	}
+
+	cm_vis_cache.num_entries = (int32_t) MIN(max_entries, (size_t) cm_vis_cache.num_keys);
+
+	cm_vis_cache.rows = Mem_Malloc(cm_vis_cache.num_entries * cm_vis_cache.row);
+	cm_vis_cache.entries = Mem_Malloc(cm_vis_cache.num_entries * sizeof(cm_vis_cache_entry_t));
+	cm_vis_cache.keys = Mem_Malloc(cm_vis_cache.num_keys * sizeof(int32_t));
+
+	for (int32_t i = 0; i < cm_vis_cache.num_keys; i++) {
+		cm_vis_cache.keys[i] = -1;
+	}
+
+	cm_vis_cache_entry_t *e = cm_vis_cache.entries;
+	for (int32_t i = 0; i < cm_vis_cache.num_entries; i++, e++) {
+		e->key = -1;
+		e->prev = i - 1;
+		e->next = i + 1 < cm_vis_cache.num_entries ? i + 1 : -1;
+	}
+
+	cm_vis_cache.head = 0;
+	cm_vis_cache.tail = cm_vis_cache.num_entries - 1;
+
+	if (cm_vis_cache.num_entries == cm_vis_cache.num_keys) {
+
+		for (int32_t i = 0; i < cm_vis_cache.num_keys; i++) {
+			const int32_t offset = cm_vis->bit_offsets[i >> 1][i & 1];
+
+			Cm_DecompressVis(cm_bsp.visibility + offset, cm_vis_cache.rows + i * cm_vis_cache.row);
+
+			cm_vis_cache.entries[i].key = i;
+			cm_vis_cache.keys[i] = i;
+		}
+
+		cm_vis_cache.full = true;
+	}
+}
+
+/**
+ * @brief Sets the decompressed vis cache budget, in bytes, and reinitializes
+ * the cache for the current map. A budget of 0 disables the cache.
+ */
+void Cm_SetVisCacheSize(const size_t size) {
+
+	cm_vis_cache.size = size;
+
+	Cm_InitVisCache();
+}
+
+/**
+ * @brief Populates the specified structure with the decompressed vis cache
+ * statistics. Each thread folds its lookups in batches, so up to
+ * CM_VIS_CACHE_STATS_BATCH lookups per thread may be pending.
+ */
+void Cm_VisCacheStats(cm_vis_cache_stats_t *stats) {
+
+	memset(stats, 0, sizeof(*stats));
+
+	stats->size = cm_vis_cache.size;
+	stats->used = cm_vis_cache.num_entries * cm_vis_cache.row;
+
+	stats->rows = cm_vis_cache.num_keys;
+	stats->cached_rows = cm_vis_cache.num_entries;
+	stats->full = cm_vis_cache.full;
+
+	SDL_AtomicLock(&cm_vis_cache.stats_lock);
+
+	stats->hits = cm_vis_cache.hits;
+	stats->misses = cm_vis_cache.misses;
+
+	SDL_AtomicUnlock(&cm_vis_cache.stats_lock);
+}
+
+/**
+ * @brief Moves the specified entry to the head of the LRU list.
+ *
+ * @remarks The cache must be locked.
+ */
+static void Cm_TouchVisCacheEntry(const int32_t entry) {
+
+	if (entry == cm_vis_cache.head) {
+		return;
+	}
+
+	cm_vis_cache_entry_t *e = &cm_vis_cache.entries[entry];
+
+	// unlink it
+	cm_vis_cache.entries[e->prev].next = e->next;
+
+	if (e->next == -1) {
+		cm_vis_cache.tail = e->prev;
+	} else {
+		cm_vis_cache.entries[e->next].prev = e->prev;
+	}
+
+	// and relink it at the head
+	e->prev = -1;
+	e->next = cm_vis_cache.head;
+
+	cm_vis_cache.entries[cm_vis_cache.head].prev = entry;
+	cm_vis_cache.head = entry;
+}
+
+/**
+ * @brief Copies the expanded row for the specified cluster and vis type into
+ * `out`, expanding and caching it if necessary.
+ */
+static void Cm_ClusterVis(const int32_t cluster, const int32_t type, byte *out) {
+
+	const int32_t offset = cm_vis->bit_offsets[cluster][type];
+
+	if (cm_vis_cache.num_entries == 0) {
+		Cm_DecompressVis(cm_bsp.visibility + offset, out);
+		return;
+	}
+
+	const int32_t key = (cluster << 1) | type;
+
+	if (cm_vis_cache.full) {
+		memcpy(out, cm_vis_cache.rows + key * cm_vis_cache.row, cm_vis_cache.row);
+		Cm_CountVisCacheLookup(true);
+		return;
+	}
+
+	SDL_AtomicLock(&cm_vis_cache.lock);
+
+	int32_t entry = cm_vis_cache.keys[key];
+	if (entry != -1) {
+		memcpy(out, cm_vis_cache.rows + entry * cm_vis_cache.row, cm_vis_cache.row);
+		Cm_TouchVisCacheEntry(entry);
+
+		SDL_AtomicUnlock(&cm_vis_cache.lock);
+
+		Cm_CountVisCacheLookup(true);
+		return;
+	}
+
+	SDL_AtomicUnlock(&cm_vis_cache.lock);
+
+	Cm_CountVisCacheLookup(false);
+
+	// expand the row outside of the lock, and then cache it
+	Cm_DecompressVis(cm_bsp.visibility + offset, out);
+
+	SDL_AtomicLock(&cm_vis_cache.lock);
+
+	if (cm_vis_cache.keys[key] == -1) { // another thread may have beaten us to it
+
+		entry = cm_vis_cache.tail;
+
+		cm_vis_cache_entry_t *e = &cm_vis_cache.entries[entry];
+		if (e->key != -1) {
+			cm_vis_cache.keys[e->key] = -1;
+		}
+
+		e->key = key;
+		cm_vis_cache.keys[key] = entry;
+
+		memcpy(cm_vis_cache.rows + entry * cm_vis_cache.row, out, cm_vis_cache.row);
+		Cm_TouchVisCacheEntry(entry);
+	}
+
+	SDL_AtomicUnlock(&cm_vis_cache.lock);
+}
+
 /**
  * @brief
  *
@@ -71,7 +346,7 @@ size_t Cm_ClusterPVS(const int32_t cluster, byte *pvs) {
 	if (cluster == -1)
 		memset(pvs, 0, len);
 	else
-		Cm_DecompressVis(cm_bsp.visibility + cm_vis->bit_offsets[cluster][DVIS_PVS], pvs);
+		Cm_ClusterVis(cluster, DVIS_PVS, pvs);
 
 	return len;
 }
@@ -86,7 +361,7 @@ size_t Cm_ClusterPHS(const int32_t cluster, byte *phs) {
 	if (cluster == -1)
 		memset(phs, 0, len);
 	else
-		Cm_DecompressVis(cm_bsp.visibility + cm_vis->bit_offsets[cluster][DVIS_PHS], phs);
+		Cm_ClusterVis(cluster, DVIS_PHS, phs);
 
 	return len;
 }
@@ -208,10 +483,7 @@ _Bool Cm_HeadnodeVisible(const int32_t node_num, const byte *vis) {
 		if (cluster == -1)
 			return false;
 
-		if (vis[cluster >> 3] & (1 << (cluster & 7)))
-			return true;
-
-		return false;
+		return Cm_BitsetTest(vis, cluster) != 0;
 	}
 
 	node = &cm_bsp.nodes[node_num];
@@ -27,6 +27,9 @@
 size_t Cm_ClusterPVS(const int32_t cluster, byte *pvs);
 size_t Cm_ClusterPHS(const int32_t cluster, byte *phs);
 
+void Cm_SetVisCacheSize(const size_t size);
+void Cm_VisCacheStats(cm_vis_cache_stats_t *stats);
+
 void Cm_SetAreaPortalState(const int32_t portal_num, const _Bool open);
 _Bool Cm_AreasConnected(const int32_t area1, const int32_t area2);
 
@@ -34,6 +37,7 @@ int32_t Cm_WriteAreaBits(const int32_t area, byte *out);
 _Bool Cm_HeadnodeVisible(const int32_t head_node, const byte *vis);
 
 #ifdef __CM_LOCAL_H__
+void Cm_InitVisCache(void);
 void Cm_FloodAreas(void);
 #endif /* __CM_LOCAL_H__ */
 
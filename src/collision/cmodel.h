@@ -26,6 +26,7 @@
 #include "filesystem.h"
 #include "matrix.h"
 
+#include "cm_bitset.h"
 #include "cm_model.h"
 #include "cm_test.h"
 #include "cm_trace.h"
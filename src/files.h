@@ -135,12 +135,19 @@ typedef struct {
  * Some of the arbitrary limits set in Quake2 have been increased to support
  * larger or more complex levels (i.e. visibility and lightmap lumps).
  *
- * Quetoo BSP identifies itself with BSP_VERSION_QUETOO.
+ * Quetoo BSP identifies itself with BSP_VERSION_QUETOO. Quetoo BSP compiled
+ * before the light grid identifies itself with BSP_VERSION_QUETOO_NO_LIGHT_GRID.
+ * Its header is one lump shorter, so the BSP_LUMP_LIGHT_GRID entry read from it
+ * overlaps the first lump, and must be ignored.
  */
 
 #define BSP_IDENT (('P' << 24) + ('S' << 16) + ('B' << 8) + 'I') // "IBSP"
 #define BSP_VERSION	38
-#define BSP_VERSION_QUETOO 69 // haha, 69..
+#define BSP_VERSION_QUETOO_NO_LIGHT_GRID 69 // haha, 69..
+#define BSP_VERSION_QUETOO 70
+
+#define BSP_VERSION_SUPPORTED(v) \
+	((v) == BSP_VERSION || (v) == BSP_VERSION_QUETOO_NO_LIGHT_GRID || (v) == BSP_VERSION_QUETOO)
 
 // upper bounds of BSP format
 #define MAX_BSP_MODELS			0x400
@@ -164,6 +171,7 @@ typedef struct {
 #define MAX_BSP_LIGHTING		0x10000000 // increased from Quake2 0x200000
 #define MAX_BSP_LIGHTMAP		(256 * 256) // minimum r_lightmap_block_size
 #define MAX_BSP_VISIBILITY		0x400000 // increased from Quake2 0x100000
+#define MAX_BSP_LIGHT_GRID		0x1000000
 
 // key / value pair sizes
 #define MAX_BSP_ENTITY_KEY		32
@@ -193,7 +201,8 @@ typedef struct {
 #define BSP_LUMP_AREAS			17
 #define BSP_LUMP_AREA_PORTALS	18
 #define BSP_LUMP_NORMALS		19 // new for q2w
-#define BSP_LUMPS				20
+#define BSP_LUMP_LIGHT_GRID		20 // new for quetoo, see d_bsp_light_grid_t
+#define BSP_LUMPS				21
 
 typedef struct {
 	int32_t ident;
@@ -314,17 +323,62 @@ typedef struct {
 } d_bsp_area_t;
 
 /**
- * @brief .aas format. Under heavy construction.
+ * @brief The light grid is a sparse irradiance volume, used to light mesh
+ * entities. Cells are grouped into bricks of BSP_LIGHT_GRID_BRICK^3 cells. The
+ * lump begins with this header, followed by the brick table of
+ * bricks[0] * bricks[1] * bricks[2] int32_t's, each the index of a populated
+ * brick or -1 for a brick entirely in solid. The populated bricks follow, each
+ * an array of cells in X, Y, Z order.
+ *
+ * Only BSP_VERSION_QUETOO files have a light grid lump. Loaders clear the lump
+ * for any other version, and an empty lump means the map has no light grid.
+ */
+
+#define BSP_LIGHT_GRID_IDENT (('D' << 24) + ('R' << 16) + ('G' << 8) + 'L') // "LGRD"
+#define BSP_LIGHT_GRID_BRICK 4
+#define BSP_LIGHT_GRID_BRICK_CELLS (BSP_LIGHT_GRID_BRICK * BSP_LIGHT_GRID_BRICK * BSP_LIGHT_GRID_BRICK)
+#define DEFAULT_LIGHT_GRID_SIZE 64
+
+typedef struct {
+	int32_t ident;
+	vec3_t mins; // the origin of the first cell
+	vec3_t size; // the spacing of cells
+	int32_t bricks[3]; // the dimensions of the brick table
+	int32_t num_bricks; // the number of populated bricks
+} d_bsp_light_grid_t;
+
+/**
+ * @brief Each cell holds the ambient light and the light arriving from its
+ * dominant direction, which is encoded like lightmap directions. Cells in solid
+ * are zeroed, and are recognized by their null direction.
+ */
+typedef struct {
+	byte ambient[3];
+	byte diffuse[3];
+	byte direction[3];
+} d_bsp_light_grid_cell_t;
+
+/**
+ * @brief .aas format. The area awareness system is a navigation graph for bots,
+ * produced by quemap -aas. Areas are the navigable BSP leafs, and reachabilities
+ * are the directed links between them. Areas are grouped into clusters, and the
+ * routing table gives the next cluster to travel through from any cluster to
+ * any other.
  */
 
 #define AAS_IDENT (('S' << 24) + ('A' << 16) + ('A' << 8) + 'Q') // "QAAS"
-#define AAS_VERSION	1
+#define AAS_VERSION	2
 
-#define AAS_LUMP_NODES 0
-#define AAS_LUMP_PORTALS 1
-#define AAS_LUMP_PATHS 2
-#define AAS_LUMPS (AAS_LUMP_PATHS + 1)
+#define AAS_LUMP_AREAS 0
+#define AAS_LUMP_REACHABILITY 1
+#define AAS_LUMP_LEAF_AREAS 2
+#define AAS_LUMP_CLUSTERS 3
+#define AAS_LUMP_ROUTES 4
+#define AAS_LUMPS (AAS_LUMP_ROUTES + 1)
 
+#define MAX_AAS_AREAS			MAX_BSP_LEAFS
+#define MAX_AAS_REACHABILITY	0x40000
+#define MAX_AAS_CLUSTERS		0x400
 
 typedef struct {
 	uint32_t ident;
@@ -332,35 +386,49 @@ typedef struct {
 	d_bsp_lump_t lumps[AAS_LUMPS];
 } d_aas_header_t;
 
-#define AAS_PORTAL_WALK		0x1
-#define AAS_PORTAL_CROUCH	0x2
-#define AAS_PORTAL_STAIR 	0x4
-#define AAS_PORTAL_JUMP		0x8
-#define AAS_PORTAL_FALL		0x10
-#define AAS_PORTAL_IMPASS	0x10000
+#define AAS_AREA_GROUNDED	0x1 // the area has a floor to stand on
+#define AAS_AREA_WATER		0x2 // the area is submerged
+#define AAS_AREA_LADDER		0x4 // the area touches a ladder
 
-// portals are polygons that split two nodes
 typedef struct {
-	uint16_t plane_num; // the plane this portal lives on
-	uint16_t nodes[2]; // the nodes this portal connects (front and back)
-	uint32_t flags[2]; // the travel flags to cross this portal from either side
-} d_aas_portal_t;
-
-#define AAS_INVALID_LEAF INT32_MIN
+	int32_t flags;
+	int32_t cluster;
+	vec3_t mins;
+	vec3_t maxs;
+	vec3_t origin; // where a player would stand (or swim) within the area
+	int32_t first_reachability;
+	int32_t num_reachability;
+} d_aas_area_t;
+
+typedef enum {
+	AAS_TRAVEL_WALK,
+	AAS_TRAVEL_JUMP,
+	AAS_TRAVEL_FALL,
+	AAS_TRAVEL_LADDER,
+	AAS_TRAVEL_WATER
+} d_aas_travel_t;
 
 typedef struct {
-	uint16_t plane_num;
-	int32_t children[2]; // negative children are leafs, just like BSP
-	int16_t mins[3];
-	int16_t maxs[3];
-	uint16_t first_path;
-	uint16_t num_paths;
-} d_aas_node_t;
+	int32_t travel; // d_aas_travel_t
+	int32_t area; // the destination area
+	vec3_t start; // where travel begins, in the source area
+	vec3_t end; // where travel ends, in the destination area
+	int32_t cost; // the travel cost, in units of distance
+} d_aas_reachability_t;
+
+#define AAS_INVALID_AREA -1
+#define AAS_INVALID_ROUTE 0xffff
 
 typedef struct {
-	uint16_t plane_num;
-	int16_t mins[3];
-	int16_t maxs[3];
-} d_aas_leaf_t;
+	vec3_t origin; // the mean origin of the cluster's areas
+	int32_t num_areas;
+} d_aas_cluster_t;
+
+/*
+ * The leaf areas lump is an int32_t area number for every BSP leaf, or
+ * AAS_INVALID_AREA. The routes lump is a uint16_t for every pair of clusters,
+ * indexed by (source * num_clusters + destination), giving the next cluster
+ * along the route, or AAS_INVALID_ROUTE.
+ */
 
 #endif /*__FILES_H__*/
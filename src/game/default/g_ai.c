@@ -20,19 +20,381 @@
  */
 
 #include "g_local.h"
+#include "bg_pmove.h"
+
+/*
+ * Bots think in three phases each frame. First, the clients they may perceive
+ * are snapshotted. Then, across the thread pool, each bot chooses whom it might
+ * see, and once their visibility traces are resolved in a single batch, decides
+ * where to move, look and shoot. Only their own navigation state is written
+ * while in parallel. Finally, their decisions are acted upon in turn, as if
+ * their commands had arrived from the network.
+ */
+
+#define AI_PATH_INTERVAL 1000
+#define AI_WAYPOINT_DIST 24.0
+#define AI_MAX_TARGETS 8
 
 /**
- * @brief
+ * @brief A client which bots may perceive.
+ */
+typedef struct {
+	g_entity_t *ent;
+	vec3_t eye;
+} g_ai_target_t;
+
+/**
+ * @brief The working state of a bot for the current frame.
+ */
+typedef struct {
+	g_entity_t *self;
+	vec3_t eye;
+
+	int32_t targets[AI_MAX_TARGETS]; // the nearest targets in the PVS, nearest first
+	int32_t num_targets;
+
+	g_trace_t traces[AI_MAX_TARGETS]; // visibility to the targets
+	int32_t first_trace; // in the trace batch
+
+	pm_cmd_t cmd; // the decision
+} g_ai_bot_t;
+
+static struct {
+	g_ai_target_t targets[MAX_CLIENTS];
+	int32_t num_targets;
+
+	g_ai_bot_t bots[MAX_CLIENTS];
+	int32_t num_bots;
+
+	g_trace_t traces[MAX_CLIENTS * AI_MAX_TARGETS];
+	int32_t num_traces;
+} g_ai;
+
+/**
+ * @brief Resolves the eye position of the specified client.
+ */
+static void G_Ai_Eye(const g_entity_t *ent, vec3_t eye) {
+
+	UnpackVector(ent->client->ps.pm_state.view_offset, eye);
+	VectorAdd(ent->s.origin, eye, eye);
+}
+
+/**
+ * @return A pseudo-random number for the specified bot, stable within a frame.
+ * Randomf is not used, as bots decide concurrently.
+ */
+static uint32_t G_Ai_Random(const g_entity_t *self, uint32_t salt) {
+
+	uint32_t x = ((self->s.number + 1) * 2654435761u) ^ (g_level.time + salt * 40503u);
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return x;
+}
+
+/**
+ * @return A random item entity which is available for pickup, or NULL.
+ */
+static g_entity_t *G_Ai_PickGoal(const g_entity_t *self) {
+	g_entity_t *goal = NULL;
+	uint32_t count = 0;
+
+	for (int32_t i = sv_max_clients->integer + 1; i < g_max_entities->integer; i++) {
+		g_entity_t *ent = &g_game.entities[i];
+
+		if (!ent->in_use || !ent->locals.item || (ent->sv_flags & SVF_NO_CLIENT)) {
+			continue;
+		}
+
+		count++;
+
+		if (G_Ai_Random(self, count) % count == 0) {
+			goal = ent;
+		}
+	}
+
+	return goal;
+}
+
+/**
+ * @brief Resolves the path to the goal again if it is stale, picking a new goal
+ * if the current one is unavailable or reached.
+ */
+static void G_Ai_UpdatePath(g_entity_t *self) {
+	g_client_ai_t *ai = &self->client->locals.ai;
+
+	const _Bool reached = ai->path_index >= ai->num_path_points;
+	const _Bool available = ai->goal && ai->goal->in_use && !(ai->goal->sv_flags & SVF_NO_CLIENT);
+
+	if (!reached && available && ai->path_time > g_level.time) {
+		return;
+	}
+
+	if (reached || !available) {
+		ai->goal = G_Ai_PickGoal(self);
+	}
+
+	ai->num_path_points = 0;
+	ai->path_index = 0;
+	ai->path_time = g_level.time + AI_PATH_INTERVAL;
+
+	if (ai->goal) {
+		ai->num_path_points = gi.FindPath(self->s.origin, ai->goal->s.origin, ai->path, AI_MAX_PATH_POINTS);
+	}
+}
+
+/**
+ * @brief Sets the command angles to look at the specified point.
+ */
+static void G_Ai_Look(const g_ai_bot_t *bot, const vec3_t point, pm_cmd_t *cmd) {
+	vec3_t dir, angles, delta_angles;
+
+	VectorSubtract(point, bot->eye, dir);
+	VectorAngles(dir, angles);
+
+	// the command angles are relative to the delta angles of the player state
+	UnpackAngles(bot->self->client->ps.pm_state.delta_angles, delta_angles);
+	VectorSubtract(angles, delta_angles, angles);
+
+	PackAngles(angles, cmd->angles);
+}
+
+/**
+ * @brief Moves toward the next waypoint of the path, jumping up to it if it is
+ * above us. If there is no enemy to look at, we look where we're going.
+ */
+static void G_Ai_Navigate(g_ai_bot_t *bot, const g_entity_t *enemy, pm_cmd_t *cmd) {
+	g_entity_t *self = bot->self;
+	g_client_ai_t *ai = &self->client->locals.ai;
+	vec3_t dir, angles, forward, right;
+
+	G_Ai_UpdatePath(self);
+
+	while (ai->path_index < ai->num_path_points) {
+
+		VectorSubtract(ai->path[ai->path_index], self->s.origin, dir);
+		const vec_t dz = dir[2];
+		dir[2] = 0.0;
+
+		if (VectorLength(dir) > AI_WAYPOINT_DIST || dz > PM_STEP_HEIGHT) {
+			break;
+		}
+
+		ai->path_index++;
+	}
+
+	if (ai->path_index == ai->num_path_points) {
+		return;
+	}
+
+	VectorSubtract(ai->path[ai->path_index], self->s.origin, dir);
+
+	if (dir[2] > PM_STEP_HEIGHT && self->locals.ground_entity) {
+		cmd->up = PM_SPEED_JUMP;
+	}
+
+	dir[2] = 0.0;
+	VectorNormalize(dir);
+
+	if (enemy == NULL) {
+		vec3_t point;
+		VectorAdd(bot->eye, dir, point);
+
+		G_Ai_Look(bot, point, cmd);
+
+		cmd->forward = PM_SPEED_RUN;
+		return;
+	}
+
+	// strafe along the path while looking at the enemy
+	UnpackAngles(cmd->angles, angles);
+	angles[PITCH] = 0.0;
+
+	vec3_t delta_angles;
+	UnpackAngles(self->client->ps.pm_state.delta_angles, delta_angles);
+	VectorAdd(angles, delta_angles, angles);
+
+	AngleVectors(angles, forward, right, NULL);
+
+	cmd->forward = DotProduct(dir, forward) * PM_SPEED_RUN;
+	cmd->right = DotProduct(dir, right) * PM_SPEED_RUN;
+}
+
+/**
+ * @brief Snapshots the clients which bots may perceive, and the bots themselves.
+ * @return The number of bots.
  */
-static void G_Ai_ClientThink(g_entity_t *self) {
-	pm_cmd_t cmd;
+static int32_t G_Ai_Snapshot(void) {
+
+	g_ai.num_targets = 0;
+	g_ai.num_bots = 0;
 
-	memset(&cmd, 0, sizeof(cmd));
-	cmd.msec = gi.frame_millis;
+	for (int32_t i = 1; i <= sv_max_clients->integer; i++) {
+		g_entity_t *ent = &g_game.entities[i];
+
+		if (!ent->in_use || !ent->client) {
+			continue;
+		}
+
+		if (!ent->locals.dead && !ent->client->locals.persistent.spectator) {
+			g_ai_target_t *target = &g_ai.targets[g_ai.num_targets++];
+
+			target->ent = ent;
+			G_Ai_Eye(ent, target->eye);
+		}
+
+		if (ent->ai) {
+			g_ai_bot_t *bot = &g_ai.bots[g_ai.num_bots++];
+
+			bot->self = ent;
+			G_Ai_Eye(ent, bot->eye);
+
+			bot->num_targets = 0;
+		}
+	}
+
+	return g_ai.num_bots;
+}
+
+/**
+ * @brief Perceive phase: chooses the nearest targets in each bot's PVS, and
+ * prepares the traces to test their visibility.
+ */
+static void G_Ai_Perceive(void *data __attribute__((unused)), int32_t begin, int32_t end) {
+	vec_t dist[AI_MAX_TARGETS];
 
-	G_ClientThink(self, &cmd);
+	for (int32_t i = begin; i < end; i++) {
+		g_ai_bot_t *bot = &g_ai.bots[i];
+		const g_entity_t *self = bot->self;
 
-	self->locals.next_think = g_level.time + gi.frame_millis;
+		if (self->locals.dead || self->client->locals.persistent.spectator) {
+			continue;
+		}
+
+		for (int32_t j = 0; j < g_ai.num_targets; j++) {
+			const g_ai_target_t *target = &g_ai.targets[j];
+
+			if (target->ent == self || G_OnSameTeam(self, target->ent)) {
+				continue;
+			}
+
+			vec3_t delta;
+			VectorSubtract(target->eye, bot->eye, delta);
+			const vec_t d = VectorLength(delta);
+
+			if (bot->num_targets == AI_MAX_TARGETS && d >= dist[AI_MAX_TARGETS - 1]) {
+				continue;
+			}
+
+			if (!gi.inPVS(bot->eye, target->eye)) {
+				continue;
+			}
+
+			// insert the target in order of distance, dropping the farthest
+			int32_t k = MIN(bot->num_targets, AI_MAX_TARGETS - 1);
+			for (; k > 0 && dist[k - 1] > d; k--) {
+				dist[k] = dist[k - 1];
+				bot->targets[k] = bot->targets[k - 1];
+			}
+
+			dist[k] = d;
+			bot->targets[k] = j;
+
+			bot->num_targets = MIN(bot->num_targets + 1, AI_MAX_TARGETS);
+		}
+
+		for (int32_t j = 0; j < bot->num_targets; j++) {
+			g_trace_t *trace = &bot->traces[j];
+
+			memset(trace, 0, sizeof(*trace));
+
+			VectorCopy(bot->eye, trace->start);
+			VectorCopy(g_ai.targets[bot->targets[j]].eye, trace->end);
+
+			trace->skip = self;
+			trace->contents = MASK_SOLID;
+		}
+	}
+}
+
+/**
+ * @brief Decide phase: resolves each bot's command from its perception and its
+ * path. Only the bot's own navigation state is written.
+ */
+static void G_Ai_Decide(void *data __attribute__((unused)), int32_t begin, int32_t end) {
+
+	for (int32_t i = begin; i < end; i++) {
+		g_ai_bot_t *bot = &g_ai.bots[i];
+		pm_cmd_t *cmd = &bot->cmd;
+
+		memset(cmd, 0, sizeof(*cmd));
+		cmd->msec = gi.frame_millis;
+
+		if (bot->self->client->locals.persistent.spectator) {
+			continue;
+		}
+
+		if (bot->self->locals.dead) {
+			cmd->buttons = (g_level.frame_num & 1) ? BUTTON_ATTACK : 0; // respawn
+			continue;
+		}
+
+		const g_entity_t *enemy = NULL;
+
+		for (int32_t j = 0; j < bot->num_targets; j++) {
+			if (g_ai.traces[bot->first_trace + j].trace.fraction == 1.0) {
+				const g_ai_target_t *target = &g_ai.targets[bot->targets[j]];
+
+				enemy = target->ent;
+
+				G_Ai_Look(bot, target->eye, cmd);
+				cmd->buttons = BUTTON_ATTACK;
+				break;
+			}
+		}
+
+		G_Ai_Navigate(bot, enemy, cmd);
+	}
+}
+
+/**
+ * @brief Runs all bots for the current frame. Perception and decisions are made
+ * in parallel; the resulting commands are then run in turn.
+ */
+void G_Ai_Frame(void) {
+
+	if (!G_Ai_Snapshot()) {
+		return;
+	}
+
+	gi.ParallelFor(G_Ai_Perceive, NULL, g_ai.num_bots, 1);
+
+	g_ai.num_traces = 0;
+
+	for (int32_t i = 0; i < g_ai.num_bots; i++) {
+		g_ai_bot_t *bot = &g_ai.bots[i];
+
+		bot->first_trace = g_ai.num_traces;
+
+		memcpy(&g_ai.traces[g_ai.num_traces], bot->traces, bot->num_targets * sizeof(g_trace_t));
+		g_ai.num_traces += bot->num_targets;
+	}
+
+	if (g_ai.num_traces) {
+		gi.TraceBatch(g_ai.traces, g_ai.num_traces);
+	}
+
+	gi.ParallelFor(G_Ai_Decide, NULL, g_ai.num_bots, 1);
+
+	for (int32_t i = 0; i < g_ai.num_bots; i++) {
+		g_ai_bot_t *bot = &g_ai.bots[i];
+
+		if (bot->self->in_use) {
+			G_ClientThink(bot->self, &bot->cmd);
+		}
+	}
 }
 
 /**
@@ -46,10 +408,6 @@ static void G_Ai_Spawn(g_entity_t *self) {
 	G_ClientBegin(self);
 
 	gi.Debug("Spawned %s at %s", self->client->locals.persistent.net_name, vtos(self->s.origin));
-
-	self->locals.Think = G_Ai_ClientThink;
-	self->locals.next_think = g_level.time + gi.frame_millis;
-
 }
 
 /**
@@ -25,6 +25,7 @@
 #include "g_types.h"
 
 #ifdef __GAME_LOCAL_H__
+void G_Ai_Frame(void);
 void G_Ai_Init(void);
 void G_Ai_Shutdown(void);
 #endif /* __GAME_LOCAL_H__ */
@@ -218,6 +218,40 @@ void G_BlasterProjectile(g_entity_t *ent, const vec3_t start, const vec3_t dir,
 	gi.LinkEntity(projectile);
 }
 
+/**
+ * @brief Resolves the end point of a bullet fired from start along dir.
+ */
+static void G_BulletProjectile_End(const vec3_t start, const vec3_t dir, uint16_t hspread,
+		uint16_t vspread, vec3_t end) {
+	vec3_t angles, forward, right, up;
+
+	VectorAngles(dir, angles);
+	AngleVectors(angles, forward, right, up);
+
+	VectorMA(start, MAX_WORLD_DIST, forward, end);
+	VectorMA(end, Randomc() * hspread, right, end);
+	VectorMA(end, Randomc() * vspread, up, end);
+}
+
+/**
+ * @brief Applies the damage and effects of a bullet impact.
+ */
+static void G_BulletProjectile_Impact(g_entity_t *ent, const vec3_t start, const vec3_t dir,
+		cm_trace_t *tr, int16_t damage, int16_t knockback, uint32_t mod) {
+
+	if (tr->fraction < 1.0) {
+
+		G_Damage(tr->ent, ent, ent, dir, tr->end, tr->plane.normal, damage, knockback, DMG_BULLET, mod);
+
+		if (G_IsStructural(tr->ent, tr->surface)) {
+			G_BulletMark(tr->end, &tr->plane, tr->surface);
+		}
+
+		if ((gi.PointContents(start) & MASK_LIQUID) || (gi.PointContents(tr->end) & MASK_LIQUID))
+			G_BubbleTrail(start, tr);
+	}
+}
+
 /**
  * @brief
  */
@@ -226,41 +260,71 @@ void G_BulletProjectile(g_entity_t *ent, const vec3_t start, const vec3_t dir, i
 
 	cm_trace_t tr = gi.Trace(ent->s.origin, start, NULL, NULL, ent, MASK_CLIP_PROJECTILE);
 	if (tr.fraction == 1.0) {
-		vec3_t angles, forward, right, up, end;
-
-		VectorAngles(dir, angles);
-		AngleVectors(angles, forward, right, up);
+		vec3_t end;
 
-		VectorMA(start, MAX_WORLD_DIST, forward, end);
-		VectorMA(end, Randomc() * hspread, right, end);
-		VectorMA(end, Randomc() * vspread, up, end);
+		G_BulletProjectile_End(start, dir, hspread, vspread, end);
 
 		tr = gi.Trace(start, end, NULL, NULL, ent, MASK_CLIP_PROJECTILE);
 
 		G_Tracer(start, tr.end);
 	}
 
-	if (tr.fraction < 1.0) {
-
-		G_Damage(tr.ent, ent, ent, dir, tr.end, tr.plane.normal, damage, knockback, DMG_BULLET, mod);
-
-		if (G_IsStructural(tr.ent, tr.surface)) {
-			G_BulletMark(tr.end, &tr.plane, tr.surface);
-		}
-
-		if ((gi.PointContents(start) & MASK_LIQUID) || (gi.PointContents(tr.end) & MASK_LIQUID))
-			G_BubbleTrail(start, &tr);
-	}
+	G_BulletProjectile_Impact(ent, start, dir, &tr, damage, knockback, mod);
 }
 
 /**
- * @brief
+ * @brief Fires the specified number of pellets. The pellets are traced in
+ * batches, and their impacts are then applied in order. A pellet whose target
+ * was freed by an earlier pellet is traced again, so that it impacts whatever
+ * lies beyond.
  */
 void G_ShotgunProjectiles(g_entity_t *ent, const vec3_t start, const vec3_t dir, int16_t damage,
 		int16_t knockback, int32_t hspread, int32_t vspread, int32_t count, uint32_t mod) {
 
-	for (int32_t i = 0; i < count; i++)
-		G_BulletProjectile(ent, start, dir, damage, knockback, hspread, vspread, mod);
+	cm_trace_t tr = gi.Trace(ent->s.origin, start, NULL, NULL, ent, MASK_CLIP_PROJECTILE);
+	while (count > 0 && tr.fraction < 1.0) { // the muzzle is obstructed, so each pellet impacts there
+
+		G_BulletProjectile_Impact(ent, start, dir, &tr, damage, knockback, mod);
+		count--;
+
+		if (tr.ent && !tr.ent->in_use) { // freed by this pellet, so the rest may pass
+			tr = gi.Trace(ent->s.origin, start, NULL, NULL, ent, MASK_CLIP_PROJECTILE);
+		}
+	}
+
+	g_trace_t pellets[32];
+
+	while (count > 0) {
+		const int32_t num_pellets = MIN(count, (int32_t) lengthof(pellets));
+
+		memset(pellets, 0, sizeof(pellets));
+
+		for (int32_t i = 0; i < num_pellets; i++) {
+			g_trace_t *p = &pellets[i];
+
+			VectorCopy(start, p->start);
+			G_BulletProjectile_End(start, dir, hspread, vspread, p->end);
+
+			p->skip = ent;
+			p->contents = MASK_CLIP_PROJECTILE;
+		}
+
+		gi.TraceBatch(pellets, num_pellets);
+
+		for (int32_t i = 0; i < num_pellets; i++) {
+			cm_trace_t *p = &pellets[i].trace;
+
+			if (p->ent && !p->ent->in_use) { // freed by a previous pellet, so trace past it
+				*p = gi.Trace(start, pellets[i].end, NULL, NULL, ent, MASK_CLIP_PROJECTILE);
+			}
+
+			G_Tracer(start, p->end);
+
+			G_BulletProjectile_Impact(ent, start, dir, p, damage, knockback, mod);
+		}
+
+		count -= num_pellets;
+	}
 }
 
 /**
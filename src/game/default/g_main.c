@@ -808,6 +808,9 @@ static void G_Frame(void) {
 	}
 		
 	if (!G_TIMEOUT) {
+		// bots decide before anything moves, as clients do over the network
+		G_Ai_Frame();
+
 		// treat each object in turn
 		// even the world gets a chance to think
 		g_entity_t *ent = &g_game.entities[0];
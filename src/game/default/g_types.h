@@ -710,6 +710,20 @@ typedef struct {
 	uint32_t round_num; // most recent arena round
 } g_client_persistent_t;
 
+#define AI_MAX_PATH_POINTS 64
+
+/**
+ * @brief AI navigation state. Bots follow a path of waypoints toward a goal
+ * entity, and periodically resolve it again as they and the goal move.
+ */
+typedef struct {
+	g_entity_t *goal; // the entity we're navigating toward
+	vec3_t path[AI_MAX_PATH_POINTS];
+	uint16_t num_path_points;
+	uint16_t path_index; // the waypoint we're moving toward
+	uint32_t path_time; // resolve the path again when time > this
+} g_client_ai_t;
+
 /**
  * @brief This structure is cleared on each spawn, with the persistent structure
  * explicitly copied over to preserve team membership, etc. This structure
@@ -789,6 +803,8 @@ typedef struct {
 	g_entity_t *old_chase_target; // player we were chasing
 
 	const g_item_t *last_dropped; // last dropped item, used for variable expansion
+
+	g_client_ai_t ai; // navigation state, for bots
 } g_client_locals_t;
 
 /**
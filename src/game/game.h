@@ -24,7 +24,7 @@
 
 #include "shared.h"
 
-#define GAME_API_VERSION 1
+#define GAME_API_VERSION 4
 
 /**
  * @brief Server flags for g_entity_t.
@@ -149,6 +149,20 @@ struct g_entity_s {
 
 typedef _Bool (*EntityFilterFunc)(const g_entity_t *ent);
 
+typedef void (*GameRangeFunc)(void *data, int32_t begin, int32_t end);
+
+/**
+ * @brief A trace request for gi.TraceBatch. The result is written to `trace`.
+ */
+typedef struct {
+	vec3_t start, end;
+	vec3_t mins, maxs;
+	const g_entity_t *skip;
+	int32_t contents;
+
+	cm_trace_t trace;
+} g_trace_t;
+
 /**
  * @brief The game import provides engine functionality and core configuration
  * such as frame intervals to the game module.
@@ -273,6 +287,30 @@ typedef struct {
 	cm_trace_t (*Trace)(const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs,
 			const g_entity_t *skip, const int32_t contents);
 
+	/**
+	 * @brief Batched collision detection. Each request is resolved exactly as
+	 * if by Trace, but the batch may be spread across the thread pool. This is
+	 * preferable for issuing many independent traces at once (e.g. pellets).
+	 *
+	 * @param traces The trace requests, whose results are written in place.
+	 * @param count The number of trace requests.
+	 */
+	void (*TraceBatch)(g_trace_t *traces, const size_t count);
+
+	/**
+	 * @brief Parallel execution on the engine's thread pool. The range
+	 * [0, count) is divided into ranges of up to `grain` elements, which are
+	 * passed to `func`, possibly concurrently. All ranges have been run when
+	 * this returns. The function may trace and query the world, but must not
+	 * link, unlink or otherwise modify shared state.
+	 *
+	 * @param func The function to run over each range.
+	 * @param data The user data passed to each call.
+	 * @param count The number of elements.
+	 * @param grain The maximum number of elements per range.
+	 */
+	void (*ParallelFor)(GameRangeFunc func, void *data, int32_t count, int32_t grain);
+
 	/**
 	 * @brief PVS and PHS query facilities, returning true if the two points
 	 * can see or hear each other.
@@ -287,6 +325,20 @@ typedef struct {
 	void (*SetAreaPortalState)(int32_t portal_num, _Bool open);
 	_Bool (*AreasConnected)(int32_t area1, int32_t area2);
 
+	/**
+	 * @brief AI navigation. Resolves a path of waypoints through the map's
+	 * navigation graph, if it has one. Paths are cached, so that repeated
+	 * queries between the same areas are cheap.
+	 *
+	 * @param start The starting position.
+	 * @param goal The goal position, which is also the final waypoint.
+	 * @param points The waypoints to populate.
+	 * @param max_points The maximum number of waypoints to populate.
+	 *
+	 * @return The number of waypoints populated, or 0 if no path exists.
+	 */
+	size_t (*FindPath)(const vec3_t start, const vec3_t goal, vec3_t *points, size_t max_points);
+
 	/**
 	 * @brief All solid and trigger entities must be linked when they are
 	 * initialized or moved. Linking resolves their absolute bounding box and
@@ -22,6 +22,7 @@
 #ifndef __SERVER_H__
 #define __SERVER_H__
 
+#include "ai/ai.h"
 #include "collision/cmodel.h"
 #include "console.h"
 #include "filesystem.h"
@@ -371,6 +371,69 @@ static void Sv_Stuff_f(void) {
 	Net_WriteString(&sv_client->net_chan.message, va("%s\n", text));
 }
 
+/**
+ * @brief Prints decompressed vis cache statistics.
+ */
+static void Sv_VisCache_f(void) {
+	cm_vis_cache_stats_t stats;
+
+	Cm_VisCacheStats(&stats);
+
+	const uint64_t lookups = stats.hits + stats.misses;
+
+	Com_Print("Vis cache: %u of %u KB (%s)\n", (uint32_t) (stats.used >> 10),
+			(uint32_t) (stats.size >> 10), stats.full ? "fully expanded" : "LRU");
+	Com_Print("  %d of %d rows cached\n", stats.cached_rows, stats.rows);
+	Com_Print("  %" PRIu64 " hits, %" PRIu64 " misses (%.1f%%)\n", stats.hits, stats.misses,
+			lookups ? 100.0 * stats.hits / lookups : 0.0);
+}
+
+/**
+ * @brief Prints brush de-duplication statistics for box traces, optionally
+ * resetting them.
+ */
+static void Sv_TraceStats_f(void) {
+	extern _Bool cm_trace_stats_enabled;
+	cm_trace_stats_t stats;
+
+	if (!cm_trace_stats_enabled) {
+		Com_Print("Trace statistics are disabled, set sv_trace_stats 1 and restart the level\n");
+		return;
+	}
+
+	Cm_TraceStats(&stats);
+
+	const uint64_t brushes = stats.brushes_tested + stats.brushes_skipped;
+
+	Com_Print("Traces: %" PRIu64 "\n", stats.traces);
+	Com_Print("  %" PRIu64 " brushes tested, %" PRIu64 " skipped (%.1f%%)\n", stats.brushes_tested,
+			stats.brushes_skipped, brushes ? 100.0 * stats.brushes_skipped / brushes : 0.0);
+
+	if (stats.traces) {
+		Com_Print("  %.2f tested, %.2f skipped per trace\n",
+				stats.brushes_tested / (vec_t) stats.traces, stats.brushes_skipped / (vec_t) stats.traces);
+	}
+
+	if (Cmd_Argc() > 1 && !g_strcmp0(Cmd_Argv(1), "reset")) {
+		Cm_ResetTraceStats();
+	}
+}
+
+/**
+ * @brief Compares the performance of the entity broadphases on the current level.
+ */
+static void Sv_BenchmarkBroadphase_f(void) {
+
+	const int32_t count = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : 10000;
+
+	if (count < 1) {
+		Com_Print("Usage: %s [count]\n", Cmd_Argv(0));
+		return;
+	}
+
+	Sv_BenchmarkBroadphase(count);
+}
+
 /**
  * @brief
  */
@@ -381,6 +444,11 @@ void Sv_InitAdmin(void) {
 	Cmd_Add("list_entities", Sv_ListEntities_f, CMD_SERVER, "List all entities in use");
 	Cmd_Add("server_info", Sv_ServerInfo_f, CMD_SERVER, "Print server info settings");
 	Cmd_Add("user_info", Sv_UserInfo_f, CMD_SERVER, "Print information for a given user");
+	Cmd_Add("vis_cache", Sv_VisCache_f, CMD_SERVER, "Print decompressed vis cache statistics");
+	Cmd_Add("trace_stats", Sv_TraceStats_f, CMD_SERVER,
+			"Print brush de-duplication statistics for traces (pass reset to reset them)");
+	Cmd_Add("benchmark_broadphase", Sv_BenchmarkBroadphase_f, CMD_SERVER,
+			"Compare the sector and AABB tree entity broadphases on the current level");
 
 	Cmd_Add("demo", Sv_Demo_f, CMD_SERVER, "Start playback of the specified demo file");
 	Cmd_Add("map", Sv_Map_f, CMD_SERVER, "Start a server for the specified map");
@@ -21,10 +21,21 @@
 
 #include "sv_local.h"
 
+/**
+ * @brief Resolves the entity state at the specified index within the client's
+ * slice of svs.entity_states.
+ */
+static entity_state_t *Sv_ClientEntityState(const sv_client_t *client, const uint32_t index) {
+
+	const size_t slice = (client - svs.clients) * SV_CLIENT_ENTITY_STATES;
+
+	return &svs.entity_states[slice + (index % SV_CLIENT_ENTITY_STATES)];
+}
+
 /**
  * @brief Writes a delta update of an entity_state_t list to the message.
  */
-static void Sv_WriteEntities(sv_frame_t *from, sv_frame_t *to, mem_buf_t *msg) {
+static void Sv_WriteEntities(const sv_client_t *client, sv_frame_t *from, sv_frame_t *to, mem_buf_t *msg) {
 	entity_state_t *old_state = NULL, *new_state = NULL;
 	uint32_t old_index, new_index;
 	uint16_t old_num, new_num;
@@ -41,15 +52,14 @@ static void Sv_WriteEntities(sv_frame_t *from, sv_frame_t *to, mem_buf_t *msg) {
 		if (new_index >= to->num_entities)
 			new_num = 0xffff;
 		else {
-			new_state = &svs.entity_states[(to->entity_state + new_index) % svs.num_entity_states];
+			new_state = Sv_ClientEntityState(client, to->entity_state + new_index);
 			new_num = new_state->number;
 		}
 
 		if (old_index >= from_num_entities)
 			old_num = 0xffff;
 		else {
-			old_state
-					= &svs.entity_states[(from->entity_state + old_index) % svs.num_entity_states];
+			old_state = Sv_ClientEntityState(client, from->entity_state + old_index);
 			old_num = old_state->number;
 		}
 
@@ -130,15 +140,16 @@ void Sv_WriteClientFrame(sv_client_t *client, mem_buf_t *msg) {
 	Sv_WritePlayerState(delta_frame, frame, msg);
 
 	// delta encode the entities
-	Sv_WriteEntities(delta_frame, frame, msg);
+	Sv_WriteEntities(client, delta_frame, frame, msg);
 }
 
 /**
  * @brief Resolve the visibility data for the bounding box around the client. The
  * bounding box provides some leniency because the client's actual view origin
  * is likely slightly different than what we think it is.
+ * @return False if the bounding box touches no leafs, true otherwise.
  */
-static void Sv_ClientVisibility(const vec3_t org, byte *pvs, byte *phs) {
+static _Bool Sv_ClientVisibility(const vec3_t org, byte *pvs, byte *phs) {
 	int32_t leafs[MAX_ENT_LEAFS];
 	int32_t clusters[MAX_ENT_LEAFS];
 	vec3_t mins, maxs;
@@ -147,7 +158,7 @@ static void Sv_ClientVisibility(const vec3_t org, byte *pvs, byte *phs) {
 	clusters[0] = Cm_LeafCluster(leafs[0]);
 
 	// take the first cluster's visibility and hearability
-	Cm_ClusterPVS(clusters[0], pvs);
+	const size_t vis_len = Cm_ClusterPVS(clusters[0], pvs);
 	Cm_ClusterPHS(clusters[0], phs);
 
 	// spread the bounds to account for view offset
@@ -156,9 +167,9 @@ static void Sv_ClientVisibility(const vec3_t org, byte *pvs, byte *phs) {
 		maxs[i] = org[i] + 16.0;
 	}
 
-	const size_t len = Cm_BoxLeafnums(mins, maxs, leafs + 1, sizeof(leafs) - 1, NULL, 0);
+	const size_t len = Cm_BoxLeafnums(mins, maxs, leafs + 1, lengthof(leafs) - 1, NULL, 0);
 	if (len == 0) {
-		Com_Error(ERR_DROP, "Bad leaf count @ %s\n", vtos(org));
+		return false;
 	}
 
 	// convert leafs to clusters and combine their visibility data
@@ -174,25 +185,47 @@ static void Sv_ClientVisibility(const vec3_t org, byte *pvs, byte *phs) {
 		if (j < i) // already got it
 			continue;
 
-		byte cluster_pvs[MAX_BSP_LEAFS >> 3];
-		Cm_ClusterPVS(clusters[i], cluster_pvs);
+		byte cluster_vis[MAX_BSP_LEAFS >> 3];
+
+		Cm_ClusterPVS(clusters[i], cluster_vis);
+		Cm_BitsetOr(pvs, pvs, cluster_vis, vis_len);
+
+		Cm_ClusterPHS(clusters[i], cluster_vis);
+		Cm_BitsetOr(phs, phs, cluster_vis, vis_len);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Ensures that every entity's state carries its own number. This must be
+ * called on the main thread, before client frames are built, as frames for
+ * several clients may be built concurrently and only read entity state.
+ */
+void Sv_CheckEntityNumbers(void) {
+
+	for (uint16_t e = 1; e < svs.game->num_entities; e++) {
+		g_entity_t *ent = ENTITY_FOR_NUM(e);
 
-		for (size_t i = 0; i < sizeof(pvs); i++) {
-			pvs[i] |= cluster_pvs[i];
+		if (ent->s.number != e) {
+			Com_Warn("Fixing entity number: %d -> %d\n", ent->s.number, e);
+			ent->s.number = e;
 		}
 	}
 }
 
 /**
  * @brief Decides which entities are going to be visible to the client, and
- * copies off the player state and area_bits.
+ * copies off the player state and area_bits. This may be called from any
+ * thread, and so must not modify shared state or raise errors.
+ * @return False if the client's visibility could not be resolved, true otherwise.
  */
-void Sv_BuildClientFrame(sv_client_t *client) {
+_Bool Sv_BuildClientFrame(sv_client_t *client) {
 	vec3_t org, off;
 
 	g_entity_t *cent = client->entity;
 	if (!cent->client)
-		return; // not in game yet
+		return true; // not in game yet
 
 	// this is the frame we are creating
 	sv_frame_t *frame = &client->frames[sv.frame_num & PACKET_MASK];
@@ -214,13 +247,40 @@ void Sv_BuildClientFrame(sv_client_t *client) {
 
 	// resolve the visibility data
 	byte pvs[MAX_BSP_LEAFS >> 3], phs[MAX_BSP_LEAFS >> 3];
-	Sv_ClientVisibility(org, pvs, phs);
+	if (!Sv_ClientVisibility(org, pvs, phs)) {
+		frame->num_entities = 0;
+		frame->entity_state = client->next_entity_state;
+		return false;
+	}
+
+	// gather the entities occupying any cluster the client can see or hear
+	byte pvs_phs[MAX_BSP_LEAFS >> 3];
+	const size_t vis_len = (Cm_NumClusters() + 7) >> 3;
+
+	Cm_BitsetOr(pvs_phs, pvs, phs, vis_len);
+
+	byte candidates[MAX_ENTITIES >> 3];
+	memset(candidates, 0, sizeof(candidates));
+
+	Sv_ClusterEntities(pvs_phs, candidates);
+
+	const uint16_t n = NUM_FOR_ENTITY(cent);
+	Cm_BitsetSet(candidates, n);
 
 	// build up the list of relevant entities
 	frame->num_entities = 0;
-	frame->entity_state = svs.next_entity_state;
+	frame->entity_state = client->next_entity_state;
 
 	for (uint16_t e = 1; e < svs.game->num_entities; e++) {
+
+		if (candidates[e >> 3] == 0) { // skip to the next byte of candidates
+			e |= 7;
+			continue;
+		}
+
+		if (!Cm_BitsetTest(candidates, e))
+			continue;
+
 		g_entity_t *ent = ENTITY_FOR_NUM(e);
 
 		// ignore entities that are local to the server
@@ -250,7 +310,7 @@ void Sv_BuildClientFrame(sv_client_t *client) {
 				int32_t i;
 				for (i = 0; i < sent->num_clusters; i++) {
 					const int32_t c = sent->clusters[i];
-					if (vis[c >> 3] & (1 << (c & 7)))
+					if (Cm_BitsetTest(vis, c))
 						break;
 				}
 				if (i == sent->num_clusters)
@@ -259,18 +319,22 @@ void Sv_BuildClientFrame(sv_client_t *client) {
 		}
 
 		// copy it to the circular entity_state_t array
-		entity_state_t *s = &svs.entity_states[svs.next_entity_state % svs.num_entity_states];
-		if (ent->s.number != e) {
-			Com_Warn("Fixing entity number: %d -> %d\n", ent->s.number, e);
-			ent->s.number = e;
-		}
+		entity_state_t *s = Sv_ClientEntityState(client, client->next_entity_state);
 		*s = ent->s;
 
 		// don't mark our own missiles as solid for prediction
 		if (ent->owner == client->entity)
 			s->solid = SOLID_NOT;
 
-		svs.next_entity_state++;
+		client->next_entity_state++;
 		frame->num_entities++;
+
+		// don't wrap the client's entity states, the delta frame may reference them
+		if (frame->num_entities == MAX_PACKET_ENTITIES) {
+			Com_Debug("%s: Too many entities\n", client->name);
+			break;
+		}
 	}
+
+	return true;
 }
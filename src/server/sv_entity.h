@@ -26,7 +26,8 @@
 
 #ifdef __SV_LOCAL_H__
 void Sv_WriteClientFrame(sv_client_t *client, mem_buf_t *msg);
-void Sv_BuildClientFrame(sv_client_t *client);
+void Sv_CheckEntityNumbers(void);
+_Bool Sv_BuildClientFrame(sv_client_t *client);
 #endif /* __SV_LOCAL_H__ */
 
 #endif /* __SV_ENTITY_H__ */
@@ -164,7 +164,7 @@ static _Bool Sv_InPVS(const vec3_t p1, const vec3_t p2) {
 
 	Cm_ClusterPVS(cluster1, pvs);
 
-	if ((pvs[cluster2 >> 3] & (1 << (cluster2 & 7))) == 0)
+	if (!Cm_BitsetTest(pvs, cluster2))
 		return false;
 
 	return true;
@@ -191,7 +191,7 @@ static _Bool Sv_InPHS(const vec3_t p1, const vec3_t p2) {
 
 	Cm_ClusterPHS(cluster1, phs);
 
-	if ((phs[cluster2 >> 3] & (1 << (cluster2 & 7))) == 0)
+	if (!Cm_BitsetTest(phs, cluster2))
 		return false;
 
 	return true;
@@ -208,6 +208,46 @@ static void Sv_Sound(const g_entity_t *ent, const uint16_t index, const uint16_t
 	Sv_PositionedSound(NULL, ent, index, atten);
 }
 
+/**
+ * @brief Sv_ParallelFor context.
+ */
+typedef struct {
+	GameRangeFunc func;
+	void *data;
+} sv_parallel_for_t;
+
+/**
+ * @brief Runs a range of a game module parallel-for. Each range binds a private
+ * box hull, so that it may clip to mesh entities concurrently.
+ */
+static void Sv_ParallelFor_(void *data, int32_t begin, int32_t end) {
+	const sv_parallel_for_t *job = (sv_parallel_for_t *) data;
+
+	const int32_t box_hull = Cm_BindBoxHull();
+
+	job->func(job->data, begin, end);
+
+	Cm_UnbindBoxHull(box_hull);
+}
+
+/**
+ * @brief Runs the specified game module function over [0, count), across the
+ * thread pool when sv_threads is set.
+ */
+static void Sv_ParallelFor(GameRangeFunc func, void *data, int32_t count, int32_t grain) {
+
+	if (sv_threads->integer) {
+		sv_parallel_for_t job = {
+			.func = func,
+			.data = data
+		};
+
+		Task_ParallelFor(Sv_ParallelFor_, &job, count, MAX(grain, 1));
+	} else if (count > 0) {
+		func(data, 0, count);
+	}
+}
+
 static void *game_handle;
 
 /**
@@ -269,12 +309,16 @@ void Sv_InitGame(void) {
 	import.PositionedSound = Sv_PositionedSound;
 
 	import.Trace = Sv_Trace;
+	import.TraceBatch = Sv_TraceBatch;
+	import.ParallelFor = Sv_ParallelFor;
 	import.PointContents = Sv_PointContents;
 	import.inPVS = Sv_InPVS;
 	import.inPHS = Sv_InPHS;
 	import.SetAreaPortalState = Cm_SetAreaPortalState;
 	import.AreasConnected = Cm_AreasConnected;
 
+	import.FindPath = Ai_FindPath;
+
 	import.LinkEntity = Sv_LinkEntity;
 	import.UnlinkEntity = Sv_UnlinkEntity;
 	import.BoxEntities = Sv_BoxEntities;
@@ -147,6 +147,7 @@ static void Sv_ClearState() {
  */
 static void Sv_UpdateLatchedVars(void) {
 	extern _Bool cm_no_areas;
+	extern _Bool cm_trace_stats_enabled;
 
 	Cvar_UpdateLatched();
 
@@ -155,6 +156,10 @@ static void Sv_UpdateLatchedVars(void) {
 	sv_hz->integer = Clamp(sv_hz->integer, SV_HZ_MIN, SV_HZ_MAX);
 
 	cm_no_areas = sv_no_areas->integer;
+
+	cm_trace_stats_enabled = sv_trace_stats->integer;
+
+	Cm_SetVisCacheSize(MAX(sv_vis_cache->integer, 0) * 1024 * 1024);
 }
 
 /**
@@ -200,7 +205,7 @@ static void Sv_InitEntities(void) {
 		svs.clients = Mem_TagMalloc(sizeof(sv_client_t) * sv_max_clients->integer, MEM_TAG_SERVER);
 
 		// and the entity states array
-		svs.num_entity_states = sv_max_clients->integer * PACKET_BACKUP * MAX_PACKET_ENTITIES;
+		svs.num_entity_states = sv_max_clients->integer * SV_CLIENT_ENTITY_STATES;
 		svs.entity_states = Mem_TagMalloc(sizeof(entity_state_t) * svs.num_entity_states, MEM_TAG_SERVER);
 
 		svs.frame_rate = sv_hz->integer;
@@ -251,6 +256,8 @@ static void Sv_LoadMedia(const char *server, sv_state_t state) {
 	if (state == SV_ACTIVE_DEMO) { // loading a demo
 		sv.cm_models[0] = Cm_LoadBspModel(NULL, &bsp_size);
 
+		Ai_FreeAas();
+
 		sv.demo_file = Fs_OpenRead(va("demos/%s.demo", sv.name));
 		svs.spawn_count = 0;
 
@@ -260,6 +267,8 @@ static void Sv_LoadMedia(const char *server, sv_state_t state) {
 
 		sv.cm_models[0] = Cm_LoadBspModel(sv.config_strings[CS_MODELS], &bsp_size);
 
+		Ai_LoadAas(va("maps/%s.aas", sv.name));
+
 		const char *dir = Fs_RealDir(sv.config_strings[CS_MODELS]);
 		if (g_str_has_suffix(dir, ".pk3")) {
 			g_strlcpy(sv.config_strings[CS_ZIP], Basename(dir), MAX_STRING_CHARS);
@@ -375,6 +384,8 @@ void Sv_ShutdownServer(const char *msg) {
 
 	Sv_ShutdownMasters();
 
+	Ai_FreeAas();
+
 	Sv_ClearState();
 
 	Net_Config(NS_UDP_SERVER, false);
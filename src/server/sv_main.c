@@ -27,6 +27,7 @@ sv_server_t sv; // per-level server info
 
 sv_client_t *sv_client; // current client
 
+cvar_t *sv_broadphase;
 cvar_t *sv_download_url;
 cvar_t *sv_enforce_time;
 cvar_t *sv_hostname;
@@ -35,8 +36,11 @@ cvar_t *sv_max_clients;
 cvar_t *sv_no_areas;
 cvar_t *sv_public;
 cvar_t *sv_rcon_password; // password for remote server commands
+cvar_t *sv_threads;
 cvar_t *sv_timeout;
+cvar_t *sv_trace_stats;
 cvar_t *sv_udp_download;
+cvar_t *sv_vis_cache;
 
 /**
  * @brief Called when the player is totally leaving the server, either willingly
@@ -772,6 +776,9 @@ static void Sv_InitLocal(void) {
 
 	sv_rcon_password = Cvar_Get("rcon_password", "", 0, NULL);
 
+	sv_broadphase = Cvar_Get("sv_broadphase", "0", CVAR_LATCH,
+			"Entity broadphase: 0 for the sector tree, 1 for the dynamic AABB tree\n");
+
 	sv_download_url = Cvar_Get("sv_download_url", "", CVAR_SERVER_INFO, NULL);
 	sv_enforce_time = Cvar_Get("sv_enforce_time", va("%d", CMD_MSEC_MAX_DRIFT_ERRORS), 0, NULL);
 
@@ -784,9 +791,16 @@ static void Sv_InitLocal(void) {
 
 	sv_max_clients = Cvar_Get("sv_max_clients", "8", CVAR_SERVER_INFO | CVAR_LATCH, NULL);
 
+	sv_threads = Cvar_Get("sv_threads", "1", 0, "Use the thread pool for client frames, batched traces and bot AI\n");
+
 	sv_timeout = Cvar_Get("sv_timeout", va("%d", SV_TIMEOUT), 0, NULL);
+	sv_trace_stats = Cvar_Get("sv_trace_stats", "0", CVAR_LATCH,
+			"Collect brush de-duplication statistics for traces (see trace_stats)\n");
 	sv_udp_download = Cvar_Get("sv_udp_download", "1", CVAR_ARCHIVE, NULL);
 
+	sv_vis_cache = Cvar_Get("sv_vis_cache", "16", CVAR_LATCH,
+			"Memory budget for decompressed PVS and PHS, in megabytes (0 disables)\n");
+
 	// set this so clients and server browsers can see it
 	Cvar_Get("sv_protocol", va("%i", PROTOCOL_MAJOR), CVAR_SERVER_INFO | CVAR_NO_SET, NULL);
 }
@@ -807,6 +821,8 @@ void Sv_Init(void) {
 	Sv_InitAdmin();
 
 	Sv_InitMasters();
+
+	Ai_Init();
 }
 
 /**
@@ -818,6 +834,8 @@ void Sv_Shutdown(const char *msg) {
 
 	Sv_ShutdownConsole();
 
+	Ai_Shutdown();
+
 	memset(&svs, 0, sizeof(svs));
 
 	Cmd_RemoveAll(CMD_SERVER);
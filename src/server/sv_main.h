@@ -30,6 +30,7 @@ void Sv_Frame(const uint32_t msec);
 
 #ifdef __SV_LOCAL_H__
 // cvars
+extern cvar_t *sv_broadphase;
 extern cvar_t *sv_download_url;
 extern cvar_t *sv_enforce_time;
 extern cvar_t *sv_hostname;
@@ -38,8 +39,11 @@ extern cvar_t *sv_max_clients;
 extern cvar_t *sv_no_areas;
 extern cvar_t *sv_public;
 extern cvar_t *sv_rcon_password;
+extern cvar_t *sv_threads;
 extern cvar_t *sv_timeout;
+extern cvar_t *sv_trace_stats;
 extern cvar_t *sv_udp_download;
+extern cvar_t *sv_vis_cache;
 
 // per-level and static server structures
 extern sv_server_t sv;
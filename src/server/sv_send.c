@@ -144,6 +144,18 @@ static void Sv_ClientDatagramMessage(sv_client_t *cl, byte *data, size_t len) {
 	}
 }
 
+/**
+ * @brief Writes the specified multicast message to the given client.
+ */
+static void Sv_MulticastMessage(sv_client_t *cl, byte *data, size_t size, const _Bool reliable) {
+
+	if (reliable) {
+		Mem_WriteBuffer(&cl->net_chan.message, data, size);
+	} else {
+		Sv_ClientDatagramMessage(cl, data, size);
+	}
+}
+
 /**
  * @brief Sends the contents of the mutlicast buffer to a single client
  */
@@ -159,19 +171,41 @@ void Sv_Unicast(const g_entity_t *ent, const _Bool reliable) {
 
 		sv_client_t *cl = svs.clients + (n - 1);
 
-		if (reliable) {
-			Mem_WriteBuffer(&cl->net_chan.message, sv.multicast.data, sv.multicast.size);
-		} else {
-			Sv_ClientDatagramMessage(cl, sv.multicast.data, sv.multicast.size);
-		}
+		Sv_MulticastMessage(cl, sv.multicast.data, sv.multicast.size, reliable);
 	}
 
 	Mem_ClearBuffer(&sv.multicast);
 }
 
+/**
+ * @return The view cluster and area of the specified client, which are only
+ * resolved again if the client's view origin has changed.
+ */
+static const sv_multicast_view_t *Sv_MulticastView(const sv_client_t *cl) {
+	sv_multicast_view_t *view = &sv.multicast_views[cl - svs.clients];
+
+	const pm_state_t *pm = &cl->entity->client->ps.pm_state;
+	vec3_t org, off;
+
+	UnpackVector(pm->view_offset, off);
+	VectorAdd(pm->origin, off, org);
+
+	if (!view->valid || !VectorCompare(org, view->origin)) {
+		const int32_t leaf = Cm_PointLeafnum(org, 0);
+
+		VectorCopy(org, view->origin);
+		view->cluster = Cm_LeafCluster(leaf);
+		view->area = Cm_LeafArea(leaf);
+		view->valid = true;
+	}
+
+	return view;
+}
+
 /**
  * @brief Sends the contents of sv.multicast to a subset of the clients,
- * then clears sv.multicast.
+ * then clears sv.multicast. The view cluster and area of each client are
+ * resolved again only if its view origin has changed.
  */
 void Sv_Multicast(const vec3_t origin, multicast_t to, EntityFilterFunc filter) {
 	byte vis[MAX_BSP_LEAFS >> 3];
@@ -233,20 +267,12 @@ void Sv_Multicast(const vec3_t origin, multicast_t to, EntityFilterFunc filter)
 			continue;
 
 		if (to != MULTICAST_ALL && to != MULTICAST_ALL_R) {
-			const pm_state_t *pm = &cl->entity->client->ps.pm_state;
-			vec3_t org, off;
-
-			UnpackVector(pm->view_offset, off);
-			VectorAdd(pm->origin, off, org);
+			const sv_multicast_view_t *view = Sv_MulticastView(cl);
 
-			const int32_t leaf = Cm_PointLeafnum(org, 0);
-
-			const int32_t client_area = Cm_LeafArea(leaf);
-			if (!Cm_AreasConnected(area, client_area))
+			if (!Cm_AreasConnected(area, view->area))
 				continue;
 
-			const int32_t cluster = Cm_LeafCluster(leaf);
-			if (!(vis[cluster >> 3] & (1 << (cluster & 7))))
+			if (!Cm_BitsetTest(vis, view->cluster))
 				continue;
 		}
 
@@ -256,11 +282,7 @@ void Sv_Multicast(const vec3_t origin, multicast_t to, EntityFilterFunc filter)
 			}
 		}
 
-		if (reliable) {
-			Mem_WriteBuffer(&cl->net_chan.message, sv.multicast.data, sv.multicast.size);
-		} else {
-			Sv_ClientDatagramMessage(cl, sv.multicast.data, sv.multicast.size);
-		}
+		Sv_MulticastMessage(cl, sv.multicast.data, sv.multicast.size, reliable);
 	}
 
 	Mem_ClearBuffer(&sv.multicast);
@@ -331,29 +353,108 @@ void Sv_PositionedSound(const vec3_t origin, const g_entity_t *ent, const uint16
 }
 
 /**
- * @brief
+ * @brief A job building and encoding the frames of a subset of clients.
+ */
+typedef struct {
+	sv_client_t **clients;
+	size_t num_clients;
+	size_t first, stride;
+	sv_client_t *bad_client; // a client whose visibility could not be resolved
+} sv_client_frames_job_t;
+
+/**
+ * @brief Builds and delta compresses the frame for each client of the job.
+ * Each client writes to its own slice of svs.entity_states and its own frame
+ * message, so jobs may run concurrently. Failures are recorded in the job, and
+ * raised by the calling thread once all jobs have completed.
+ */
+static void Sv_BuildClientFrames_(void *data) {
+	sv_client_frames_job_t *job = (sv_client_frames_job_t *) data;
+
+	for (size_t i = job->first; i < job->num_clients; i += job->stride) {
+		sv_client_t *cl = job->clients[i];
+
+		if (!Sv_BuildClientFrame(cl)) {
+			job->bad_client = cl;
+			continue;
+		}
+
+		Mem_InitBuffer(&cl->frame_message, cl->frame_message_buffer, sizeof(cl->frame_message_buffer));
+		cl->frame_message.allow_overflow = true;
+
+		// send over all the relevant entity_state_t and the player_state_t
+		Sv_WriteClientFrame(cl, &cl->frame_message);
+	}
+}
+
+/**
+ * @brief Builds and encodes the frames for the specified clients. If
+ * sv_threads is set, the clients are distributed across the thread pool.
+ */
+static void Sv_BuildClientFrames(sv_client_t **clients, const size_t num_clients) {
+	sv_client_frames_job_t jobs[MAX_THREADS + 1];
+	thread_t *threads[MAX_THREADS];
+
+	if (num_clients == 0)
+		return;
+
+	// the cluster index and entity numbers must be current before any jobs are dispatched
+	Sv_UpdateClusterIndex();
+	Sv_CheckEntityNumbers();
+
+	size_t num_jobs = 1;
+	if (sv_threads->integer) {
+		num_jobs = MIN((size_t) Thread_Count() + 1, num_clients);
+	}
+
+	for (size_t i = 0; i < num_jobs; i++) {
+		jobs[i].clients = clients;
+		jobs[i].num_clients = num_clients;
+		jobs[i].first = i;
+		jobs[i].stride = num_jobs;
+		jobs[i].bad_client = NULL;
+	}
+
+	// dispatch all but the last job to the thread pool, running that one here
+	for (size_t i = 0; i < num_jobs - 1; i++) {
+		threads[i] = Thread_Create(Sv_BuildClientFrames_, &jobs[i]);
+	}
+
+	Sv_BuildClientFrames_(&jobs[num_jobs - 1]);
+
+	for (size_t i = 0; i < num_jobs - 1; i++) {
+		Thread_Wait(threads[i]);
+	}
+
+	for (size_t i = 0; i < num_jobs; i++) {
+		if (jobs[i].bad_client) {
+			Com_Error(ERR_DROP, "Bad leaf count for %s\n", jobs[i].bad_client->name);
+		}
+	}
+}
+
+/**
+ * @brief Packetizes the client's frame message and datagram, and transmits them.
  */
 static void Sv_SendClientDatagram(sv_client_t *cl) {
 	byte buffer[MAX_MSG_SIZE];
 	mem_buf_t buf;
 
-	Sv_BuildClientFrame(cl);
-
 	Mem_InitBuffer(&buf, buffer, sizeof(buffer));
 	buf.allow_overflow = true;
 
 	// accumulate the total size for rate throttling
 	size_t frame_size = 0;
 
-	// send over all the relevant entity_state_t and the player_state_t
-	Sv_WriteClientFrame(cl, &buf);
-
 	// the frame itself (player state and delta entities) must fit into a single message,
 	// since it is parsed as a single command by the client
-	if (buf.overflowed || buf.size > MAX_MSG_SIZE - 16) {
-		Com_Error(ERR_DROP, "Frame exceeds MAX_MSG_SIZE (%u)\n", (uint32_t) buf.size);
+	const mem_buf_t *frame = &cl->frame_message;
+	if (frame->overflowed || frame->size > MAX_MSG_SIZE - 16) {
+		Com_Error(ERR_DROP, "Frame exceeds MAX_MSG_SIZE (%u)\n", (uint32_t) frame->size);
 	}
 
+	Mem_WriteBuffer(&buf, frame->data, frame->size);
+
 	// but we can packetize the remaining datagram messages, which are parsed individually
 	const GList *e = cl->datagram.messages;
 	while (e) {
@@ -462,14 +563,41 @@ static size_t Sv_GetDemoMessage(byte *buffer) {
 
 /**
  * @brief Send the frame and all pending datagram messages since the last frame.
+ * Frames for active clients are built and encoded first, potentially in
+ * parallel, and then transmitted serially.
  */
 void Sv_SendClientPackets(void) {
+	sv_client_t *clients[MAX_CLIENTS];
+	size_t num_clients = 0;
 	sv_client_t * cl;
 	int32_t i;
 
 	if (!svs.initialized)
 		return;
 
+	// resolve the clients to receive a game packet, enforcing rate throttle
+	if (sv.state != SV_ACTIVE_DEMO) {
+		for (i = 0, cl = svs.clients; i < sv_max_clients->integer; i++, cl++) {
+
+			if (cl->state != SV_CLIENT_ACTIVE)
+				continue;
+
+			if (cl->net_chan.message.overflowed) // will be dropped below
+				continue;
+
+			if (Sv_RateDrop(cl)) {
+				cl->frame_size[sv.frame_num % sv_hz->integer] = 0;
+				continue;
+			}
+
+			clients[num_clients++] = cl;
+		}
+	}
+
+	Sv_BuildClientFrames(clients, num_clients);
+
+	size_t j = 0;
+
 	// send a message to each connected client
 	for (i = 0, cl = svs.clients; i < sv_max_clients->integer; i++, cl++) {
 
@@ -492,10 +620,9 @@ void Sv_SendClientPackets(void) {
 			}
 		} else if (cl->state == SV_CLIENT_ACTIVE) { // send the game packet
 
-			if (Sv_RateDrop(cl)) { // enforce rate throttle
-				cl->frame_size[sv.frame_num % sv_hz->integer] = 0;
-			} else {
+			if (j < num_clients && clients[j] == cl) { // a frame was built, so send it
 				Sv_SendClientDatagram(cl);
+				j++;
 			}
 
 			// clean up for the next frame
@@ -513,4 +640,3 @@ void Sv_SendClientPackets(void) {
 		}
 	}
 }
-
@@ -59,6 +59,12 @@ typedef struct {
 	matrix4x4_t inverse_matrix;
 } sv_entity_t;
 
+/**
+ * @brief Each client owns a slice of svs.entity_states large enough to hold
+ * its entire frame backup, so that client frames may be built concurrently.
+ */
+#define SV_CLIENT_ENTITY_STATES (PACKET_BACKUP * MAX_PACKET_ENTITIES)
+
 /**
  * @brief Server states.
  */
@@ -69,6 +75,17 @@ typedef enum {
 	SV_ACTIVE_DEMO
 } sv_state_t;
 
+/**
+ * @brief A client's view leaf cluster and area, resolved for multicasts only
+ * when the client's view origin changes.
+ */
+typedef struct {
+	vec3_t origin;
+	int32_t cluster;
+	int32_t area;
+	_Bool valid;
+} sv_multicast_view_t;
+
 /**
  * @brief The sv_server_t struct is wiped at each level load.
  */
@@ -92,6 +109,9 @@ typedef struct {
 	mem_buf_t multicast;
 	byte multicast_buffer[MAX_MSG_SIZE];
 
+	// the view cluster and area of each client, for PVS and PHS multicasts
+	sv_multicast_view_t multicast_views[MAX_CLIENTS];
+
 	// demo server information
 	file_t *demo_file;
 } sv_server_t;
@@ -101,7 +121,7 @@ typedef struct {
 	byte area_bits[MAX_BSP_AREAS >> 3]; // portal area visibility bits
 	player_state_t ps;
 	uint16_t num_entities;
-	uint32_t entity_state; // index into svs.entity_states array
+	uint32_t entity_state; // index into the client's slice of svs.entity_states
 	uint32_t sent_time; // for ping calculations
 } sv_frame_t;
 
@@ -211,6 +231,12 @@ typedef struct {
 	sv_client_datagram_t datagram;
 
 	sv_frame_t frames[PACKET_BACKUP]; // updates can be delta'd from here
+	uint32_t next_entity_state; // next entity_state to use in this client's slice
+
+	// the frame message is built and delta compressed concurrently with other
+	// clients' frames, and is then packetized along with the datagram
+	mem_buf_t frame_message;
+	byte frame_message_buffer[MAX_MSG_SIZE];
 
 	sv_client_download_t download; // UDP file downloads
 
@@ -262,8 +288,7 @@ typedef struct {
 	// the size of this array is based on the number of clients we might be
 	// asked to support at any point in time during the current game
 
-	uint32_t num_entity_states; // sv_max_clients->integer * UPDATE_BACKUP * MAX_PACKET_ENTITIES
-	uint32_t next_entity_state; // next entity_state to use for newly spawned entities
+	uint32_t num_entity_states; // sv_max_clients->integer * SV_CLIENT_ENTITY_STATES
 	entity_state_t *entity_states; // entity states array used for delta compression
 
 	net_addr_t masters[MAX_MASTERS];
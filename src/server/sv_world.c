@@ -37,23 +37,78 @@ typedef struct sv_sector_s {
 #define SECTOR_NODES	32
 
 /**
- * @brief The world structure contains all sectors and also the current query
- * context issued to Sv_BoxEntities.
+ * @brief Alternatively, entities are kept in a dynamic AABB tree, selected by
+ * sv_broadphase. The nodes are stored contiguously, and each leaf holds one
+ * entity in a box fattened by TREE_MARGIN, so that entities moving within
+ * their fattened box need not be reinserted when they are relinked.
  */
 typedef struct {
-	sv_sector_t sectors[SECTOR_NODES];
-	uint16_t num_sectors;
+	vec3_t mins, maxs;
+	int32_t parent; // or the next free node
+	int32_t children[2]; // -1 for leafs
+	int32_t height; // 0 for leafs, -1 for free nodes
+	uint16_t entity; // the entity number, for leafs
+} sv_tree_node_t;
+
+#define TREE_NODES	(MAX_ENTITIES * 2)
+#define TREE_MARGIN	8.0
+#define TREE_STACK	256
+
+/**
+ * @brief The dynamic AABB tree.
+ */
+typedef struct {
+	sv_tree_node_t nodes[TREE_NODES];
+	int32_t root;
+	int32_t free_node;
 
-	const vec_t *box_mins, *box_maxs;
+	int32_t leafs[MAX_ENTITIES]; // by entity number, -1 if not in the tree
+} sv_tree_t;
 
-	g_entity_t **box_entities;
-	size_t num_box_entities, max_box_entities;
+/**
+ * @brief The world structure contains all sectors and the AABB tree.
+ */
+typedef struct {
+	sv_sector_t sectors[SECTOR_NODES];
+	uint16_t num_sectors;
 
-	uint32_t box_type; // BOX_SOLID, BOX_TRIGGER, ..
+	_Bool use_tree; // true to use the AABB tree rather than sectors
+	sv_tree_t tree;
 } sv_world_t;
 
 static sv_world_t sv_world;
 
+/**
+ * @brief The query context issued to Sv_BoxEntities. Queries do not modify the
+ * world, and so may be issued concurrently.
+ */
+typedef struct {
+	const vec_t *mins, *maxs;
+
+	g_entity_t **entities;
+	size_t num_entities, max_entities;
+
+	uint32_t type; // BOX_SOLID, BOX_TRIGGER, ..
+} sv_box_query_t;
+
+/**
+ * @brief The cluster index maps each PVS cluster to the entities occupying it,
+ * so that client frames need only consider the entities within their
+ * potentially visible set. It is rebuilt at most once per frame, and only if
+ * entities have been linked or unlinked since it was last built.
+ */
+typedef struct {
+	uint32_t first_entity[MAX_BSP_LEAFS + 1]; // offsets into entities, by cluster
+	uint16_t entities[MAX_ENTITIES * MAX_ENT_CLUSTERS]; // entity numbers, grouped by cluster
+
+	uint16_t top_node_entities[MAX_ENTITIES]; // entities exceeding MAX_ENT_CLUSTERS
+	uint16_t num_top_node_entities;
+
+	_Bool dirty;
+} sv_cluster_index_t;
+
+static sv_cluster_index_t sv_cluster_index;
+
 /**
  * @brief Builds a uniformly subdivided tree for the given world size.
  */
@@ -89,6 +144,375 @@ static sv_sector_t *Sv_CreateSector(int32_t depth, vec3_t mins, vec3_t maxs) {
 	return sector;
 }
 
+/**
+ * @brief Resets the AABB tree, chaining all of its nodes to the free list.
+ */
+static void Sv_InitTree(void) {
+	sv_tree_t *tree = &sv_world.tree;
+
+	for (int32_t i = 0; i < TREE_NODES; i++) {
+		tree->nodes[i].parent = i + 1 < TREE_NODES ? i + 1 : -1;
+		tree->nodes[i].height = -1;
+	}
+
+	tree->root = -1;
+	tree->free_node = 0;
+
+	for (int32_t i = 0; i < MAX_ENTITIES; i++) {
+		tree->leafs[i] = -1;
+	}
+}
+
+/**
+ * @return A node from the free list of the AABB tree.
+ */
+static int32_t Sv_AllocTreeNode(void) {
+	sv_tree_t *tree = &sv_world.tree;
+
+	const int32_t index = tree->free_node;
+	if (index == -1) {
+		Com_Error(ERR_DROP, "TREE_NODES exhausted\n");
+	}
+
+	sv_tree_node_t *node = &tree->nodes[index];
+
+	tree->free_node = node->parent;
+
+	node->parent = -1;
+	node->children[0] = node->children[1] = -1;
+	node->height = 0;
+
+	return index;
+}
+
+/**
+ * @brief Returns the specified node to the free list of the AABB tree.
+ */
+static void Sv_FreeTreeNode(const int32_t index) {
+	sv_tree_t *tree = &sv_world.tree;
+
+	tree->nodes[index].parent = tree->free_node;
+	tree->nodes[index].height = -1;
+
+	tree->free_node = index;
+}
+
+/**
+ * @return The surface area heuristic cost of the specified bounds.
+ */
+static vec_t Sv_TreeCost(const vec3_t mins, const vec3_t maxs) {
+	vec3_t size;
+
+	VectorSubtract(maxs, mins, size);
+
+	return 2.0 * (size[0] * size[1] + size[1] * size[2] + size[2] * size[0]);
+}
+
+/**
+ * @brief Sets the bounds of the specified node to the union of its children.
+ */
+static void Sv_FitTreeNode(const int32_t index) {
+	sv_tree_node_t *nodes = sv_world.tree.nodes;
+	sv_tree_node_t *node = &nodes[index];
+
+	const sv_tree_node_t *a = &nodes[node->children[0]];
+	const sv_tree_node_t *b = &nodes[node->children[1]];
+
+	for (int32_t i = 0; i < 3; i++) {
+		node->mins[i] = MIN(a->mins[i], b->mins[i]);
+		node->maxs[i] = MAX(a->maxs[i], b->maxs[i]);
+	}
+
+	node->height = 1 + MAX(a->height, b->height);
+}
+
+/**
+ * @brief Rotates the subtree at the specified node, if it is imbalanced.
+ *
+ * @return The index of the node now at the root of the subtree.
+ */
+static int32_t Sv_BalanceTreeNode(const int32_t a) {
+	sv_tree_t *tree = &sv_world.tree;
+	sv_tree_node_t *nodes = tree->nodes;
+
+	if (nodes[a].height < 2)
+		return a;
+
+	const int32_t b = nodes[a].children[0];
+	const int32_t c = nodes[a].children[1];
+
+	const int32_t balance = nodes[c].height - nodes[b].height;
+
+	if (balance > 1 || balance < -1) {
+
+		// promote the taller child, x, in place of a
+		const int32_t x = balance > 1 ? c : b;
+		const int32_t y = balance > 1 ? b : c;
+
+		const int32_t f = nodes[x].children[0];
+		const int32_t g = nodes[x].children[1];
+
+		nodes[x].children[0] = a;
+		nodes[x].parent = nodes[a].parent;
+		nodes[a].parent = x;
+
+		if (nodes[x].parent == -1) {
+			tree->root = x;
+		} else if (nodes[nodes[x].parent].children[0] == a) {
+			nodes[nodes[x].parent].children[0] = x;
+		} else {
+			nodes[nodes[x].parent].children[1] = x;
+		}
+
+		// and demote the shorter of its children beneath a
+		const int32_t tall = nodes[f].height > nodes[g].height ? f : g;
+		const int32_t short_ = tall == f ? g : f;
+
+		nodes[x].children[1] = tall;
+		nodes[a].children[0] = y;
+		nodes[a].children[1] = short_;
+		nodes[short_].parent = a;
+
+		Sv_FitTreeNode(a);
+		Sv_FitTreeNode(x);
+
+		return x;
+	}
+
+	return a;
+}
+
+/**
+ * @brief Walks from the specified node to the root of the AABB tree, balancing
+ * and fitting each node along the way.
+ */
+static void Sv_RefitTree(int32_t index) {
+	sv_tree_node_t *nodes = sv_world.tree.nodes;
+
+	while (index != -1) {
+		index = Sv_BalanceTreeNode(index);
+
+		Sv_FitTreeNode(index);
+
+		index = nodes[index].parent;
+	}
+}
+
+/**
+ * @brief Inserts the specified leaf into the AABB tree, pairing it with the
+ * sibling that minimizes the growth in surface area of the tree.
+ */
+static void Sv_InsertTreeLeaf(const int32_t leaf) {
+	sv_tree_t *tree = &sv_world.tree;
+	sv_tree_node_t *nodes = tree->nodes;
+
+	if (tree->root == -1) {
+		tree->root = leaf;
+		nodes[leaf].parent = -1;
+		return;
+	}
+
+	const vec_t *mins = nodes[leaf].mins, *maxs = nodes[leaf].maxs;
+	vec3_t union_mins, union_maxs;
+
+	// descend to the best sibling
+	int32_t index = tree->root;
+	while (nodes[index].height > 0) {
+		const sv_tree_node_t *node = &nodes[index];
+
+		for (int32_t i = 0; i < 3; i++) {
+			union_mins[i] = MIN(node->mins[i], mins[i]);
+			union_maxs[i] = MAX(node->maxs[i], maxs[i]);
+		}
+
+		const vec_t area = Sv_TreeCost(node->mins, node->maxs);
+		const vec_t union_area = Sv_TreeCost(union_mins, union_maxs);
+
+		// the cost of pairing with this node, and the cost inherited by descending
+		const vec_t cost = 2.0 * union_area;
+		const vec_t inherited = 2.0 * (union_area - area);
+
+		vec_t child_cost[2];
+		for (int32_t c = 0; c < 2; c++) {
+			const sv_tree_node_t *child = &nodes[node->children[c]];
+
+			for (int32_t i = 0; i < 3; i++) {
+				union_mins[i] = MIN(child->mins[i], mins[i]);
+				union_maxs[i] = MAX(child->maxs[i], maxs[i]);
+			}
+
+			child_cost[c] = Sv_TreeCost(union_mins, union_maxs) + inherited;
+			if (child->height > 0) {
+				child_cost[c] -= Sv_TreeCost(child->mins, child->maxs);
+			}
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+			break;
+
+		index = child_cost[0] < child_cost[1] ? node->children[0] : node->children[1];
+	}
+
+	const int32_t sibling = index;
+	const int32_t old_parent = nodes[sibling].parent;
+	const int32_t new_parent = Sv_AllocTreeNode();
+
+	nodes[new_parent].parent = old_parent;
+	nodes[new_parent].children[0] = sibling;
+	nodes[new_parent].children[1] = leaf;
+
+	nodes[sibling].parent = new_parent;
+	nodes[leaf].parent = new_parent;
+
+	if (old_parent == -1) {
+		tree->root = new_parent;
+	} else if (nodes[old_parent].children[0] == sibling) {
+		nodes[old_parent].children[0] = new_parent;
+	} else {
+		nodes[old_parent].children[1] = new_parent;
+	}
+
+	Sv_RefitTree(new_parent);
+}
+
+/**
+ * @brief Removes the specified leaf from the AABB tree, replacing its parent
+ * with its sibling.
+ */
+static void Sv_RemoveTreeLeaf(const int32_t leaf) {
+	sv_tree_t *tree = &sv_world.tree;
+	sv_tree_node_t *nodes = tree->nodes;
+
+	if (leaf == tree->root) {
+		tree->root = -1;
+		return;
+	}
+
+	const int32_t parent = nodes[leaf].parent;
+	const int32_t grand_parent = nodes[parent].parent;
+
+	const int32_t sibling = nodes[parent].children[0] == leaf ?
+		nodes[parent].children[1] : nodes[parent].children[0];
+
+	nodes[sibling].parent = grand_parent;
+
+	if (grand_parent == -1) {
+		tree->root = sibling;
+	} else {
+		if (nodes[grand_parent].children[0] == parent) {
+			nodes[grand_parent].children[0] = sibling;
+		} else {
+			nodes[grand_parent].children[1] = sibling;
+		}
+
+		Sv_RefitTree(grand_parent);
+	}
+
+	Sv_FreeTreeNode(parent);
+}
+
+/**
+ * @brief Links the specified entity into the AABB tree. Entities already in
+ * the tree are only reinserted if they have left their fattened bounds.
+ */
+static void Sv_LinkTreeEntity(const g_entity_t *ent) {
+	sv_tree_t *tree = &sv_world.tree;
+
+	const uint16_t n = NUM_FOR_ENTITY(ent);
+	int32_t leaf = tree->leafs[n];
+
+	if (leaf == -1) {
+		leaf = tree->leafs[n] = Sv_AllocTreeNode();
+		tree->nodes[leaf].entity = n;
+	} else {
+		const sv_tree_node_t *node = &tree->nodes[leaf];
+
+		if (node->mins[0] <= ent->abs_mins[0] && node->maxs[0] >= ent->abs_maxs[0] &&
+			node->mins[1] <= ent->abs_mins[1] && node->maxs[1] >= ent->abs_maxs[1] &&
+			node->mins[2] <= ent->abs_mins[2] && node->maxs[2] >= ent->abs_maxs[2]) {
+			return; // still within its fattened bounds
+		}
+
+		Sv_RemoveTreeLeaf(leaf);
+	}
+
+	sv_tree_node_t *node = &tree->nodes[leaf];
+
+	for (int32_t i = 0; i < 3; i++) {
+		node->mins[i] = ent->abs_mins[i] - TREE_MARGIN;
+		node->maxs[i] = ent->abs_maxs[i] + TREE_MARGIN;
+	}
+
+	node->children[0] = node->children[1] = -1;
+	node->height = 0;
+
+	Sv_InsertTreeLeaf(leaf);
+}
+
+/**
+ * @brief Removes the specified entity from the AABB tree.
+ *
+ * @return True if the entity was in the tree, false otherwise.
+ */
+static _Bool Sv_UnlinkTreeEntity(const uint16_t n) {
+	sv_tree_t *tree = &sv_world.tree;
+
+	const int32_t leaf = tree->leafs[n];
+	if (leaf == -1)
+		return false;
+
+	Sv_RemoveTreeLeaf(leaf);
+	Sv_FreeTreeNode(leaf);
+
+	tree->leafs[n] = -1;
+	return true;
+}
+
+/**
+ * @brief Links the specified entity into the first sector that its box crosses.
+ */
+static void Sv_LinkSectorEntity(g_entity_t *ent) {
+
+	sv_entity_t *sent = &sv.entities[NUM_FOR_ENTITY(ent)];
+
+	sv_sector_t *sector = sv_world.sectors;
+	while (true) {
+
+		if (sector->axis == -1)
+			break;
+
+		if (ent->abs_mins[sector->axis] > sector->dist)
+			sector = sector->children[0];
+		else if (ent->abs_maxs[sector->axis] < sector->dist)
+			sector = sector->children[1];
+		else
+			break; // crosses the node
+	}
+
+	sent->sector = sector;
+	sector->entities = g_list_prepend(sector->entities, ent);
+}
+
+/**
+ * @brief Removes the specified entity from its sector.
+ *
+ * @return True if the entity was in a sector, false otherwise.
+ */
+static _Bool Sv_UnlinkSectorEntity(g_entity_t *ent) {
+
+	sv_entity_t *sent = &sv.entities[NUM_FOR_ENTITY(ent)];
+
+	if (sent->sector) {
+		sv_sector_t *sector = (sv_sector_t *) sent->sector;
+		sector->entities = g_list_remove(sector->entities, ent);
+
+		sent->sector = NULL;
+		return true;
+	}
+
+	return false;
+}
+
 /**
  * @brief Resolve our area nodes for a newly loaded level. This is called prior to
  * linking any entities.
@@ -102,6 +526,13 @@ void Sv_InitWorld(void) {
 	memset(&sv_world, 0, sizeof(sv_world));
 
 	Sv_CreateSector(0, sv.cm_models[0]->mins, sv.cm_models[0]->maxs);
+
+	Sv_InitTree();
+
+	sv_world.use_tree = sv_broadphase->integer == 1;
+
+	sv_cluster_index.num_top_node_entities = 0;
+	sv_cluster_index.dirty = true;
 }
 
 /**
@@ -110,13 +541,12 @@ void Sv_InitWorld(void) {
  */
 void Sv_UnlinkEntity(g_entity_t *ent) {
 
-	sv_entity_t *sent = &sv.entities[NUM_FOR_ENTITY(ent)];
+	const uint16_t n = NUM_FOR_ENTITY(ent);
 
-	if (sent->sector) {
-		sv_sector_t *sector = (sv_sector_t *) sent->sector;
-		sector->entities = g_list_remove(sector->entities, ent);
+	sv_cluster_index.dirty = true;
 
-		memset(sent, 0, sizeof(*sent));
+	if (Sv_UnlinkSectorEntity(ent) || Sv_UnlinkTreeEntity(n)) {
+		memset(&sv.entities[n], 0, sizeof(sv_entity_t));
 	}
 }
 
@@ -133,8 +563,16 @@ void Sv_LinkEntity(g_entity_t *ent) {
 	if (ent == svs.game->entities) // never bother with the world
 		return;
 
-	// remove it from its current sector
-	Sv_UnlinkEntity(ent);
+	sv_cluster_index.dirty = true;
+
+	// remove it from its current sector; tree leafs are refit below
+	if (Sv_UnlinkSectorEntity(ent)) {
+		memset(&sv.entities[NUM_FOR_ENTITY(ent)], 0, sizeof(sv_entity_t));
+	}
+
+	if (!ent->in_use || ent->solid == SOLID_NOT) {
+		Sv_UnlinkEntity(ent);
+	}
 
 	if (!ent->in_use) // and if its free, we're done
 		return;
@@ -241,25 +679,13 @@ void Sv_LinkEntity(g_entity_t *ent) {
 	if (ent->solid == SOLID_NOT)
 		return;
 
-	// find the first sector that the ent's box crosses
-	sv_sector_t *sector = sv_world.sectors;
-	while (true) {
-
-		if (sector->axis == -1)
-			break;
-
-		if (ent->abs_mins[sector->axis] > sector->dist)
-			sector = sector->children[0];
-		else if (ent->abs_maxs[sector->axis] < sector->dist)
-			sector = sector->children[1];
-		else
-			break; // crosses the node
+	// add it to the broadphase
+	if (sv_world.use_tree) {
+		Sv_LinkTreeEntity(ent);
+	} else {
+		Sv_LinkSectorEntity(ent);
 	}
 
-	// add it to the sector
-	sent->sector = sector;
-	sector->entities = g_list_prepend(sector->entities, ent);
-
 	// and update its clipping matrices
 	const vec_t *angles = ent->solid == SOLID_BSP ? ent->s.angles : vec3_origin;
 
@@ -268,21 +694,129 @@ void Sv_LinkEntity(g_entity_t *ent) {
 }
 
 /**
- * @return True if the entity matches the current world filter, false otherwise.
+ * @brief Rebuilds the cluster index from the clusters resolved for each entity
+ * in Sv_LinkEntity. Entities are bucketed by cluster with a counting sort, so
+ * that each cluster's entities are contiguous and in ascending order.
+ */
+static void Sv_BuildClusterIndex(void) {
+
+	sv_cluster_index_t *index = &sv_cluster_index;
+
+	const int32_t num_clusters = Cm_NumClusters();
+
+	memset(index->first_entity, 0, sizeof(uint32_t) * (num_clusters + 1));
+	index->num_top_node_entities = 0;
+
+	// count the entities occupying each cluster
+	for (uint16_t e = 1; e < svs.game->num_entities; e++) {
+		const sv_entity_t *sent = &sv.entities[e];
+
+		if (sent->num_clusters == -1) {
+			index->top_node_entities[index->num_top_node_entities++] = e;
+			continue;
+		}
+
+		for (int32_t i = 0; i < sent->num_clusters; i++) {
+			const int32_t c = sent->clusters[i];
+			if (c >= 0 && c < num_clusters) {
+				index->first_entity[c]++;
+			}
+		}
+	}
+
+	// accumulate the counts so that each cluster points to the end of its range
+	for (int32_t c = 1; c < num_clusters; c++) {
+		index->first_entity[c] += index->first_entity[c - 1];
+	}
+
+	if (num_clusters) {
+		index->first_entity[num_clusters] = index->first_entity[num_clusters - 1];
+	}
+
+	// and fill the ranges back to front, leaving each cluster at its start
+	for (uint16_t e = svs.game->num_entities - 1; e > 0; e--) {
+		const sv_entity_t *sent = &sv.entities[e];
+
+		for (int32_t i = 0; i < sent->num_clusters; i++) {
+			const int32_t c = sent->clusters[i];
+			if (c >= 0 && c < num_clusters) {
+				index->entities[--index->first_entity[c]] = e;
+			}
+		}
+	}
+
+	index->dirty = false;
+}
+
+/**
+ * @brief Rebuilds the cluster index if entities have been linked or unlinked
+ * since it was last built. This must be called prior to building client
+ * frames concurrently.
+ */
+void Sv_UpdateClusterIndex(void) {
+
+	if (sv_cluster_index.dirty) {
+		Sv_BuildClusterIndex();
+	}
+}
+
+/**
+ * @brief Marks the entities occupying any of the clusters set in `vis` in the
+ * specified entity bit vector. Entities which exceed MAX_ENT_CLUSTERS are
+ * always marked, as their visibility must be resolved via their top_node.
+ *
+ * @remarks `entities` must be at least `MAX_ENTITIES >> 3` in length.
+ */
+void Sv_ClusterEntities(const byte *vis, byte *entities) {
+
+	const sv_cluster_index_t *index = &sv_cluster_index;
+
+	Sv_UpdateClusterIndex();
+
+	const int32_t num_clusters = Cm_NumClusters();
+
+	for (int32_t i = 0; i < num_clusters; i += 8) {
+
+		if (vis[i >> 3] == 0) // skip empty bytes quickly
+			continue;
+
+		for (int32_t c = i; c < i + 8 && c < num_clusters; c++) {
+
+			if (!Cm_BitsetTest(vis, c))
+				continue;
+
+			const uint16_t *e = index->entities + index->first_entity[c];
+			const uint16_t *end = index->entities + index->first_entity[c + 1];
+
+			while (e < end) {
+				Cm_BitsetSet(entities, *e);
+				e++;
+			}
+		}
+	}
+
+	for (uint16_t i = 0; i < index->num_top_node_entities; i++) {
+		const uint16_t e = index->top_node_entities[i];
+		Cm_BitsetSet(entities, e);
+	}
+}
+
+/**
+ * @return True if the entity matches the query filter, false otherwise.
  */
-static _Bool Sv_BoxEntities_Filter(const g_entity_t *ent) {
+static _Bool Sv_BoxEntities_Filter(const sv_box_query_t *query, const g_entity_t *ent) {
 
 	switch (ent->solid) {
 		case SOLID_TRIGGER:
 		case SOLID_PROJECTILE:
-			if (sv_world.box_type & BOX_OCCUPY)
+			if (query->type & BOX_OCCUPY)
 				return true;
 			break;
 
 		case SOLID_DEAD:
 		case SOLID_BOX:
 		case SOLID_BSP:
-			if (sv_world.box_type & BOX_COLLIDE)
+			if (query->type & BOX_COLLIDE)
 				return true;
 			break;
 
@@ -294,66 +828,124 @@ static _Bool Sv_BoxEntities_Filter(const g_entity_t *ent) {
 }
 
 /**
- * @brief
+ * @brief Appends the entity to the query results if it matches the query.
+ *
+ * @return False if the query results are full, true otherwise.
  */
-static void Sv_BoxEntities_r(sv_sector_t *sector) {
-
-	GList *e = sector->entities;
-	while (e) {
-		g_entity_t *ent = (g_entity_t *) e->data;
+static _Bool Sv_BoxEntities_Append(sv_box_query_t *query, g_entity_t *ent) {
 
-		if (Sv_BoxEntities_Filter(ent)) {
+	if (Sv_BoxEntities_Filter(query, ent)) {
 
-			if (BoxIntersect(ent->abs_mins, ent->abs_maxs, sv_world.box_mins, sv_world.box_maxs)) {
+		if (BoxIntersect(ent->abs_mins, ent->abs_maxs, query->mins, query->maxs)) {
 
-				sv_world.box_entities[sv_world.num_box_entities] = ent;
-				sv_world.num_box_entities++;
+			query->entities[query->num_entities] = ent;
+			query->num_entities++;
 
-				if (sv_world.num_box_entities == sv_world.max_box_entities) {
-					Com_Warn("sv_world.max_box_entities reached\n");
-					return;
-				}
+			if (query->num_entities == query->max_entities) {
+				Com_Warn("max_entities reached\n");
+				return false;
 			}
 		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Populates the query results with entities from the sector tree.
+ *
+ * @return False if the query results are full, true otherwise.
+ */
+static _Bool Sv_BoxEntities_r(sv_box_query_t *query, sv_sector_t *sector) {
+
+	GList *e = sector->entities;
+	while (e) {
+		if (!Sv_BoxEntities_Append(query, (g_entity_t *) e->data)) {
+			return false;
+		}
 
 		e = e->next;
 	}
 
 	if (sector->axis == -1)
-		return; // terminal node
+		return true; // terminal node
 
 	// recurse down both sides
-	if (sv_world.box_maxs[sector->axis] > sector->dist)
-		Sv_BoxEntities_r(sector->children[0]);
+	if (query->maxs[sector->axis] > sector->dist) {
+		if (!Sv_BoxEntities_r(query, sector->children[0]))
+			return false;
+	}
+
+	if (query->mins[sector->axis] < sector->dist) {
+		if (!Sv_BoxEntities_r(query, sector->children[1]))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Populates the query results with entities from the AABB tree.
+ */
+static void Sv_BoxEntities_Tree(sv_box_query_t *query) {
+	const sv_tree_node_t *nodes = sv_world.tree.nodes;
+	int32_t stack[TREE_STACK];
+	int32_t depth = 0;
+
+	if (sv_world.tree.root == -1)
+		return;
+
+	stack[depth++] = sv_world.tree.root;
+
+	while (depth) {
+		const sv_tree_node_t *node = &nodes[stack[--depth]];
+
+		if (!BoxIntersect(node->mins, node->maxs, query->mins, query->maxs))
+			continue;
+
+		if (node->height > 0) {
+			if (depth + 2 > TREE_STACK) {
+				Com_Warn("TREE_STACK exceeded\n");
+				return;
+			}
 
-	if (sv_world.box_mins[sector->axis] < sector->dist)
-		Sv_BoxEntities_r(sector->children[1]);
+			stack[depth++] = node->children[1];
+			stack[depth++] = node->children[0];
+			continue;
+		}
+
+		if (!Sv_BoxEntities_Append(query, ENTITY_FOR_NUM(node->entity))) {
+			return;
+		}
+	}
 }
 
 /**
  * @brief Populates an array of entities with those which have bounding boxes
  * that intersect the given area. It is possible for a non-axial BSP model to
- * be returned that doesn't actually intersect the area.
+ * be returned that doesn't actually intersect the area. This may be called
+ * concurrently, so long as no entities are linked or unlinked meanwhile.
  *
  * @return The number of entities found.
  */
 size_t Sv_BoxEntities(const vec3_t mins, const vec3_t maxs, g_entity_t **list, const size_t len,
 		const uint32_t type) {
 
-	sv_world.box_mins = mins;
-	sv_world.box_maxs = maxs;
-	sv_world.box_entities = list;
-	sv_world.num_box_entities = 0;
-	sv_world.max_box_entities = len;
-	sv_world.box_type = type;
+	sv_box_query_t query = {
+		.mins = mins,
+		.maxs = maxs,
+		.entities = list,
+		.max_entities = len,
+		.type = type
+	};
 
-	Sv_BoxEntities_r(sv_world.sectors);
-	
-	sv_world.box_mins = vec3_origin;
-	sv_world.box_maxs = vec3_origin;
-	sv_world.box_entities = NULL;
+	if (sv_world.use_tree) {
+		Sv_BoxEntities_Tree(&query);
+	} else {
+		Sv_BoxEntities_r(&query, sv_world.sectors);
+	}
 
-	return sv_world.num_box_entities;
+	return query.num_entities;
 }
 
 /**
@@ -542,3 +1134,144 @@ cm_trace_t Sv_Trace(const vec3_t start, const vec3_t end, const vec3_t mins, con
 
 	return trace.trace;
 }
+
+/**
+ * @brief The number of requests claimed at a time by Sv_TraceBatch workers.
+ */
+#define TRACE_BATCH_CHUNK 4
+
+/**
+ * @brief Resolves the trace requests in [begin, end). Each range binds a
+ * private box hull, so that it may clip to mesh entities concurrently.
+ */
+static void Sv_TraceBatch_(void *data, int32_t begin, int32_t end) {
+	g_trace_t *traces = (g_trace_t *) data;
+
+	const int32_t box_hull = Cm_BindBoxHull();
+
+	for (int32_t i = begin; i < end; i++) {
+		g_trace_t *t = &traces[i];
+		t->trace = Sv_Trace(t->start, t->end, t->mins, t->maxs, t->skip, t->contents);
+	}
+
+	Cm_UnbindBoxHull(box_hull);
+}
+
+/**
+ * @brief Resolves the specified trace requests, fanning them out across the
+ * thread pool when sv_threads is set. Each request is traced exactly as if by
+ * Sv_Trace. Entities must not be linked or unlinked until the batch returns.
+ */
+void Sv_TraceBatch(g_trace_t *traces, const size_t count) {
+
+	if (sv_threads->integer) {
+		Task_ParallelFor(Sv_TraceBatch_, traces, (int32_t) count, TRACE_BATCH_CHUNK);
+	} else {
+		for (size_t i = 0; i < count; i++) {
+			g_trace_t *t = &traces[i];
+			t->trace = Sv_Trace(t->start, t->end, t->mins, t->maxs, t->skip, t->contents);
+		}
+	}
+}
+
+/**
+ * @brief Moves every entity in the broadphase to either the sectors or the
+ * AABB tree.
+ */
+static void Sv_SetBroadphase(const _Bool use_tree) {
+
+	for (uint16_t i = 1; i < svs.game->num_entities; i++) {
+		g_entity_t *ent = ENTITY_FOR_NUM(i);
+
+		if (Sv_UnlinkSectorEntity(ent) || Sv_UnlinkTreeEntity(i)) {
+			if (use_tree) {
+				Sv_LinkTreeEntity(ent);
+			} else {
+				Sv_LinkSectorEntity(ent);
+			}
+		}
+	}
+
+	sv_world.use_tree = use_tree;
+}
+
+/**
+ * @brief Compares the sector and AABB tree broadphases by issuing the same
+ * random box queries and traces, between points near the solid entities of
+ * the current level, against each.
+ */
+void Sv_BenchmarkBroadphase(const uint32_t count) {
+	static const vec3_t mins = { -16.0, -16.0, -24.0 };
+	static const vec3_t maxs = { 16.0, 16.0, 32.0 };
+
+	if (sv.state != SV_ACTIVE_GAME) {
+		Com_Print("No level loaded\n");
+		return;
+	}
+
+	uint16_t solids[MAX_ENTITIES];
+	size_t num_solids = 0;
+
+	for (uint16_t i = 1; i < svs.game->num_entities; i++) {
+		const g_entity_t *ent = ENTITY_FOR_NUM(i);
+
+		if (ent->in_use && ent->solid != SOLID_NOT) {
+			solids[num_solids++] = i;
+		}
+	}
+
+	if (!num_solids) {
+		Com_Print("No solid entities\n");
+		return;
+	}
+
+	vec3_t *points = Mem_Malloc(count * 2 * sizeof(vec3_t));
+
+	for (uint32_t i = 0; i < count * 2; i++) {
+		const g_entity_t *ent = ENTITY_FOR_NUM(solids[(uint32_t) Random() % num_solids]);
+
+		for (int32_t j = 0; j < 3; j++) {
+			points[i][j] = ent->s.origin[j] + Randomc() * 256.0;
+		}
+	}
+
+	const _Bool use_tree = sv_world.use_tree;
+
+	for (int32_t i = 0; i < 2; i++) {
+		g_entity_t *entities[MAX_ENTITIES];
+		size_t num_entities = 0;
+		vec_t fraction = 0.0;
+
+		Sv_SetBroadphase(i == 1);
+
+		gint64 start = g_get_monotonic_time();
+
+		for (uint32_t j = 0; j < count; j++) {
+			vec3_t box_mins, box_maxs;
+
+			ClearBounds(box_mins, box_maxs);
+			AddPointToBounds(points[j * 2 + 0], box_mins, box_maxs);
+			AddPointToBounds(points[j * 2 + 1], box_mins, box_maxs);
+
+			num_entities += Sv_BoxEntities(box_mins, box_maxs, entities, lengthof(entities), BOX_ALL);
+		}
+
+		const gint64 box_time = g_get_monotonic_time() - start;
+
+		start = g_get_monotonic_time();
+
+		for (uint32_t j = 0; j < count; j++) {
+			fraction += Sv_Trace(points[j * 2 + 0], points[j * 2 + 1], mins, maxs, NULL, MASK_CLIP_PLAYER).fraction;
+		}
+
+		const gint64 trace_time = g_get_monotonic_time() - start;
+
+		Com_Print("%s: %u boxes in %.2fms (%u entities), %u traces in %.2fms (%.2f mean fraction)\n",
+				sv_world.use_tree ? "AABB tree" : "Sectors", count, box_time / 1000.0,
+				(uint32_t) num_entities, count, trace_time / 1000.0, fraction / count);
+	}
+
+	Sv_SetBroadphase(use_tree);
+
+	Mem_Free(points);
+}
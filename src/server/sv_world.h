@@ -28,11 +28,15 @@
 void Sv_InitWorld(void);
 void Sv_LinkEntity(g_entity_t *ent);
 void Sv_UnlinkEntity(g_entity_t *ent);
+void Sv_UpdateClusterIndex(void);
+void Sv_ClusterEntities(const byte *vis, byte *entities);
 size_t Sv_BoxEntities(const vec3_t mins, const vec3_t maxs, g_entity_t **list, const size_t len,
 		const uint32_t type);
 int32_t Sv_PointContents(const vec3_t p);
+void Sv_BenchmarkBroadphase(const uint32_t count);
 cm_trace_t Sv_Trace(const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs,
 		const g_entity_t *skip, const int32_t contents);
+void Sv_TraceBatch(g_trace_t *traces, const size_t count);
 
 #endif /* __SV_LOCAL_H__ */
 
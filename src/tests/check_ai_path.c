@@ -0,0 +1,211 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "tests.h"
+#include "ai/ai_local.h"
+
+#define NUM_AREAS 6
+#define NUM_CLUSTERS 3
+
+/*
+ * A line of five areas, 0 through 4, linked by walking in both directions, and
+ * an isolated area, 5. Areas 0 to 2 are cluster 0, 3 and 4 are cluster 1, and 5
+ * is cluster 2.
+ */
+static struct {
+	d_aas_header_t header;
+	d_aas_area_t areas[NUM_AREAS];
+	d_aas_reachability_t reachability[8];
+	int32_t leaf_areas[1];
+	d_aas_cluster_t clusters[NUM_CLUSTERS];
+	uint16_t routes[NUM_CLUSTERS * NUM_CLUSTERS];
+} aas;
+
+/**
+ * @brief Sets the specified lump of the synthetic AAS file.
+ */
+static void lump(int32_t lump, const void *data, size_t len) {
+
+	aas.header.lumps[lump].file_ofs = LittleLong((int32_t) ((const byte *) data - (const byte *) &aas));
+	aas.header.lumps[lump].file_len = LittleLong((int32_t) len);
+}
+
+/**
+ * @brief Setup fixture.
+ */
+void setup(void) {
+
+	Mem_Init();
+
+	memset(&aas, 0, sizeof(aas));
+
+	aas.header.ident = LittleLong(AAS_IDENT);
+	aas.header.version = LittleLong(AAS_VERSION);
+
+	int32_t num_reachability = 0;
+
+	for (int32_t i = 0; i < NUM_AREAS; i++) {
+		d_aas_area_t *area = &aas.areas[i];
+
+		area->flags = AAS_AREA_GROUNDED;
+		area->cluster = i < 3 ? 0 : i < 5 ? 1 : 2;
+		VectorSet(area->origin, i * 64.0, 0.0, 0.0);
+
+		area->first_reachability = num_reachability;
+
+		for (int32_t j = i - 1; j <= i + 1; j += 2) {
+			if (i < 5 && j >= 0 && j < 5) {
+				d_aas_reachability_t *reach = &aas.reachability[num_reachability++];
+
+				reach->travel = AAS_TRAVEL_WALK;
+				reach->area = j;
+				reach->cost = 64;
+				VectorSet(reach->end, j * 64.0, 0.0, 0.0);
+
+				area->num_reachability++;
+			}
+		}
+	}
+
+	aas.leaf_areas[0] = AAS_INVALID_AREA;
+
+	memset(aas.routes, 0xff, sizeof(aas.routes));
+
+	for (int32_t i = 0; i < NUM_CLUSTERS; i++) {
+		aas.routes[i * NUM_CLUSTERS + i] = i;
+	}
+
+	aas.routes[0 * NUM_CLUSTERS + 1] = 1;
+	aas.routes[1 * NUM_CLUSTERS + 0] = 0;
+
+	lump(AAS_LUMP_AREAS, aas.areas, sizeof(aas.areas));
+	lump(AAS_LUMP_REACHABILITY, aas.reachability, num_reachability * sizeof(d_aas_reachability_t));
+	lump(AAS_LUMP_LEAF_AREAS, aas.leaf_areas, sizeof(aas.leaf_areas));
+	lump(AAS_LUMP_CLUSTERS, aas.clusters, sizeof(aas.clusters));
+	lump(AAS_LUMP_ROUTES, aas.routes, sizeof(aas.routes));
+}
+
+/**
+ * @brief Teardown fixture.
+ */
+void teardown(void) {
+
+	Ai_FreeAas();
+
+	Mem_Shutdown();
+}
+
+START_TEST(check_Ai_InitAas)
+	{
+		aas.header.version = LittleLong(AAS_VERSION - 1);
+		ck_assert_msg(!Ai_InitAas(&aas, sizeof(aas)), "Accepted an old AAS version");
+
+		aas.header.version = LittleLong(AAS_VERSION);
+		ck_assert_msg(!Ai_InitAas(&aas, sizeof(aas.header) + 4), "Accepted a truncated AAS file");
+
+		ck_assert_msg(Ai_InitAas(&aas, sizeof(aas)), "Failed to load a valid AAS file");
+		ck_assert_int_eq(NUM_AREAS, ai_aas.num_areas);
+		ck_assert_int_eq(NUM_CLUSTERS, ai_aas.num_clusters);
+	}END_TEST
+
+START_TEST(check_Ai_ReachabilityCost)
+	{
+		aas.reachability[0].cost = LittleLong(1);
+
+		ck_assert(Ai_InitAas(&aas, sizeof(aas)));
+
+		const d_aas_reachability_t *reach = &ai_aas.reachability[0];
+		ck_assert_msg(reach->cost >= 64, "Reachability costs less than its distance: %d", reach->cost);
+	}END_TEST
+
+START_TEST(check_Ai_AreaPath)
+	{
+		int32_t reachability[16];
+
+		ck_assert(Ai_InitAas(&aas, sizeof(aas)));
+
+		ck_assert_int_eq(4, Ai_AreaPath(0, 4, reachability, lengthof(reachability)));
+
+		int32_t area = 0;
+		for (int32_t i = 0; i < 4; i++) {
+			const d_aas_reachability_t *reach = &ai_aas.reachability[reachability[i]];
+
+			ck_assert(reachability[i] >= ai_aas.areas[area].first_reachability);
+			ck_assert_int_eq(area + 1, reach->area);
+
+			area = reach->area;
+		}
+
+		ck_assert_int_eq(4, Ai_AreaPath(4, 0, reachability, lengthof(reachability)));
+		ck_assert_int_eq(0, Ai_AreaPath(2, 2, reachability, lengthof(reachability)));
+
+		ck_assert_int_eq(-1, Ai_AreaPath(0, 5, reachability, lengthof(reachability)));
+		ck_assert_int_eq(-1, Ai_AreaPath(5, 0, reachability, lengthof(reachability)));
+		ck_assert_int_eq(-1, Ai_AreaPath(0, NUM_AREAS, reachability, lengthof(reachability)));
+	}END_TEST
+
+START_TEST(check_Ai_PathCache)
+	{
+		int32_t reachability[16];
+		ai_path_stats_t stats;
+
+		ck_assert(Ai_InitAas(&aas, sizeof(aas)));
+
+		Ai_AreaPath(0, 4, reachability, lengthof(reachability));
+		Ai_AreaPath(0, 4, reachability, lengthof(reachability));
+		Ai_AreaPath(0, 5, reachability, lengthof(reachability));
+		Ai_AreaPath(0, 5, reachability, lengthof(reachability));
+
+		Ai_PathStats(&stats);
+
+		ck_assert_uint_eq(2, stats.hits);
+		ck_assert_uint_eq(2, stats.misses);
+		ck_assert_uint_eq(2, stats.paths);
+
+		Ai_FreePaths();
+		Ai_PathStats(&stats);
+
+		ck_assert_uint_eq(0, stats.paths);
+	}END_TEST
+
+/**
+ * @brief Test entry point.
+ */
+int32_t main(int32_t argc, char **argv) {
+
+	Test_Init(argc, argv);
+
+	TCase *tcase = tcase_create("check_ai_path");
+	tcase_add_checked_fixture(tcase, setup, teardown);
+
+	tcase_add_test(tcase, check_Ai_InitAas);
+	tcase_add_test(tcase, check_Ai_ReachabilityCost);
+	tcase_add_test(tcase, check_Ai_AreaPath);
+	tcase_add_test(tcase, check_Ai_PathCache);
+
+	Suite *suite = suite_create("check_ai_path");
+	suite_add_tcase(suite, tcase);
+
+	int32_t failed = Test_Run(suite);
+
+	Test_Shutdown();
+	return failed;
+}
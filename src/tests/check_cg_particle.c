@@ -0,0 +1,196 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "tests.h"
+#include "cg_local.h"
+
+/*
+ * The reference loops must not be fused either, or they would round differently
+ * than the kernels on targets with FMA.
+ */
+#if defined(__clang__)
+ #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+ #pragma GCC optimize ("fp-contract=off")
+#endif
+
+#define PARTICLES 256
+
+static vec_t a[PARTICLES + 1], b[PARTICLES + 1], c[PARTICLES + 1], d[PARTICLES + 1];
+static vec_t out[4][PARTICLES + 1], reference[4][PARTICLES + 1];
+
+static uint32_t live[PARTICLES], reference_live[PARTICLES];
+
+/**
+ * @return A reproducible random value in [-1, 1], which is exactly 0 one time
+ * in eight, to exercise the comparisons of Cg_ParticleLive.
+ */
+static vec_t Rand(void) {
+
+	if ((rand() & 7) == 0) {
+		return 0.0;
+	}
+
+	return (rand() / (vec_t) RAND_MAX) * 2.0 - 1.0;
+}
+
+/**
+ * @brief Setup fixture.
+ */
+void setup(void) {
+
+	srand(1);
+
+	for (size_t i = 0; i < lengthof(a); i++) {
+		a[i] = Rand();
+		b[i] = Rand();
+		c[i] = Rand() * 1024.0;
+		d[i] = rand() & 1 ? -INFINITY : Rand() * 1024.0;
+	}
+}
+
+/**
+ * @brief Teardown fixture.
+ */
+void teardown(void) {
+
+}
+
+START_TEST(check_Cg_ParticleMA)
+	{
+		// exercise the kernel's tail, at aligned and unaligned offsets
+		for (size_t offset = 0; offset < 2; offset++) {
+			for (uint32_t count = 0; count + offset < PARTICLES; count++) {
+
+				memcpy(out[0], c, sizeof(c));
+				memcpy(reference[0], c, sizeof(c));
+
+				Cg_ParticleMA(out[0] + offset, a + offset, 0.016, count);
+
+				for (uint32_t i = 0; i < count; i++) {
+					reference[0][offset + i] += a[offset + i] * (vec_t) 0.016;
+				}
+
+				ck_assert(!memcmp(out[0], reference[0], sizeof(c)));
+			}
+		}
+	}END_TEST
+
+START_TEST(check_Cg_ParticleMove)
+	{
+		const vec_t delta = 0.016, delta_squared = delta * delta;
+
+		for (size_t offset = 0; offset < 2; offset++) {
+			for (uint32_t count = 0; count + offset < PARTICLES; count++) {
+
+				memcpy(out[0], c, sizeof(c)); // origin
+				memcpy(out[1], d, sizeof(d)); // end
+				memcpy(out[2], a, sizeof(a)); // velocity
+
+				memcpy(reference[0], c, sizeof(c));
+				memcpy(reference[1], d, sizeof(d));
+				memcpy(reference[2], a, sizeof(a));
+
+				Cg_ParticleMove(out[0] + offset, out[1] + offset, out[2] + offset, b + offset,
+						delta, delta_squared, count);
+
+				for (uint32_t i = offset; i < offset + count; i++) {
+					const vec_t move = reference[2][i] * delta + b[i] * delta_squared;
+
+					reference[0][i] += move;
+					reference[1][i] += move;
+
+					reference[2][i] += b[i] * delta;
+				}
+
+				for (int32_t j = 0; j < 3; j++) {
+					ck_assert_msg(!memcmp(out[j], reference[j], sizeof(c)), "Field %d of %u", j, count);
+				}
+			}
+		}
+	}END_TEST
+
+START_TEST(check_Cg_ParticleLive)
+	{
+		for (size_t offset = 0; offset < 2; offset++) {
+			for (uint32_t count = 0; count + offset < PARTICLES; count++) {
+
+				const vec_t *alpha = a + offset, *scale = b + offset;
+				const vec_t *z = c + offset, *end_z = d + offset;
+
+				uint32_t num_reference_live = 0;
+				for (uint32_t i = 0; i < count; i++) {
+					if (alpha[i] > 0.0 && scale[i] > 0.0 && z[i] > end_z[i]) {
+						reference_live[num_reference_live++] = i;
+					}
+				}
+
+				const uint32_t num_live = Cg_ParticleLive(alpha, scale, z, end_z, count, live);
+
+				ck_assert_uint_eq(num_live, num_reference_live);
+				ck_assert(!memcmp(live, reference_live, num_live * sizeof(uint32_t)));
+			}
+		}
+	}END_TEST
+
+START_TEST(check_Cg_ParticleCompact)
+	{
+		for (uint32_t count = 0; count < PARTICLES; count++) {
+
+			const uint32_t num_live = Cg_ParticleLive(a, b, c, d, count, live);
+
+			memcpy(out[0], c, sizeof(c));
+
+			Cg_ParticleCompact(out[0], live, num_live);
+
+			for (uint32_t i = 0; i < num_live; i++) {
+				ck_assert(out[0][i] == c[live[i]]);
+				ck_assert(out[0][i] > d[live[i]]);
+			}
+
+			// the particles beyond the live ones are left untouched
+			ck_assert(!memcmp(out[0] + num_live, c + num_live, sizeof(c) - num_live * sizeof(vec_t)));
+		}
+	}END_TEST
+
+/**
+ * @brief Test entry point.
+ */
+int32_t main(int32_t argc, char **argv) {
+
+	Test_Init(argc, argv);
+
+	TCase *tcase = tcase_create("check_Cg_Particle");
+	tcase_add_checked_fixture(tcase, setup, teardown);
+
+	tcase_add_test(tcase, check_Cg_ParticleMA);
+	tcase_add_test(tcase, check_Cg_ParticleMove);
+	tcase_add_test(tcase, check_Cg_ParticleLive);
+	tcase_add_test(tcase, check_Cg_ParticleCompact);
+
+	Suite *suite = suite_create("check_cg_particle");
+	suite_add_tcase(suite, tcase);
+
+	int32_t failed = Test_Run(suite);
+
+	Test_Shutdown();
+	return failed;
+}
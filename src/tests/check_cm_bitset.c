@@ -0,0 +1,231 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "tests.h"
+#include "collision/cmodel.h"
+
+#define BITSET_SIZE (MAX_BSP_LEAFS >> 3)
+#define BITSET_ITERATIONS 2000
+
+static byte a[BITSET_SIZE + 1], b[BITSET_SIZE + 1], out[BITSET_SIZE + 1];
+
+/**
+ * @brief Setup fixture.
+ */
+void setup(void) {
+
+	srand(1);
+
+	for (size_t i = 0; i < sizeof(a); i++) {
+		a[i] = rand() & 0xff;
+		b[i] = rand() & 0xff;
+	}
+
+	memset(out, 0, sizeof(out));
+}
+
+/**
+ * @brief Teardown fixture.
+ */
+void teardown(void) {
+
+}
+
+/**
+ * @return The number of bits set in `bits`, one bit at a time.
+ */
+static size_t count(const byte *bits, const size_t len) {
+	size_t c = 0;
+
+	for (size_t i = 0; i < len << 3; i++) {
+		if (bits[i >> 3] & (1 << (i & 7)))
+			c++;
+	}
+
+	return c;
+}
+
+START_TEST(check_Cm_BitsetOr)
+	{
+		// exercise every kernel's tail, at aligned and unaligned offsets
+		for (size_t offset = 0; offset < 2; offset++) {
+			for (size_t len = 0; len < 200; len++) {
+
+				Cm_BitsetOr(out + offset, a + offset, b + offset, len);
+
+				for (size_t i = 0; i < len; i++) {
+					ck_assert_int_eq(out[offset + i], a[offset + i] | b[offset + i]);
+				}
+			}
+		}
+	}END_TEST
+
+START_TEST(check_Cm_BitsetAnd)
+	{
+		for (size_t offset = 0; offset < 2; offset++) {
+			for (size_t len = 0; len < 200; len++) {
+
+				Cm_BitsetAnd(out + offset, a + offset, b + offset, len);
+
+				for (size_t i = 0; i < len; i++) {
+					ck_assert_int_eq(out[offset + i], a[offset + i] & b[offset + i]);
+				}
+			}
+		}
+	}END_TEST
+
+START_TEST(check_Cm_BitsetCount)
+	{
+		for (size_t offset = 0; offset < 2; offset++) {
+			for (size_t len = 0; len < 200; len++) {
+				ck_assert_uint_eq(Cm_BitsetCount(a + offset, len), count(a + offset, len));
+			}
+		}
+
+		ck_assert_uint_eq(Cm_BitsetCount(a, BITSET_SIZE), count(a, BITSET_SIZE));
+	}END_TEST
+
+START_TEST(check_Cm_BitsetAny)
+	{
+		memset(out, 0, sizeof(out));
+
+		for (size_t len = 0; len < 200; len++) {
+			ck_assert(!Cm_BitsetAny(out, len));
+		}
+
+		// set each bit in turn, ensuring that every kernel finds it
+		for (size_t i = 0; i < 200 << 3; i++) {
+
+			Cm_BitsetSet(out, i);
+
+			ck_assert(Cm_BitsetAny(out, 200));
+			ck_assert(!Cm_BitsetAny(out, i >> 3));
+
+			out[i >> 3] = 0;
+		}
+	}END_TEST
+
+START_TEST(check_Cm_BitsetAnyAndNot)
+	{
+		memset(out, 0xff, sizeof(out));
+
+		for (size_t len = 0; len < 200; len++) {
+			ck_assert(!Cm_BitsetAnyAndNot(a, out, len));
+			ck_assert(!Cm_BitsetAnyAndNot(a, a, len));
+		}
+
+		// clear each bit of the mask in turn, ensuring that every kernel finds it
+		for (size_t i = 0; i < 200 << 3; i++) {
+
+			out[i >> 3] &= ~(1 << (i & 7));
+
+			ck_assert(Cm_BitsetAnyAndNot(b, out, 200) == (Cm_BitsetTest(b, i) != 0));
+
+			out[i >> 3] = 0xff;
+		}
+	}END_TEST
+
+START_TEST(check_Cm_BitsetAndAnyAndNot)
+	{
+		byte mask[sizeof(out)], expected[sizeof(out)];
+
+		memset(mask, 0xff, sizeof(mask));
+
+		for (size_t len = 0; len < 200; len++) {
+			ck_assert(!Cm_BitsetAndAnyAndNot(out, a, b, mask, len));
+
+			Cm_BitsetAnd(expected, a, b, len);
+			ck_assert(!memcmp(out, expected, len));
+		}
+
+		// clear each bit of the mask in turn, ensuring that every kernel finds it
+		for (size_t i = 0; i < 200 << 3; i++) {
+
+			mask[i >> 3] &= ~(1 << (i & 7));
+
+			const _Bool any = Cm_BitsetAndAnyAndNot(out, a, b, mask, 200);
+			ck_assert(any == (Cm_BitsetTest(a, i) && Cm_BitsetTest(b, i)));
+
+			mask[i >> 3] = 0xff;
+		}
+	}END_TEST
+
+/**
+ * @brief Compares the bitset kernels against naive byte loops over a full
+ * sized PVS row. The timings are informational only.
+ */
+START_TEST(check_Cm_Bitset_Benchmark)
+	{
+		size_t naive_count = 0, bitset_count = 0;
+
+		gint64 start = g_get_monotonic_time();
+
+		for (int32_t i = 0; i < BITSET_ITERATIONS; i++) {
+			for (size_t j = 0; j < BITSET_SIZE; j++) {
+				out[j] = a[j] | b[j];
+			}
+			naive_count += count(out, BITSET_SIZE);
+		}
+
+		const gint64 naive = g_get_monotonic_time() - start;
+
+		start = g_get_monotonic_time();
+
+		for (int32_t i = 0; i < BITSET_ITERATIONS; i++) {
+			Cm_BitsetOr(out, a, b, BITSET_SIZE);
+			bitset_count += Cm_BitsetCount(out, BITSET_SIZE);
+		}
+
+		const gint64 bitset = g_get_monotonic_time() - start;
+
+		ck_assert_uint_eq(naive_count, bitset_count);
+
+		Com_Print("Or + Count of %d bytes x %d: naive %" PRId64 "us, bitset %" PRId64 "us (%.1fx)\n",
+				BITSET_SIZE, BITSET_ITERATIONS, (int64_t) naive, (int64_t) bitset,
+				naive / (double) MAX(bitset, 1));
+	}END_TEST
+
+/**
+ * @brief Test entry point.
+ */
+int32_t main(int32_t argc, char **argv) {
+
+	Test_Init(argc, argv);
+
+	TCase *tcase = tcase_create("check_Cm_Bitset");
+	tcase_add_checked_fixture(tcase, setup, teardown);
+
+	tcase_add_test(tcase, check_Cm_BitsetOr);
+	tcase_add_test(tcase, check_Cm_BitsetAnd);
+	tcase_add_test(tcase, check_Cm_BitsetCount);
+	tcase_add_test(tcase, check_Cm_BitsetAny);
+	tcase_add_test(tcase, check_Cm_BitsetAnyAndNot);
+	tcase_add_test(tcase, check_Cm_BitsetAndAnyAndNot);
+	tcase_add_test(tcase, check_Cm_Bitset_Benchmark);
+
+	Suite *suite = suite_create("check_cm_bitset");
+	suite_add_tcase(suite, tcase);
+
+	int32_t failed = Test_Run(suite);
+
+	Test_Shutdown();
+	return failed;
+}
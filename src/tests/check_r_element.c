@@ -0,0 +1,181 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "tests.h"
+#include "r_local.h"
+
+#define ELEMENTS_COUNT 50000
+#define ELEMENTS_ITERATIONS 20
+
+static r_element_t *elements, *reference;
+static void *scratch;
+
+/**
+ * @brief Setup fixture.
+ */
+void setup(void) {
+
+	Mem_Init();
+
+	elements = Mem_Malloc(ELEMENTS_COUNT * sizeof(r_element_t));
+	reference = Mem_Malloc(ELEMENTS_COUNT * sizeof(r_element_t));
+
+	scratch = Mem_Malloc(R_ElementSortScratchSize(ELEMENTS_COUNT));
+
+	srand(1);
+}
+
+/**
+ * @brief Teardown fixture.
+ */
+void teardown(void) {
+
+	Mem_Shutdown();
+}
+
+/**
+ * @brief Populates the elements with random depths, many of them equal, and
+ * tags each with its original position.
+ */
+static void populate(size_t count) {
+
+	for (size_t i = 0; i < count; i++) {
+		elements[i].type = rand() % 2 ? ELEMENT_PARTICLE : ELEMENT_BSP_SURFACE_BLEND;
+		elements[i].depth = (rand() % 4) ? rand() / (vec_t) RAND_MAX * 8192.0 : (vec_t) (rand() % 16);
+		elements[i].data = (void *) (intptr_t) i;
+	}
+}
+
+/**
+ * @brief Stable, farthest-first comparator for the reference sort.
+ */
+static int compare(const void *a, const void *b) {
+	const r_element_t *e1 = (const r_element_t *) a, *e2 = (const r_element_t *) b;
+
+	if (e1->depth != e2->depth)
+		return e1->depth < e2->depth ? 1 : -1;
+
+	return (intptr_t) e1->data < (intptr_t) e2->data ? -1 : 1;
+}
+
+/**
+ * @brief The qsort comparator which R_SortElements used previously.
+ */
+static int compare_depth(const void *a, const void *b) {
+	return ((r_element_t *) b)->depth - ((r_element_t *) a)->depth;
+}
+
+START_TEST(check_R_RadixSortElements)
+	{
+		const size_t counts[] = { 0, 1, 2, 3, 255, 256, 257, 1000, ELEMENTS_COUNT };
+
+		for (size_t i = 0; i < lengthof(counts); i++) {
+			const size_t count = counts[i];
+
+			populate(count);
+
+			memcpy(reference, elements, count * sizeof(r_element_t));
+			qsort(reference, count, sizeof(r_element_t), compare);
+
+			R_RadixSortElements(elements, count, scratch);
+
+			for (size_t j = 0; j < count; j++) {
+				ck_assert_msg(elements[j].data == reference[j].data, "Mismatch at %zu of %zu", j, count);
+			}
+		}
+	}END_TEST
+
+START_TEST(check_R_RadixSortElements_Negative)
+	{
+		const vec_t depths[] = { -1.0, 0.0, -0.0, 1.0, -1024.0, 1024.0, 0.5, -0.5 };
+
+		for (size_t i = 0; i < lengthof(depths); i++) {
+			elements[i].depth = depths[i];
+			elements[i].data = (void *) (intptr_t) i;
+		}
+
+		memcpy(reference, elements, lengthof(depths) * sizeof(r_element_t));
+		qsort(reference, lengthof(depths), sizeof(r_element_t), compare);
+
+		R_RadixSortElements(elements, lengthof(depths), scratch);
+
+		for (size_t i = 0; i < lengthof(depths); i++) {
+			ck_assert(elements[i].depth == reference[i].depth);
+		}
+	}END_TEST
+
+/**
+ * @brief Compares the radix sort against qsort with the previous comparator.
+ * The timings are informational only.
+ */
+START_TEST(check_R_RadixSortElements_Benchmark)
+	{
+		gint64 radix = 0, quick = 0;
+
+		for (int32_t i = 0; i < ELEMENTS_ITERATIONS; i++) {
+
+			populate(ELEMENTS_COUNT);
+			memcpy(reference, elements, ELEMENTS_COUNT * sizeof(r_element_t));
+
+			gint64 start = g_get_monotonic_time();
+
+			qsort(reference, ELEMENTS_COUNT, sizeof(r_element_t), compare_depth);
+
+			quick += g_get_monotonic_time() - start;
+
+			start = g_get_monotonic_time();
+
+			R_RadixSortElements(elements, ELEMENTS_COUNT, scratch);
+
+			radix += g_get_monotonic_time() - start;
+
+			for (size_t j = 1; j < ELEMENTS_COUNT; j++) {
+				ck_assert(elements[j - 1].depth >= elements[j].depth);
+			}
+		}
+
+		Com_Print("Sort of %d elements x %d: qsort %" PRId64 "us, radix %" PRId64 "us (%.1fx)\n",
+				ELEMENTS_COUNT, ELEMENTS_ITERATIONS, (int64_t) quick, (int64_t) radix,
+				quick / (double) MAX(radix, 1));
+	}END_TEST
+
+/**
+ * @brief Test entry point.
+ */
+int32_t main(int32_t argc, char **argv) {
+
+	Test_Init(argc, argv);
+
+	TCase *tcase = tcase_create("check_R_Element");
+	tcase_add_checked_fixture(tcase, setup, teardown);
+
+	tcase_add_test(tcase, check_R_RadixSortElements);
+	tcase_add_test(tcase, check_R_RadixSortElements_Negative);
+	tcase_add_test(tcase, check_R_RadixSortElements_Benchmark);
+
+	Suite *suite = suite_create("check_r_element");
+	suite_add_tcase(suite, tcase);
+
+	int32_t failed = Test_Run(suite);
+
+	Test_Shutdown();
+	return failed;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "tests.h"
+#include "r_local.h"
+
+#define MESH_VERTS 2500 // comparable to a player model, all meshes combined
+#define MESH_FRAMES 200
+#define MESH_ENTITIES 32
+#define MESH_ITERATIONS 50
+
+static r_md3_vertex_t *aos;
+static GLfloat *frames, *out, *reference;
+
+/**
+ * @brief Setup fixture.
+ */
+void setup(void) {
+
+	Mem_Init();
+
+	aos = Mem_Malloc(MESH_FRAMES * MESH_VERTS * sizeof(r_md3_vertex_t));
+
+	frames = Mem_Malloc(MESH_FRAMES * MESH_VERTS * sizeof(vec3_t));
+	out = Mem_Malloc((MESH_VERTS * 3 + 1) * sizeof(GLfloat)); // and an overrun sentinel
+	reference = Mem_Malloc(MESH_VERTS * sizeof(vec3_t));
+
+	srand(1);
+
+	for (size_t i = 0; i < MESH_FRAMES * MESH_VERTS; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			aos[i].point[j] = frames[i * 3 + j] = (rand() / (vec_t) RAND_MAX - 0.5) * 64.0;
+			aos[i].normal[j] = aos[i].point[j] / 64.0;
+		}
+	}
+}
+
+/**
+ * @brief Teardown fixture.
+ */
+void teardown(void) {
+
+	Mem_Shutdown();
+}
+
+START_TEST(check_R_LerpMeshVertexes)
+	{
+		const size_t counts[] = { 0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 33, MESH_VERTS * 3 };
+		const vec_t lerps[] = { 0.0, 0.25, 0.5, 1.0 };
+
+		for (size_t i = 0; i < lengthof(counts); i++) {
+			for (size_t j = 0; j < lengthof(lerps); j++) {
+
+				const size_t count = counts[i];
+				const vec_t lerp = lerps[j], back_lerp = 1.0 - lerp;
+
+				const GLfloat *from = frames + 1; // deliberately unaligned
+				const GLfloat *to = frames + MESH_VERTS * 3 + 2;
+
+				for (size_t k = 0; k < count; k++) {
+					reference[k] = from[k] * back_lerp + to[k] * lerp;
+				}
+
+				out[count] = -1.0;
+
+				R_LerpMeshVertexes(out, from, to, back_lerp, lerp, count);
+
+				for (size_t k = 0; k < count; k++) {
+					ck_assert_msg(fabsf(out[k] - reference[k]) < 0.0001, "Mismatch at %zu of %zu", k, count);
+				}
+
+				ck_assert_msg(out[count] == -1.0, "Overrun at %zu", count);
+			}
+		}
+	}END_TEST
+
+/**
+ * @brief Compares frame interpolation with the previous, per vertex arithmetic
+ * over interleaved vertexes. The timings are informational only.
+ */
+START_TEST(check_R_LerpMeshVertexes_Benchmark)
+	{
+		gint64 scalar = 0, simd = 0;
+
+		for (int32_t i = 0; i < MESH_ITERATIONS; i++) {
+			for (int32_t j = 0; j < MESH_ENTITIES; j++) {
+
+				const int32_t frame = rand() % MESH_FRAMES, old_frame = rand() % MESH_FRAMES;
+				const vec_t lerp = rand() / (vec_t) RAND_MAX, back_lerp = 1.0 - lerp;
+
+				const r_md3_vertex_t *v = aos + frame * MESH_VERTS;
+				const r_md3_vertex_t *ov = aos + old_frame * MESH_VERTS;
+
+				gint64 start = g_get_monotonic_time();
+
+				for (size_t k = 0; k < MESH_VERTS; k++, v++, ov++) {
+					VectorSet((reference + k * 3),
+							ov->point[0] * back_lerp + v->point[0] * lerp,
+							ov->point[1] * back_lerp + v->point[1] * lerp,
+							ov->point[2] * back_lerp + v->point[2] * lerp);
+				}
+
+				scalar += g_get_monotonic_time() - start;
+
+				start = g_get_monotonic_time();
+
+				R_LerpMeshVertexes(out, frames + old_frame * MESH_VERTS * 3,
+						frames + frame * MESH_VERTS * 3, back_lerp, lerp, MESH_VERTS * 3);
+
+				simd += g_get_monotonic_time() - start;
+
+				for (size_t k = 0; k < MESH_VERTS * 3; k++) {
+					ck_assert(fabsf(out[k] - reference[k]) < 0.0001);
+				}
+			}
+		}
+
+		Com_Print("Interpolation of %d vertexes x %d: scalar %" PRId64 "us, simd %" PRId64 "us (%.1fx)\n",
+				MESH_VERTS, MESH_ENTITIES * MESH_ITERATIONS, (int64_t) scalar, (int64_t) simd,
+				scalar / (double) MAX(simd, 1));
+	}END_TEST
+
+/**
+ * @brief Test entry point.
+ */
+int32_t main(int32_t argc, char **argv) {
+
+	Test_Init(argc, argv);
+
+	TCase *tcase = tcase_create("check_R_MeshLerp");
+	tcase_add_checked_fixture(tcase, setup, teardown);
+
+	tcase_add_test(tcase, check_R_LerpMeshVertexes);
+	tcase_add_test(tcase, check_R_LerpMeshVertexes_Benchmark);
+
+	Suite *suite = suite_create("check_r_mesh_lerp");
+	suite_add_tcase(suite, tcase);
+
+	int32_t failed = Test_Run(suite);
+
+	Test_Shutdown();
+	return failed;
+}
@@ -81,6 +81,94 @@ START_TEST(check_Thread_Wait)
 
 	}END_TEST
 
+static SDL_atomic_t counter;
+
+/**
+ * @brief Increments the counter.
+ */
+static void increment(void *data __attribute__((unused))) {
+	SDL_AtomicIncRef(&counter);
+}
+
+START_TEST(check_Task_Submit)
+	{
+		task_t *tasks[64];
+
+		SDL_AtomicSet(&counter, 0);
+
+		for (size_t i = 0; i < lengthof(tasks); i++) {
+			tasks[i] = Task_Submit(increment, NULL);
+		}
+
+		for (size_t i = 0; i < lengthof(tasks); i++) {
+			Task_Wait(tasks[i]);
+		}
+
+		ck_assert_int_eq(lengthof(tasks), SDL_AtomicGet(&counter));
+
+		for (size_t i = 0; i < lengthof(tasks); i++) {
+			tasks[i] = Task_Submit(increment, NULL);
+		}
+
+		Task_WaitAll();
+
+		ck_assert_int_eq(lengthof(tasks) * 2, SDL_AtomicGet(&counter));
+
+		// the barrier does not release the handles, so they are still ours to release
+		for (size_t i = 0; i < lengthof(tasks); i++) {
+			Task_Wait(tasks[i]);
+		}
+
+	}END_TEST
+
+static int32_t sequence[3];
+
+/**
+ * @brief Records the order in which the counter is observed.
+ */
+static void record(void *data) {
+	sequence[SDL_AtomicIncRef(&counter)] = (int32_t) (intptr_t) data;
+}
+
+START_TEST(check_Task_SubmitAfter)
+	{
+		SDL_AtomicSet(&counter, 0);
+
+		task_t *a = Task_Submit(record, (void *) 0);
+		task_t *b = Task_SubmitAfter(record, (void *) 1, &a, 1);
+
+		task_t *deps[] = { a, b };
+		task_t *c = Task_SubmitAfter(record, (void *) 2, deps, lengthof(deps));
+
+		Task_Wait(c);
+		Task_Wait(b);
+		Task_Wait(a);
+
+		ck_assert_int_eq(0, sequence[0]);
+		ck_assert_int_eq(1, sequence[1]);
+		ck_assert_int_eq(2, sequence[2]);
+
+	}END_TEST
+
+/**
+ * @brief Accumulates the indices of the specified range.
+ */
+static void accumulate(void *data, int32_t begin, int32_t end) {
+	for (int32_t i = begin; i < end; i++) {
+		SDL_AtomicAdd((SDL_atomic_t *) data, i);
+	}
+}
+
+START_TEST(check_Task_ParallelFor)
+	{
+		SDL_atomic_t sum = { 0 };
+
+		Task_ParallelFor(accumulate, &sum, 1000, 7);
+
+		ck_assert_int_eq(1000 * 999 / 2, SDL_AtomicGet(&sum));
+
+	}END_TEST
+
 /**
  * @brief Test entry point.
  */
@@ -92,6 +180,9 @@ int32_t main(int32_t argc, char **argv) {
 	tcase_add_checked_fixture(tcase, setup, teardown);
 
 	tcase_add_test(tcase, check_Thread_Wait);
+	tcase_add_test(tcase, check_Task_Submit);
+	tcase_add_test(tcase, check_Task_SubmitAfter);
+	tcase_add_test(tcase, check_Task_ParallelFor);
 
 	Suite *suite = suite_create("check_threads");
 	suite_add_tcase(suite, tcase);
@@ -0,0 +1,184 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "tests.h"
+#include "qvis.h"
+
+#define FLOW_WINDINGS 10000
+
+/**
+ * @return A reproducible random value in [-1, 1].
+ */
+static vec_t Rand(void) {
+	return (rand() / (vec_t) RAND_MAX) * 2.0 - 1.0;
+}
+
+/**
+ * @brief Populates `plane` with a random plane, axial one time in four.
+ */
+static void RandomPlane(plane_t *plane) {
+
+	if (rand() & 3) {
+		VectorSet(plane->normal, Rand(), Rand(), Rand());
+		if (VectorNormalize(plane->normal) == 0.0) {
+			VectorSet(plane->normal, 0.0, 0.0, 1.0);
+		}
+	} else {
+		VectorClear(plane->normal);
+		plane->normal[rand() % 3] = rand() & 1 ? 1.0 : -1.0;
+	}
+
+	plane->dist = Rand() * MAX_WORLD_COORD;
+}
+
+/**
+ * @return The side of the plane a point at `dist` lies on, as Vis_ChopWinding
+ * classifies it.
+ */
+static int32_t Side(const vec_t dist) {
+
+	if (dist > ON_EPSILON)
+		return SIDE_FRONT;
+	else if (dist < -ON_EPSILON)
+		return SIDE_BACK;
+
+	return SIDE_BOTH;
+}
+
+/**
+ * @brief Compares Vis_PlaneDistances with the scalar DotProduct it replaced, for
+ * the specified winding and plane. Sides must agree, even at ON_EPSILON.
+ */
+static void CheckPlaneDistances(const winding_t *w, const plane_t *plane) {
+	vec_t dists[MAX_POINTS_ON_FIXED_WINDING + 1];
+
+	dists[w->num_points] = -1.0;
+
+	Vis_PlaneDistances(w, plane, dists);
+
+	for (int32_t i = 0; i < w->num_points; i++) {
+		const vec_t *p = w->points[i], *n = plane->normal;
+
+		// the compiler must not fuse the reference arithmetic, either
+		volatile vec_t x = p[0] * n[0], y = p[1] * n[1], z = p[2] * n[2];
+		volatile vec_t dot = x + y;
+		dot = dot + z;
+
+		const vec_t dist = dot - plane->dist;
+
+		ck_assert_msg(dists[i] == dist, "Point %d of %d: %.9g != %.9g", i, w->num_points, dists[i], dist);
+		ck_assert_int_eq(Side(dists[i]), Side(dist));
+	}
+
+	ck_assert_msg(dists[w->num_points] == -1.0, "Overrun at %d", w->num_points);
+}
+
+/**
+ * @brief Setup fixture.
+ */
+void setup(void) {
+
+	srand(1);
+}
+
+/**
+ * @brief Teardown fixture.
+ */
+void teardown(void) {
+
+}
+
+START_TEST(check_Vis_PlaneDistances)
+	{
+		winding_t w;
+		plane_t plane;
+
+		// exercise the kernel and its tail at every winding size
+		for (int32_t i = 0; i < FLOW_WINDINGS; i++) {
+
+			w.num_points = 1 + i % MAX_POINTS_ON_FIXED_WINDING;
+
+			for (int32_t j = 0; j < w.num_points; j++) {
+				VectorSet(w.points[j], Rand(), Rand(), Rand());
+				VectorScale(w.points[j], MAX_WORLD_COORD, w.points[j]);
+			}
+
+			RandomPlane(&plane);
+
+			CheckPlaneDistances(&w, &plane);
+		}
+	}END_TEST
+
+START_TEST(check_Vis_PlaneDistances_Epsilon)
+	{
+		const vec_t offsets[] = {
+			0.0, ON_EPSILON, -ON_EPSILON,
+			ON_EPSILON * 0.999, ON_EPSILON * 1.001,
+			-ON_EPSILON * 0.999, -ON_EPSILON * 1.001
+		};
+
+		winding_t w;
+		plane_t plane;
+
+		// place points on and around the epsilon boundaries of each plane
+		for (int32_t i = 0; i < FLOW_WINDINGS; i++) {
+
+			w.num_points = 1 + i % MAX_POINTS_ON_FIXED_WINDING;
+
+			RandomPlane(&plane);
+
+			for (int32_t j = 0; j < w.num_points; j++) {
+				vec3_t point;
+
+				VectorSet(point, Rand(), Rand(), Rand());
+				VectorScale(point, MAX_WORLD_COORD, point);
+
+				const vec_t d = DotProduct(point, plane.normal) - plane.dist;
+				const vec_t offset = offsets[rand() % lengthof(offsets)];
+
+				VectorMA(point, offset - d, plane.normal, w.points[j]);
+			}
+
+			CheckPlaneDistances(&w, &plane);
+		}
+	}END_TEST
+
+/**
+ * @brief Test entry point.
+ */
+int32_t main(int32_t argc, char **argv) {
+
+	Test_Init(argc, argv);
+
+	TCase *tcase = tcase_create("check_vis_flow");
+	tcase_add_checked_fixture(tcase, setup, teardown);
+
+	tcase_add_test(tcase, check_Vis_PlaneDistances);
+	tcase_add_test(tcase, check_Vis_PlaneDistances_Epsilon);
+
+	Suite *suite = suite_create("check_vis_flow");
+	suite_add_tcase(suite, tcase);
+
+	int32_t failed = Test_Run(suite);
+
+	Test_Shutdown();
+	return failed;
+}
@@ -26,6 +26,17 @@ typedef struct thread_pool_s {
 
 	thread_t *threads;
 	uint16_t num_threads;
+
+	struct {
+		SDL_mutex *mutex;
+
+		task_t *tasks;
+		task_t *free; // released tasks, available for submission
+		task_t *head, *tail; // submitted tasks not yet claimed by a worker
+
+		uint16_t num_workers; // detached pool threads draining the queue
+		SDL_atomic_t num_incomplete; // submitted tasks which have not yet completed
+	} scheduler;
 } thread_pool_t;
 
 static thread_pool_t thread_pool;
@@ -48,8 +59,8 @@ static int32_t Thread_Run(void *data) {
 			t->Run = NULL;
 			t->data = NULL;
 
-			t->status = THREAD_WAIT;
-		} else {
+			t->status = t->detached ? THREAD_IDLE : THREAD_WAIT;
+		} else if (thread_pool.mutex) {
 			SDL_CondWait(t->cond, t->mutex);
 		}
 
@@ -91,7 +102,11 @@ static void Thread_Shutdown_(void) {
 
 		for (i = 0; i < thread_pool.num_threads; i++, t++) {
 			Thread_Wait(t);
+
+			SDL_mutexP(t->mutex);
 			SDL_CondSignal(t->cond);
+			SDL_mutexV(t->mutex);
+
 			SDL_WaitThread(t->thread, NULL);
 			SDL_DestroyCond(t->cond);
 			SDL_DestroyMutex(t->mutex);
@@ -102,55 +117,62 @@ static void Thread_Shutdown_(void) {
 }
 
 /**
- * @brief Creates a new thread to run the specified function. Callers must use
- * Thread_Wait on the returned handle to release the thread when finished.
+ * @brief Dispatches the specified function to an idle thread, if one is available.
+ * @return The thread, or NULL if all threads are busy.
  */
-thread_t *Thread_Create_(const char *name, ThreadRunFunc run, void *data) {
+static thread_t *Thread_Dispatch(const char *name, ThreadRunFunc run, void *data, _Bool detached) {
 
 	thread_t *t = thread_pool.threads;
 	uint16_t i = 0;
 
-	// if threads are available, find an idle one and dispatch it
-	if (thread_pool.num_threads) {
-		SDL_mutexP(thread_pool.mutex);
-
-		for (i = 0; i < thread_pool.num_threads; i++, t++) {
+	if (thread_pool.num_threads == 0) {
+		return NULL;
+	}
 
-			// if the thread appears idle, lock it and check again
-			if (t->status == THREAD_IDLE) {
+	SDL_mutexP(thread_pool.mutex);
 
-				SDL_mutexP(t->mutex);
+	for (i = 0; i < thread_pool.num_threads; i++, t++) {
 
-				// if the thread is idle, dispatch it
-				if (t->status == THREAD_IDLE) {
-					g_strlcpy(t->name, name, sizeof(t->name));
+		// if the thread appears idle, lock it and check again
+		if (t->status == THREAD_IDLE) {
 
-					t->Run = run;
-					t->data = data;
+			SDL_mutexP(t->mutex);
 
-					t->status = THREAD_RUNNING;
+			// if the thread is idle, dispatch it
+			if (t->status == THREAD_IDLE) {
+				g_strlcpy(t->name, name, sizeof(t->name));
 
-					SDL_mutexV(t->mutex);
-					SDL_CondSignal(t->cond);
+				t->Run = run;
+				t->data = data;
+				t->detached = detached;
 
-					break;
-				}
+				t->status = THREAD_RUNNING;
 
 				SDL_mutexV(t->mutex);
+				SDL_CondSignal(t->cond);
+
+				break;
 			}
-		}
 
-		SDL_mutexV(thread_pool.mutex);
+			SDL_mutexV(t->mutex);
+		}
 	}
 
+	SDL_mutexV(thread_pool.mutex);
+
+	return i < thread_pool.num_threads ? t : NULL;
+}
+
+/**
+ * @brief Creates a new thread to run the specified function. Callers must use
+ * Thread_Wait on the returned handle to release the thread when finished.
+ */
+thread_t *Thread_Create_(const char *name, ThreadRunFunc run, void *data) {
+
+	thread_t *t = Thread_Dispatch(name, run, data, false);
+
 	// if we failed to allocate a thread, run the function in this thread
-	if (i == thread_pool.num_threads) {
-#if 0
-		if (thread_pool.num_threads) {
-			printf("No threads available for %s\n", name);
-		}
-#endif
-		t = NULL;
+	if (t == NULL) {
 		run(data);
 	}
 
@@ -165,7 +187,7 @@ void Thread_Wait(thread_t *t) {
 	if (!t || t->status == THREAD_IDLE)
 		return;
 
-	while (t->status != THREAD_WAIT) {
+	while (t->status == THREAD_RUNNING) {
 		usleep(0);
 	}
 
@@ -179,6 +201,317 @@ uint16_t Thread_Count(void) {
 	return thread_pool.num_threads;
 }
 
+/**
+ * @return True if all of the task's dependencies have completed. Dependencies
+ * whose slot has since been released and reused are considered complete.
+ */
+static _Bool Task_Ready(const task_t *task) {
+
+	const task_dependency_t *dep = task->dependencies;
+	for (uint16_t i = 0; i < task->num_dependencies; i++, dep++) {
+
+		if (dep->task->generation != dep->generation) {
+			continue;
+		}
+
+		if (SDL_AtomicGet((SDL_atomic_t *) &dep->task->status) != TASK_DONE) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Claims the first ready task from the queue. Detached workers which
+ * find no ready task retire while still holding the scheduler lock, so that
+ * Task_Dispatch never miscounts them.
+ */
+static task_t *Task_Pop(_Bool worker) {
+	task_t *task, *prev = NULL;
+
+	SDL_mutexP(thread_pool.scheduler.mutex);
+
+	for (task = thread_pool.scheduler.head; task; prev = task, task = task->next) {
+		if (Task_Ready(task)) {
+
+			if (prev) {
+				prev->next = task->next;
+			} else {
+				thread_pool.scheduler.head = task->next;
+			}
+
+			if (thread_pool.scheduler.tail == task) {
+				thread_pool.scheduler.tail = prev;
+			}
+
+			task->next = NULL;
+			SDL_AtomicSet(&task->status, TASK_RUNNING);
+			break;
+		}
+	}
+
+	if (task == NULL && worker) {
+		thread_pool.scheduler.num_workers--;
+	}
+
+	SDL_mutexV(thread_pool.scheduler.mutex);
+
+	return task;
+}
+
+static void Task_Dispatch(void);
+
+/**
+ * @brief Runs the specified task, and dispatches workers for any tasks
+ * which its completion may have made ready.
+ */
+static void Task_Execute(task_t *task) {
+
+	task->Run(task->data);
+
+	SDL_AtomicSet(&task->status, TASK_DONE);
+	SDL_AtomicAdd(&thread_pool.scheduler.num_incomplete, -1);
+
+	if (thread_pool.scheduler.head) {
+		Task_Dispatch();
+	}
+}
+
+/**
+ * @brief Detached worker entry point: drains ready tasks until none remain.
+ */
+static void Task_Work(void *data __attribute__((unused))) {
+	task_t *task;
+
+	while ((task = Task_Pop(true))) {
+		Task_Execute(task);
+	}
+}
+
+/**
+ * @brief Dispatches detached workers to idle pool threads, one per ready task.
+ * Workers are reserved under the scheduler lock, but dispatched outside of it.
+ */
+static void Task_Dispatch(void) {
+
+	SDL_mutexP(thread_pool.scheduler.mutex);
+
+	uint16_t num_ready = 0;
+	for (const task_t *task = thread_pool.scheduler.head; task; task = task->next) {
+		if (Task_Ready(task)) {
+			num_ready++;
+		}
+	}
+
+	const uint16_t num_workers = MIN(num_ready, thread_pool.num_threads);
+
+	uint16_t num_reserved = 0;
+	if (num_workers > thread_pool.scheduler.num_workers) {
+		num_reserved = num_workers - thread_pool.scheduler.num_workers;
+		thread_pool.scheduler.num_workers = num_workers;
+	}
+
+	SDL_mutexV(thread_pool.scheduler.mutex);
+
+	uint16_t num_dispatched = 0;
+	while (num_dispatched < num_reserved) {
+		if (Thread_Dispatch(__func__, Task_Work, NULL, true) == NULL) {
+			break;
+		}
+		num_dispatched++;
+	}
+
+	if (num_dispatched < num_reserved) {
+		SDL_mutexP(thread_pool.scheduler.mutex);
+		thread_pool.scheduler.num_workers -= num_reserved - num_dispatched;
+		SDL_mutexV(thread_pool.scheduler.mutex);
+	}
+}
+
+/**
+ * @brief Runs queued tasks on the calling thread until the specified task
+ * has completed.
+ */
+static void Task_Help(const task_t *task) {
+
+	while (true) {
+		const int32_t status = SDL_AtomicGet((SDL_atomic_t *) &task->status);
+		if (status == TASK_DONE || status == TASK_IDLE) {
+			break;
+		}
+
+		task_t *t = Task_Pop(false);
+		if (t) {
+			Task_Execute(t);
+		} else {
+			usleep(0);
+		}
+	}
+}
+
+/**
+ * @brief Submits a task to run the specified function once all of the given
+ * dependencies have completed. Callers must use Task_Wait to release the
+ * returned handle. If no task slot is available, the dependencies
+ * are waited on and the function is run in the calling thread, and NULL is
+ * returned.
+ */
+task_t *Task_Submit_(const char *name, ThreadRunFunc run, void *data, task_t **dependencies, size_t num_dependencies) {
+
+	SDL_mutexP(thread_pool.scheduler.mutex);
+
+	task_t *task = thread_pool.scheduler.free;
+	if (task) {
+		thread_pool.scheduler.free = task->next;
+	}
+
+	SDL_mutexV(thread_pool.scheduler.mutex);
+
+	// dependencies beyond what the task can record are resolved here
+	for (size_t i = task ? MAX_TASK_DEPENDENCIES : 0; i < num_dependencies; i++) {
+		if (dependencies[i]) {
+			Task_Help(dependencies[i]);
+		}
+	}
+
+	if (task == NULL) {
+		run(data);
+		return NULL;
+	}
+
+	g_strlcpy(task->name, name, sizeof(task->name));
+
+	task->Run = run;
+	task->data = data;
+	task->num_dependencies = 0;
+	task->next = NULL;
+
+	for (size_t i = 0; i < MIN(num_dependencies, MAX_TASK_DEPENDENCIES); i++) {
+		if (dependencies[i]) {
+			task_dependency_t *dep = &task->dependencies[task->num_dependencies++];
+			dep->task = dependencies[i];
+			dep->generation = dependencies[i]->generation;
+		}
+	}
+
+	SDL_AtomicSet(&task->status, TASK_PENDING);
+	SDL_AtomicIncRef(&thread_pool.scheduler.num_incomplete);
+
+	SDL_mutexP(thread_pool.scheduler.mutex);
+
+	if (thread_pool.scheduler.tail) {
+		thread_pool.scheduler.tail->next = task;
+	} else {
+		thread_pool.scheduler.head = task;
+	}
+
+	thread_pool.scheduler.tail = task;
+
+	SDL_mutexV(thread_pool.scheduler.mutex);
+
+	Task_Dispatch();
+
+	return task;
+}
+
+/**
+ * @brief Waits for the specified task to complete, running queued tasks on the
+ * calling thread in the meantime, and then releases the task.
+ */
+void Task_Wait(task_t *task) {
+
+	if (!task || SDL_AtomicGet(&task->status) == TASK_IDLE)
+		return;
+
+	Task_Help(task);
+
+	SDL_mutexP(thread_pool.scheduler.mutex);
+
+	SDL_AtomicSet(&task->status, TASK_IDLE);
+	task->generation++;
+
+	task->next = thread_pool.scheduler.free;
+	thread_pool.scheduler.free = task;
+
+	SDL_mutexV(thread_pool.scheduler.mutex);
+}
+
+/**
+ * @brief Waits for all submitted tasks to complete, running queued tasks on the
+ * calling thread in the meantime. This is a barrier only: task handles are
+ * owned by their submitters, and must still be released with Task_Wait.
+ */
+void Task_WaitAll(void) {
+
+	while (SDL_AtomicGet(&thread_pool.scheduler.num_incomplete) > 0) {
+
+		task_t *task = Task_Pop(false);
+		if (task) {
+			Task_Execute(task);
+		} else {
+			usleep(0);
+		}
+	}
+}
+
+typedef struct {
+	ThreadRangeFunc func;
+	void *data;
+	int32_t count;
+	int32_t grain;
+	SDL_atomic_t next;
+} task_range_t;
+
+/**
+ * @brief Claims and runs ranges of a parallel-for until the range is exhausted.
+ */
+static void Task_ParallelFor_Work(void *data) {
+	task_range_t *range = (task_range_t *) data;
+
+	while (true) {
+		const int32_t begin = SDL_AtomicAdd(&range->next, range->grain);
+		if (begin >= range->count) {
+			break;
+		}
+
+		range->func(range->data, begin, MIN(begin + range->grain, range->count));
+	}
+}
+
+/**
+ * @brief Runs the specified function over [0, count) in ranges of up to grain
+ * indices, distributed across the pool and the calling thread. Returns when
+ * the entire range has completed.
+ */
+void Task_ParallelFor_(const char *name, ThreadRangeFunc func, void *data, int32_t count, int32_t grain) {
+	task_t *tasks[MAX_THREADS];
+
+	if (count <= 0) {
+		return;
+	}
+
+	task_range_t range = {
+		.func = func,
+		.data = data,
+		.count = count,
+		.grain = MAX(grain, 1)
+	};
+
+	const int32_t num_ranges = (count + range.grain - 1) / range.grain;
+	const int32_t num_tasks = MIN(thread_pool.num_threads, num_ranges - 1);
+
+	for (int32_t i = 0; i < num_tasks; i++) {
+		tasks[i] = Task_Submit_(name, Task_ParallelFor_Work, &range, NULL, 0);
+	}
+
+	Task_ParallelFor_Work(&range);
+
+	for (int32_t i = 0; i < num_tasks; i++) {
+		Task_Wait(tasks[i]);
+	}
+}
+
 /**
  * @brief Initializes the thread pool.
  */
@@ -188,6 +521,14 @@ void Thread_Init(uint16_t num_threads) {
 
 	thread_pool.mutex = SDL_CreateMutex();
 
+	thread_pool.scheduler.mutex = SDL_CreateMutex();
+	thread_pool.scheduler.tasks = Mem_Malloc(sizeof(task_t) * MAX_TASKS);
+
+	for (int32_t i = MAX_TASKS - 1; i >= 0; i--) {
+		thread_pool.scheduler.tasks[i].next = thread_pool.scheduler.free;
+		thread_pool.scheduler.free = &thread_pool.scheduler.tasks[i];
+	}
+
 	Thread_Init_(num_threads);
 }
 
@@ -196,6 +537,23 @@ void Thread_Init(uint16_t num_threads) {
  */
 void Thread_Shutdown(void) {
 
+	if (thread_pool.scheduler.mutex) {
+		Task_WaitAll();
+
+		// detached workers may still be dispatching, so let them retire
+		while (true) {
+			SDL_mutexP(thread_pool.scheduler.mutex);
+			const uint16_t num_workers = thread_pool.scheduler.num_workers;
+			SDL_mutexV(thread_pool.scheduler.mutex);
+
+			if (num_workers == 0) {
+				break;
+			}
+
+			usleep(0);
+		}
+	}
+
 	if (thread_pool.mutex) {
 		SDL_DestroyMutex(thread_pool.mutex);
 		thread_pool.mutex = NULL;
@@ -203,5 +561,10 @@ void Thread_Shutdown(void) {
 
 	Thread_Shutdown_();
 
+	if (thread_pool.scheduler.mutex) {
+		SDL_DestroyMutex(thread_pool.scheduler.mutex);
+		Mem_Free(thread_pool.scheduler.tasks);
+	}
+
 	memset(&thread_pool, 0, sizeof(thread_pool));
 }
@@ -28,6 +28,9 @@
 
 #define MAX_THREADS 128
 
+#define MAX_TASKS 1024
+#define MAX_TASK_DEPENDENCIES 8
+
 typedef enum {
 	THREAD_IDLE,
 	THREAD_RUNNING,
@@ -44,12 +47,53 @@ typedef struct {
 	thread_status_t status;
 	ThreadRunFunc Run;
 	void *data;
+	_Bool detached; // return to idle without Thread_Wait
 } thread_t;
 
+typedef enum {
+	TASK_IDLE,
+	TASK_PENDING,
+	TASK_RUNNING,
+	TASK_DONE
+} task_status_t;
+
+/**
+ * @brief A dependency on a task, qualified by the generation of the task slot
+ * at the time the dependency was declared.
+ */
+typedef struct {
+	const struct task_s *task;
+	uint32_t generation;
+} task_dependency_t;
+
+/**
+ * @brief Tasks are units of work scheduled onto the thread pool. A task runs
+ * once all of its dependencies have completed.
+ */
+typedef struct task_s {
+	char name[64];
+	ThreadRunFunc Run;
+	void *data;
+	task_dependency_t dependencies[MAX_TASK_DEPENDENCIES];
+	uint16_t num_dependencies;
+	SDL_atomic_t status;
+	uint32_t generation;
+	struct task_s *next;
+} task_t;
+
+typedef void (*ThreadRangeFunc)(void *data, int32_t begin, int32_t end);
+
 thread_t *Thread_Create_(const char *name, ThreadRunFunc run, void *data);
 #define Thread_Create(f, d) Thread_Create_(#f, f, d)
 void Thread_Wait(thread_t *t);
 uint16_t Thread_Count(void);
+task_t *Task_Submit_(const char *name, ThreadRunFunc run, void *data, task_t **dependencies, size_t num_dependencies);
+#define Task_Submit(f, d) Task_Submit_(#f, f, d, NULL, 0)
+#define Task_SubmitAfter(f, d, deps, num_deps) Task_Submit_(#f, f, d, deps, num_deps)
+void Task_Wait(task_t *task);
+void Task_WaitAll(void);
+void Task_ParallelFor_(const char *name, ThreadRangeFunc func, void *data, int32_t count, int32_t grain);
+#define Task_ParallelFor(f, d, c, g) Task_ParallelFor_(#f, f, d, c, g)
 void Thread_Init(uint16_t num_threads);
 void Thread_Shutdown(void);
 
@@ -0,0 +1,199 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "quemap.h"
+
+/*
+ * Arenas back the small, short-lived objects of the compile stages: windings,
+ * brushes, faces and portals. Each thread bump-allocates from its own arena,
+ * so that the global lock and tag table of Mem_Malloc are only touched once per
+ * block. Freed chunks are kept on per-thread free lists by size class, which
+ * for windings amounts to a free list per point count. All arenas are released
+ * at once by ArenaReset, between compile stages.
+ */
+
+#define ARENA_ALIGN 16
+#define ARENA_BLOCK_SIZE (1 << 20)
+#define ARENA_MAX_SIZE 4096 // larger allocations fall through to Mem_Malloc
+#define ARENA_NUM_CLASSES (ARENA_MAX_SIZE / ARENA_ALIGN + 1)
+
+/**
+ * @brief The header preceding each allocation. While the chunk is free, its
+ * payload links it into the free list for its size class.
+ */
+typedef union arena_chunk_s {
+	struct {
+		int32_t size_class; // payload size in units of ARENA_ALIGN, or -1 if oversized
+	};
+	byte pad[ARENA_ALIGN];
+} arena_chunk_t;
+
+typedef struct arena_free_s {
+	struct arena_free_s *next;
+} arena_free_t;
+
+typedef struct {
+	byte *blocks; // the most recently allocated block, which links to the previous
+	byte *pointer; // the next free byte of the current block
+	byte *end; // the end of the current block
+	arena_free_t *free[ARENA_NUM_CLASSES];
+	size_t size; // total block size
+} arena_t;
+
+static struct {
+	thread_buffers_t arenas;
+	size_t peak; // the largest total size of all arenas
+} arena_state;
+
+static __thread thread_buffer_t thread_arena;
+
+/**
+ * @return The calling thread's arena, allocating it if necessary.
+ */
+static arena_t *ThreadArena(void) {
+	return ThreadBuffer(&arena_state.arenas, &thread_arena, sizeof(arena_t));
+}
+
+/**
+ * @brief Starts a new block for the specified arena.
+ */
+static void ArenaGrow(arena_t *arena) {
+
+	byte *block = Mem_Malloc(ARENA_BLOCK_SIZE);
+
+	*(byte **) block = arena->blocks;
+	arena->blocks = block;
+
+	arena->pointer = block + ARENA_ALIGN;
+	arena->end = block + ARENA_BLOCK_SIZE;
+
+	arena->size += ARENA_BLOCK_SIZE;
+}
+
+/**
+ * @brief Allocates zeroed memory from the calling thread's arena.
+ */
+void *ArenaMalloc(size_t size) {
+	arena_chunk_t *chunk;
+
+	// every pooled chunk must hold the free list link, even for empty requests
+	const int32_t size_class = (int32_t) MAX((size + ARENA_ALIGN - 1) / ARENA_ALIGN, 1);
+
+	if (size_class >= ARENA_NUM_CLASSES) {
+		chunk = Mem_Malloc(sizeof(arena_chunk_t) + size);
+		chunk->size_class = -1;
+		return chunk + 1;
+	}
+
+	arena_t *arena = ThreadArena();
+
+	arena_free_t *free = arena->free[size_class];
+	if (free) {
+		arena->free[size_class] = free->next;
+		chunk = ((arena_chunk_t *) free) - 1;
+	} else {
+		const size_t chunk_size = sizeof(arena_chunk_t) + size_class * ARENA_ALIGN;
+
+		if (arena->pointer + chunk_size > arena->end) {
+			ArenaGrow(arena);
+		}
+
+		chunk = (arena_chunk_t *) arena->pointer;
+		arena->pointer += chunk_size;
+	}
+
+	chunk->size_class = size_class;
+
+	memset(chunk + 1, 0, size_class * ARENA_ALIGN);
+	return chunk + 1;
+}
+
+/**
+ * @brief Returns memory allocated by ArenaMalloc to the calling thread's free
+ * list for its size class. The memory may have been allocated by any thread.
+ */
+void ArenaFree(void *p) {
+
+	arena_chunk_t *chunk = ((arena_chunk_t *) p) - 1;
+
+	if (chunk->size_class == -1) {
+		Mem_Free(chunk);
+		return;
+	}
+
+	arena_t *arena = ThreadArena();
+
+	arena_free_t *free = (arena_free_t *) p;
+	free->next = arena->free[chunk->size_class];
+	arena->free[chunk->size_class] = free;
+}
+
+/**
+ * @brief ThreadBufferFunc for ArenaSize.
+ */
+static void ArenaSize_(void *buffer, void *data) {
+	*(size_t *) data += ((const arena_t *) buffer)->size;
+}
+
+/**
+ * @return The total size of all arenas, in bytes.
+ */
+size_t ArenaSize(void) {
+	size_t size = 0;
+
+	ForEachThreadBuffer(&arena_state.arenas, ArenaSize_, &size);
+
+	return size;
+}
+
+/**
+ * @return The largest total size of all arenas, in bytes, at any reset.
+ */
+size_t ArenaPeakSize(void) {
+	return MAX(arena_state.peak, ArenaSize());
+}
+
+/**
+ * @brief ThreadBufferFunc for ArenaReset, which frees the blocks of an arena.
+ */
+static void ArenaReset_(void *buffer, void *data __attribute__((unused))) {
+
+	byte *block = ((arena_t *) buffer)->blocks;
+	while (block) {
+		byte *prev = *(byte **) block;
+		Mem_Free(block);
+		block = prev;
+	}
+}
+
+/**
+ * @brief Releases all arenas, and everything allocated from them. This must
+ * only be called between compile stages, while no other threads are working.
+ * Oversized allocations are not tracked, and must still be freed.
+ */
+void ArenaReset(void) {
+
+	arena_state.peak = ArenaPeakSize();
+
+	ForEachThreadBuffer(&arena_state.arenas, ArenaReset_, NULL);
+
+	FreeThreadBuffers(&arena_state.arenas);
+}
@@ -193,7 +193,7 @@ bsp_brush_t *AllocBrush(int32_t num_sides) {
 	if (debug)
 		SDL_SemPost(semaphores.active_brushes);
 
-	return Mem_Malloc(size);
+	return ArenaMalloc(size);
 }
 
 /**
@@ -209,7 +209,7 @@ void FreeBrush(bsp_brush_t * brush) {
 	if (debug)
 		SDL_SemWait(semaphores.active_brushes);
 
-	Mem_Free(brush);
+	ArenaFree(brush);
 }
 
 /**
@@ -452,32 +452,121 @@ static _Bool CheckPlaneAgainstVolume(int32_t pnum, node_t * node) {
 	return good;
 }
 
+/**
+ * @brief A candidate split plane, and its value once scored.
+ */
+typedef struct {
+	side_t *side;
+	int32_t plane_num;
+	int32_t value;
+	_Bool valid; // false if the plane would produce a tiny volume
+} split_candidate_t;
+
+typedef struct {
+	bsp_brush_t *brushes;
+	node_t *node;
+	split_candidate_t *candidates;
+} split_candidates_t;
+
+/**
+ * @brief Candidate scoring is spread across threads once the number of brush
+ * tests for a node reaches this.
+ */
+#define SPLIT_CANDIDATES_PARALLEL 4096
+
+/**
+ * @brief Gives a value estimate for partitioning the brushes with the specified
+ * candidate. This does not modify the brushes, and so is safe to call from any
+ * thread.
+ */
+static void ScoreSplitCandidate(bsp_brush_t *brushes, node_t *node, split_candidate_t *c) {
+	int32_t s, bsplits;
+	_Bool hintsplit;
+
+	c->valid = CheckPlaneAgainstVolume(c->plane_num, node);
+	if (!c->valid) {
+		return; // would produce a tiny volume
+	}
+
+	int32_t front = 0, back = 0, facing = 0, splits = 0, epsilonbrush = 0;
+	hintsplit = false;
+
+	for (bsp_brush_t *test = brushes; test; test = test->next) {
+		s = TestBrushToPlanenum(test, c->plane_num, &bsplits, &hintsplit, &epsilonbrush);
+
+		splits += bsplits;
+		if (bsplits && (s & SIDE_FACING))
+			Com_Error(ERR_FATAL, "SIDE_FACING with splits\n");
+
+		if (s & SIDE_FACING)
+			facing++;
+		if (s & SIDE_FRONT)
+			front++;
+		if (s & SIDE_BACK)
+			back++;
+	}
+
+	c->value = 5 * facing - 5 * splits - abs(front - back);
+	if (AXIAL(&map_planes[c->plane_num]))
+		c->value += 5; // axial is better
+	c->value -= epsilonbrush * 1000; // avoid!
+
+	// never split a hint side except with another hint
+	if (hintsplit && !(c->side->surf & SURF_HINT))
+		c->value = -9999999;
+}
+
+/**
+ * @brief ThreadRangeFunc for SelectSplitSide.
+ */
+static void ScoreSplitCandidates(void *data, int32_t begin, int32_t end) {
+	split_candidates_t *candidates = (split_candidates_t *) data;
+
+	for (int32_t i = begin; i < end; i++) {
+		ScoreSplitCandidate(candidates->brushes, candidates->node, &candidates->candidates[i]);
+	}
+}
+
 /**
  * @brief Using a heuristic, chooses one of the sides out of the brush list
  * to partition the brushes with.
  * Returns NULL if there are no valid planes to split with..
+ *
+ * @remarks Each plane is scored once, for the first side on it in search order,
+ * and the first of the best valued candidates is chosen. The candidates are
+ * scored in parallel for large nodes, so the choice is independent of the
+ * number of threads.
  */
-static side_t *SelectSplitSide(bsp_brush_t * brushes, node_t * node) {
-	int32_t value, bestvalue;
-	bsp_brush_t *brush, *test;
+static side_t *SelectSplitSide(bsp_brush_t *brushes, node_t *node) {
+	byte considered[MAX_BSP_PLANES / 16]; // positive planes already scored
+	bsp_brush_t *brush;
 	side_t *side, *bestside;
-	int32_t i, j, pass, numpasses;
-	int32_t pnum;
-	int32_t s;
-	int32_t front, back, both, facing, splits;
-	int32_t bsplits;
-	int32_t epsilonbrush;
-	_Bool hintsplit;
+	int32_t i, pass, pnum, bestvalue, num_brushes, num_sides;
 
 	bestside = NULL;
 	bestvalue = -99999;
 
+	num_brushes = num_sides = 0;
+	for (brush = brushes; brush; brush = brush->next) {
+		num_brushes++;
+		num_sides += brush->num_sides;
+	}
+
+	split_candidates_t candidates = {
+		.brushes = brushes,
+		.node = node,
+		.candidates = Mem_Malloc(MAX(num_sides, 1) * sizeof(split_candidate_t))
+	};
+
+	memset(considered, 0, sizeof(considered));
+
 	// the search order goes: visible-structural, visible-detail,
 	// nonvisible-structural, nonvisible-detail.
 	// If any valid plane is available in a pass, no further
 	// passes will be tried.
-	numpasses = 4;
-	for (pass = 0; pass < numpasses; pass++) {
+	for (pass = 0; pass < 4; pass++) {
+		int32_t num_candidates = 0;
+
 		for (brush = brushes; brush; brush = brush->next) {
 			if ((pass & 1) && !(brush->original->contents & CONTENTS_DETAIL))
 				continue;
@@ -491,8 +580,6 @@ static side_t *SelectSplitSide(bsp_brush_t * brushes, node_t * node) {
 					continue; // nothing visible, so it can't split
 				if (side->texinfo == TEXINFO_NODE)
 					continue; // already a node splitter
-				if (side->tested)
-					continue; // we already have metrics for this plane
 				if (side->surf & SURF_SKIP)
 					continue; // skip surfaces are never chosen
 				if (side->visible ^ (pass < 2))
@@ -501,64 +588,31 @@ static side_t *SelectSplitSide(bsp_brush_t * brushes, node_t * node) {
 				pnum = side->plane_num;
 				pnum &= ~1; // always use positive facing plane
 
+				if (considered[pnum >> 4] & (1 << ((pnum >> 1) & 7)))
+					continue; // we already have metrics for this plane
+
+				considered[pnum >> 4] |= (1 << ((pnum >> 1) & 7));
+
 				CheckPlaneAgainstParents(pnum, node);
 
-				if (!CheckPlaneAgainstVolume(pnum, node))
-					continue; // would produce a tiny volume
-
-				front = 0;
-				back = 0;
-				both = 0;
-				facing = 0;
-				splits = 0;
-				epsilonbrush = 0;
-				hintsplit = false;
-
-				for (test = brushes; test; test = test->next) {
-					s = TestBrushToPlanenum(test, pnum, &bsplits, &hintsplit, &epsilonbrush);
-
-					splits += bsplits;
-					if (bsplits && (s & SIDE_FACING))
-						Com_Error(ERR_FATAL, "SIDE_FACING with splits\n");
-
-					test->test_side = s;
-					// if the brush shares this face, don't bother
-					// testing that facenum as a splitter again
-					if (s & SIDE_FACING) {
-						facing++;
-						for (j = 0; j < test->num_sides; j++) {
-							if ((test->sides[j].plane_num & ~1) == pnum)
-								test->sides[j].tested = true;
-						}
-					}
-					if (s & SIDE_FRONT)
-						front++;
-					if (s & SIDE_BACK)
-						back++;
-					if (s == SIDE_BOTH)
-						both++;
-				}
-
-				// give a value estimate for using this plane
-
-				value = 5 * facing - 5 * splits - abs(front - back);
-				if (AXIAL(&map_planes[pnum]))
-					value += 5; // axial is better
-				value -= epsilonbrush * 1000; // avoid!
-
-				// never split a hint side except with another hint
-				if (hintsplit && !(side->surf & SURF_HINT))
-					value = -9999999;
-
-				// save off the side test so we don't need
-				// to recalculate it when we actually seperate
-				// the brushes
-				if (value > bestvalue) {
-					bestvalue = value;
-					bestside = side;
-					for (test = brushes; test; test = test->next)
-						test->side = test->test_side;
-				}
+				candidates.candidates[num_candidates++] = (split_candidate_t) {
+					.side = side,
+					.plane_num = pnum
+				};
+			}
+		}
+
+		if (num_candidates * num_brushes >= SPLIT_CANDIDATES_PARALLEL) {
+			Task_ParallelFor(ScoreSplitCandidates, &candidates, num_candidates, 1);
+		} else {
+			ScoreSplitCandidates(&candidates, 0, num_candidates);
+		}
+
+		for (i = 0; i < num_candidates; i++) {
+			const split_candidate_t *c = &candidates.candidates[i];
+			if (c->valid && c->value > bestvalue) {
+				bestvalue = c->value;
+				bestside = c->side;
 			}
 		}
 
@@ -574,10 +628,19 @@ static side_t *SelectSplitSide(bsp_brush_t * brushes, node_t * node) {
 		}
 	}
 
-	// clear all the tested flags we set
-	for (brush = brushes; brush; brush = brush->next) {
-		for (i = 0; i < brush->num_sides; i++)
-			brush->sides[i].tested = false;
+	Mem_Free(candidates.candidates);
+
+	// save off the side test so we don't need
+	// to recalculate it when we actually seperate
+	// the brushes
+	if (bestside) {
+		int32_t bsplits, epsilonbrush = 0;
+		_Bool hintsplit;
+
+		for (brush = brushes; brush; brush = brush->next) {
+			brush->side = TestBrushToPlanenum(brush, bestside->plane_num & ~1, &bsplits, &hintsplit,
+					&epsilonbrush);
+		}
 	}
 
 	return bestside;
@@ -700,7 +763,6 @@ void SplitBrush(bsp_brush_t *brush, int32_t plane_num, bsp_brush_t **front, bsp_
 			*cs = *s;
 
 			cs->winding = cw[j];
-			cs->tested = false;
 		}
 	}
 
@@ -744,7 +806,6 @@ void SplitBrush(bsp_brush_t *brush, int32_t plane_num, bsp_brush_t **front, bsp_
 		cs->plane_num = plane_num ^ i ^ 1;
 		cs->texinfo = TEXINFO_NODE;
 		cs->visible = false;
-		cs->tested = false;
 		if (i == 0)
 			cs->winding = CopyWinding(midwinding);
 		else
@@ -823,6 +884,27 @@ static void SplitBrushList(bsp_brush_t * brushes, node_t * node, bsp_brush_t **
 	}
 }
 
+/**
+ * @brief Sibling subtrees are built concurrently once both hold this many brushes.
+ */
+#define BUILD_TREE_TASK_BRUSHES 32
+
+typedef struct {
+	node_t *node;
+	bsp_brush_t *brushes;
+} build_tree_t;
+
+static node_t *BuildTree_r(node_t * node, bsp_brush_t * brushes);
+
+/**
+ * @brief ThreadRunFunc for building a subtree.
+ */
+static void BuildTree_Task(void *data) {
+	build_tree_t *build = (build_tree_t *) data;
+
+	BuildTree_r(build->node, build->brushes);
+}
+
 /*
  * ================
  * BuildTree_r
@@ -863,9 +945,25 @@ static node_t *BuildTree_r(node_t * node, bsp_brush_t * brushes) {
 	SplitBrush(node->volume, node->plane_num, &node->children[0]->volume,
 			&node->children[1]->volume);
 
-	// recursively process children
-	for (i = 0; i < 2; i++) {
-		node->children[i] = BuildTree_r(node->children[i], children[i]);
+	// recursively process children, building the front as a task if both are
+	// large enough. Subtrees share no state, so the tree is the same either way.
+	if (Thread_Count() && CountBrushList(children[0]) >= BUILD_TREE_TASK_BRUSHES &&
+			CountBrushList(children[1]) >= BUILD_TREE_TASK_BRUSHES) {
+
+		build_tree_t front = {
+			.node = node->children[0],
+			.brushes = children[0]
+		};
+
+		task_t *task = Task_Submit(BuildTree_Task, &front);
+
+		node->children[1] = BuildTree_r(node->children[1], children[1]);
+
+		Task_Wait(task);
+	} else {
+		for (i = 0; i < 2; i++) {
+			node->children[i] = BuildTree_r(node->children[i], children[i]);
+		}
 	}
 
 	return node;
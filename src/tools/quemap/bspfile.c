@@ -256,16 +256,19 @@ void LoadBSPFile(char *file_name) {
 	if (header->ident != BSP_IDENT)
 		Com_Error(ERR_FATAL, "%s is not a IBSP file\n", file_name);
 
-	if (header->version != BSP_VERSION && header->version != BSP_VERSION_QUETOO)
+	if (!BSP_VERSION_SUPPORTED(header->version))
 		Com_Error(ERR_FATAL, "%s is unsupported version %i\n", file_name,
 				header->version);
 
+	if (header->version != BSP_VERSION_QUETOO) // shorter header, see BSP_VERSION_QUETOO_NO_LIGHT_GRID
+		memset(&header->lumps[BSP_LUMP_LIGHT_GRID], 0, sizeof(d_bsp_lump_t));
+
 	d_bsp.num_models = CopyLump(BSP_LUMP_MODELS, d_bsp.models, sizeof(d_bsp_model_t));
 	d_bsp.num_vertexes = CopyLump(BSP_LUMP_VERTEXES, d_bsp.vertexes, sizeof(d_bsp_vertex_t));
 
 	d_bsp.num_normals = d_bsp.num_vertexes;
 
-	if (header->version == BSP_VERSION_QUETOO) // enhanced format
+	if (header->version != BSP_VERSION) // enhanced format
 		d_bsp.num_normals = CopyLump(BSP_LUMP_NORMALS, d_bsp.normals, sizeof(d_bsp_normal_t));
 
 	d_bsp.num_planes = CopyLump(BSP_LUMP_PLANES, d_bsp.planes, sizeof(d_bsp_plane_t));
@@ -289,6 +292,9 @@ void LoadBSPFile(char *file_name) {
 
 	d_bsp.vis_data_size = CopyLump(BSP_LUMP_VISIBILITY, d_bsp.vis_data, 1);
 	d_bsp.lightmap_data_size = CopyLump(BSP_LUMP_LIGHTMAPS, d_bsp.lightmap_data, 1);
+
+	d_bsp.light_grid_size = CopyLump(BSP_LUMP_LIGHT_GRID, d_bsp.light_grid, 1);
+
 	d_bsp.entity_string_len = CopyLump(BSP_LUMP_ENTITIES, d_bsp.entity_string, 1);
 
 	CopyLump(BSP_LUMP_POP, d_bsp.dpop, 1);
@@ -324,7 +330,7 @@ void LoadBSPFileTexinfo(char *file_name) {
 	if (header->ident != BSP_IDENT)
 		Com_Error(ERR_FATAL, "%s is not a bsp file\n", file_name);
 
-	if (header->version != BSP_VERSION && header->version != BSP_VERSION_QUETOO)
+	if (!BSP_VERSION_SUPPORTED(header->version))
 		Com_Error(ERR_FATAL, "%s is unsupported version %i\n", file_name,
 				header->version);
 
@@ -409,6 +415,10 @@ void WriteBSPFile(char *file_name) {
 			d_bsp.num_area_portals * sizeof(d_bsp_area_portal_t));
 
 	AddLump(BSP_LUMP_LIGHTMAPS, d_bsp.lightmap_data, d_bsp.lightmap_data_size);
+
+	if (!legacy) // only BSP_VERSION_QUETOO has a light grid lump
+		AddLump(BSP_LUMP_LIGHT_GRID, d_bsp.light_grid, d_bsp.light_grid_size);
+
 	AddLump(BSP_LUMP_VISIBILITY, d_bsp.vis_data, d_bsp.vis_data_size);
 	AddLump(BSP_LUMP_ENTITIES, d_bsp.entity_string, d_bsp.entity_string_len);
 	AddLump(BSP_LUMP_POP, d_bsp.dpop, sizeof(d_bsp.dpop));
@@ -478,6 +488,8 @@ void PrintBSPFileSizes(void) {
 	Com_Verbose("      lightmap     %7i\n", d_bsp.lightmap_data_size);
 
 	Com_Verbose("      vis          %7i\n", d_bsp.vis_data_size);
+
+	Com_Verbose("      light grid   %7i\n", d_bsp.light_grid_size);
 }
 
 uint16_t num_entities;
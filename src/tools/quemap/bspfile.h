@@ -34,6 +34,9 @@ typedef struct d_bsp_s {
 	int32_t lightmap_data_size;
 	byte lightmap_data[MAX_BSP_LIGHTING];
 
+	int32_t light_grid_size;
+	byte light_grid[MAX_BSP_LIGHT_GRID]; // little endian, see d_bsp_light_grid_t
+
 	int32_t entity_string_len;
 	char entity_string[MAX_BSP_ENT_STRING];
 
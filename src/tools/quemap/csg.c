@@ -305,19 +305,16 @@ static inline _Bool BrushGE(const bsp_brush_t * b1, const bsp_brush_t * b2) {
 }
 
 /**
- * @brief Carves any intersecting solid brushes into the minimum number
- * of non-intersecting brushes.
+ * @brief Carves any intersecting solid brushes of a single cluster into the
+ * minimum number of non-intersecting brushes.
  */
-bsp_brush_t *ChopBrushes(bsp_brush_t * head) {
+static bsp_brush_t *ChopBrushList(bsp_brush_t * head) {
 	bsp_brush_t *b1, *b2, *next;
 	bsp_brush_t *tail;
 	bsp_brush_t *keep;
 	bsp_brush_t *sub, *sub2;
 	int32_t c1, c2;
 
-	Com_Verbose("---- ChopBrushes ----\n");
-	Com_Verbose("original brushes: %i\n", CountBrushList(head));
-
 	keep = NULL;
 
 	newlist:
@@ -395,6 +392,179 @@ bsp_brush_t *ChopBrushes(bsp_brush_t * head) {
 		}
 	}
 
+	return keep;
+}
+
+/**
+ * @brief A set of brushes whose bounds overlap, directly or transitively. Chopping
+ * only ever shrinks brushes, so clusters may be chopped independently.
+ */
+typedef struct {
+	bsp_brush_t *head, *tail;
+	int32_t num_brushes;
+} chop_cluster_t;
+
+typedef struct {
+	vec_t min;
+	int32_t index;
+} chop_sweep_t;
+
+/**
+ * @brief qsort comparator for the sweep along the X axis.
+ */
+static int32_t ChopSweep_Compare(const void *a, const void *b) {
+	const chop_sweep_t *sa = (const chop_sweep_t *) a;
+	const chop_sweep_t *sb = (const chop_sweep_t *) b;
+
+	if (sa->min == sb->min) {
+		return sa->index - sb->index;
+	}
+
+	return sa->min < sb->min ? -1 : 1;
+}
+
+/**
+ * @return The root of the specified brush's cluster.
+ */
+static int32_t ChopClusterRoot(int32_t *parents, int32_t i) {
+
+	while (parents[i] != i) {
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+
+	return i;
+}
+
+/**
+ * @brief ThreadRangeFunc for ChopBrushes.
+ */
+static void ChopClusters(void *data, int32_t begin, int32_t end) {
+	chop_cluster_t *clusters = (chop_cluster_t *) data;
+
+	for (int32_t i = begin; i < end; i++) {
+		if (clusters[i].num_brushes > 1) {
+			clusters[i].head = ChopBrushList(clusters[i].head);
+		}
+	}
+}
+
+/**
+ * @brief Carves any intersecting solid brushes into the minimum number
+ * of non-intersecting brushes.
+ *
+ * @remarks The brushes are first partitioned into clusters of overlapping bounds
+ * by sweeping along the X axis, so that only brushes which may intersect are
+ * ever tested against one another. The clusters are then chopped in parallel,
+ * and reassembled in the order of their first brush.
+ */
+bsp_brush_t *ChopBrushes(bsp_brush_t * head) {
+	int32_t i, j;
+
+	Com_Verbose("---- ChopBrushes ----\n");
+
+	const int32_t num_brushes = CountBrushList(head);
+	Com_Verbose("original brushes: %i\n", num_brushes);
+
+	if (!num_brushes)
+		return NULL;
+
+	bsp_brush_t **brushes = Mem_Malloc(num_brushes * sizeof(bsp_brush_t *));
+	chop_sweep_t *sweep = Mem_Malloc(num_brushes * sizeof(chop_sweep_t));
+	int32_t *parents = Mem_Malloc(num_brushes * sizeof(int32_t));
+	int32_t *active = Mem_Malloc(num_brushes * sizeof(int32_t));
+
+	bsp_brush_t *b = head;
+	for (i = 0; i < num_brushes; i++, b = b->next) {
+		brushes[i] = b;
+		sweep[i].min = b->mins[0];
+		sweep[i].index = i;
+		parents[i] = i;
+	}
+
+	qsort(sweep, num_brushes, sizeof(chop_sweep_t), ChopSweep_Compare);
+
+	// sweep along X, joining the clusters of any brushes whose bounds overlap
+	int32_t num_active = 0;
+	for (i = 0; i < num_brushes; i++) {
+		const bsp_brush_t *b1 = brushes[sweep[i].index];
+
+		int32_t k = 0;
+		for (j = 0; j < num_active; j++) {
+			const bsp_brush_t *b2 = brushes[active[j]];
+
+			if (b2->maxs[0] <= b1->mins[0]) {
+				continue; // no longer overlapping the sweep
+			}
+
+			active[k++] = active[j];
+
+			if (b1->mins[1] >= b2->maxs[1] || b1->maxs[1] <= b2->mins[1] ||
+				b1->mins[2] >= b2->maxs[2] || b1->maxs[2] <= b2->mins[2]) {
+				continue;
+			}
+
+			const int32_t r1 = ChopClusterRoot(parents, sweep[i].index);
+			const int32_t r2 = ChopClusterRoot(parents, active[j]);
+
+			if (r1 != r2) {
+				parents[MAX(r1, r2)] = MIN(r1, r2);
+			}
+		}
+
+		active[k++] = sweep[i].index;
+		num_active = k;
+	}
+
+	// assemble the clusters, preserving the order of the brush list
+	chop_cluster_t *clusters = Mem_Malloc(num_brushes * sizeof(chop_cluster_t));
+	int32_t *cluster_nums = active;
+	int32_t num_clusters = 0;
+
+	for (i = 0; i < num_brushes; i++) {
+		const int32_t root = ChopClusterRoot(parents, i);
+
+		if (root == i) {
+			cluster_nums[i] = num_clusters++;
+		} else {
+			cluster_nums[i] = cluster_nums[root];
+		}
+
+		chop_cluster_t *cluster = &clusters[cluster_nums[i]];
+
+		brushes[i]->next = NULL;
+		if (cluster->tail) {
+			cluster->tail->next = brushes[i];
+		} else {
+			cluster->head = brushes[i];
+		}
+		cluster->tail = brushes[i];
+		cluster->num_brushes++;
+	}
+
+	Com_Verbose("chop clusters: %i\n", num_clusters);
+
+	Task_ParallelFor(ChopClusters, clusters, num_clusters, 1);
+
+	bsp_brush_t *keep = NULL, *tail = NULL;
+
+	for (i = 0; i < num_clusters; i++) {
+		for (b = clusters[i].head; b; b = b->next) {
+			if (tail) {
+				tail->next = b;
+			} else {
+				keep = b;
+			}
+			tail = b;
+		}
+	}
+
+	Mem_Free(clusters);
+	Mem_Free(active);
+	Mem_Free(parents);
+	Mem_Free(sweep);
+	Mem_Free(brushes);
+
 	Com_Verbose("output brushes: %i\n", CountBrushList(keep));
 	return keep;
 }
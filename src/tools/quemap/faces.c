@@ -143,7 +143,7 @@ static int32_t c_faces;
 static face_t *AllocFace(void) {
 	face_t *f;
 
-	f = Mem_Malloc(sizeof(*f));
+	f = ArenaMalloc(sizeof(*f));
 	c_faces++;
 
 	return f;
@@ -169,7 +169,7 @@ static face_t *NewFaceFromFace(const face_t *f) {
 void FreeFace(face_t *f) {
 	if (f->w)
 		FreeWinding(f->w);
-	Mem_Free(f);
+	ArenaFree(f);
 	c_faces--;
 }
 
@@ -41,12 +41,12 @@
  */
 
 size_t CountBits(const byte * bits, size_t max) {
-	size_t i, c;
 
-	c = 0;
-	for (i = 0; i < max; i++)
-		if (bits[i >> 3] & (1 << (i & 7)))
-			c++;
+	size_t c = Cm_BitsetCount(bits, max >> 3);
+
+	if (max & 7) {
+		c += __builtin_popcount(bits[max >> 3] & ((1 << (max & 7)) - 1));
+	}
 
 	return c;
 }
@@ -92,11 +92,11 @@ static winding_t *Vis_ChopWinding(winding_t *in, pstack_t *stack, plane_t *split
 
 	memset(counts, 0, sizeof(counts));
 
+	Vis_PlaneDistances(in, split, dists);
+
 	// determine sides for each point
 	for (i = 0; i < in->num_points; i++) {
-		dot = DotProduct(in->points[i], split->normal);
-		dot -= split->dist;
-		dists[i] = dot;
+		dot = dists[i];
 		if (dot > ON_EPSILON)
 			sides[i] = SIDE_FRONT;
 		else if (dot < -ON_EPSILON)
@@ -196,6 +196,7 @@ static winding_t *ClipToSeperators(winding_t * source, winding_t * pass, winding
 	vec_t length;
 	int32_t counts[3];
 	_Bool fliptest;
+	vec_t dists[MAX_POINTS_ON_WINDING];
 
 	// check all combinations
 	for (i = 0; i < source->num_points; i++) {
@@ -234,10 +235,11 @@ static winding_t *ClipToSeperators(winding_t * source, winding_t * pass, winding
 			//
 #if 1
 			fliptest = false;
+			Vis_PlaneDistances(source, &plane, dists);
 			for (k = 0; k < source->num_points; k++) {
 				if (k == i || k == l)
 					continue;
-				d = DotProduct(source->points[k], plane.normal) - plane.dist;
+				d = dists[k];
 				if (d < -ON_EPSILON) { // source is on the negative side, so we want all
 					// pass and target on the positive side
 					fliptest = false;
@@ -266,10 +268,11 @@ static winding_t *ClipToSeperators(winding_t * source, winding_t * pass, winding
 			// this is the seperating plane
 			//
 			counts[0] = counts[1] = counts[2] = 0;
+			Vis_PlaneDistances(pass, &plane, dists);
 			for (k = 0; k < pass->num_points; k++) {
 				if (k == j)
 					continue;
-				d = DotProduct(pass->points[k], plane.normal) - plane.dist;
+				d = dists[k];
 				if (d < -ON_EPSILON)
 					break;
 				else if (d > ON_EPSILON)
@@ -324,11 +327,12 @@ static void RecursiveLeafFlow(int32_t leaf_num, thread_data_t * thread, pstack_t
 	portal_t *p;
 	plane_t back_plane;
 	leaf_t *leaf;
-	uint32_t i, j;
-	long *test, *might, *vis, more;
+	uint32_t i;
+	const byte *test;
+	_Bool more;
 	int32_t pnum;
 
-	thread->c_chains++;
+	thread->stats.chains++;
 
 	leaf = &map_vis.leafs[leaf_num];
 
@@ -338,31 +342,27 @@ static void RecursiveLeafFlow(int32_t leaf_num, thread_data_t * thread, pstack_t
 	stack.leaf = leaf;
 	stack.portal = NULL;
 
-	might = (long *) stack.mightsee;
-	vis = (long *) thread->base->vis;
-
 	// check all portals for flowing into other leafs
 	for (i = 0; i < leaf->num_portals; i++) {
 		p = leaf->portals[i];
 		pnum = p - map_vis.portals;
 
-		if (!(prevstack->mightsee[pnum >> 3] & (1 << (pnum & 7)))) {
+		if (!Cm_BitsetTest(prevstack->mightsee, pnum)) {
+			thread->stats.mightsee++;
 			continue; // can't possibly see it
 		}
 		// if the portal can't see anything we haven't already seen, skip it
 		if (p->status == stat_done) {
-			test = (long *) p->vis;
+			test = p->vis;
 		} else {
-			test = (long *) p->flood;
+			test = p->flood;
 		}
 
-		more = 0;
-		for (j = 0; j < map_vis.portal_longs; j++) {
-			might[j] = ((long *) prevstack->mightsee)[j] & test[j];
-			more |= (might[j] & ~vis[j]);
-		}
+		more = Cm_BitsetAndAnyAndNot(stack.mightsee, prevstack->mightsee, test, thread->base->vis,
+				map_vis.portal_bytes);
 
-		if (!more && (thread->base->vis[pnum >> 3] & (1 << (pnum & 7)))) { // can't see anything new
+		if (!more && Cm_BitsetTest(thread->base->vis, pnum)) { // can't see anything new
+			thread->stats.nothing_new++;
 			continue;
 		}
 		// get plane of portal, point normal into the neighbor leaf
@@ -380,13 +380,16 @@ static void RecursiveLeafFlow(int32_t leaf_num, thread_data_t * thread, pstack_t
 			const vec_t d = DotProduct(p->origin, thread->pstack_head.portalplane.normal)
 					- thread->pstack_head.portalplane.dist;
 			if (d < -p->radius) {
+				thread->stats.behind++;
 				continue;
 			} else if (d > p->radius) {
 				stack.pass = p->winding;
 			} else {
 				stack.pass = Vis_ChopWinding(p->winding, &stack, &thread->pstack_head.portalplane);
-				if (!stack.pass)
+				if (!stack.pass) {
+					thread->stats.behind++;
 					continue;
+				}
 			}
 		}
 
@@ -396,14 +399,17 @@ static void RecursiveLeafFlow(int32_t leaf_num, thread_data_t * thread, pstack_t
 			const vec_t d = DotProduct(thread->base->origin, p->plane.normal) - p->plane.dist;
 			if (d > thread->base->radius) {
 				//if(d > p->radius){
+				thread->stats.source++;
 				continue;
 			} else if (d < -thread->base->radius) {
 				//} else if(d < -p->radius){
 				stack.source = prevstack->source;
 			} else {
 				stack.source = Vis_ChopWinding(prevstack->source, &stack, &back_plane);
-				if (!stack.source)
+				if (!stack.source) {
+					thread->stats.source++;
 					continue;
+				}
 			}
 		}
 
@@ -411,38 +417,97 @@ static void RecursiveLeafFlow(int32_t leaf_num, thread_data_t * thread, pstack_t
 
 			// mark the portal as visible
 			thread->base->vis[pnum >> 3] |= (1 << (pnum & 7));
+			thread->stats.visible++;
 
 			RecursiveLeafFlow(p->leaf, thread, &stack);
 			continue;
 		}
 
 		stack.pass = ClipToSeperators(stack.source, prevstack->pass, stack.pass, false, &stack);
-		if (!stack.pass)
+		if (!stack.pass) {
+			thread->stats.separators++;
 			continue;
+		}
 
 		stack.pass = ClipToSeperators(prevstack->pass, stack.source, stack.pass, true, &stack);
 
-		if (!stack.pass)
+		if (!stack.pass) {
+			thread->stats.separators++;
 			continue;
+		}
 
 		// mark the portal as visible
 		thread->base->vis[pnum >> 3] |= (1 << (pnum & 7));
+		thread->stats.visible++;
 
 		// flow through it for real
 		RecursiveLeafFlow(p->leaf, thread, &stack);
 	}
 }
 
+/**
+ * @brief The early-out statistics of each thread, accumulated by FinalVis.
+ */
+static thread_buffers_t vis_stats;
+
+static __thread thread_buffer_t thread_vis_stats;
+
+/**
+ * @return The calling thread's statistics, allocating them if necessary.
+ */
+static vis_stats_t *ThreadVisStats(void) {
+	return ThreadBuffer(&vis_stats, &thread_vis_stats, sizeof(vis_stats_t));
+}
+
+/**
+ * @brief ThreadBufferFunc for PrintVisStats.
+ */
+static void PrintVisStats_(void *buffer, void *data) {
+	const vis_stats_t *stats = buffer;
+	vis_stats_t *total = data;
+
+	total->chains += stats->chains;
+	total->mightsee += stats->mightsee;
+	total->nothing_new += stats->nothing_new;
+	total->behind += stats->behind;
+	total->source += stats->source;
+	total->separators += stats->separators;
+	total->visible += stats->visible;
+}
+
+/**
+ * @brief Prints the early-out statistics summed across all threads, and releases them.
+ */
+void PrintVisStats(void) {
+	vis_stats_t total;
+
+	memset(&total, 0, sizeof(total));
+
+	ForEachThreadBuffer(&vis_stats, PrintVisStats_, &total);
+
+	FreeThreadBuffers(&vis_stats);
+
+	Com_Verbose("Portal flow: %" PRIu64 " chains, %" PRIu64 " visible\n", total.chains, total.visible);
+
+	Com_Verbose("Portal flow early-outs: %" PRIu64 " mightsee, %" PRIu64 " nothing new, "
+			"%" PRIu64 " behind, %" PRIu64 " source clipped, %" PRIu64 " separator clipped\n",
+			total.mightsee, total.nothing_new, total.behind, total.source, total.separators);
+}
+
 /**
  * @brief Generates the vis bit vector.
  */
 void FinalVis(int32_t portal_num) {
 	thread_data_t data;
-	uint32_t i;
 	portal_t *p;
 	size_t c_might, c_can;
 
 	p = map_vis.sorted_portals[portal_num];
+
+	if (SkipPortal(p)) {
+		return;
+	}
+
 	p->status = stat_working;
 
 	c_might = CountBits(p->flood, map_vis.num_portals * 2);
@@ -454,18 +519,31 @@ void FinalVis(int32_t portal_num) {
 	data.pstack_head.source = p->winding;
 	data.pstack_head.portalplane = p->plane;
 
-	for (i = 0; i < map_vis.portal_longs; i++) {
-		((long *) data.pstack_head.mightsee)[i] = ((long *) p->flood)[i];
-	}
+	memcpy(data.pstack_head.mightsee, p->flood, map_vis.portal_bytes);
 
 	RecursiveLeafFlow(p->leaf, &data, &data.pstack_head);
 
 	p->status = stat_done;
 
+	CheckpointPortal(p);
+
 	c_can = CountBits(p->vis, map_vis.num_portals * 2);
 
-	Com_Debug("portal:%4i mightsee:%4i cansee:%4i (%i chains)\n",
-			(int32_t) (p - map_vis.portals), (int32_t) c_might, (int32_t) c_can, data.c_chains);
+	Com_Debug("portal:%4i mightsee:%4i cansee:%4i (%" PRIu64 " chains, early-outs: %" PRIu64
+			" mightsee, %" PRIu64 " nothing new, %" PRIu64 " behind, %" PRIu64 " source, %" PRIu64
+			" separators)\n", (int32_t) (p - map_vis.portals), (int32_t) c_might, (int32_t) c_can,
+			data.stats.chains, data.stats.mightsee, data.stats.nothing_new, data.stats.behind,
+			data.stats.source, data.stats.separators);
+
+	vis_stats_t *stats = ThreadVisStats();
+
+	stats->chains += data.stats.chains;
+	stats->mightsee += data.stats.mightsee;
+	stats->nothing_new += data.stats.nothing_new;
+	stats->behind += data.stats.behind;
+	stats->source += data.stats.source;
+	stats->separators += data.stats.separators;
+	stats->visible += data.stats.visible;
 }
 
 /**
@@ -482,10 +560,10 @@ static void SimpleFlood(portal_t *srcportal, int32_t leaf_num) {
 	for (i = 0; i < leaf->num_portals; i++) {
 		p = leaf->portals[i];
 		pnum = p - map_vis.portals;
-		if (!(srcportal->front[pnum >> 3] & (1 << (pnum & 7))))
+		if (!Cm_BitsetTest(srcportal->front, pnum))
 			continue;
 
-		if (srcportal->flood[pnum >> 3] & (1 << (pnum & 7)))
+		if (Cm_BitsetTest(srcportal->flood, pnum))
 			continue;
 
 		srcportal->flood[pnum >> 3] |= (1 << (pnum & 7));
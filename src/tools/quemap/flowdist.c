@@ -0,0 +1,69 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "qvis.h"
+
+#if defined(__SSE__)
+ #include <xmmintrin.h>
+#endif
+
+/*
+ * Fusing the multiplies and adds, on targets with FMA, would round differently
+ * in the kernel and its scalar tail, so that a point's distance depended on its
+ * index in the winding.
+ */
+#if defined(__clang__)
+ #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+ #pragma GCC optimize ("fp-contract=off")
+#endif
+
+/**
+ * @brief Resolves the distance of each point of the winding to the plane, four
+ * points at a time. The arithmetic is performed in the same order as the scalar
+ * DotProduct, and is never fused, so that results are identical.
+ */
+void Vis_PlaneDistances(const winding_t *w, const plane_t *plane, vec_t *dists) {
+	int32_t i = 0;
+
+#if defined(__SSE__)
+	const __m128 nx = _mm_set1_ps(plane->normal[0]);
+	const __m128 ny = _mm_set1_ps(plane->normal[1]);
+	const __m128 nz = _mm_set1_ps(plane->normal[2]);
+	const __m128 dist = _mm_set1_ps(plane->dist);
+
+	for (; i + 4 <= w->num_points; i += 4) {
+		const vec_t *p = w->points[i];
+
+		const __m128 x = _mm_setr_ps(p[0], p[3], p[6], p[9]);
+		const __m128 y = _mm_setr_ps(p[1], p[4], p[7], p[10]);
+		const __m128 z = _mm_setr_ps(p[2], p[5], p[8], p[11]);
+
+		const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, nx), _mm_mul_ps(y, ny)), _mm_mul_ps(z, nz));
+
+		_mm_storeu_ps(dists + i, _mm_sub_ps(dot, dist));
+	}
+#endif
+
+	for (; i < w->num_points; i++) {
+		dists[i] = DotProduct(w->points[i], plane->normal) - plane->dist;
+	}
+}
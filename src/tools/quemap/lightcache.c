@@ -0,0 +1,383 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "qlight.h"
+
+/*
+ * The light cache is a sidecar to the BSP file, ${bsp_name}.lcache, which
+ * retains the direct lighting of each face between runs. Faces are keyed by a
+ * hash of everything that BuildFacelights consumes: the sample positions and
+ * normals, the contributing lights, and the solid brushes which could occlude
+ * them. Faces whose key is unchanged reuse their cached samples and directions.
+ */
+
+#define LIGHT_CACHE_IDENT (('E' << 24) + ('H' << 16) + ('C' << 8) + 'L') // "LCHE"
+#define LIGHT_CACHE_VERSION 2
+
+typedef struct {
+	int32_t ident;
+	int32_t version;
+	int32_t num_faces;
+} light_cache_header_t;
+
+typedef struct {
+	uint64_t key;
+	int32_t num_samples;
+	const vec_t *samples;
+	const vec_t *directions;
+} light_cache_face_t;
+
+typedef struct {
+	_Bool solid;
+	vec3_t mins, maxs;
+	uint64_t hash;
+} light_cache_brush_t;
+
+_Bool light_cache = true;
+
+static struct {
+	void *buffer; // the loaded sidecar
+	light_cache_face_t *cached; // the faces within it
+	GHashTable *faces; // cached faces, by key
+
+	light_cache_face_t updated[MAX_BSP_FACES]; // faces lit by this run
+
+	light_cache_brush_t *brushes; // brushes which may occlude, by brush number
+
+	SDL_atomic_t hits, misses;
+} light_cache_state;
+
+/**
+ * @brief Resolves the bounds and hash of every solid brush. Brushes carry their
+ * axial planes, so their bounds are read directly from them.
+ */
+static void BuildLightCacheBrushes(void) {
+
+	light_cache_state.brushes = Mem_Malloc(MAX(d_bsp.num_brushes, 1) * sizeof(light_cache_brush_t));
+
+	for (int32_t i = 0; i < d_bsp.num_brushes; i++) {
+		const d_bsp_brush_t *b = &d_bsp.brushes[i];
+
+		if (!(b->contents & CONTENTS_SOLID)) {
+			continue;
+		}
+
+		light_cache_brush_t *brush = &light_cache_state.brushes[i];
+
+		brush->solid = true;
+
+		VectorSet(brush->mins, -MAX_WORLD_DIST, -MAX_WORLD_DIST, -MAX_WORLD_DIST);
+		VectorSet(brush->maxs, MAX_WORLD_DIST, MAX_WORLD_DIST, MAX_WORLD_DIST);
+
+		brush->hash = HashFNV(0, &b->contents, sizeof(b->contents));
+
+		for (int32_t j = 0; j < b->num_sides; j++) {
+			const d_bsp_brush_side_t *side = &d_bsp.brush_sides[b->first_side + j];
+			const d_bsp_plane_t *plane = &d_bsp.planes[side->plane_num];
+
+			for (int32_t k = 0; k < 3; k++) {
+				if (plane->normal[k] == 1.0) {
+					brush->maxs[k] = plane->dist;
+				} else if (plane->normal[k] == -1.0) {
+					brush->mins[k] = -plane->dist;
+				}
+			}
+
+			brush->hash = HashFNV(brush->hash, plane->normal, sizeof(vec3_t));
+			brush->hash = HashFNV(brush->hash, &plane->dist, sizeof(vec_t));
+
+			const int32_t flags = d_bsp.texinfo[side->surf_num].flags & SURF_SKY;
+			brush->hash = HashFNV(brush->hash, &flags, sizeof(flags));
+		}
+	}
+}
+
+/**
+ * @brief Marks the brushes of every leaf beneath the specified node which the
+ * bounds intersect.
+ */
+static void MarkLightCacheBrushes_r(int32_t node_num, const vec3_t mins, const vec3_t maxs, byte *marks) {
+
+	while (node_num >= 0) {
+		const d_bsp_node_t *node = &d_bsp.nodes[node_num];
+		const d_bsp_plane_t *plane = &d_bsp.planes[node->plane_num];
+
+		vec3_t near, far;
+		for (int32_t i = 0; i < 3; i++) {
+			if (plane->normal[i] < 0.0) {
+				near[i] = maxs[i];
+				far[i] = mins[i];
+			} else {
+				near[i] = mins[i];
+				far[i] = maxs[i];
+			}
+		}
+
+		const vec_t near_dist = DotProduct(plane->normal, near) - plane->dist;
+		const vec_t far_dist = DotProduct(plane->normal, far) - plane->dist;
+
+		if (near_dist >= 0.0) {
+			node_num = node->children[0];
+		} else if (far_dist < 0.0) {
+			node_num = node->children[1];
+		} else {
+			MarkLightCacheBrushes_r(node->children[0], mins, maxs, marks);
+			node_num = node->children[1];
+		}
+	}
+
+	const d_bsp_leaf_t *leaf = &d_bsp.leafs[-(node_num + 1)];
+
+	for (int32_t i = 0; i < leaf->num_leaf_brushes; i++) {
+		const int32_t brush_num = d_bsp.leaf_brushes[leaf->first_leaf_brush + i];
+		marks[brush_num >> 3] |= 1 << (brush_num & 7);
+	}
+}
+
+/**
+ * @brief Accumulates the hashes of all solid brushes intersecting the specified
+ * bounds, which must contain every occlusion ray cast for a face. The candidate
+ * brushes are gathered from the leafs of each model's BSP tree which the bounds
+ * reach, and are hashed in brush order so that the key is stable.
+ */
+uint64_t HashLightCacheOccluders(uint64_t hash, const vec3_t mins, const vec3_t maxs) {
+
+	byte *marks = Mem_Malloc(MAX((d_bsp.num_brushes + 7) >> 3, 1));
+
+	for (int32_t i = 0; i < d_bsp.num_models; i++) {
+		const d_bsp_model_t *model = &d_bsp.models[i];
+
+		if (i && (model->mins[0] > maxs[0] || model->maxs[0] < mins[0] ||
+				  model->mins[1] > maxs[1] || model->maxs[1] < mins[1] ||
+				  model->mins[2] > maxs[2] || model->maxs[2] < mins[2])) {
+			continue;
+		}
+
+		MarkLightCacheBrushes_r(model->head_node, mins, maxs, marks);
+	}
+
+	for (int32_t i = 0; i < d_bsp.num_brushes; i++) {
+
+		if (!(marks[i >> 3] & (1 << (i & 7)))) {
+			continue;
+		}
+
+		const light_cache_brush_t *brush = &light_cache_state.brushes[i];
+
+		if (!brush->solid) {
+			continue;
+		}
+
+		if (brush->mins[0] > maxs[0] || brush->maxs[0] < mins[0] ||
+			brush->mins[1] > maxs[1] || brush->maxs[1] < mins[1] ||
+			brush->mins[2] > maxs[2] || brush->maxs[2] < mins[2]) {
+			continue;
+		}
+
+		hash = HashFNV(hash, &brush->hash, sizeof(brush->hash));
+	}
+
+	Mem_Free(marks);
+
+	return hash;
+}
+
+/**
+ * @brief Resolves the light cache file name for the current BSP.
+ */
+static void LightCacheName(char *path, size_t len) {
+
+	StripExtension(bsp_name, path);
+	g_strlcat(path, ".lcache", len);
+}
+
+/**
+ * @brief Loads the light cache sidecar, if one exists, and prepares the brush
+ * occluders for keying faces.
+ */
+void LoadLightCache(void) {
+	char path[MAX_QPATH];
+
+	memset(&light_cache_state, 0, sizeof(light_cache_state));
+
+	if (!light_cache) {
+		return;
+	}
+
+	BuildLightCacheBrushes();
+
+	light_cache_state.faces = g_hash_table_new(g_int64_hash, g_int64_equal);
+
+	LightCacheName(path, sizeof(path));
+
+	const int64_t len = Fs_Load(path, &light_cache_state.buffer);
+	if (len == -1) {
+		Com_Verbose("No light cache at %s\n", path);
+		return;
+	}
+
+	const light_cache_header_t *header = (light_cache_header_t *) light_cache_state.buffer;
+
+	if (len < (int64_t) sizeof(*header) || header->ident != LIGHT_CACHE_IDENT
+			|| header->version != LIGHT_CACHE_VERSION) {
+		Com_Warn("Ignoring invalid light cache %s\n", path);
+		return;
+	}
+
+	light_cache_state.cached = Mem_Malloc(MAX(header->num_faces, 1) * sizeof(light_cache_face_t));
+
+	const byte *in = (const byte *) (header + 1);
+	const byte *end = (const byte *) light_cache_state.buffer + len;
+
+	for (int32_t i = 0; i < header->num_faces; i++) {
+
+		if (in + sizeof(uint64_t) + sizeof(int32_t) > end) {
+			break;
+		}
+
+		light_cache_face_t *face = &light_cache_state.cached[i];
+
+		memcpy(&face->key, in, sizeof(face->key));
+		in += sizeof(face->key);
+
+		memcpy(&face->num_samples, in, sizeof(face->num_samples));
+		in += sizeof(face->num_samples);
+
+		const size_t size = face->num_samples * sizeof(vec3_t);
+		if (face->num_samples < 0 || in + size * 2 > end) {
+			Com_Warn("Truncated light cache %s\n", path);
+			break;
+		}
+
+		face->samples = (const vec_t *) in;
+		in += size;
+
+		face->directions = (const vec_t *) in;
+		in += size;
+
+		g_hash_table_insert(light_cache_state.faces, &face->key, face);
+	}
+
+	Com_Verbose("Loaded %u cached faces from %s\n", g_hash_table_size(light_cache_state.faces), path);
+}
+
+/**
+ * @brief Copies the cached samples and directions for the specified key.
+ * @return True on a cache hit, false otherwise.
+ */
+_Bool LookupLightCache(uint64_t key, int32_t num_samples, vec_t *samples, vec_t *directions) {
+
+	if (!light_cache_state.faces) {
+		return false;
+	}
+
+	const light_cache_face_t *face = g_hash_table_lookup(light_cache_state.faces, &key);
+	if (face == NULL || face->num_samples != num_samples) {
+		SDL_AtomicIncRef(&light_cache_state.misses);
+		return false;
+	}
+
+	memcpy(samples, face->samples, num_samples * sizeof(vec3_t));
+	memcpy(directions, face->directions, num_samples * sizeof(vec3_t));
+
+	SDL_AtomicIncRef(&light_cache_state.hits);
+	return true;
+}
+
+/**
+ * @brief Records the direct lighting of the specified face for the next run.
+ * The sample and direction arrays must persist until WriteLightCache.
+ */
+void UpdateLightCache(int32_t face_num, uint64_t key, int32_t num_samples, const vec_t *samples,
+		const vec_t *directions) {
+
+	if (!light_cache_state.faces) {
+		return;
+	}
+
+	light_cache_face_t *face = &light_cache_state.updated[face_num];
+
+	face->key = key;
+	face->num_samples = num_samples;
+	face->samples = samples;
+	face->directions = directions;
+}
+
+/**
+ * @brief Writes the light cache sidecar for every face lit by this run, and
+ * releases the loaded cache.
+ */
+void WriteLightCache(void) {
+	char path[MAX_QPATH];
+	file_t *f;
+
+	if (!light_cache_state.faces) {
+		return;
+	}
+
+	Com_Verbose("Light cache: %d hits, %d misses\n", SDL_AtomicGet(&light_cache_state.hits),
+			SDL_AtomicGet(&light_cache_state.misses));
+
+	LightCacheName(path, sizeof(path));
+
+	if (!(f = Fs_OpenWrite(path))) {
+		Com_Warn("Couldn't open %s for writing\n", path);
+	} else {
+		light_cache_header_t header = {
+			.ident = LIGHT_CACHE_IDENT,
+			.version = LIGHT_CACHE_VERSION
+		};
+
+		for (int32_t i = 0; i < d_bsp.num_faces; i++) {
+			if (light_cache_state.updated[i].samples) {
+				header.num_faces++;
+			}
+		}
+
+		Fs_Write(f, &header, sizeof(header), 1);
+
+		for (int32_t i = 0; i < d_bsp.num_faces; i++) {
+			const light_cache_face_t *face = &light_cache_state.updated[i];
+
+			if (face->samples) {
+				Fs_Write(f, &face->key, sizeof(face->key), 1);
+				Fs_Write(f, &face->num_samples, sizeof(face->num_samples), 1);
+				Fs_Write(f, face->samples, sizeof(vec3_t), face->num_samples);
+				Fs_Write(f, face->directions, sizeof(vec3_t), face->num_samples);
+			}
+		}
+
+		Fs_Close(f);
+	}
+
+	g_hash_table_destroy(light_cache_state.faces);
+	light_cache_state.faces = NULL;
+
+	if (light_cache_state.buffer) {
+		Fs_Free(light_cache_state.buffer);
+	}
+
+	if (light_cache_state.cached) {
+		Mem_Free(light_cache_state.cached);
+	}
+
+	Mem_Free(light_cache_state.brushes);
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright(c) 1997-2001 id Software, Inc.
+ * Copyright(c) 2002 The Quakeforge Project.
+ * Copyright(c) 2006 Quetoo.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "qlight.h"
+
+/*
+ * The light grid samples the direct lighting of the world at regular intervals
+ * over the bounds of the world model, so that the renderer may light mesh
+ * entities without tracing. Bricks of cells which lie entirely in solid are
+ * omitted. See d_bsp_light_grid_t.
+ */
+
+static struct {
+	vec3_t mins;
+	vec3_t size;
+	int32_t bricks[3];
+	int32_t num_bricks; // total bricks, populated or not
+	d_bsp_light_grid_cell_t *cells; // the cells of every brick
+	_Bool *populated; // bricks with at least one cell out of solid
+} light_grid;
+
+/**
+ * @brief Encodes the specified light into the cell. The portion of the light
+ * arriving from the dominant direction is diffuse, and the remainder ambient.
+ */
+static void LightGridCell(const vec3_t sample, const vec3_t direction, vec_t total,
+		d_bsp_light_grid_cell_t *cell) {
+	vec3_t dir, a, d;
+
+	VectorCopy(direction, dir);
+	const vec_t directed = total > 0.0 ? Clamp(VectorNormalize(dir) / total, 0.0, 1.0) : 0.0;
+
+	if (directed == 0.0) {
+		VectorSet(dir, 0.0, 0.0, 1.0);
+	}
+
+	VectorScale(sample, directed / 255.0, d);
+	VectorScale(sample, (1.0 - directed) / 255.0, a);
+
+	// add an ambient term if desired
+	VectorAdd(a, ambient, a);
+
+	// apply brightness, saturation and contrast
+	ColorFilter(a, a, brightness, saturation, contrast);
+	ColorFilter(d, d, brightness, saturation, contrast);
+
+	for (int32_t i = 0; i < 3; i++) {
+		cell->ambient[i] = (byte) Clamp(a[i] * 255, 0, 255);
+		cell->diffuse[i] = (byte) Clamp(d[i] * 255, 0, 255);
+		cell->direction[i] = (byte) ((dir[i] + 1.0) * 127.0);
+	}
+}
+
+/**
+ * @brief Lights each cell of the specified brick which is not in solid.
+ */
+static void LightGridBrick(int32_t brick_num) {
+
+	const int32_t bx = brick_num % light_grid.bricks[0];
+	const int32_t by = (brick_num / light_grid.bricks[0]) % light_grid.bricks[1];
+	const int32_t bz = brick_num / (light_grid.bricks[0] * light_grid.bricks[1]);
+
+	d_bsp_light_grid_cell_t *cell = &light_grid.cells[brick_num * BSP_LIGHT_GRID_BRICK_CELLS];
+
+	for (int32_t z = 0; z < BSP_LIGHT_GRID_BRICK; z++) {
+		for (int32_t y = 0; y < BSP_LIGHT_GRID_BRICK; y++) {
+			for (int32_t x = 0; x < BSP_LIGHT_GRID_BRICK; x++, cell++) {
+				vec3_t pos, sample, direction;
+
+				pos[0] = light_grid.mins[0] + (bx * BSP_LIGHT_GRID_BRICK + x) * light_grid.size[0];
+				pos[1] = light_grid.mins[1] + (by * BSP_LIGHT_GRID_BRICK + y) * light_grid.size[1];
+				pos[2] = light_grid.mins[2] + (bz * BSP_LIGHT_GRID_BRICK + z) * light_grid.size[2];
+
+				const d_bsp_leaf_t *leaf = &d_bsp.leafs[Light_PointLeafnum(pos)];
+				if (leaf->contents & CONTENTS_SOLID) {
+					continue; // leave it zeroed
+				}
+
+				VectorClear(sample);
+				VectorClear(direction);
+
+				const vec_t total = GatherLightGridSample(pos, sample, direction);
+
+				LightGridCell(sample, direction, total, cell);
+
+				light_grid.populated[brick_num] = true;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Bakes the light grid again without light culling, and compares it to
+ * the culled one. Any difference is fatal.
+ */
+static void VerifyLightGrid(void) {
+
+	d_bsp_light_grid_cell_t *cells = light_grid.cells;
+	_Bool *populated = light_grid.populated;
+
+	light_grid.cells = Mem_Malloc(light_grid.num_bricks * BSP_LIGHT_GRID_BRICK_CELLS *
+			sizeof(d_bsp_light_grid_cell_t));
+	light_grid.populated = Mem_Malloc(light_grid.num_bricks * sizeof(_Bool));
+
+	light_reference = true;
+
+	RunThreadsOn(light_grid.num_bricks, true, LightGridBrick);
+
+	light_reference = false;
+
+	const size_t brick_size = BSP_LIGHT_GRID_BRICK_CELLS * sizeof(d_bsp_light_grid_cell_t);
+
+	int32_t num_mismatched = 0;
+	for (int32_t i = 0; i < light_grid.num_bricks; i++) {
+
+		const d_bsp_light_grid_cell_t *a = &cells[i * BSP_LIGHT_GRID_BRICK_CELLS];
+		const d_bsp_light_grid_cell_t *b = &light_grid.cells[i * BSP_LIGHT_GRID_BRICK_CELLS];
+
+		if (populated[i] != light_grid.populated[i] || memcmp(a, b, brick_size)) {
+			Com_Warn("Light grid brick %d differs from the reference lighting\n", i);
+			num_mismatched++;
+		}
+	}
+
+	Mem_Free(light_grid.cells);
+	Mem_Free(light_grid.populated);
+
+	light_grid.cells = cells;
+	light_grid.populated = populated;
+
+	if (num_mismatched) {
+		Com_Error(ERR_FATAL, "%d light grid bricks differ from the reference lighting\n", num_mismatched);
+	}
+
+	Com_Print("Verified %d light grid bricks against the reference lighting\n", light_grid.num_bricks);
+}
+
+/**
+ * @brief Bakes the light grid for the world model, and writes it to the light
+ * grid lump.
+ */
+void BuildLightGrid(void) {
+
+	d_bsp.light_grid_size = 0;
+
+	if (legacy) {
+		return;
+	}
+
+	memset(&light_grid, 0, sizeof(light_grid));
+
+	vec_t size = FloatForKey(&entities[0], "light_grid_size");
+	if (size <= 0.0) {
+		size = DEFAULT_LIGHT_GRID_SIZE;
+	}
+
+	const d_bsp_model_t *world = &d_bsp.models[0];
+
+	for (int32_t i = 0; i < 3; i++) {
+		light_grid.size[i] = size;
+		light_grid.mins[i] = floor(world->mins[i] / size) * size;
+
+		const int32_t cells = (int32_t) ceil((world->maxs[i] - light_grid.mins[i]) / size) + 1;
+		light_grid.bricks[i] = (cells + BSP_LIGHT_GRID_BRICK - 1) / BSP_LIGHT_GRID_BRICK;
+	}
+
+	light_grid.num_bricks = light_grid.bricks[0] * light_grid.bricks[1] * light_grid.bricks[2];
+
+	const size_t table_size = sizeof(d_bsp_light_grid_t) + light_grid.num_bricks * sizeof(int32_t);
+	if (table_size > MAX_BSP_LIGHT_GRID) {
+		Com_Warn("Light grid size %g is too fine for this map, skipping light grid\n", size);
+		return;
+	}
+
+	Com_Verbose("Building %d x %d x %d light grid bricks of %g units\n", light_grid.bricks[0],
+			light_grid.bricks[1], light_grid.bricks[2], size);
+
+	light_grid.cells = Mem_Malloc(light_grid.num_bricks * BSP_LIGHT_GRID_BRICK_CELLS *
+			sizeof(d_bsp_light_grid_cell_t));
+	light_grid.populated = Mem_Malloc(light_grid.num_bricks * sizeof(_Bool));
+
+	RunThreadsOn(light_grid.num_bricks, true, LightGridBrick);
+
+	// compare it to the reference path, if requested
+	if (light_verify) {
+		VerifyLightGrid();
+	}
+
+	// write the header, brick table and populated bricks to the lump, little endian
+	d_bsp_light_grid_t *header = (d_bsp_light_grid_t *) d_bsp.light_grid;
+	int32_t *table = (int32_t *) (header + 1);
+	byte *out = (byte *) (table + light_grid.num_bricks);
+
+	const size_t brick_size = BSP_LIGHT_GRID_BRICK_CELLS * sizeof(d_bsp_light_grid_cell_t);
+
+	int32_t num_populated = 0;
+	for (int32_t i = 0; i < light_grid.num_bricks; i++) {
+
+		if (!light_grid.populated[i]) {
+			table[i] = LittleLong(-1);
+			continue;
+		}
+
+		if (out + brick_size > d_bsp.light_grid + MAX_BSP_LIGHT_GRID) {
+			Com_Warn("MAX_BSP_LIGHT_GRID, skipping light grid\n");
+			goto done;
+		}
+
+		memcpy(out, &light_grid.cells[i * BSP_LIGHT_GRID_BRICK_CELLS], brick_size);
+		out += brick_size;
+
+		table[i] = LittleLong(num_populated++);
+	}
+
+	header->ident = LittleLong(BSP_LIGHT_GRID_IDENT);
+	for (int32_t i = 0; i < 3; i++) {
+		header->mins[i] = LittleFloat(light_grid.mins[i]);
+		header->size[i] = LittleFloat(light_grid.size[i]);
+		header->bricks[i] = LittleLong(light_grid.bricks[i]);
+	}
+	header->num_bricks = LittleLong(num_populated);
+
+	d_bsp.light_grid_size = (int32_t) (out - d_bsp.light_grid);
+
+	Com_Verbose("Light grid: %d of %d bricks populated, %d bytes\n", num_populated,
+			light_grid.num_bricks, d_bsp.light_grid_size);
+
+done:
+	FreeCandidateLights();
+
+	Mem_Free(light_grid.cells);
+	Mem_Free(light_grid.populated);
+}
@@ -254,11 +254,54 @@ typedef struct light_s { // a light source
 	vec3_t color;
 	vec3_t normal; // spotlight direction
 	vec_t stopdot; // spotlight cone
+
+	int32_t cluster; // the cluster bucket the light resides in
+	int32_t num; // index into the flattened light list
+	vec_t radius; // beyond which the light contributes nothing, or 0.0 if unbounded
 } light_t;
 
 static light_t *lights[MAX_BSP_LEAFS];
 static int32_t num_lights;
 
+/**
+ * @brief A node in the light bounding volume hierarchy. Leafs reference a range of
+ * bounded (point and spot) lights, while interior nodes have two children.
+ */
+typedef struct {
+	vec3_t mins, maxs;
+	int32_t children[2];
+	int32_t first_light, num_lights;
+} light_node_t;
+
+#define LIGHT_LEAF_SIZE 4
+#define LIGHT_NODE_STACK 64
+#define LIGHT_RADIUS_EPSILON 1.0
+
+/**
+ * @brief The lights, flattened in cluster bucket order. Candidate lights are
+ * gathered into a bit vector over this list, and visited in ascending order, so
+ * that light is accumulated in exactly the same order as the cluster buckets.
+ */
+static struct {
+	light_t **lights;
+	int32_t num_lights;
+
+	size_t num_words; // of candidate bit vectors
+	uint64_t *unbounded; // lights which are candidates for every sample
+
+	light_node_t *nodes;
+	int32_t num_nodes;
+
+	int32_t *refs; // bounded light indexes, referenced by leaf nodes
+} light_tree;
+
+/**
+ * @brief The candidate bit vector of each thread, for the light grid.
+ */
+static thread_buffers_t light_candidates;
+
+static __thread thread_buffer_t thread_candidates;
+
 // sunlight, borrowed from ufo2map
 typedef struct sun_s {
 	vec_t light;
@@ -284,6 +327,198 @@ static entity_t *FindTargetEntity(const char *target) {
 	return NULL;
 }
 
+/**
+ * @brief The axis along which BuildLightTree_ is partitioning lights.
+ */
+static int32_t light_tree_axis;
+
+/**
+ * @brief Qsort comparator for BuildLightTree_.
+ */
+static int32_t BuildLightTree_Compare(const void *a, const void *b) {
+
+	const light_t *la = light_tree.lights[*(const int32_t *) a];
+	const light_t *lb = light_tree.lights[*(const int32_t *) b];
+
+	const vec_t delta = la->origin[light_tree_axis] - lb->origin[light_tree_axis];
+	if (delta == 0.0) {
+		return la->num - lb->num;
+	}
+
+	return delta < 0.0 ? -1 : 1;
+}
+
+/**
+ * @brief Recursively partitions the specified range of bounded lights at the
+ * median of their longest axis.
+ * @return The node index.
+ */
+static int32_t BuildLightTree_(int32_t first_light, int32_t num_lights) {
+	vec3_t size;
+
+	const int32_t node_num = light_tree.num_nodes++;
+	light_node_t *node = &light_tree.nodes[node_num];
+
+	ClearBounds(node->mins, node->maxs);
+
+	for (int32_t i = first_light; i < first_light + num_lights; i++) {
+		const light_t *l = light_tree.lights[light_tree.refs[i]];
+		vec3_t mins, maxs;
+
+		for (int32_t j = 0; j < 3; j++) {
+			mins[j] = l->origin[j] - l->radius;
+			maxs[j] = l->origin[j] + l->radius;
+		}
+
+		AddPointToBounds(mins, node->mins, node->maxs);
+		AddPointToBounds(maxs, node->mins, node->maxs);
+	}
+
+	node->children[0] = node->children[1] = -1;
+	node->first_light = first_light;
+	node->num_lights = num_lights;
+
+	if (num_lights <= LIGHT_LEAF_SIZE) {
+		return node_num;
+	}
+
+	VectorSubtract(node->maxs, node->mins, size);
+
+	light_tree_axis = 0;
+	if (size[1] > size[light_tree_axis]) {
+		light_tree_axis = 1;
+	}
+	if (size[2] > size[light_tree_axis]) {
+		light_tree_axis = 2;
+	}
+
+	qsort(light_tree.refs + first_light, num_lights, sizeof(int32_t), BuildLightTree_Compare);
+
+	const int32_t half = num_lights / 2;
+
+	const int32_t child0 = BuildLightTree_(first_light, half);
+	const int32_t child1 = BuildLightTree_(first_light + half, num_lights - half);
+
+	// the node array is never reallocated, but refresh the pointer for clarity
+	node = &light_tree.nodes[node_num];
+
+	node->children[0] = child0;
+	node->children[1] = child1;
+	node->num_lights = 0;
+
+	return node_num;
+}
+
+/**
+ * @brief Flattens the cluster light buckets, and builds a bounding volume hierarchy
+ * over the lights with a finite radius of influence. Point and spot lights emit
+ * (intensity - dist) or less, so they are bounded by their intensity. Face lights
+ * fall off exponentially, and must be considered for every sample.
+ */
+static void BuildLightTree(void) {
+	int32_t num_bounded = 0;
+
+	memset(&light_tree, 0, sizeof(light_tree));
+
+	light_tree.lights = Mem_Malloc(MAX(num_lights, 1) * sizeof(light_t *));
+
+	for (int32_t i = 0; i < d_vis->num_clusters; i++) {
+		for (light_t *l = lights[i]; l; l = l->next) {
+
+			l->cluster = i;
+			l->num = light_tree.num_lights++;
+
+			light_tree.lights[l->num] = l;
+
+			if (l->type == LIGHT_FACE) {
+				l->radius = 0.0;
+			} else {
+				l->radius = MAX(l->intensity, 0.0) + LIGHT_RADIUS_EPSILON;
+				num_bounded++;
+			}
+		}
+	}
+
+	light_tree.num_words = (light_tree.num_lights + 63) / 64;
+	light_tree.unbounded = Mem_Malloc(MAX(light_tree.num_words, 1) * sizeof(uint64_t));
+
+	light_tree.refs = Mem_Malloc(MAX(num_bounded, 1) * sizeof(int32_t));
+	light_tree.nodes = Mem_Malloc(MAX(num_bounded * 2, 1) * sizeof(light_node_t));
+
+	num_bounded = 0;
+	for (int32_t i = 0; i < light_tree.num_lights; i++) {
+		if (light_tree.lights[i]->radius == 0.0) {
+			light_tree.unbounded[i >> 6] |= (1ull << (i & 63));
+		} else {
+			light_tree.refs[num_bounded++] = i;
+		}
+	}
+
+	if (num_bounded) {
+		BuildLightTree_(0, num_bounded);
+	}
+
+	Com_Verbose("Light tree: %d bounded, %d unbounded lights in %d nodes\n", num_bounded,
+			light_tree.num_lights - num_bounded, light_tree.num_nodes);
+}
+
+/**
+ * @brief Populates the candidate bit vector with every light which may contribute
+ * to the specified sample position: all unbounded lights, and those bounded
+ * lights whose radius of influence contains the position.
+ */
+static void GatherCandidateLights(const vec3_t pos, uint64_t *candidates) {
+	int32_t stack[LIGHT_NODE_STACK];
+	int32_t depth = 0;
+
+	if (light_reference) { // every light is a candidate
+		memset(candidates, 0, light_tree.num_words * sizeof(uint64_t));
+
+		for (int32_t i = 0; i < light_tree.num_lights; i++) {
+			candidates[i >> 6] |= (1ull << (i & 63));
+		}
+
+		return;
+	}
+
+	memcpy(candidates, light_tree.unbounded, light_tree.num_words * sizeof(uint64_t));
+
+	if (light_tree.num_nodes == 0) {
+		return;
+	}
+
+	stack[depth++] = 0;
+
+	while (depth) {
+		const light_node_t *node = &light_tree.nodes[stack[--depth]];
+
+		if (pos[0] < node->mins[0] || pos[0] > node->maxs[0] ||
+			pos[1] < node->mins[1] || pos[1] > node->maxs[1] ||
+			pos[2] < node->mins[2] || pos[2] > node->maxs[2]) {
+			continue;
+		}
+
+		if (node->num_lights) {
+			for (int32_t i = node->first_light; i < node->first_light + node->num_lights; i++) {
+				const int32_t num = light_tree.refs[i];
+				const light_t *l = light_tree.lights[num];
+				vec3_t delta;
+
+				VectorSubtract(l->origin, pos, delta);
+				if (DotProduct(delta, delta) < l->radius * l->radius) {
+					candidates[num >> 6] |= (1ull << (num & 63));
+				}
+			}
+		} else {
+			if (depth + 2 > LIGHT_NODE_STACK) {
+				Com_Error(ERR_FATAL, "Light tree stack overflow\n");
+			}
+			stack[depth++] = node->children[0];
+			stack[depth++] = node->children[1];
+		}
+	}
+}
+
 #define ANGLE_UP	-1.0
 #define ANGLE_DOWN	-2.0
 
@@ -406,6 +641,8 @@ void BuildLights(void) {
 
 	Com_Verbose("Lighting %i lights\n", num_lights);
 
+	BuildLightTree();
+
 	{
 		// sun.light parameters come from worldspawn
 		const entity_t *e = &entities[0];
@@ -497,66 +734,138 @@ static void GatherSampleSunlight(const vec3_t pos, const vec3_t normal, vec_t *s
 }
 
 /**
- * @brief Iterate over all light sources for the sample position's PVS, accumulating
- * light and directional information to the specified pointers.
+ * @brief Resolves the contribution of the light at the specified sample, ignoring
+ * occlusion. The normalized direction to the light is written to delta.
+ * @return The light contribution, which is zero or negative for none.
  */
-static void GatherSampleLight(vec3_t pos, vec3_t normal, byte *pvs, vec_t *sample,
-		vec_t *direction, vec_t scale) {
-
-	light_t *l;
-	vec3_t delta;
+static vec_t LightContribution(const light_t *l, const vec3_t pos, const vec3_t normal, vec3_t delta) {
 	vec_t dot, dot2;
 	vec_t dist;
-	cm_trace_t trace;
-	int32_t i;
 
-	// iterate over lights, which are in buckets by cluster
-	for (i = 0; i < d_vis->num_clusters; i++) {
+	vec_t light = 0.0;
 
-		if (!(pvs[i >> 3] & (1 << (i & 7))))
-			continue;
+	VectorSubtract(l->origin, pos, delta);
+	dist = VectorNormalize(delta);
 
-		for (l = lights[i]; l; l = l->next) {
-
-			vec_t light = 0.0;
-
-			VectorSubtract(l->origin, pos, delta);
-			dist = VectorNormalize(delta);
-
-			dot = DotProduct(delta, normal);
-			if (dot <= 0.001)
-				continue; // behind sample surface
-
-			switch (l->type) {
-				case LIGHT_POINT: // linear falloff
-					light = (l->intensity - dist) * dot;
-					break;
-
-				case LIGHT_FACE: // exponential falloff
-					light = (l->intensity / (dist * dist)) * dot;
-					break;
-
-				case LIGHT_SPOT: // linear falloff with cone
-					dot2 = -DotProduct(delta, l->normal);
-					if (dot2 > l->stopdot) // inside the cone
-						light = (l->intensity - dist) * dot;
-					else { // outside the cone
-						const vec_t decay = 1.0 + l->stopdot - dot2;
-						light = (l->intensity - decay * decay * dist) * dot;
-					}
-					break;
-				default:
-					Mon_SendPoint(ERR_WARN, l->origin, "Light with bad type");
-					break;
+	dot = DotProduct(delta, normal);
+	if (dot <= 0.001)
+		return 0.0; // behind sample surface
+
+	switch (l->type) {
+		case LIGHT_POINT: // linear falloff
+			light = (l->intensity - dist) * dot;
+			break;
+
+		case LIGHT_FACE: // exponential falloff
+			light = (l->intensity / (dist * dist)) * dot;
+			break;
+
+		case LIGHT_SPOT: // linear falloff with cone
+			dot2 = -DotProduct(delta, l->normal);
+			if (dot2 > l->stopdot) // inside the cone
+				light = (l->intensity - dist) * dot;
+			else { // outside the cone
+				const vec_t decay = 1.0 + l->stopdot - dot2;
+				light = (l->intensity - decay * decay * dist) * dot;
 			}
+			break;
+		default:
+			Mon_SendPoint(ERR_WARN, l->origin, "Light with bad type");
+			break;
+	}
 
-			if (light <= 0.0) // no light
+	return light;
+}
+
+/**
+ * @brief Resolves the lights which reach each sample of a packet: candidate lights
+ * in the sample's PVS which contribute to it, and are not occluded. The occlusion
+ * rays towards each light are cast for all samples of the packet together. Each
+ * sample's lights are marked in its own bit vector of visible.
+ */
+static void GatherPacketLights(const face_sample_t **samples, int32_t num_samples,
+		byte pvs[][(MAX_BSP_LEAFS + 7) / 8], uint64_t *candidates, uint64_t *visible) {
+
+	vec3_t delta;
+
+	const size_t num_words = light_tree.num_words;
+
+	for (int32_t i = 0; i < num_samples; i++) {
+		GatherCandidateLights(samples[i]->pos, candidates + i * num_words);
+	}
+
+	memset(visible, 0, num_samples * num_words * sizeof(uint64_t));
+
+	for (size_t w = 0; w < num_words; w++) {
+
+		uint64_t bits = 0;
+		for (int32_t i = 0; i < num_samples; i++) {
+			bits |= candidates[i * num_words + w];
+		}
+
+		while (bits) {
+
+			const uint64_t bit = 1ull << __builtin_ctzll(bits);
+			const int32_t num = (int32_t) (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			const light_t *l = light_tree.lights[num];
+
+			vec3_t ends[LIGHT_PACKET_SIZE];
+			uint32_t lanes = 0;
+
+			for (int32_t i = 0; i < num_samples; i++) {
+				const face_sample_t *s = samples[i];
+
+				if (!(candidates[i * num_words + w] & bit))
+					continue;
+
+				if (!(pvs[i][l->cluster >> 3] & (1 << (l->cluster & 7))))
+					continue;
+
+				if (LightContribution(l, s->pos, s->normal, delta) <= 0.0) // no light
+					continue;
+
+				VectorCopy(s->pos, ends[i]);
+				lanes |= (1u << i);
+			}
+
+			if (!lanes)
 				continue;
 
-			Light_Trace(&trace, l->origin, pos, CONTENTS_SOLID);
+			const uint32_t lit = lanes & ~Light_OccludedPacket(l->origin, (const vec3_t *) ends, lanes,
+					CONTENTS_SOLID);
 
-			if (trace.fraction < 1.0)
-				continue; // occluded
+			for (int32_t i = 0; i < num_samples; i++) {
+				if (lit & (1u << i)) {
+					visible[i * num_words + w] |= bit;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Accumulates light and directional information from the visible lights,
+ * as resolved by GatherPacketLights, and the sun to the specified pointers. The
+ * lights are visited in cluster bucket order.
+ */
+static void GatherSampleLight(const vec3_t pos, const vec3_t normal, const uint64_t *visible,
+		vec_t *sample, vec_t *direction, vec_t scale) {
+
+	vec3_t delta;
+
+	for (size_t w = 0; w < light_tree.num_words; w++) {
+
+		uint64_t bits = visible[w];
+		while (bits) {
+
+			const int32_t num = (int32_t) (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			const light_t *l = light_tree.lights[num];
+
+			const vec_t light = LightContribution(l, pos, normal, delta);
 
 			// add some light to it
 			VectorMA(sample, light * scale, l->color, sample);
@@ -570,15 +879,128 @@ static void GatherSampleLight(vec3_t pos, vec3_t normal, byte *pvs, vec_t *sampl
 	GatherSampleSunlight(pos, normal, sample, direction, scale);
 }
 
+/**
+ * @return The calling thread's candidate bit vector, allocating it if necessary.
+ */
+static uint64_t *ThreadCandidateLights(void) {
+	return ThreadBuffer(&light_candidates, &thread_candidates,
+			MAX(light_tree.num_words, 1) * sizeof(uint64_t));
+}
+
+/**
+ * @brief Frees the candidate bit vectors of all threads.
+ */
+void FreeCandidateLights(void) {
+	FreeThreadBuffers(&light_candidates);
+}
+
+/**
+ * @brief Resolves the direct light arriving at the specified point from every
+ * direction, for the light grid. Each light is evaluated as if facing the point,
+ * and the direction is accumulated weighted by the light's contribution.
+ * @return The total contribution, or 0.0 if the point is in solid or unlit.
+ */
+vec_t GatherLightGridSample(const vec3_t pos, vec_t *sample, vec_t *direction) {
+	byte pvs[(MAX_BSP_LEAFS + 7) / 8];
+	vec3_t dir, delta;
+	cm_trace_t trace;
+
+	if (!Light_PointPVS(pos, pvs))
+		return 0.0;
+
+	uint64_t *candidates = ThreadCandidateLights();
+
+	GatherCandidateLights(pos, candidates);
+
+	vec_t total = 0.0;
+
+	for (size_t w = 0; w < light_tree.num_words; w++) {
+
+		uint64_t bits = candidates[w];
+		while (bits) {
+
+			const int32_t num = (int32_t) (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			const light_t *l = light_tree.lights[num];
+
+			if (!(pvs[l->cluster >> 3] & (1 << (l->cluster & 7))))
+				continue;
+
+			VectorSubtract(l->origin, pos, dir);
+			VectorNormalize(dir);
+
+			const vec_t light = LightContribution(l, pos, dir, delta);
+
+			if (light <= 0.0) // no light
+				continue;
+
+			if (Light_Occluded(l->origin, pos, CONTENTS_SOLID))
+				continue; // occluded
+
+			VectorMA(sample, light, l->color, sample);
+			VectorMA(direction, light, delta, direction);
+
+			total += light;
+		}
+	}
+
+	if (sun.light) {
+		VectorMA(pos, MAX_WORLD_DIST, sun.dir, delta);
+
+		Light_Trace(&trace, pos, delta, CONTENTS_SOLID);
+
+		if (trace.fraction == 1.0 || (trace.surface->flags & SURF_SKY)) {
+			VectorMA(sample, sun.light, sun.color, sample);
+			VectorMA(direction, sun.light, sun.dir, direction);
+
+			total += sun.light;
+		}
+	}
+
+	return total;
+}
+
+/**
+ * @brief Marks every light which contributes to the specified sample, occluded or
+ * not, in the contributors bit vector.
+ */
+static void MarkContributingLights(const vec3_t pos, const vec3_t normal, const byte *pvs,
+		uint64_t *candidates, uint64_t *contributors) {
+
+	vec3_t delta;
+
+	GatherCandidateLights(pos, candidates);
+
+	for (size_t w = 0; w < light_tree.num_words; w++) {
+
+		uint64_t bits = candidates[w] & ~contributors[w];
+		while (bits) {
+
+			const int32_t num = (int32_t) (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			const light_t *l = light_tree.lights[num];
+
+			if (!(pvs[l->cluster >> 3] & (1 << (l->cluster & 7))))
+				continue;
+
+			if (LightContribution(l, pos, normal, delta) > 0.0) {
+				contributors[w] |= (1ull << (num & 63));
+			}
+		}
+	}
+}
+
 #define SAMPLE_NUDGE 0.25
 
 /**
  * @brief Move the incoming sample position towards the surface center and along the
- * surface normal to reduce false-positive traces. Test the PVS at the new
- * position, returning true if the new point is valid, false otherwise.
+ * surface normal to reduce false-positive traces.
+ * @return The cluster of the new position, or -1 if the new point is not valid.
  */
-static _Bool NudgeSamplePosition(const vec3_t in, const vec3_t normal, const vec3_t center,
-		vec3_t out, byte *pvs) {
+static int32_t NudgeSamplePosition(const vec3_t in, const vec3_t normal, const vec3_t center,
+		vec3_t out) {
 	vec3_t dir;
 
 	VectorCopy(in, out);
@@ -590,7 +1012,7 @@ static _Bool NudgeSamplePosition(const vec3_t in, const vec3_t normal, const vec
 	VectorMA(out, SAMPLE_NUDGE, dir, out);
 	VectorMA(out, SAMPLE_NUDGE, normal, out);
 
-	return Light_PointPVS(out, pvs);
+	return Light_PointCluster(out);
 }
 
 #define MAX_VERT_FACES 256
@@ -728,6 +1150,137 @@ static const vec_t sampleofs[MAX_SAMPLES][2] = {
 		{ 0.125, 0.125 },
 		{ -0.125, 0.125 } };
 
+/**
+ * @brief A nudged sample position, shared by the light cache key and the lighting
+ * of a face.
+ */
+typedef struct {
+	vec3_t pos;
+	vec3_t normal;
+	int32_t cluster; // -1 if the sample is not valid
+} face_sample_t;
+
+/**
+ * @brief Resolves the nudged position, normal and cluster of every sample of a
+ * face, including antialiasing samples, which are interleaved per sample point.
+ */
+static void BuildFaceSamples(const light_info_t *l, int32_t num_samples, const d_bsp_texinfo_t *tex,
+		const vec_t *center, face_sample_t *samples) {
+
+	for (int32_t i = 0; i < l[0].num_sample_points; i++) {
+		for (int32_t j = 0; j < num_samples; j++) {
+			face_sample_t *s = &samples[i * num_samples + j];
+
+			if (tex->flags & SURF_PHONG) { // interpolated normal
+				SampleNormal(&l[0], l[j].sample_points[i], s->normal);
+			} else { // or just plane normal
+				VectorCopy(l[0].face_normal, s->normal);
+			}
+
+			s->cluster = NudgeSamplePosition(l[j].sample_points[i], s->normal, center, s->pos);
+		}
+	}
+}
+
+/**
+ * @brief Decompresses the PVS for the specified sample into pvs, unless it is
+ * already there. Neighboring samples usually share a cluster.
+ */
+static void FaceSamplePVS(const face_sample_t *s, int32_t *cluster, byte *pvs) {
+
+	if (s->cluster != *cluster) {
+		Light_ClusterPVS(s->cluster, pvs);
+		*cluster = s->cluster;
+	}
+}
+
+/**
+ * @brief Resolves the light cache key for a face. The key covers the sample
+ * positions and normals, every light which contributes to any sample, and every
+ * solid brush within the bounds of the rays that could be cast towards them.
+ */
+static uint64_t FacelightKey(const light_info_t *l, int32_t num_samples, const d_bsp_texinfo_t *tex,
+		const face_sample_t *samples, uint64_t *candidates) {
+
+	byte pvs[(MAX_BSP_LEAFS + 7) / 8];
+	int32_t cluster = -1;
+	vec3_t mins, maxs;
+	uint64_t hash = 0;
+
+	uint64_t *contributors = Mem_Malloc(MAX(light_tree.num_words, 1) * sizeof(uint64_t));
+
+	const int32_t settings[] = { legacy, num_samples, lightmap_scale, l[0].num_sample_points };
+
+	hash = HashFNV(hash, settings, sizeof(settings));
+	hash = HashFNV(hash, tex->vecs, sizeof(tex->vecs));
+	hash = HashFNV(hash, &tex->flags, sizeof(tex->flags));
+
+	ClearBounds(mins, maxs);
+
+	const face_sample_t *s = samples;
+	for (int32_t i = 0; i < l[0].num_sample_points * num_samples; i++, s++) {
+
+		const _Bool valid = s->cluster != -1;
+
+		hash = HashFNV(hash, s->pos, sizeof(s->pos));
+		hash = HashFNV(hash, s->normal, sizeof(s->normal));
+		hash = HashFNV(hash, &valid, sizeof(valid));
+
+		if (valid) {
+			FaceSamplePVS(s, &cluster, pvs);
+
+			AddPointToBounds(s->pos, mins, maxs);
+			MarkContributingLights(s->pos, s->normal, pvs, candidates, contributors);
+		}
+	}
+
+	for (size_t w = 0; w < light_tree.num_words; w++) {
+
+		uint64_t bits = contributors[w];
+		while (bits) {
+
+			const int32_t num = (int32_t) (w << 6) + __builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			const light_t *light = light_tree.lights[num];
+
+			hash = HashFNV(hash, &light->type, sizeof(light->type));
+			hash = HashFNV(hash, &light->intensity, sizeof(light->intensity));
+			hash = HashFNV(hash, light->origin, sizeof(light->origin));
+			hash = HashFNV(hash, light->color, sizeof(light->color));
+			hash = HashFNV(hash, light->normal, sizeof(light->normal));
+			hash = HashFNV(hash, &light->stopdot, sizeof(light->stopdot));
+
+			AddPointToBounds(light->origin, mins, maxs);
+		}
+	}
+
+	Mem_Free(contributors);
+
+	if (mins[0] > maxs[0]) { // no valid samples, so nothing to occlude
+		return hash;
+	}
+
+	if (sun.light) { // sun rays are cast from each sample towards the sky
+		vec3_t sun_mins, sun_maxs;
+
+		hash = HashFNV(hash, &sun, sizeof(sun));
+
+		VectorMA(mins, MAX_WORLD_DIST, sun.dir, sun_mins);
+		VectorMA(maxs, MAX_WORLD_DIST, sun.dir, sun_maxs);
+
+		AddPointToBounds(sun_mins, mins, maxs);
+		AddPointToBounds(sun_maxs, mins, maxs);
+	}
+
+	for (int32_t i = 0; i < 3; i++) { // brushes grazing the rays may clip them, too
+		mins[i] -= 1.0;
+		maxs[i] += 1.0;
+	}
+
+	return HashLightCacheOccluders(hash, mins, maxs);
+}
+
 /**
  * @brief
  */
@@ -737,7 +1290,8 @@ void BuildFacelights(int32_t face_num) {
 	d_bsp_texinfo_t *tex;
 	vec_t *center;
 	vec_t *sdir, *tdir, scale;
-	vec3_t pos;
+	byte pvs[LIGHT_PACKET_SIZE][(MAX_BSP_LEAFS + 7) / 8];
+	int32_t clusters[LIGHT_PACKET_SIZE];
 	vec3_t normal, bitangent;
 	vec4_t tangent;
 	light_info_t l[MAX_SAMPLES];
@@ -806,24 +1360,65 @@ void BuildFacelights(int32_t face_num) {
 
 	center = face_extents[face_num].center; // center of the face
 
+	uint64_t *candidates = Mem_Malloc(LIGHT_PACKET_SIZE * MAX(light_tree.num_words, 1) * sizeof(uint64_t));
+	uint64_t *visible = Mem_Malloc(LIGHT_PACKET_SIZE * MAX(light_tree.num_words, 1) * sizeof(uint64_t));
+
+	face_sample_t *samples = Mem_Malloc(fl->num_samples * num_samples * sizeof(face_sample_t));
+	BuildFaceSamples(l, num_samples, tex, center, samples);
+
+	uint64_t key = 0;
+	if (light_cache) { // reuse the cached lighting if none of its inputs have changed
+		key = FacelightKey(l, num_samples, tex, samples, candidates);
+
+		if (LookupLightCache(key, fl->num_samples, fl->samples, fl->directions)) {
+			UpdateLightCache(face_num, key, fl->num_samples, fl->samples, fl->directions);
+			goto done;
+		}
+	}
+
+	const int32_t num_face_samples = fl->num_samples * num_samples;
+
+	for (i = 0; i < LIGHT_PACKET_SIZE; i++) {
+		clusters[i] = -1;
+	}
+
+	const face_sample_t *packet[LIGHT_PACKET_SIZE];
+	int32_t packet_end = 0, lane = 0; // the samples before packet_end have been gathered
+
 	for (i = 0; i < fl->num_samples; i++) { // calculate light for each sample
 
 		vec_t *sample = fl->samples + i * 3; // accumulate lighting here
 		vec_t *direction = fl->directions + i * 3; // accumulate direction here
 
 		for (j = 0; j < num_samples; j++) { // with antialiasing
-			byte pvs[(MAX_BSP_LEAFS + 7) / 8];
+			const int32_t k = i * num_samples + j;
+			const face_sample_t *s = &samples[k];
 
-			if (tex->flags & SURF_PHONG) { // interpolated normal
-				SampleNormal(&l[0], l[j].sample_points[i], normal);
-			} else { // or just plane normal
-				VectorCopy(l[0].face_normal, normal);
-			}
+			VectorCopy(s->normal, normal);
 
-			if (!NudgeSamplePosition(l[j].sample_points[i], normal, center, pos, pvs))
+			if (s->cluster == -1)
 				continue; // not a valid point
 
-			GatherSampleLight(pos, normal, pvs, sample, direction, scale);
+			if (k >= packet_end) { // gather the lights of the next packet of valid samples
+				int32_t num_packet_samples = 0;
+
+				for (int32_t m = k; m < num_face_samples && num_packet_samples < LIGHT_PACKET_SIZE; m++) {
+
+					if (samples[m].cluster == -1)
+						continue;
+
+					FaceSamplePVS(&samples[m], &clusters[num_packet_samples], pvs[num_packet_samples]);
+
+					packet[num_packet_samples++] = &samples[m];
+					packet_end = m + 1;
+				}
+
+				GatherPacketLights(packet, num_packet_samples, pvs, candidates, visible);
+				lane = 0;
+			}
+
+			GatherSampleLight(s->pos, s->normal, visible + lane++ * light_tree.num_words,
+					sample, direction, scale);
 		}
 
 		if (!legacy) { // finalize the lighting direction for the sample
@@ -857,12 +1452,78 @@ void BuildFacelights(int32_t face_num) {
 		}
 	}
 
+	if (light_cache) {
+		UpdateLightCache(face_num, key, fl->num_samples, fl->samples, fl->directions);
+	}
+
+done:
+	Mem_Free(samples);
+	Mem_Free(candidates);
+	Mem_Free(visible);
+
 	// free the sample positions for the face
 	for (i = 0; i < num_samples; i++) {
 		Mem_Free(l[i].sample_points);
 	}
 }
 
+/**
+ * @brief Relights every face with light culling and occluder seeking disabled,
+ * which is the reference path that the light tree and Light_Occluded must
+ * reproduce exactly, and compares the results bit for bit. Any mismatch is a
+ * fatal error. The lighting of the first pass is retained.
+ */
+void VerifyFacelights(void) {
+
+	face_light_t *lit = Mem_Malloc(d_bsp.num_faces * sizeof(face_light_t));
+	memcpy(lit, face_lights, d_bsp.num_faces * sizeof(face_light_t));
+
+	memset(face_lights, 0, d_bsp.num_faces * sizeof(face_light_t));
+
+	light_reference = true;
+
+	RunThreadsOn(d_bsp.num_faces, true, BuildFacelights);
+
+	light_reference = false;
+
+	int32_t num_samples = 0, num_mismatched = 0;
+
+	for (int32_t i = 0; i < d_bsp.num_faces; i++) {
+		face_light_t *fl = &face_lights[i];
+
+		if (fl->num_samples != lit[i].num_samples) {
+			Com_Error(ERR_FATAL, "Face %d: %d samples, reference %d\n", i, lit[i].num_samples,
+					fl->num_samples);
+		}
+
+		const size_t size = fl->num_samples * sizeof(vec3_t);
+
+		if (size && (memcmp(fl->samples, lit[i].samples, size) ||
+				memcmp(fl->directions, lit[i].directions, size))) {
+			Com_Warn("Face %d differs from the reference lighting\n", i);
+			num_mismatched++;
+		}
+
+		num_samples += fl->num_samples;
+
+		if (fl->origins) {
+			Mem_Free(fl->origins);
+			Mem_Free(fl->samples);
+			Mem_Free(fl->directions);
+		}
+	}
+
+	memcpy(face_lights, lit, d_bsp.num_faces * sizeof(face_light_t));
+	Mem_Free(lit);
+
+	if (num_mismatched) {
+		Com_Error(ERR_FATAL, "%d faces differ from the reference lighting\n", num_mismatched);
+	}
+
+	Com_Print("Verified %d samples of %d faces against the reference lighting\n", num_samples,
+			d_bsp.num_faces);
+}
+
 /**
  * @brief Add the indirect lighting on top of the direct lighting and save into
  * final map format.
@@ -21,6 +21,13 @@
 
 #include <SDL2/SDL.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
 #include "quemap.h"
 
 quetoo_t quetoo;
@@ -59,15 +66,41 @@ extern int32_t subdivide_size;
 /* VIS */
 extern _Bool fastvis;
 extern _Bool nosort;
+extern _Bool resume_vis;
+extern int32_t portal_range[2];
 
 /* LIGHT */
 extern _Bool extra_samples;
+extern _Bool light_cache;
+extern _Bool light_verify;
 extern vec_t brightness;
 extern vec_t saturation;
 extern vec_t contrast;
 extern vec_t surface_scale;
 extern vec_t entity_scale;
 
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+/**
+ * @brief Accumulates the specified data into the FNV-1a hash. A hash of 0
+ * starts a new one.
+ */
+uint64_t HashFNV(uint64_t hash, const void *data, size_t len) {
+	const byte *b = (const byte *) data;
+
+	if (hash == 0) {
+		hash = FNV_OFFSET;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= b[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
 static void Print(const char *msg);
 
 /**
@@ -285,6 +318,16 @@ static void Check_VIS_Options(int32_t argc) {
 		} else if (!g_strcmp0(Com_Argv(i), "-nosort")) {
 			Com_Verbose("nosort = true\n");
 			nosort = true;
+		} else if (!g_strcmp0(Com_Argv(i), "-resume")) {
+			Com_Verbose("resume = true\n");
+			resume_vis = true;
+		} else if (!g_strcmp0(Com_Argv(i), "-portal-range")) {
+			if (sscanf(Com_Argv(i + 1), "%d:%d", &portal_range[0], &portal_range[1]) != 2 ||
+					portal_range[0] < 0 || portal_range[1] <= portal_range[0]) {
+				Com_Error(ERR_FATAL, "Invalid portal range: %s\n", Com_Argv(i + 1));
+			}
+			Com_Verbose("portal range = %d:%d\n", portal_range[0], portal_range[1]);
+			i++;
 		} else
 			break;
 	}
@@ -299,6 +342,13 @@ static void Check_LIGHT_Options(int32_t argc) {
 		if (!g_strcmp0(Com_Argv(i), "-extra")) {
 			extra_samples = true;
 			Com_Verbose("extra samples = true\n");
+		} else if (!g_strcmp0(Com_Argv(i), "-nocache")) {
+			light_cache = false;
+			Com_Verbose("light cache = false\n");
+		} else if (!g_strcmp0(Com_Argv(i), "-verify")) {
+			light_verify = true;
+			light_cache = false;
+			Com_Verbose("light verify = true\n");
 		} else if (!g_strcmp0(Com_Argv(i), "-brightness")) {
 			brightness = atof(Com_Argv(i + 1));
 			Com_Verbose("brightness at %f\n", brightness);
@@ -381,9 +431,13 @@ static void PrintHelpMessage(void) {
 	Com_Print("-vis               VIS stage options:\n");
 	Com_Print(" -fast\n");
 	Com_Print(" -nosort\n");
+	Com_Print(" -resume - resume from, or merge, portal checkpoints\n");
+	Com_Print(" -portal-range <a:b> - flow and checkpoint only portals a to b\n");
 	Com_Print("\n");
 	Com_Print("-light             LIGHT stage options:\n");
 	Com_Print(" -extra - extra light samples\n");
+	Com_Print(" -nocache - ignore and do not write the light cache\n");
+	Com_Print(" -verify - relight and bake the light grid without light culling, and compare (implies -nocache)\n");
 	Com_Print(" -entity <float> - entity light scaling\n");
 	Com_Print(" -surface <float> - surface light scaling\n");
 	Com_Print(" -brightness <float> - brightness factor\n");
@@ -406,6 +460,51 @@ static void PrintHelpMessage(void) {
 	Com_Print("\n");
 }
 
+/**
+ * @return The peak resident set size of the process, in bytes.
+ */
+static size_t PeakResidentSetSize(void) {
+
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage)) {
+		return 0;
+	}
+#if defined(__APPLE__)
+	return (size_t) usage.ru_maxrss;
+#else
+	return (size_t) usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+typedef int32_t (*StageFunc)(void);
+
+/**
+ * @brief Runs the specified compile stage, releasing its arenas afterwards, and
+ * reports its duration and the peak memory usage.
+ */
+static void RunStage(const char *name, StageFunc func) {
+
+	const uint32_t start = SDL_GetTicks();
+
+	func();
+
+	const uint32_t duration = SDL_GetTicks() - start;
+	const size_t arenas = ArenaSize();
+
+	ArenaReset();
+
+	Com_Print("%s stage: %u ms, %zu KB arenas, %zu MB peak resident\n", name, duration,
+			arenas >> 10, PeakResidentSetSize() >> 20);
+}
+
 /**
  * @brief
  */
@@ -531,17 +630,17 @@ int32_t main(int32_t argc, char **argv) {
 	const time_t start = time(NULL);
 
 	if (do_bsp)
-		BSP_Main();
+		RunStage("BSP", BSP_Main);
 	if (do_vis)
-		VIS_Main();
+		RunStage("VIS", VIS_Main);
 	if (do_light)
-		LIGHT_Main();
+		RunStage("LIGHT", LIGHT_Main);
 	if (do_aas)
-		AAS_Main();
+		RunStage("AAS", AAS_Main);
 	if (do_mat)
-		MAT_Main();
+		RunStage("MAT", MAT_Main);
 	if (do_zip)
-		ZIP_Main();
+		RunStage("ZIP", ZIP_Main);
 
 	// emit time
 	const time_t end = time(NULL);
@@ -551,5 +650,8 @@ int32_t main(int32_t argc, char **argv) {
 		Com_Print("%d Minutes ", (int32_t) (duration / 60));
 	Com_Print("%d Seconds\n", (int32_t) (duration % 60));
 
+	Com_Print("Peak memory: %zu KB arenas, %zu MB resident\n", ArenaPeakSize() >> 10,
+			PeakResidentSetSize() >> 20);
+
 	Com_Shutdown(NULL);
 }
@@ -38,7 +38,7 @@ static portal_t *AllocPortal(void) {
 			c_peak_portals = active_portals;
 	}
 
-	return Mem_Malloc(sizeof(portal_t));
+	return ArenaMalloc(sizeof(portal_t));
 }
 
 void FreePortal(portal_t * p) {
@@ -49,7 +49,7 @@ void FreePortal(portal_t * p) {
 	if (debug)
 		SDL_SemWait(semaphores.active_portals);
 
-	Mem_Free(p);
+	ArenaFree(p);
 }
 
 //==============================================================
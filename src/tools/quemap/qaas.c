@@ -21,120 +21,682 @@
 
 #include "bspfile.h"
 #include "polylib.h"
+#include "collision/cmodel.h"
 
-#define AI_NODE_MIN_NORMAL 0.7
+/*
+ * These mirror the player movement constants in bg_pmove.h, with the jump
+ * height resolved for the default gravity of 800.
+ */
+#define AAS_STEP_HEIGHT 16.0
+#define AAS_STEP_NORMAL 0.7
+#define AAS_JUMP_HEIGHT 44.0
+#define AAS_JUMP_DIST 128.0
+#define AAS_FALL_HEIGHT 256.0
+#define AAS_GROUND_SAMPLE 32.0
+
+#define AAS_CLUSTER_AREAS 64
+
+static const vec3_t aas_mins = { -16.0, -16.0, -24.0 };
+static const vec3_t aas_maxs = { 16.0, 16.0, 32.0 };
 
 typedef struct {
-	d_aas_node_t nodes[MAX_BSP_NODES];
-	int32_t num_nodes;
+	d_aas_area_t areas[MAX_AAS_AREAS];
+	int32_t num_areas;
+
+	d_aas_reachability_t reachability[MAX_AAS_REACHABILITY];
+	int32_t num_reachability;
+
+	int32_t leaf_areas[MAX_BSP_LEAFS];
+
+	d_aas_cluster_t clusters[MAX_AAS_CLUSTERS];
+	int32_t num_clusters;
+
+	uint16_t *routes;
 } d_aas_t;
 
 static d_aas_t d_aas;
 
+static GArray *area_reachability[MAX_AAS_AREAS]; // per area, while they are found
+
+typedef struct {
+	int32_t cluster;
+	int32_t cost;
+} aas_route_edge_t;
+
+static GArray *cluster_edges[MAX_AAS_CLUSTERS]; // reversed, for routing to each cluster
+
+/**
+ * @brief Traces the player box between the specified points.
+ */
+static cm_trace_t AAS_Trace(const vec3_t start, const vec3_t end) {
+	return Cm_BoxTrace(start, end, aas_mins, aas_maxs, 0, MASK_CLIP_PLAYER);
+}
+
+/**
+ * @brief Drops the player box from above the specified point to the ground.
+ * @return True if the box came to rest on a walkable surface, with its origin in
+ * `out`.
+ */
+static _Bool AAS_DropToGround(const vec3_t point, vec3_t out) {
+	vec3_t start, end;
+
+	VectorMA(point, AAS_STEP_HEIGHT, vec3_up, start);
+	VectorMA(point, -AAS_STEP_HEIGHT * 2.0, vec3_up, end);
+
+	const cm_trace_t tr = AAS_Trace(start, end);
+	if (tr.start_solid || tr.fraction == 1.0 || tr.plane.normal[2] < AAS_STEP_NORMAL) {
+		return false;
+	}
+
+	VectorCopy(tr.end, out);
+	return true;
+}
+
+/**
+ * @brief Resolves the standing origin of a grounded leaf from its largest floor
+ * face which the player box fits upon.
+ * @return True if the leaf has a floor.
+ */
+static _Bool AAS_LeafFloor(const d_bsp_leaf_t *leaf, vec3_t origin) {
+	vec_t best = 0.0;
+
+	for (int32_t i = 0; i < leaf->num_leaf_faces; i++) {
+		const d_bsp_face_t *face = &d_bsp.faces[d_bsp.leaf_faces[leaf->first_leaf_face + i]];
+		const d_bsp_plane_t *plane = &d_bsp.planes[face->plane_num];
+
+		const vec_t z = face->side ? -plane->normal[2] : plane->normal[2];
+		if (z < AAS_STEP_NORMAL) {
+			continue;
+		}
+
+		if (d_bsp.texinfo[face->texinfo].flags & SURF_SKY) {
+			continue;
+		}
+
+		winding_t *w = WindingForFace(face);
+
+		const vec_t area = WindingArea(w);
+		if (area > best) {
+			vec3_t center, start;
+
+			WindingCenter(w, center);
+
+			VectorMA(center, AAS_STEP_HEIGHT - aas_mins[2], vec3_up, start);
+
+			const cm_trace_t tr = AAS_Trace(start, center);
+			if (!tr.start_solid && tr.fraction < 1.0 && tr.plane.normal[2] >= AAS_STEP_NORMAL) {
+				VectorCopy(tr.end, origin);
+				best = area;
+			}
+		}
+
+		FreeWinding(w);
+	}
+
+	return best > 0.0;
+}
+
 /**
- * @brief Create the initial AAS nodes, which are just partial copies of the
- * BSP nodes. We'll prune these to remove leafs which are not navigable.
+ * @brief Creates an area for every BSP leaf the player can stand, swim or climb
+ * in. Leafs which the player would only pass through (in the air) have no area.
  */
-static void CreateAASNodes(void) {
-	uint16_t i;
+static void CreateAASAreas(void) {
+
+	for (int32_t i = 0; i < d_bsp.num_leafs; i++) {
+		const d_bsp_leaf_t *leaf = &d_bsp.leafs[i];
+
+		d_aas.leaf_areas[i] = AAS_INVALID_AREA;
+
+		if (i == 0 || (leaf->contents & (MASK_CLIP_PLAYER | CONTENTS_LAVA | CONTENTS_SLIME))) {
+			continue;
+		}
 
-	const d_bsp_node_t *in = d_bsp.nodes;
-	d_aas_node_t *out = d_aas.nodes;
+		if (d_aas.num_areas == MAX_AAS_AREAS) {
+			Com_Error(ERR_FATAL, "MAX_AAS_AREAS\n");
+		}
+
+		d_aas_area_t *area = &d_aas.areas[d_aas.num_areas];
+		memset(area, 0, sizeof(*area));
+
+		for (int32_t j = 0; j < leaf->num_leaf_brushes; j++) {
+			const d_bsp_brush_t *brush = &d_bsp.brushes[d_bsp.leaf_brushes[leaf->first_leaf_brush + j]];
+			if (brush->contents & CONTENTS_LADDER) {
+				area->flags |= AAS_AREA_LADDER;
+			}
+		}
+
+		if (leaf->contents & CONTENTS_WATER) {
+			area->flags |= AAS_AREA_WATER;
+		}
+
+		for (int32_t j = 0; j < 3; j++) {
+			area->mins[j] = leaf->mins[j];
+			area->maxs[j] = leaf->maxs[j];
+		}
+
+		if (AAS_LeafFloor(leaf, area->origin)) {
+			area->flags |= AAS_AREA_GROUNDED;
+		} else if (area->flags & (AAS_AREA_WATER | AAS_AREA_LADDER)) {
 
-	for (i = 0; i < d_bsp.num_nodes; i++, in++, out++) {
-		memcpy(out, in, sizeof(*in));
+			VectorMix(area->mins, area->maxs, 0.5, area->origin);
+
+			if (AAS_Trace(area->origin, area->origin).start_solid) {
+				continue;
+			}
+		} else {
+			continue;
+		}
 
-		out->first_path = 0;
-		out->num_paths = 0;
+		d_aas.leaf_areas[i] = d_aas.num_areas++;
 	}
+
+	Com_Verbose("%d areas from %d leafs\n", d_aas.num_areas, d_bsp.num_leafs);
 }
 
 /**
- * @brief Returns true if the specified leaf is navigable (has an upward-facing
- * solid plane), false otherwise.
+ * @brief Resolves the point within the specified area nearest to `target`, on
+ * the ground if the area is grounded.
  */
-static _Bool PruneAASNodes_isNavigable(const d_bsp_leaf_t *leaf) {
-	uint16_t i;
+static void AAS_ClosestPoint(const d_aas_area_t *area, const vec3_t target, vec3_t out) {
+
+	for (int32_t i = 0; i < 2; i++) {
+		const vec_t min = area->mins[i] - aas_mins[i];
+		const vec_t max = area->maxs[i] - aas_maxs[i];
 
-	if ((leaf->contents & MASK_CLIP_PLAYER) == 0) {
+		if (min > max) {
+			out[i] = area->origin[i];
+		} else {
+			out[i] = Clamp(target[i], min, max);
+		}
+	}
+
+	out[2] = area->origin[2];
+
+	if (area->flags & AAS_AREA_GROUNDED) {
+		if (!AAS_DropToGround(out, out)) {
+			VectorCopy(area->origin, out);
+		}
+	} else if (AAS_Trace(out, out).start_solid) {
+		VectorCopy(area->origin, out);
+	}
+}
+
+/**
+ * @return True if the player could walk from `start` to `end` without falling.
+ */
+static _Bool AAS_Walk(const vec3_t start, const vec3_t end) {
+	vec3_t a, b, dir;
+
+	VectorMA(start, AAS_STEP_HEIGHT, vec3_up, a);
+	VectorMA(end, AAS_STEP_HEIGHT, vec3_up, b);
+
+	if (AAS_Trace(a, b).fraction < 1.0) {
 		return false;
 	}
 
-	const uint16_t *lb = &d_bsp.leaf_brushes[leaf->first_leaf_brush];
+	VectorSubtract(b, a, dir);
+	const vec_t dist = VectorNormalize(dir);
+
+	for (vec_t d = AAS_GROUND_SAMPLE; d < dist; d += AAS_GROUND_SAMPLE) {
+		vec3_t p, ground;
+
+		VectorMA(a, d, dir, p);
+		VectorMA(p, -AAS_STEP_HEIGHT, vec3_up, p);
+
+		if (!AAS_DropToGround(p, ground)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @return True if the player could jump from `start` and land at `end`.
+ */
+static _Bool AAS_Jump(const vec3_t start, const vec3_t end) {
+	vec3_t a, b;
+
+	VectorMA(start, AAS_JUMP_HEIGHT, vec3_up, a);
+	VectorCopy(end, b);
+	b[2] = a[2];
+
+	return AAS_Trace(start, a).fraction == 1.0 && AAS_Trace(a, b).fraction == 1.0 &&
+			AAS_Trace(b, end).fraction == 1.0;
+}
+
+/**
+ * @return True if the player could step off at `start` and fall to `end`.
+ */
+static _Bool AAS_Fall(const vec3_t start, const vec3_t end) {
+	vec3_t a;
+
+	VectorCopy(end, a);
+	a[2] = start[2];
+
+	return AAS_Trace(start, a).fraction == 1.0 && AAS_Trace(a, end).fraction == 1.0;
+}
+
+/**
+ * @return True if the bounds of the specified areas touch.
+ */
+static _Bool AAS_Touching(const d_aas_area_t *a, const d_aas_area_t *b) {
+
+	for (int32_t i = 0; i < 3; i++) {
+		if (a->mins[i] > b->maxs[i] + 1.0 || a->maxs[i] < b->mins[i] - 1.0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Classifies travel from area `a` to area `b`, if possible.
+ * @return True if `b` is reachable from `a`, with `reach` populated.
+ */
+static _Bool AAS_Reachability(const d_aas_area_t *a, const d_aas_area_t *b, d_aas_reachability_t *reach) {
+	vec3_t delta;
+
+	AAS_ClosestPoint(a, b->origin, reach->start);
+	AAS_ClosestPoint(b, reach->start, reach->end);
+
+	VectorSubtract(reach->end, reach->start, delta);
+
+	const vec_t dz = delta[2];
+	delta[2] = 0.0;
+
+	const vec_t dist = VectorLength(delta);
+	const vec_t length = sqrt(dist * dist + dz * dz);
+
+	const _Bool touching = AAS_Touching(a, b);
+
+	if (touching && ((a->flags | b->flags) & AAS_AREA_WATER)) {
+		if (AAS_Trace(reach->start, reach->end).fraction == 1.0) {
+			reach->travel = AAS_TRAVEL_WATER;
+			reach->cost = length * 2.0;
+			return true;
+		}
+	}
+
+	if (touching && ((a->flags | b->flags) & AAS_AREA_LADDER) && fabs(dz) > AAS_STEP_HEIGHT) {
+		if (AAS_Trace(reach->start, reach->end).fraction == 1.0) {
+			reach->travel = AAS_TRAVEL_LADDER;
+			reach->cost = length * 2.0;
+			return true;
+		}
+	}
+
+	if (!(a->flags & AAS_AREA_GROUNDED) || !(b->flags & AAS_AREA_GROUNDED)) {
+		return false;
+	}
+
+	if (fabs(dz) <= AAS_STEP_HEIGHT) {
+		if (touching && AAS_Walk(reach->start, reach->end)) {
+			reach->travel = AAS_TRAVEL_WALK;
+			reach->cost = length;
+			return true;
+		}
+	}
+
+	if (dz <= AAS_JUMP_HEIGHT && dz >= -AAS_FALL_HEIGHT && dist <= AAS_JUMP_DIST) {
+		if (AAS_Jump(reach->start, reach->end)) {
+			reach->travel = AAS_TRAVEL_JUMP;
+			reach->cost = length + AAS_JUMP_HEIGHT * 2.0;
+			return true;
+		}
+	}
+
+	if (dz < -AAS_STEP_HEIGHT && dz >= -AAS_FALL_HEIGHT) {
+		if (AAS_Fall(reach->start, reach->end)) {
+			reach->travel = AAS_TRAVEL_FALL;
+			reach->cost = dist + AAS_STEP_HEIGHT * 2.0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Finds all reachabilities from the specified area. Candidates are areas
+ * within jumping distance horizontally, and within falling or jumping distance
+ * vertically.
+ */
+static void FindAASReachability(int32_t area_num) {
+
+	const d_aas_area_t *a = &d_aas.areas[area_num];
+
+	GArray *reachability = g_array_new(false, false, sizeof(d_aas_reachability_t));
+
+	for (int32_t i = 0; i < d_aas.num_areas; i++) {
+		const d_aas_area_t *b = &d_aas.areas[i];
+
+		if (i == area_num) {
+			continue;
+		}
+
+		if (b->mins[0] > a->maxs[0] + AAS_JUMP_DIST || b->maxs[0] < a->mins[0] - AAS_JUMP_DIST ||
+			b->mins[1] > a->maxs[1] + AAS_JUMP_DIST || b->maxs[1] < a->mins[1] - AAS_JUMP_DIST ||
+			b->mins[2] > a->maxs[2] + AAS_JUMP_HEIGHT || b->maxs[2] < a->mins[2] - AAS_FALL_HEIGHT) {
+			continue;
+		}
+
+		d_aas_reachability_t reach;
+		memset(&reach, 0, sizeof(reach));
+
+		if (AAS_Reachability(a, b, &reach)) {
+			vec3_t delta;
+
+			// the path heuristic is the distance between area origins, so
+			// no reachability may cost less than that
+			VectorSubtract(b->origin, a->origin, delta);
+			reach.cost = MAX(reach.cost, (int32_t) ceil(VectorLength(delta)));
+
+			reach.area = i;
+			g_array_append_val(reachability, reach);
+		}
+	}
+
+	area_reachability[area_num] = reachability;
+}
+
+/**
+ * @brief Finds the reachabilities of all areas, in parallel, and gathers them
+ * into the reachability lump.
+ */
+static void FindAASReachabilities(void) {
+	int32_t counts[AAS_TRAVEL_WATER + 1];
+
+	RunThreadsOn(d_aas.num_areas, true, FindAASReachability);
+
+	memset(counts, 0, sizeof(counts));
+
+	for (int32_t i = 0; i < d_aas.num_areas; i++) {
+		d_aas_area_t *area = &d_aas.areas[i];
+		GArray *reachability = area_reachability[i];
+
+		if (d_aas.num_reachability + (int32_t) reachability->len > MAX_AAS_REACHABILITY) {
+			Com_Error(ERR_FATAL, "MAX_AAS_REACHABILITY\n");
+		}
+
+		area->first_reachability = d_aas.num_reachability;
+		area->num_reachability = reachability->len;
+
+		for (guint j = 0; j < reachability->len; j++) {
+			const d_aas_reachability_t *reach = &g_array_index(reachability, d_aas_reachability_t, j);
+
+			d_aas.reachability[d_aas.num_reachability++] = *reach;
+			counts[reach->travel]++;
+		}
+
+		g_array_free(reachability, true);
+		area_reachability[i] = NULL;
+	}
+
+	Com_Verbose("%d reachabilities: %d walk, %d jump, %d fall, %d ladder, %d water\n",
+			d_aas.num_reachability, counts[AAS_TRAVEL_WALK], counts[AAS_TRAVEL_JUMP],
+			counts[AAS_TRAVEL_FALL], counts[AAS_TRAVEL_LADDER], counts[AAS_TRAVEL_WATER]);
+}
+
+/**
+ * @brief Groups areas into clusters by flooding through their reachabilities,
+ * taking no more than a fixed number of areas into each cluster.
+ */
+static void CreateAASClusters(void) {
+
+	const int32_t cluster_areas = MAX(AAS_CLUSTER_AREAS, d_aas.num_areas / MAX_AAS_CLUSTERS + 1);
+
+	int32_t *queue = Mem_Malloc(MAX(d_aas.num_areas, 1) * sizeof(int32_t));
+
+	for (int32_t i = 0; i < d_aas.num_areas; i++) {
+		d_aas.areas[i].cluster = -1;
+	}
+
+	for (int32_t i = 0; i < d_aas.num_areas; i++) {
 
-	for (i = 0; i < leaf->num_leaf_brushes; i++, lb++) {
-		const d_bsp_brush_t *brush = &d_bsp.brushes[*lb];
+		if (d_aas.areas[i].cluster != -1) {
+			continue;
+		}
+
+		if (d_aas.num_clusters == MAX_AAS_CLUSTERS) {
+			Com_Error(ERR_FATAL, "MAX_AAS_CLUSTERS\n");
+		}
+
+		const int32_t cluster_num = d_aas.num_clusters++;
+		d_aas_cluster_t *cluster = &d_aas.clusters[cluster_num];
 
-		if (brush->contents & MASK_CLIP_PLAYER) {
-			const d_bsp_brush_side_t *bs = &d_bsp.brush_sides[brush->first_side];
-			int32_t j;
+		int32_t head = 0, tail = 0;
 
-			for (j = 0; j < brush->num_sides; j++, bs++) {
-				const d_bsp_plane_t *plane = &d_bsp.planes[bs->plane_num];
+		queue[tail++] = i;
+		d_aas.areas[i].cluster = cluster_num;
 
-				if (plane->normal[2] > AI_NODE_MIN_NORMAL) {
-					return true;
+		while (head < tail) {
+			const d_aas_area_t *area = &d_aas.areas[queue[head++]];
+
+			VectorAdd(cluster->origin, area->origin, cluster->origin);
+			cluster->num_areas++;
+
+			const d_aas_reachability_t *reach = &d_aas.reachability[area->first_reachability];
+			for (int32_t j = 0; j < area->num_reachability && tail < cluster_areas; j++, reach++) {
+
+				if (d_aas.areas[reach->area].cluster == -1) {
+					d_aas.areas[reach->area].cluster = cluster_num;
+					queue[tail++] = reach->area;
 				}
 			}
 		}
+
+		VectorScale(cluster->origin, 1.0 / cluster->num_areas, cluster->origin);
 	}
 
-	return false;
+	Mem_Free(queue);
+
+	Com_Verbose("%d clusters of up to %d areas\n", d_aas.num_clusters, cluster_areas);
 }
 
+typedef struct {
+	int32_t cost;
+	int32_t cluster;
+} aas_route_node_t;
+
 /**
- * @brief Recurse the AAS node tree, pruning leafs which are not navigable.
+ * @brief Pushes a node onto the binary min-heap.
  */
-static void PruneAASNodes_(d_aas_node_t *node) {
-	int32_t c;
+static void AAS_HeapPush(aas_route_node_t *heap, int32_t *size, aas_route_node_t node) {
 
-	c = LittleLong(node->children[0]);
-	if (c < 0) {
-		if (PruneAASNodes_isNavigable(&d_bsp.leafs[-1 - c])) {
+	int32_t i = (*size)++;
 
-		} else {
-			node->children[0] = AAS_INVALID_LEAF;
+	while (i > 0) {
+		const int32_t parent = (i - 1) / 2;
+		if (heap[parent].cost <= node.cost) {
+			break;
 		}
+		heap[i] = heap[parent];
+		i = parent;
+	}
+
+	heap[i] = node;
+}
 
-		return;
+/**
+ * @brief Pops the least costly node from the binary min-heap.
+ */
+static aas_route_node_t AAS_HeapPop(aas_route_node_t *heap, int32_t *size) {
+
+	const aas_route_node_t top = heap[0];
+	const aas_route_node_t last = heap[--(*size)];
+
+	int32_t i = 0;
+	while (true) {
+		int32_t child = i * 2 + 1;
+		if (child >= *size) {
+			break;
+		}
+		if (child + 1 < *size && heap[child + 1].cost < heap[child].cost) {
+			child++;
+		}
+		if (heap[child].cost >= last.cost) {
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
 	}
 
-	PruneAASNodes_(&d_aas.nodes[c]);
+	heap[i] = last;
+	return top;
+}
+
+/**
+ * @brief Resolves the routes from every cluster to the specified cluster, by
+ * running Dijkstra's algorithm outward from it over the reversed cluster graph.
+ */
+static void FindAASRoutes(int32_t dest) {
 
-	c = LittleLong(node->children[1]);
-	if (c < 0) {
-		if (PruneAASNodes_isNavigable(&d_bsp.leafs[-1 - c])) {
+	const int32_t n = d_aas.num_clusters;
 
-		} else {
-			node->children[1] = AAS_INVALID_LEAF;
+	int32_t *cost = Mem_Malloc(n * sizeof(int32_t));
+	for (int32_t i = 0; i < n; i++) {
+		cost[i] = INT32_MAX;
+	}
+
+	int32_t max_heap = n;
+	for (int32_t i = 0; i < n; i++) {
+		max_heap += cluster_edges[i]->len;
+	}
+
+	aas_route_node_t *heap = Mem_Malloc(max_heap * sizeof(aas_route_node_t));
+	int32_t size = 0;
+
+	cost[dest] = 0;
+	d_aas.routes[dest * n + dest] = dest;
+
+	AAS_HeapPush(heap, &size, (aas_route_node_t) { .cost = 0, .cluster = dest });
+
+	while (size) {
+		const aas_route_node_t node = AAS_HeapPop(heap, &size);
+
+		if (node.cost > cost[node.cluster]) {
+			continue;
 		}
 
-		return;
+		const GArray *edges = cluster_edges[node.cluster];
+		for (guint i = 0; i < edges->len; i++) {
+			const aas_route_edge_t *edge = &g_array_index(edges, aas_route_edge_t, i);
+
+			const int32_t c = node.cost + edge->cost;
+			if (c < cost[edge->cluster]) {
+				cost[edge->cluster] = c;
+
+				// travelling from edge->cluster toward dest, go to node.cluster next
+				d_aas.routes[edge->cluster * n + dest] = node.cluster;
+
+				AAS_HeapPush(heap, &size, (aas_route_node_t) { .cost = c, .cluster = edge->cluster });
+			}
+		}
 	}
 
-	PruneAASNodes_(&d_aas.nodes[c]);
+	Mem_Free(heap);
+	Mem_Free(cost);
 }
 
 /**
- * @brief Entry point for recursive AAS node pruning.
+ * @brief Builds the cluster graph from the reachabilities which cross clusters,
+ * and resolves the routing table for every pair of clusters, in parallel.
  */
-static void PruneAASNodes(void) {
-	PruneAASNodes_(d_aas.nodes);
+static void CreateAASRoutes(void) {
+
+	const int32_t n = d_aas.num_clusters;
+
+	for (int32_t i = 0; i < n; i++) {
+		cluster_edges[i] = g_array_new(false, false, sizeof(aas_route_edge_t));
+	}
+
+	for (int32_t i = 0; i < d_aas.num_areas; i++) {
+		const d_aas_area_t *area = &d_aas.areas[i];
+
+		const d_aas_reachability_t *reach = &d_aas.reachability[area->first_reachability];
+		for (int32_t j = 0; j < area->num_reachability; j++, reach++) {
+
+			const int32_t cluster = d_aas.areas[reach->area].cluster;
+			if (cluster == area->cluster) {
+				continue;
+			}
+
+			vec3_t delta;
+			VectorSubtract(d_aas.clusters[cluster].origin, d_aas.clusters[area->cluster].origin, delta);
+
+			const aas_route_edge_t edge = {
+				.cluster = area->cluster,
+				.cost = VectorLength(delta) + reach->cost
+			};
+
+			g_array_append_val(cluster_edges[cluster], edge);
+		}
+	}
+
+	d_aas.routes = Mem_Malloc(MAX(n * n, 1) * sizeof(uint16_t));
+	memset(d_aas.routes, 0xff, n * n * sizeof(uint16_t));
+
+	RunThreadsOn(n, true, FindAASRoutes);
+
+	for (int32_t i = 0; i < n; i++) {
+		g_array_free(cluster_edges[i], true);
+		cluster_edges[i] = NULL;
+	}
 }
 
 /**
  * @brief Byte-swap all fields of the AAS file to LE.
  */
 static void SwapAASFile(void) {
-	int32_t i, j;
 
-	d_aas_node_t *node = d_aas.nodes;
-	for (i = 0; i < d_aas.num_nodes; i++, node++) {
+	d_aas_area_t *area = d_aas.areas;
+	for (int32_t i = 0; i < d_aas.num_areas; i++, area++) {
+
+		area->flags = LittleLong(area->flags);
+		area->cluster = LittleLong(area->cluster);
 
-		for (j = 0; j < 3; j++) {
-			node->mins[j] = LittleShort(node->mins[j]);
-			node->maxs[j] = LittleShort(node->maxs[j]);
+		for (int32_t j = 0; j < 3; j++) {
+			area->mins[j] = LittleFloat(area->mins[j]);
+			area->maxs[j] = LittleFloat(area->maxs[j]);
+			area->origin[j] = LittleFloat(area->origin[j]);
 		}
+
+		area->first_reachability = LittleLong(area->first_reachability);
+		area->num_reachability = LittleLong(area->num_reachability);
+	}
+
+	d_aas_reachability_t *reach = d_aas.reachability;
+	for (int32_t i = 0; i < d_aas.num_reachability; i++, reach++) {
+
+		reach->travel = LittleLong(reach->travel);
+		reach->area = LittleLong(reach->area);
+
+		for (int32_t j = 0; j < 3; j++) {
+			reach->start[j] = LittleFloat(reach->start[j]);
+			reach->end[j] = LittleFloat(reach->end[j]);
+		}
+
+		reach->cost = LittleLong(reach->cost);
+	}
+
+	for (int32_t i = 0; i < d_bsp.num_leafs; i++) {
+		d_aas.leaf_areas[i] = LittleLong(d_aas.leaf_areas[i]);
+	}
+
+	d_aas_cluster_t *cluster = d_aas.clusters;
+	for (int32_t i = 0; i < d_aas.num_clusters; i++, cluster++) {
+
+		for (int32_t j = 0; j < 3; j++) {
+			cluster->origin[j] = LittleFloat(cluster->origin[j]);
+		}
+
+		cluster->num_areas = LittleLong(cluster->num_areas);
+	}
+
+	for (int32_t i = 0; i < d_aas.num_clusters * d_aas.num_clusters; i++) {
+		d_aas.routes[i] = LittleShort(d_aas.routes[i]);
 	}
 }
 
@@ -163,11 +725,15 @@ void WriteAASFile(void) {
 		Com_Error(ERR_FATAL, "Couldn't open %s for writing\n", path);
 	}
 
-	Com_Print("Writing %d AAS nodes..\n", d_aas.num_nodes);
+	Com_Print("Writing %d AAS areas, %d reachabilities, %d clusters..\n", d_aas.num_areas,
+			d_aas.num_reachability, d_aas.num_clusters);
+
+	const int32_t num_leafs = d_bsp.num_leafs;
+	const int32_t num_routes = d_aas.num_clusters * d_aas.num_clusters;
 
 	SwapAASFile();
 
-	d_bsp_header_t header;
+	d_aas_header_t header;
 	memset(&header, 0, sizeof(header));
 
 	header.ident = LittleLong(AAS_IDENT);
@@ -175,8 +741,16 @@ void WriteAASFile(void) {
 
 	Fs_Write(f, &header, 1, sizeof(header));
 
-	d_bsp_lump_t *lump = &header.lumps[AAS_LUMP_NODES];
-	WriteLump(f, lump, d_aas.nodes, sizeof(d_aas_node_t) * d_aas.num_nodes);
+	WriteLump(f, &header.lumps[AAS_LUMP_AREAS], d_aas.areas,
+			sizeof(d_aas_area_t) * d_aas.num_areas);
+	WriteLump(f, &header.lumps[AAS_LUMP_REACHABILITY], d_aas.reachability,
+			sizeof(d_aas_reachability_t) * d_aas.num_reachability);
+	WriteLump(f, &header.lumps[AAS_LUMP_LEAF_AREAS], d_aas.leaf_areas,
+			sizeof(int32_t) * num_leafs);
+	WriteLump(f, &header.lumps[AAS_LUMP_CLUSTERS], d_aas.clusters,
+			sizeof(d_aas_cluster_t) * d_aas.num_clusters);
+	WriteLump(f, &header.lumps[AAS_LUMP_ROUTES], d_aas.routes,
+			sizeof(uint16_t) * num_routes);
 
 	// rewrite the header with the populated lumps
 
@@ -197,18 +771,27 @@ int32_t AAS_Main(void) {
 
 	LoadBSPFile(bsp_name);
 
-	if (d_bsp.num_nodes == 0) {
-		Com_Error(ERR_FATAL, "No nodes");
+	if (d_bsp.num_leafs == 0) {
+		Com_Error(ERR_FATAL, "No leafs");
 	}
 
+	// load the map for tracing
+	Cm_LoadBspModel(bsp_name, NULL);
+
 	memset(&d_aas, 0, sizeof(d_aas));
 
-	CreateAASNodes();
+	CreateAASAreas();
 
-	PruneAASNodes();
+	FindAASReachabilities();
+
+	CreateAASClusters();
+
+	CreateAASRoutes();
 
 	WriteAASFile();
 
+	Mem_Free(d_aas.routes);
+
 	const time_t end = time(NULL);
 	const time_t duration = end - start;
 	Com_Print("\nAAS Time: ");
@@ -54,7 +54,6 @@ typedef struct side_s {
 	int32_t contents; // from miptex
 	int32_t surf; // from miptex
 	_Bool visible; // choose visible planes first
-	_Bool tested; // this plane already checked as a split
 	_Bool bevel; // don't ever use for bsp splitting
 } side_t;
 
@@ -21,6 +21,10 @@
 
 #include "qlight.h"
 
+#if defined(__SSE__)
+ #include <xmmintrin.h>
+#endif
+
 /*
  *
  * every surface must be divided into at least two patches each axis
@@ -34,6 +38,9 @@ vec3_t face_offset[MAX_BSP_FACES]; // for rotating bmodels
 
 _Bool extra_samples = false;
 
+_Bool light_verify = false; // relight with the reference path, and compare
+_Bool light_reference = false; // cull no lights, and seek the nearest occluder
+
 vec3_t ambient;
 
 vec_t brightness = 1.0;
@@ -64,21 +71,41 @@ int32_t Light_PointLeafnum(const vec3_t point) {
 }
 
 /**
- * @brief
+ * @return The cluster containing the specified point, or -1 if the point is in
+ * solid. Without vis data, every point is visible from cluster 0.
  */
-_Bool Light_PointPVS(const vec3_t org, byte *pvs) {
-	d_bsp_leaf_t *leaf;
+int32_t Light_PointCluster(const vec3_t org) {
+
+	if (!d_bsp.vis_data_size) {
+		return 0;
+	}
+
+	return d_bsp.leafs[Light_PointLeafnum(org)].cluster;
+}
+
+/**
+ * @brief Decompresses the PVS of the specified cluster.
+ */
+void Light_ClusterPVS(int32_t cluster, byte *pvs) {
 
 	if (!d_bsp.vis_data_size) {
 		memset(pvs, 0xff, (d_bsp.num_leafs + 7) / 8);
-		return true;
+		return;
 	}
 
-	leaf = &d_bsp.leafs[Light_PointLeafnum(org)];
-	if (leaf->cluster == -1)
+	DecompressVis(d_bsp.vis_data + d_vis->bit_offsets[cluster][DVIS_PVS], pvs);
+}
+
+/**
+ * @brief
+ */
+_Bool Light_PointPVS(const vec3_t org, byte *pvs) {
+
+	const int32_t cluster = Light_PointCluster(org);
+	if (cluster == -1)
 		return false; // in solid leaf
 
-	DecompressVis(d_bsp.vis_data + d_vis->bit_offsets[leaf->cluster][DVIS_PVS], pvs);
+	Light_ClusterPVS(cluster, pvs);
 	return true;
 }
 
@@ -86,8 +113,30 @@ _Bool Light_PointPVS(const vec3_t org, byte *pvs) {
 static int32_t num_cmodels;
 static cm_bsp_model_t *cmodels[MAX_BSP_MODELS];
 
+#define LIGHT_MODEL_EPSILON 1.0
+
 /**
- * @brief
+ * @return True if the segment's bounds intersect those of the specified model.
+ * Models which fail this test can not clip the segment.
+ */
+static _Bool Light_SegmentIntersectsModel(const vec3_t start, const vec3_t end, const cm_bsp_model_t *mod) {
+
+	for (int32_t i = 0; i < 3; i++) {
+		if (MIN(start[i], end[i]) > mod->maxs[i] + LIGHT_MODEL_EPSILON) {
+			return false;
+		}
+		if (MAX(start[i], end[i]) < mod->mins[i] - LIGHT_MODEL_EPSILON) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Traces against the world and any BSP submodels, yielding the nearest
+ * intersection. The world is always traced first, so submodels whose bounds
+ * the segment misses are skipped without changing the result.
  */
 void Light_Trace(cm_trace_t *trace, const vec3_t start, const vec3_t end, int32_t mask) {
 	vec_t frac;
@@ -97,6 +146,11 @@ void Light_Trace(cm_trace_t *trace, const vec3_t start, const vec3_t end, int32_
 
 	// and any BSP submodels, too
 	for (i = 0; i < num_cmodels; i++) {
+
+		if (i && !light_reference && !Light_SegmentIntersectsModel(start, end, cmodels[i])) {
+			continue;
+		}
+
 		const cm_trace_t tr = Cm_BoxTrace(start, end, vec3_origin, vec3_origin,
 				cmodels[i]->head_node, mask);
 
@@ -107,6 +161,645 @@ void Light_Trace(cm_trace_t *trace, const vec3_t start, const vec3_t end, int32_
 	}
 }
 
+/**
+ * @brief Plane side epsilon of Cm_BoxTrace, which the occlusion walk must share.
+ */
+#define LIGHT_DIST_EPSILON 0.03125
+
+/**
+ * @brief A node of the occlusion tree, with its plane inlined.
+ */
+typedef struct {
+	vec3_t normal;
+	vec_t dist;
+	int32_t type;
+	int32_t children[2]; // negative numbers are -(leafs+1), not nodes
+} light_occlusion_node_t;
+
+/**
+ * @brief A leaf of the occlusion tree, referencing a range of leaf brushes.
+ */
+typedef struct {
+	int32_t contents;
+	int32_t first_leaf_brush;
+	int32_t num_leaf_brushes;
+} light_occlusion_leaf_t;
+
+/**
+ * @brief A brush of the occlusion tree, referencing a range of side planes.
+ */
+typedef struct {
+	vec3_t mins, maxs;
+	int32_t contents;
+	int32_t first_plane;
+	int32_t num_planes;
+} light_occlusion_brush_t;
+
+/**
+ * @brief A brush side plane of the occlusion tree.
+ */
+typedef struct {
+	vec3_t normal;
+	vec_t dist;
+} light_occlusion_plane_t;
+
+/**
+ * @brief The brush stamps of one thread, so that each lane of an occlusion
+ * packet tests a brush at most once, however many leafs it crosses. A stamp
+ * holds the generation of the packet in its upper bits, and the lanes which
+ * have tested the brush in its lower LIGHT_PACKET_SIZE bits.
+ */
+typedef struct {
+	uint32_t generation;
+	uint32_t brushes[];
+} light_occlusion_stamps_t;
+
+#define LIGHT_PACKET_LANES ((1u << LIGHT_PACKET_SIZE) - 1)
+
+/**
+ * @brief The BSP, flattened once for occlusion rays. The nodes carry their
+ * planes, and the brushes their bounds and contiguous side planes, so that the
+ * walk chases no pointers. It makes the same decisions as Cm_BoxTrace.
+ */
+static struct {
+	light_occlusion_node_t *nodes;
+	light_occlusion_leaf_t *leafs;
+	int32_t *leaf_brushes;
+	light_occlusion_brush_t *brushes;
+	light_occlusion_plane_t *planes;
+	int32_t num_brushes;
+
+	thread_buffers_t stamps;
+} light_occlusion;
+
+static __thread thread_buffer_t thread_stamps;
+
+/**
+ * @brief A packet of occlusion rays, cast from a common start towards the end
+ * of each lane.
+ */
+typedef struct {
+	vec3_t start;
+	vec3_t ends[LIGHT_PACKET_SIZE];
+	vec3_t box_mins[LIGHT_PACKET_SIZE], box_maxs[LIGHT_PACKET_SIZE];
+	int32_t mask;
+	uint32_t occluded; // the lanes clipped so far
+	light_occlusion_stamps_t *stamps;
+} light_occlusion_packet_t;
+
+/**
+ * @brief The segments of a packet's lanes beneath a node, one component per
+ * row, so that they may be classified against its plane together.
+ */
+typedef struct {
+	vec_t p1[3][LIGHT_PACKET_SIZE], p2[3][LIGHT_PACKET_SIZE];
+	vec_t p1f[LIGHT_PACKET_SIZE], p2f[LIGHT_PACKET_SIZE];
+	uint32_t lanes;
+} light_occlusion_segments_t;
+
+/**
+ * @brief Flattens the loaded BSP into the occlusion tree.
+ */
+static void BuildOcclusionTree(void) {
+
+	light_occlusion.nodes = Mem_Malloc(MAX(d_bsp.num_nodes, 1) * sizeof(light_occlusion_node_t));
+
+	for (int32_t i = 0; i < d_bsp.num_nodes; i++) {
+		const d_bsp_node_t *in = &d_bsp.nodes[i];
+		const d_bsp_plane_t *plane = &d_bsp.planes[in->plane_num];
+		light_occlusion_node_t *out = &light_occlusion.nodes[i];
+
+		VectorCopy(plane->normal, out->normal);
+		out->dist = plane->dist;
+		out->type = plane->type;
+
+		out->children[0] = in->children[0];
+		out->children[1] = in->children[1];
+	}
+
+	light_occlusion.leafs = Mem_Malloc(MAX(d_bsp.num_leafs, 1) * sizeof(light_occlusion_leaf_t));
+
+	for (int32_t i = 0; i < d_bsp.num_leafs; i++) {
+		const d_bsp_leaf_t *in = &d_bsp.leafs[i];
+		light_occlusion_leaf_t *out = &light_occlusion.leafs[i];
+
+		out->contents = in->contents;
+		out->first_leaf_brush = in->first_leaf_brush;
+		out->num_leaf_brushes = in->num_leaf_brushes;
+	}
+
+	light_occlusion.leaf_brushes = Mem_Malloc(MAX(d_bsp.num_leaf_brushes, 1) * sizeof(int32_t));
+
+	for (int32_t i = 0; i < d_bsp.num_leaf_brushes; i++) {
+		light_occlusion.leaf_brushes[i] = d_bsp.leaf_brushes[i];
+	}
+
+	light_occlusion.planes = Mem_Malloc(MAX(d_bsp.num_brush_sides, 1) * sizeof(light_occlusion_plane_t));
+
+	for (int32_t i = 0; i < d_bsp.num_brush_sides; i++) {
+		const d_bsp_plane_t *plane = &d_bsp.planes[d_bsp.brush_sides[i].plane_num];
+		light_occlusion_plane_t *out = &light_occlusion.planes[i];
+
+		VectorCopy(plane->normal, out->normal);
+		out->dist = plane->dist;
+	}
+
+	light_occlusion.brushes = Mem_Malloc(MAX(d_bsp.num_brushes, 1) * sizeof(light_occlusion_brush_t));
+	light_occlusion.num_brushes = d_bsp.num_brushes;
+
+	for (int32_t i = 0; i < d_bsp.num_brushes; i++) {
+		const d_bsp_brush_t *in = &d_bsp.brushes[i];
+		light_occlusion_brush_t *out = &light_occlusion.brushes[i];
+
+		out->contents = in->contents;
+		out->first_plane = in->first_side;
+		out->num_planes = in->num_sides;
+
+		// the first six sides are axial, as for Cm_SetupBspBrushes
+		const d_bsp_brush_side_t *bs = &d_bsp.brush_sides[in->first_side];
+
+		out->mins[0] = -d_bsp.planes[bs[0].plane_num].dist;
+		out->mins[1] = -d_bsp.planes[bs[2].plane_num].dist;
+		out->mins[2] = -d_bsp.planes[bs[4].plane_num].dist;
+
+		out->maxs[0] = d_bsp.planes[bs[1].plane_num].dist;
+		out->maxs[1] = d_bsp.planes[bs[3].plane_num].dist;
+		out->maxs[2] = d_bsp.planes[bs[5].plane_num].dist;
+	}
+}
+
+/**
+ * @brief Frees the occlusion tree, and the brush stamps of all threads.
+ */
+static void FreeOcclusionTree(void) {
+
+	Mem_Free(light_occlusion.nodes);
+	Mem_Free(light_occlusion.leafs);
+	Mem_Free(light_occlusion.leaf_brushes);
+	Mem_Free(light_occlusion.brushes);
+	Mem_Free(light_occlusion.planes);
+
+	FreeThreadBuffers(&light_occlusion.stamps);
+}
+
+/**
+ * @return The brush stamps of the calling thread, allocating them if necessary.
+ */
+static light_occlusion_stamps_t *ThreadOcclusionStamps(void) {
+	return ThreadBuffer(&light_occlusion.stamps, &thread_stamps, sizeof(light_occlusion_stamps_t) +
+			MAX(light_occlusion.num_brushes, 1) * sizeof(uint32_t));
+}
+
+/**
+ * @return True if the specified lane of the packet is clipped by the brush.
+ * This is Cm_TraceToBrush for a point, with the trace fraction still at 1.0.
+ */
+static _Bool Light_OccludedByBrush(const light_occlusion_packet_t *packet, int32_t lane,
+		const light_occlusion_brush_t *brush) {
+
+	if (!brush->num_planes)
+		return false;
+
+	if (!BoxIntersect(packet->box_mins[lane], packet->box_maxs[lane], brush->mins, brush->maxs))
+		return false;
+
+	const vec_t *start = packet->start;
+	const vec_t *end = packet->ends[lane];
+
+	vec_t enter_fraction = -1.0;
+	vec_t leave_fraction = 1.0;
+
+	_Bool end_outside = false, start_outside = false;
+
+	const light_occlusion_plane_t *plane = &light_occlusion.planes[brush->first_plane];
+
+	for (int32_t i = 0; i < brush->num_planes; i++, plane++) {
+
+		const vec_t d1 = DotProduct(start, plane->normal) - plane->dist;
+		const vec_t d2 = DotProduct(end, plane->normal) - plane->dist;
+
+		if (d2 > 0.0)
+			end_outside = true;
+		if (d1 > 0.0)
+			start_outside = true;
+
+		// if completely in front of face, no intersection with entire brush
+		if (d1 > 0.0 && d2 >= d1)
+			return false;
+
+		// if completely behind plane, no intersection
+		if (d1 <= 0.0 && d2 <= 0.0)
+			continue;
+
+		// crosses face
+		if (d1 > d2) { // enter
+			const vec_t f = (d1 - LIGHT_DIST_EPSILON) / (d1 - d2);
+
+			if (f > enter_fraction)
+				enter_fraction = f;
+		} else { // leave
+			const vec_t f = (d1 + LIGHT_DIST_EPSILON) / (d1 - d2);
+
+			if (f < leave_fraction)
+				leave_fraction = f;
+		}
+	}
+
+	if (!start_outside) { // only all solid brushes shorten the trace
+		return !end_outside;
+	}
+
+	if (enter_fraction < leave_fraction) { // pierced brush
+		return enter_fraction > -1.0 && enter_fraction < 1.0;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Clips the specified lanes of the packet to the brushes in the leaf.
+ */
+static void Light_OccludedByLeaf(light_occlusion_packet_t *packet, int32_t leaf_num, uint32_t lanes) {
+
+	const light_occlusion_leaf_t *leaf = &light_occlusion.leafs[leaf_num];
+
+	if (!(leaf->contents & packet->mask))
+		return;
+
+	light_occlusion_stamps_t *stamps = packet->stamps;
+
+	const int32_t *leaf_brush = &light_occlusion.leaf_brushes[leaf->first_leaf_brush];
+
+	for (int32_t i = 0; i < leaf->num_leaf_brushes; i++, leaf_brush++) {
+
+		uint32_t *stamp = &stamps->brushes[*leaf_brush];
+
+		uint32_t tested = 0;
+		if ((*stamp & ~LIGHT_PACKET_LANES) == stamps->generation) {
+			tested = *stamp & LIGHT_PACKET_LANES;
+		}
+
+		const uint32_t untested = lanes & ~tested & ~packet->occluded;
+		if (!untested)
+			continue; // already checked this brush in another leaf
+
+		*stamp = stamps->generation | tested | untested;
+
+		const light_occlusion_brush_t *b = &light_occlusion.brushes[*leaf_brush];
+
+		if (!(b->contents & packet->mask))
+			continue;
+
+		for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+			if ((untested & (1u << lane)) && Light_OccludedByBrush(packet, lane, b)) {
+				packet->occluded |= (1u << lane);
+			}
+		}
+
+		if (!(lanes & ~packet->occluded))
+			return;
+	}
+}
+
+/**
+ * @brief Resolves the distances of the specified segment end points to the
+ * plane of the node, and the lanes whose points are on or in front of it, and
+ * on or behind it. The arithmetic is that of the scalar Cm_TraceToNode.
+ */
+static void Light_PlaneDistances(const light_occlusion_node_t *node, const vec_t p[3][LIGHT_PACKET_SIZE],
+		vec_t *d, uint32_t *front, uint32_t *back) {
+
+#if defined(__SSE__) && LIGHT_PACKET_SIZE == 4
+	__m128 dist;
+
+	if (node->type < PLANE_ANY_X) {
+		dist = _mm_sub_ps(_mm_loadu_ps(p[node->type]), _mm_set1_ps(node->dist));
+	} else {
+		const __m128 x = _mm_mul_ps(_mm_set1_ps(node->normal[0]), _mm_loadu_ps(p[0]));
+		const __m128 y = _mm_mul_ps(_mm_set1_ps(node->normal[1]), _mm_loadu_ps(p[1]));
+		const __m128 z = _mm_mul_ps(_mm_set1_ps(node->normal[2]), _mm_loadu_ps(p[2]));
+
+		dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(x, y), z), _mm_set1_ps(node->dist));
+	}
+
+	_mm_storeu_ps(d, dist);
+
+	*front = (uint32_t) _mm_movemask_ps(_mm_cmpge_ps(dist, _mm_setzero_ps()));
+	*back = (uint32_t) _mm_movemask_ps(_mm_cmple_ps(dist, _mm_setzero_ps()));
+#else
+	*front = *back = 0;
+
+	for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+		if (node->type < PLANE_ANY_X) {
+			d[lane] = p[node->type][lane] - node->dist;
+		} else {
+			d[lane] = node->normal[0] * p[0][lane] + node->normal[1] * p[1][lane] +
+					node->normal[2] * p[2][lane] - node->dist;
+		}
+
+		if (d[lane] >= 0.0)
+			*front |= (1u << lane);
+		if (d[lane] <= 0.0)
+			*back |= (1u << lane);
+	}
+#endif
+}
+
+/**
+ * @brief Copies the end points of a lane's segment to vectors.
+ */
+static void Light_SegmentPoints(const light_occlusion_segments_t *segments, int32_t lane,
+		vec3_t p1, vec3_t p2) {
+
+	for (int32_t i = 0; i < 3; i++) {
+		p1[i] = segments->p1[i][lane];
+		p2[i] = segments->p2[i][lane];
+	}
+}
+
+/**
+ * @brief Sets a lane's segment from the specified end points and fractions.
+ */
+static void Light_SetSegment(light_occlusion_segments_t *segments, int32_t lane,
+		const vec3_t p1, const vec3_t p2, vec_t p1f, vec_t p2f) {
+
+	for (int32_t i = 0; i < 3; i++) {
+		segments->p1[i][lane] = p1[i];
+		segments->p2[i][lane] = p2[i];
+	}
+
+	segments->p1f[lane] = p1f;
+	segments->p2f[lane] = p2f;
+
+	segments->lanes |= (1u << lane);
+}
+
+/**
+ * @brief Clips the segments of the packet's lanes beneath the specified node.
+ * For each lane, this is Cm_TraceToNode for a point, with the trace fraction
+ * still at 1.0: every lane sends the same segments to the same children, and
+ * so reaches the same leafs. The lanes are classified against each plane
+ * together, and walk each child together. Only the order in which leafs are
+ * reached differs, and that can not change whether a lane is clipped.
+ */
+static void Light_OccludedByNode(light_occlusion_packet_t *packet, int32_t num,
+		const light_occlusion_segments_t *segments) {
+
+	uint32_t lanes = segments->lanes & ~packet->occluded;
+
+	for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+		if (segments->p1f[lane] >= 1.0) {
+			lanes &= ~(1u << lane);
+		}
+	}
+
+	if (!lanes)
+		return;
+
+	// if < 0, we are in a leaf node
+	if (num < 0) {
+		Light_OccludedByLeaf(packet, -1 - num, lanes);
+		return;
+	}
+
+	const light_occlusion_node_t *node = &light_occlusion.nodes[num];
+
+	vec_t d1[LIGHT_PACKET_SIZE], d2[LIGHT_PACKET_SIZE];
+	uint32_t front1, back1, front2, back2;
+
+	Light_PlaneDistances(node, segments->p1, d1, &front1, &back1);
+	Light_PlaneDistances(node, segments->p2, d2, &front2, &back2);
+
+	// lanes wholly on one side keep their segments
+	const uint32_t front = lanes & front1 & front2;
+	const uint32_t back = lanes & ~front & back1 & back2;
+
+	light_occlusion_segments_t children[2];
+
+	children[0] = children[1] = *segments;
+
+	children[0].lanes = front;
+	children[1].lanes = back;
+
+	// and the others are split, with the cross point LIGHT_DIST_EPSILON pixels on the near side
+	const uint32_t split = lanes & ~front & ~back;
+
+	for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+
+		if (!(split & (1u << lane)))
+			continue;
+
+		int32_t side;
+		vec_t frac1, frac2;
+
+		if (d1[lane] < d2[lane]) {
+			const vec_t idist = 1.0 / (d1[lane] - d2[lane]);
+			side = 1;
+			frac2 = (d1[lane] + LIGHT_DIST_EPSILON) * idist;
+			frac1 = (d1[lane] + LIGHT_DIST_EPSILON) * idist;
+		} else if (d1[lane] > d2[lane]) {
+			const vec_t idist = 1.0 / (d1[lane] - d2[lane]);
+			side = 0;
+			frac2 = (d1[lane] - LIGHT_DIST_EPSILON) * idist;
+			frac1 = (d1[lane] + LIGHT_DIST_EPSILON) * idist;
+		} else {
+			side = 0;
+			frac1 = 1.0;
+			frac2 = 0.0;
+		}
+
+		const vec_t p1f = segments->p1f[lane];
+		const vec_t p2f = segments->p2f[lane];
+
+		vec3_t p1, p2, mid;
+
+		Light_SegmentPoints(segments, lane, p1, p2);
+
+		// move up to the node
+		frac1 = Clamp(frac1, 0.0, 1.0);
+
+		const vec_t midf1 = p1f + (p2f - p1f) * frac1;
+
+		VectorLerp(p1, p2, frac1, mid);
+
+		Light_SetSegment(&children[side], lane, p1, mid, p1f, midf1);
+
+		// go past the node
+		frac2 = Clamp(frac2, 0.0, 1.0);
+
+		const vec_t midf2 = p1f + (p2f - p1f) * frac2;
+
+		VectorLerp(p1, p2, frac2, mid);
+
+		Light_SetSegment(&children[side ^ 1], lane, mid, p2, midf2, p2f);
+	}
+
+	Light_OccludedByNode(packet, node->children[0], &children[0]);
+	Light_OccludedByNode(packet, node->children[1], &children[1]);
+}
+
+/**
+ * @brief Clips the specified lanes of the packet to the model. For each lane,
+ * this is equivalent to testing a point Cm_BoxTrace for a fraction less than 1.0.
+ */
+static void Light_OccludedByModel(light_occlusion_packet_t *packet, int32_t model, uint32_t lanes) {
+	light_occlusion_segments_t segments;
+
+	memset(&segments, 0, sizeof(segments));
+
+	for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+
+		if (!(lanes & (1u << lane)))
+			continue;
+
+		const vec_t *end = packet->ends[lane];
+
+		if (VectorCompare(packet->start, end)) { // position test, which Cm_BoxTrace resolves by leafs
+			const cm_trace_t tr = Cm_BoxTrace(packet->start, end, vec3_origin, vec3_origin,
+					cmodels[model]->head_node, packet->mask);
+
+			if (tr.fraction < 1.0) {
+				packet->occluded |= (1u << lane);
+			}
+			continue;
+		}
+
+		Light_SetSegment(&segments, lane, packet->start, end, 0.0, 1.0);
+	}
+
+	if (!segments.lanes)
+		return;
+
+	light_occlusion_stamps_t *stamps = packet->stamps;
+
+	stamps->generation += (1u << LIGHT_PACKET_SIZE);
+
+	if (stamps->generation == 0) { // wrapped, so stale generations must be cleared
+		memset(stamps->brushes, 0, light_occlusion.num_brushes * sizeof(uint32_t));
+		stamps->generation = (1u << LIGHT_PACKET_SIZE);
+	}
+
+	Light_OccludedByNode(packet, cmodels[model]->head_node, &segments);
+}
+
+/**
+ * @brief The model which last occluded a ray on this thread. Occlusion rays cast
+ * from neighboring samples tend to be blocked by the same model, so it is
+ * tested first.
+ */
+static __thread int32_t light_occluder;
+
+/**
+ * @return The specified lanes whose segments, from start to their ends, are
+ * clipped by the world or any BSP submodel. For each lane, this is equivalent
+ * to Light_Occluded. The lanes walk the occlusion tree together, and each model
+ * is walked only by those lanes which are not yet clipped.
+ */
+uint32_t Light_OccludedPacket(const vec3_t start, const vec3_t *ends, uint32_t lanes, int32_t mask) {
+
+	if (light_reference) {
+		uint32_t occluded = 0;
+
+		for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+			if ((lanes & (1u << lane)) && Light_Occluded(start, ends[lane], mask)) {
+				occluded |= (1u << lane);
+			}
+		}
+
+		return occluded;
+	}
+
+	light_occlusion_packet_t packet;
+
+	memset(&packet, 0, sizeof(packet));
+
+	VectorCopy(start, packet.start);
+
+	for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+
+		if (!(lanes & (1u << lane)))
+			continue;
+
+		const vec_t *end = ends[lane];
+
+		VectorCopy(end, packet.ends[lane]);
+
+		for (int32_t i = 0; i < 3; i++) {
+			if (start[i] < end[i]) {
+				packet.box_mins[lane][i] = start[i] - 1.0;
+				packet.box_maxs[lane][i] = end[i] + 1.0;
+			} else {
+				packet.box_mins[lane][i] = end[i] - 1.0;
+				packet.box_maxs[lane][i] = start[i] + 1.0;
+			}
+		}
+	}
+
+	packet.mask = mask;
+	packet.stamps = ThreadOcclusionStamps();
+
+	const int32_t occluder = light_occluder;
+
+	for (int32_t i = -1; i < num_cmodels; i++) {
+
+		const int32_t model = i == -1 ? occluder : i;
+		if (i == occluder || model >= num_cmodels) {
+			continue;
+		}
+
+		uint32_t model_lanes = 0;
+
+		for (int32_t lane = 0; lane < LIGHT_PACKET_SIZE; lane++) {
+
+			if (!(lanes & ~packet.occluded & (1u << lane)))
+				continue;
+
+			if (model && !Light_SegmentIntersectsModel(start, ends[lane], cmodels[model]))
+				continue;
+
+			model_lanes |= (1u << lane);
+		}
+
+		if (!model_lanes)
+			continue;
+
+		const uint32_t occluded = packet.occluded;
+
+		Light_OccludedByModel(&packet, model, model_lanes);
+
+		if (packet.occluded != occluded) {
+			light_occluder = model;
+
+			if (packet.occluded == lanes)
+				break;
+		}
+	}
+
+	return packet.occluded;
+}
+
+/**
+ * @return True if the segment is clipped by the world or any BSP submodel. This
+ * is equivalent to testing Light_Trace for a fraction less than 1.0, but
+ * walks the occlusion tree, and returns at the first occluder rather than
+ * seeking the nearest one.
+ */
+_Bool Light_Occluded(const vec3_t start, const vec3_t end, int32_t mask) {
+
+	if (light_reference) {
+		cm_trace_t trace;
+
+		Light_Trace(&trace, start, end, mask);
+		return trace.fraction < 1.0;
+	}
+
+	vec3_t ends[1];
+
+	VectorCopy(end, ends[0]);
+
+	return Light_OccludedPacket(start, (const vec3_t *) ends, 1, mask) != 0;
+}
+
 /**
  * @brief
  */
@@ -123,6 +816,9 @@ static void LightWorld(void) {
 		cmodels[i] = Cm_Model(va("*%d", i));
 	}
 
+	// and flatten it for occlusion rays
+	BuildOcclusionTree();
+
 	// turn each face into a single patch
 	BuildPatches();
 
@@ -138,12 +834,28 @@ static void LightWorld(void) {
 	// build per-vertex normals for phong shading
 	BuildVertexNormals();
 
+	// load the lighting from the previous run, if any
+	LoadLightCache();
+
 	// build initial facelights
 	RunThreadsOn(d_bsp.num_faces, true, BuildFacelights);
 
+	// and save it for the next run
+	WriteLightCache();
+
+	// compare it to the reference path, if requested
+	if (light_verify) {
+		VerifyFacelights();
+	}
+
 	// finalize it and write it out
 	d_bsp.lightmap_data_size = 0;
 	RunThreadsOn(d_bsp.num_faces, true, FinalLightFace);
+
+	// and bake the light grid for mesh entities
+	BuildLightGrid();
+
+	FreeOcclusionTree();
 }
 
 /**
@@ -26,6 +26,8 @@
 #include "polylib.h"
 #include "collision/cmodel.h"
 
+#define LIGHT_PACKET_SIZE 4 // occlusion rays cast together by Light_OccludedPacket
+
 typedef enum {
     LIGHT_POINT,
     LIGHT_SPOT,
@@ -58,12 +60,29 @@ extern vec_t entity_scale;
 extern vec3_t ambient;
 
 extern _Bool extra_samples;
+extern _Bool light_cache;
+extern _Bool light_verify;
+extern _Bool light_reference;
 
 // lightmap.c
 void BuildLights(void);
 void BuildVertexNormals(void);
 void BuildFacelights(int32_t facenum);
+void VerifyFacelights(void);
 void FinalLightFace(int32_t facenum);
+vec_t GatherLightGridSample(const vec3_t pos, vec_t *sample, vec_t *direction);
+void FreeCandidateLights(void);
+
+// lightgrid.c
+void BuildLightGrid(void);
+
+// lightcache.c
+uint64_t HashLightCacheOccluders(uint64_t hash, const vec3_t mins, const vec3_t maxs);
+void LoadLightCache(void);
+_Bool LookupLightCache(uint64_t key, int32_t num_samples, vec_t *samples, vec_t *directions);
+void UpdateLightCache(int32_t face_num, uint64_t key, int32_t num_samples, const vec_t *samples,
+		const vec_t *directions);
+void WriteLightCache(void);
 
 // patches.c
 void CalcTextureReflectivity(void);
@@ -72,8 +91,12 @@ void SubdividePatches(void);
 void FreePatches(void);
 
 // qlight.c
+int32_t Light_PointCluster(const vec3_t org);
+void Light_ClusterPVS(int32_t cluster, byte *pvs);
 _Bool Light_PointPVS(const vec3_t org, byte *pvs);
 int32_t Light_PointLeafnum(const vec3_t point);
 void Light_Trace(cm_trace_t *trace, const vec3_t start, const vec3_t end, int32_t mask);
+_Bool Light_Occluded(const vec3_t start, const vec3_t end, int32_t mask);
+uint32_t Light_OccludedPacket(const vec3_t start, const vec3_t *ends, uint32_t lanes, int32_t mask);
 
 #endif /* __QLIGHT_H__ */
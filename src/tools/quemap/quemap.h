@@ -42,6 +42,8 @@ extern _Bool verbose;
 extern _Bool debug;
 extern _Bool legacy;
 
+uint64_t HashFNV(uint64_t hash, const void *data, size_t len);
+
 // threads.c
 typedef struct semaphores_s {
 	SDL_sem *active_portals;
@@ -59,9 +61,12 @@ void Sem_Init(void);
 void Sem_Shutdown(void);
 
 typedef struct thread_work_s {
-	int32_t index; // current work cycle
+	SDL_atomic_t index; // next work cycle to be claimed
 	int32_t count; // total work cycles
-	int32_t fraction; // last fraction of work completed (tenths)
+	int32_t chunk; // work cycles claimed at a time by each worker
+	int32_t num_workers; // pool threads plus the calling thread
+	SDL_atomic_t completed; // work cycles completed
+	SDL_atomic_t fraction; // last fraction of work completed (tenths)
 	_Bool progress; // are we reporting progress
 } thread_work_t;
 
@@ -73,4 +78,35 @@ void ThreadLock(void);
 void ThreadUnlock(void);
 void RunThreadsOn(int32_t workcount, _Bool progress, ThreadWorkFunc func);
 
+/**
+ * @brief A set of buffers, one per thread, allocated on demand and released
+ * all at once between work runs.
+ */
+typedef struct {
+	SDL_SpinLock lock;
+	struct thread_buffer_link_s *buffers; // in the list of all buffers
+	int32_t generation; // incremented by FreeThreadBuffers to orphan thread buffers
+} thread_buffers_t;
+
+/**
+ * @brief A thread's handle to its buffer in a set, declared static __thread.
+ */
+typedef struct {
+	void *buffer;
+	int32_t generation;
+} thread_buffer_t;
+
+typedef void (*ThreadBufferFunc)(void *buffer, void *data);
+
+void *ThreadBuffer(thread_buffers_t *buffers, thread_buffer_t *thread_buffer, size_t size);
+void ForEachThreadBuffer(thread_buffers_t *buffers, ThreadBufferFunc func, void *data);
+void FreeThreadBuffers(thread_buffers_t *buffers);
+
+// arena.c
+void *ArenaMalloc(size_t size);
+void ArenaFree(void *p);
+size_t ArenaSize(void);
+size_t ArenaPeakSize(void);
+void ArenaReset(void);
+
 #endif /*__QUETOOMAP_H__*/
@@ -26,8 +26,252 @@ map_vis_t map_vis;
 _Bool fastvis = false;
 _Bool nosort = false;
 
+_Bool resume_vis = false;
+int32_t portal_range[2] = { 0, -1 };
+
 static int32_t visibility_count;
 
+/*
+ * Vis checkpoints retain the final vis of each portal as it completes, so that
+ * an interrupted run may be resumed with -resume, and so that several processes
+ * may each flow a disjoint -portal-range a:b and merge their results. Each file
+ * is a header followed by records of a memory portal index and its vis vector.
+ * Checkpoints are named ${map_name}.vck, or ${map_name}.a-b.vck for a range.
+ */
+
+#define VIS_CHECKPOINT_IDENT (('K' << 24) + ('C' << 16) + ('V' << 8) + 'Q') // "QVCK"
+#define VIS_CHECKPOINT_VERSION 1
+
+typedef struct {
+	int32_t ident;
+	int32_t version;
+	uint32_t num_portals;
+	uint32_t portal_bytes;
+	uint64_t hash; // of the portal file, so that stale checkpoints are ignored
+} vis_checkpoint_header_t;
+
+static struct {
+	uint64_t hash;
+	file_t *file;
+	int32_t num_loaded;
+} vis_checkpoint;
+
+/**
+ * @return True if the specified memory portal is within the -portal-range.
+ */
+static _Bool PortalInRange(int32_t portal_num) {
+
+	if (portal_range[1] < 0) {
+		return true;
+	}
+
+	return portal_num >= portal_range[0] && portal_num < portal_range[1];
+}
+
+/**
+ * @brief Resolves the checkpoint file name for this run.
+ */
+static void VisCheckpointName(char *path, size_t len) {
+
+	StripExtension(map_name, path);
+
+	if (portal_range[1] < 0) {
+		g_strlcat(path, ".vck", len);
+	} else {
+		g_strlcat(path, va(".%d-%d.vck", portal_range[0], portal_range[1]), len);
+	}
+}
+
+/**
+ * @return True if the specified path is a checkpoint of this map, named either
+ * `<map>.vck` or `<map>.<first>-<last>.vck` by VisCheckpointName.
+ */
+static _Bool IsVisCheckpoint(const char *path, const char *base) {
+	char name[MAX_OS_PATH];
+	int32_t first, last;
+
+	const size_t base_len = strlen(base);
+
+	if (strncmp(path, base, base_len)) {
+		return false;
+	}
+
+	const char *suffix = path + base_len;
+
+	if (!strcmp(suffix, ".vck")) {
+		return true;
+	}
+
+	if (sscanf(suffix, ".%d-%d.vck", &first, &last) != 2) {
+		return false;
+	}
+
+	g_snprintf(name, sizeof(name), ".%d-%d.vck", first, last);
+	return !strcmp(suffix, name);
+}
+
+/**
+ * @brief Fs_EnumerateFunc for LoadVisCheckpoints. Restores the vis of every
+ * complete record in a checkpoint matching the loaded portal file.
+ */
+static void LoadVisCheckpoint(const char *path, void *data) {
+	void *buffer;
+
+	if (!IsVisCheckpoint(path, (const char *) data)) {
+		return;
+	}
+
+	const int64_t len = Fs_Load(path, &buffer);
+	if (len == -1) {
+		return;
+	}
+
+	const vis_checkpoint_header_t *header = (vis_checkpoint_header_t *) buffer;
+
+	if (len < (int64_t) sizeof(*header) || header->ident != VIS_CHECKPOINT_IDENT
+			|| header->version != VIS_CHECKPOINT_VERSION
+			|| header->num_portals != map_vis.num_portals
+			|| header->portal_bytes != map_vis.portal_bytes
+			|| header->hash != vis_checkpoint.hash) {
+		Com_Warn("Ignoring stale or invalid vis checkpoint %s\n", path);
+		Fs_Free(buffer);
+		return;
+	}
+
+	const size_t record = sizeof(int32_t) + map_vis.portal_bytes;
+
+	const byte *in = (const byte *) (header + 1);
+	const byte *end = (const byte *) buffer + len;
+
+	int32_t count = 0;
+
+	// a trailing partial record is simply an interrupted write
+	for (; in + record <= end; in += record) {
+		int32_t portal_num;
+
+		memcpy(&portal_num, in, sizeof(portal_num));
+
+		if (portal_num < 0 || (uint32_t) portal_num >= map_vis.num_portals * 2) {
+			Com_Warn("Invalid portal %d in vis checkpoint %s\n", portal_num, path);
+			break;
+		}
+
+		portal_t *p = &map_vis.portals[portal_num];
+
+		if (p->status != stat_done) {
+			memcpy(p->vis, in + sizeof(portal_num), map_vis.portal_bytes);
+			p->status = stat_done;
+			vis_checkpoint.num_loaded++;
+		}
+
+		count++;
+	}
+
+	Com_Verbose("Loaded %d portals from vis checkpoint %s\n", count, path);
+
+	Fs_Free(buffer);
+}
+
+/**
+ * @brief Appends the final vis of the specified portal to the checkpoint.
+ */
+static void WriteVisCheckpointPortal(const portal_t *p) {
+
+	const int32_t portal_num = (int32_t) (p - map_vis.portals);
+
+	Fs_Write(vis_checkpoint.file, &portal_num, sizeof(portal_num), 1);
+	Fs_Write(vis_checkpoint.file, p->vis, map_vis.portal_bytes, 1);
+}
+
+/**
+ * @brief Restores any checkpoints from previous runs, when resuming, and opens
+ * this run's checkpoint, retaining the restored portals within it.
+ */
+static void OpenVisCheckpoint(void) {
+	char path[MAX_OS_PATH];
+
+	if (resume_vis) {
+		char base[MAX_OS_PATH], pattern[MAX_OS_PATH];
+
+		StripExtension(map_name, base);
+		g_snprintf(pattern, sizeof(pattern), "%s*.vck", base);
+
+		Fs_Enumerate(pattern, LoadVisCheckpoint, base);
+
+		Com_Print("Resuming with %d of %u portals complete\n", vis_checkpoint.num_loaded,
+				map_vis.num_portals * 2);
+	}
+
+	VisCheckpointName(path, sizeof(path));
+
+	if (!(vis_checkpoint.file = Fs_OpenWrite(path))) {
+		Com_Warn("Couldn't open %s for writing\n", path);
+		return;
+	}
+
+	const vis_checkpoint_header_t header = {
+		.ident = VIS_CHECKPOINT_IDENT,
+		.version = VIS_CHECKPOINT_VERSION,
+		.num_portals = map_vis.num_portals,
+		.portal_bytes = (uint32_t) map_vis.portal_bytes,
+		.hash = vis_checkpoint.hash
+	};
+
+	Fs_Write(vis_checkpoint.file, &header, sizeof(header), 1);
+
+	for (uint32_t i = 0; i < map_vis.num_portals * 2; i++) {
+		const portal_t *p = &map_vis.portals[i];
+
+		if (p->status == stat_done && PortalInRange(i)) {
+			WriteVisCheckpointPortal(p);
+		}
+	}
+
+	Fs_Flush(vis_checkpoint.file);
+}
+
+/**
+ * @brief Records the final vis of the specified portal in the checkpoint. This
+ * is called from FinalVis, and so may be called from any thread.
+ */
+void CheckpointPortal(const portal_t *p) {
+
+	if (!vis_checkpoint.file) {
+		return;
+	}
+
+	ThreadLock();
+
+	WriteVisCheckpointPortal(p);
+	Fs_Flush(vis_checkpoint.file);
+
+	ThreadUnlock();
+}
+
+/**
+ * @return True if FinalVis should skip the specified portal, because it was
+ * restored from a checkpoint or lies outside of the -portal-range.
+ */
+_Bool SkipPortal(const portal_t *p) {
+
+	if (p->status == stat_done) {
+		return true;
+	}
+
+	return !PortalInRange((int32_t) (p - map_vis.portals));
+}
+
+/**
+ * @brief Closes this run's checkpoint.
+ */
+static void CloseVisCheckpoint(void) {
+
+	if (vis_checkpoint.file) {
+		Fs_Close(vis_checkpoint.file);
+		vis_checkpoint.file = NULL;
+	}
+}
+
 /**
  * @brief
  */
@@ -111,7 +355,7 @@ static void ClusterMerge(uint32_t leaf_num) {
 	byte portalvector[MAX_BSP_PORTALS / 8];
 	byte uncompressed[MAX_BSP_LEAFS / 8];
 	byte compressed[MAX_BSP_LEAFS / 8];
-	uint32_t i, j;
+	uint32_t i;
 	int32_t numvis;
 	byte *dest;
 	portal_t *p;
@@ -128,10 +372,9 @@ static void ClusterMerge(uint32_t leaf_num) {
 		p = leaf->portals[i];
 		if (p->status != stat_done)
 			Com_Error(ERR_FATAL, "Portal not done\n");
-		for (j = 0; j < map_vis.portal_longs; j++)
-			((long *) portalvector)[j] |= ((long *) p->vis)[j];
+		Cm_BitsetOr(portalvector, portalvector, p->vis, map_vis.portal_bytes);
 		pnum = p - map_vis.portals;
-		portalvector[pnum >> 3] |= 1 << (pnum & 7);
+		Cm_BitsetSet(portalvector, pnum);
 	}
 
 	// convert portal bits to leaf bits
@@ -181,7 +424,18 @@ static void CalcVis(void) {
 			map_vis.portals[i].status = stat_done;
 		}
 	} else {
+		OpenVisCheckpoint();
+
 		RunThreadsOn(map_vis.num_portals * 2, true, FinalVis);
+
+		CloseVisCheckpoint();
+
+		PrintVisStats();
+
+		// a slice of the portals can not be merged until every slice is complete
+		if (portal_range[1] >= 0) {
+			return;
+		}
 	}
 
 	// assemble the leaf vis lists by OR-ing and compressing the portal lists
@@ -238,13 +492,16 @@ static void LoadPortals(const char *filename) {
 	int32_t leaf_nums[2];
 	plane_t plane;
 
-	if (Fs_Load(filename, (void **) &buffer) == -1)
+	const int64_t buffer_len = Fs_Load(filename, (void **) &buffer);
+	if (buffer_len == -1)
 		Com_Error(ERR_FATAL, "Could not open %s\n", filename);
 
 	s = buffer;
 
 	memset(&map_vis, 0, sizeof(map_vis));
 
+	vis_checkpoint.hash = HashFNV(0, buffer, (size_t) buffer_len);
+
 	if (sscanf(s, "%79s\n%u\n%u\n%n", magic, &map_vis.portal_clusters, &map_vis.num_portals, &len)
 			!= 3)
 		Com_Error(ERR_FATAL, "Failed to read header: %s\n", filename);
@@ -260,7 +517,8 @@ static void LoadPortals(const char *filename) {
 	map_vis.leaf_bytes = ((map_vis.portal_clusters + 63) & ~63) >> 3;
 	map_vis.leaf_longs = map_vis.leaf_bytes / sizeof(long);
 
-	map_vis.portal_bytes = ((map_vis.num_portals * 2 + 63) & ~63) >> 3;
+	// portal bit vectors are padded to the width of the widest bitset kernel
+	map_vis.portal_bytes = ((map_vis.num_portals * 2 + 255) & ~255) >> 3;
 	map_vis.portal_longs = map_vis.portal_bytes / sizeof(long);
 
 	// each file portal is split into two memory portals
@@ -360,9 +618,10 @@ static void LoadPortals(const char *filename) {
  * by ORing together all the PVS visible from a leaf
  */
 static void CalcPHS(void) {
-	uint32_t i, j, k, l, index;
+	uint32_t i, j, k, index;
 	int32_t bitbyte;
-	long *dest, *src;
+	const byte *src;
+	byte *dest;
 	byte *scan;
 	int32_t count;
 	byte uncompressed[MAX_BSP_LEAFS / 8];
@@ -385,25 +644,22 @@ static void CalcPHS(void) {
 				index = ((j << 3) + k);
 				if (index >= map_vis.portal_clusters)
 					Com_Error(ERR_FATAL, "Bad bit vector in PVS\n"); // pad bits should be 0
-				src = (long *) (map_vis.uncompressed + index * map_vis.leaf_bytes);
-				for (l = 0; l < map_vis.leaf_longs; l++)
-					((long *) uncompressed)[l] |= src[l];
+				src = map_vis.uncompressed + index * map_vis.leaf_bytes;
+				Cm_BitsetOr(uncompressed, uncompressed, src, map_vis.leaf_bytes);
 			}
 		}
-		for (j = 0; j < map_vis.portal_clusters; j++)
-			if (uncompressed[j >> 3] & (1 << (j & 7)))
-				count++;
+		count += CountBits(uncompressed, map_vis.portal_clusters);
 
 		// compress the bit string
 		j = CompressVis(uncompressed, compressed);
 
-		dest = (long *) map_vis.pointer;
+		dest = map_vis.pointer;
 		map_vis.pointer += j;
 
 		if (map_vis.pointer > map_vis.end)
 			Com_Error(ERR_FATAL, "Overflow\n");
 
-		d_vis->bit_offsets[i][DVIS_PHS] = (byte *) dest - map_vis.base;
+		d_vis->bit_offsets[i][DVIS_PHS] = dest - map_vis.base;
 
 		memcpy(dest, compressed, j);
 	}
@@ -434,8 +690,22 @@ int32_t VIS_Main(void) {
 
 	LoadPortals(portal_file);
 
+	if (portal_range[1] >= 0) {
+		if (portal_range[1] > (int32_t) map_vis.num_portals * 2) {
+			portal_range[1] = map_vis.num_portals * 2;
+		}
+		Com_Print("Flowing portals %d to %d of %u\n", portal_range[0], portal_range[1],
+				map_vis.num_portals * 2);
+	}
+
 	CalcVis();
 
+	if (portal_range[1] >= 0 && !fastvis) {
+		Com_Print("Portals %d to %d checkpointed, run -vis -resume to merge all slices\n",
+				portal_range[0], portal_range[1]);
+		return 0;
+	}
+
 	CalcPHS();
 
 	d_bsp.vis_data_size = map_vis.pointer - d_bsp.vis_data;
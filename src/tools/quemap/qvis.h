@@ -23,6 +23,7 @@
 #define __QVIS_H__
 
 #include "bspfile.h"
+#include "collision/cmodel.h"
 
 #define	PORTALFILE	"PRT1"
 
@@ -84,7 +85,7 @@ typedef struct leaf_s {
 } leaf_t;
 
 typedef struct pstack_s {
-	byte mightsee[MAX_BSP_PORTALS / 8];	// bit string
+	byte mightsee[MAX_BSP_PORTALS / 8] __attribute__((aligned(32))); // bit string
 	struct pstack_s *next;
 	leaf_t *leaf;
 	portal_t *portal; // portal exiting
@@ -97,9 +98,22 @@ typedef struct pstack_s {
 	plane_t portalplane;
 } pstack_t;
 
+/**
+ * @brief Counts of the early-outs taken while flowing through portals.
+ */
+typedef struct {
+	uint64_t chains; // recursions into a leaf
+	uint64_t mightsee; // portals not in the might-see set
+	uint64_t nothing_new; // portals which could reveal nothing new
+	uint64_t behind; // portals behind the base portal
+	uint64_t source; // source windings clipped away
+	uint64_t separators; // pass windings clipped away by separating planes
+	uint64_t visible; // portals marked visible
+} vis_stats_t;
+
 typedef struct {
 	portal_t *base;
-	int32_t c_chains;
+	vis_stats_t stats;
 	pstack_t pstack_head;
 } thread_data_t;
 
@@ -115,7 +129,7 @@ typedef struct map_vis_s {
 	size_t leaf_bytes; // (portal_clusters + 63) >> 3
 	size_t leaf_longs; // / sizeof(long)
 
-	size_t portal_bytes; // (num_portals * 2 + 63) >> 3
+	size_t portal_bytes; // (num_portals * 2 + 255) >> 3, a multiple of 32
 	size_t portal_longs; // / sizeof(long)
 
 	size_t uncompressed_size;
@@ -130,7 +144,11 @@ extern map_vis_t map_vis;
 
 void BaseVis(int32_t portal_num);
 void FinalVis(int32_t portal_num);
+void CheckpointPortal(const portal_t *p);
+_Bool SkipPortal(const portal_t *p);
+void PrintVisStats(void);
 
 size_t CountBits(const byte *bits, size_t max);
+void Vis_PlaneDistances(const winding_t *w, const plane_t *plane, vec_t *dists);
 
 #endif /* __QVIS_H__ */
@@ -57,52 +57,58 @@ void Sem_Shutdown(void) {
 }
 
 /**
- * @brief Return an iteration of work, updating progress when appropriate.
+ * @brief Claims the next chunk of work from the shared cursor. Chunks are handed
+ * out in ascending order, so that low work cycles finish first. Some work, such
+ * as qvis's FinalVis, relies on this to reuse the results of earlier cycles.
+ * @return True if any work was claimed, false if all work has been claimed.
  */
-static int32_t GetThreadWork(void) {
-	int r;
-	int f;
+static _Bool GetThreadWork(int32_t *begin, int32_t *end) {
 
-	ThreadLock();
+	*begin = SDL_AtomicAdd(&thread_work.index, thread_work.chunk);
 
-	if (thread_work.index == thread_work.count) { // done
-		ThreadUnlock();
-		return -1;
+	if (*begin >= thread_work.count) {
+		return false;
 	}
 
-	// update work fraction and output progress if desired
-	f = 10 * thread_work.index / thread_work.count;
-	if (f != thread_work.fraction) {
-		thread_work.fraction = f;
-		if (thread_work.progress && !(verbose || debug)) {
-			Com_Print("%i...", f);
-		}
-	}
+	*end = MIN(*begin + thread_work.chunk, thread_work.count);
+	return true;
+}
 
-	// assign the next work iteration
-	r = thread_work.index;
-	thread_work.index++;
+/**
+ * @brief Accounts for a completed chunk of work, updating progress when appropriate.
+ */
+static void CompleteThreadWork(int32_t count) {
 
-	ThreadUnlock();
+	const int32_t completed = SDL_AtomicAdd(&thread_work.completed, count) + count;
+	const int32_t f = 10 * completed / thread_work.count;
 
-	return r;
+	if (f < 10) {
+		const int32_t fraction = SDL_AtomicGet(&thread_work.fraction);
+		if (f > fraction && SDL_AtomicCAS(&thread_work.fraction, fraction, f)) {
+			if (thread_work.progress && !(verbose || debug)) {
+				Com_Print("%i...", f);
+			}
+		}
+	}
 }
 
 // generic function pointer to actual work to be done
 static ThreadWorkFunc WorkFunction;
 
 /**
- * @brief Shared work entry point by all threads. Retrieve and perform
- * chunks of work iteratively until work is finished.
+ * @brief Shared work entry point by all threads. Claim and perform chunks of
+ * work iteratively until work is finished.
  */
 static void ThreadWork(void *p __attribute__((unused))) {
-	int32_t work;
+	int32_t begin, end;
+
+	while (GetThreadWork(&begin, &end)) {
+
+		for (int32_t work = begin; work < end; work++) {
+			WorkFunction(work);
+		}
 
-	while (true) {
-		work = GetThreadWork();
-		if (work == -1)
-			break;
-		WorkFunction(work);
+		CompleteThreadWork(end - begin);
 	}
 }
 
@@ -131,14 +137,20 @@ void ThreadUnlock(void) {
 }
 
 /**
- * @brief
+ * @brief Runs the work across all workers, which claim chunks of it from a
+ * shared cursor. The calling thread participates as worker 0.
  */
 static void RunThreads(void) {
 	thread_t *t[MAX_THREADS];
 	int32_t i;
 
+	thread_work.num_workers = Thread_Count() + 1;
+
+	// small chunks keep the long tail short, large chunks keep the locks cold
+	thread_work.chunk = Clamp(thread_work.count / (thread_work.num_workers * 32), 1, 64);
+
 	if (Thread_Count() == 0) {
-		ThreadWork(0);
+		ThreadWork(NULL);
 		return;
 	}
 
@@ -147,6 +159,8 @@ static void RunThreads(void) {
 	for (i = 0; i < Thread_Count(); i++)
 		t[i] = Thread_Create(ThreadWork, NULL);
 
+	ThreadWork(NULL);
+
 	for (i = 0; i < Thread_Count(); i++)
 		Thread_Wait(t[i]);
 
@@ -160,20 +174,93 @@ static void RunThreads(void) {
 void RunThreadsOn(int32_t work_count, _Bool progress, ThreadWorkFunc func) {
 	time_t start, end;
 
-	thread_work.index = 0;
 	thread_work.count = work_count;
-	thread_work.fraction = -1;
 	thread_work.progress = progress;
 
+	SDL_AtomicSet(&thread_work.index, 0);
+	SDL_AtomicSet(&thread_work.completed, 0);
+	SDL_AtomicSet(&thread_work.fraction, 0);
+
 	WorkFunction = func;
 
 	start = time(NULL);
 
-	RunThreads();
+	if (thread_work.progress && !(verbose || debug)) {
+		Com_Print("0...");
+	}
+
+	if (work_count > 0) {
+		RunThreads();
+	}
 
 	end = time(NULL);
 
 	if (thread_work.progress)
 		Com_Print(" (%i seconds)\n", (int32_t) (end - start));
+
+	Com_Debug("%d work cycles in chunks of %d across %d workers\n",
+			thread_work.count, thread_work.chunk, thread_work.num_workers);
+}
+
+/**
+ * @brief The header preceding each thread buffer.
+ */
+typedef struct thread_buffer_link_s {
+	struct thread_buffer_link_s *next;
+	uint64_t data[];
+} thread_buffer_link_t;
+
+/**
+ * @return The calling thread's zeroed buffer in the specified set, allocating it
+ * if necessary. The size must not change until the set is freed.
+ */
+void *ThreadBuffer(thread_buffers_t *buffers, thread_buffer_t *thread_buffer, size_t size) {
+
+	if (thread_buffer->buffer == NULL || thread_buffer->generation != buffers->generation) {
+
+		thread_buffer_link_t *link = Mem_Malloc(sizeof(thread_buffer_link_t) + size);
+
+		SDL_AtomicLock(&buffers->lock);
+
+		link->next = buffers->buffers;
+		buffers->buffers = link;
+
+		thread_buffer->buffer = link->data;
+		thread_buffer->generation = buffers->generation;
+
+		SDL_AtomicUnlock(&buffers->lock);
+	}
+
+	return thread_buffer->buffer;
+}
+
+/**
+ * @brief Calls the specified function for every thread's buffer in the set.
+ */
+void ForEachThreadBuffer(thread_buffers_t *buffers, ThreadBufferFunc func, void *data) {
+
+	SDL_AtomicLock(&buffers->lock);
+
+	for (thread_buffer_link_t *link = buffers->buffers; link; link = link->next) {
+		func(link->data, data);
+	}
+
+	SDL_AtomicUnlock(&buffers->lock);
 }
 
+/**
+ * @brief Frees every thread's buffer in the set. This must only be called while
+ * no other threads are working.
+ */
+void FreeThreadBuffers(thread_buffers_t *buffers) {
+
+	thread_buffer_link_t *link = buffers->buffers;
+	while (link) {
+		thread_buffer_link_t *next = link->next;
+		Mem_Free(link);
+		link = next;
+	}
+
+	buffers->buffers = NULL;
+	buffers->generation++;
+}